@@ -1,6 +1,9 @@
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <cuda_runtime.h>
@@ -27,33 +30,47 @@
 namespace torch_tensorrt {
 namespace core {
 
-void AddEngineToGraph(
+const char WEIGHT_NAME_MAP_SUFFIX[] = "_weight_name_map";
+
+// Registers the engine as an attribute of the module unless the module already holds it (ex. an engine shared by
+// several methods), returns the name of the attribute
+std::string RegisterEngine(
     torch::jit::script::Module mod,
-    std::shared_ptr<torch::jit::Graph>& g,
-    const std::string& serialized_engine,
-    runtime::RTDevice& device_info,
-    const std::vector<std::string>& input_binding_names,
-    const std::vector<std::string>& output_binding_names,
-    std::string engine_id = "",
-    bool fallback = false) {
-  auto engine_ptr = c10::make_intrusive<runtime::TRTEngine>(
-      mod._ivalue()->name() + "_engine_" + engine_id,
-      serialized_engine,
-      device_info,
-      input_binding_names,
-      output_binding_names);
-  // Get required metadata about the engine out
-  auto num_io = engine_ptr->num_io;
+    const c10::intrusive_ptr<runtime::TRTEngine>& engine_ptr,
+    const conversion::WeightNameMap* weight_name_map) {
+  auto engine_type = c10::getCustomClassType<c10::intrusive_ptr<runtime::TRTEngine>>();
   auto name = engine_ptr->name;
+  for (size_t i = 1; mod.hasattr(name); i++) {
+    auto attr = mod.attr(name);
+    if (attr.type() == engine_type && attr.toCustomClass<runtime::TRTEngine>().get() == engine_ptr.get()) {
+      return name;
+    }
+    name = engine_ptr->name + "_" + std::to_string(i);
+  }
 
   //..
   // Add the engine as an attribute of the module, this will let the engine be
   // serialized and deserialized
-  mod.register_attribute(
-      name,
-      c10::getCustomClassType<c10::intrusive_ptr<runtime::TRTEngine>>(),
-      c10::IValue(std::move(engine_ptr)),
-      false);
+  mod.register_attribute(name, engine_type, c10::IValue(engine_ptr), false);
+
+  // Persist which weights of the engine correspond to which parameters so the engine can be refit later
+  if (weight_name_map) {
+    mod.register_attribute(
+        name + WEIGHT_NAME_MAP_SUFFIX, c10::StringType::get(), c10::IValue(weight_name_map->serialize()), false);
+  }
+  return name;
+}
+
+void AddEngineToGraph(
+    torch::jit::script::Module mod,
+    std::shared_ptr<torch::jit::Graph>& g,
+    const c10::intrusive_ptr<runtime::TRTEngine>& engine_ptr,
+    bool fallback = false,
+    const conversion::WeightNameMap* weight_name_map = nullptr) {
+  // Get required metadata about the engine out
+  engine_ptr->wait_until_deserialized();
+  auto num_io = engine_ptr->num_io;
+  auto name = RegisterEngine(mod, engine_ptr, weight_name_map);
 
   // Add the module as an input into the graph
   auto self = g->addInput("self_1");
@@ -64,32 +81,23 @@ void AddEngineToGraph(
   g->block()->appendNode(engine_node);
 
   // Add inputs to the graph corresponding to the number of input tensors
-  // expected by the engine Also store those inputs in a vector so that they can
-  // be coalesced into a single list at runtime
-  std::vector<torch::jit::Value*> engine_inputs;
+  // expected by the engine, they are passed to the engine call directly
+  // followed by the engine, which is popped off the stack first and contains
+  // all the metadata needed for execution
+  std::vector<torch::jit::Value*> execute_node_inputs;
   for (uint64_t i = 0; i < num_io.first; i++) {
     auto in_val = g->addInput(std::string("input_") + std::to_string(i));
     in_val->setType(c10::TensorType::get());
-    engine_inputs.push_back(in_val);
+    execute_node_inputs.push_back(in_val);
   }
-
-  // Create a node that will merge all of the input tensors into a single list
-  // argument to the trt::execute_engine op Creates: prim::ListConstruct(<input
-  // tensors>)
-  auto input_list_node = g->createList(c10::TensorType::get(), torch::jit::ArrayRef<torch::jit::Value*>(engine_inputs));
-  g->block()->appendNode(input_list_node);
-
-  // Make a list of inputs to the actual trt::execute_engine op
-  // Note: Ordering of list and then engine is because we can pop off the engine
-  // first which contains all the metadata needed for execution
-  std::vector<torch::jit::Value*> execute_node_inputs;
-  execute_node_inputs.push_back(input_list_node->outputs()[0]);
   execute_node_inputs.push_back(engine_node->outputs()[0]);
 
-  // Create the actual execution node trt::execute_engine using the assembled
-  // inputs
+  // Create the actual execution node tensorrt::execute_engine_unpacked using
+  // the assembled inputs, unlike tensorrt::execute_engine the inputs are not
+  // packed into a list so the interpreter hands them to the engine without
+  // copying
   auto execute_node = g->create(
-      c10::Symbol::fromQualString("tensorrt::execute_engine"),
+      c10::Symbol::fromQualString(runtime::UNPACKED_ENGINE_OP_NAME),
       torch::jit::ArrayRef<torch::jit::Value*>(execute_node_inputs),
       1);
   g->block()->appendNode(execute_node);
@@ -123,6 +131,172 @@ void AddEngineToGraph(
   return;
 }
 
+void AddEngineToGraph(
+    torch::jit::script::Module mod,
+    std::shared_ptr<torch::jit::Graph>& g,
+    const std::string& serialized_engine,
+    runtime::RTDevice& device_info,
+    const std::vector<std::string>& input_binding_names,
+    const std::vector<std::string>& output_binding_names,
+    std::string engine_id = "",
+    bool fallback = false,
+    const conversion::WeightNameMap* weight_name_map = nullptr) {
+  auto engine_ptr = c10::make_intrusive<runtime::TRTEngine>(
+      mod._ivalue()->name() + "_engine_" + engine_id,
+      serialized_engine,
+      device_info,
+      input_binding_names,
+      output_binding_names);
+  AddEngineToGraph(mod, g, engine_ptr, fallback, weight_name_map);
+}
+
+// Keeps the stitched graph of a hybrid module as its own method and replaces it with a graph which runs the
+// precompiled execution plan of the stitched graph, the plan is serialized along with the module
+std::shared_ptr<torch::jit::Graph> AddExecutionPlanToModule(
+    torch::jit::script::Module mod,
+    std::shared_ptr<torch::jit::Graph>& stitched_g,
+    const std::string& method_name = "forward") {
+  // Methods other than forward keep their stitched graph and plan under names derived from the method name
+  auto stitched_name = runtime::EXECUTION_PLAN_METHOD_NAME;
+  auto plan_name = runtime::EXECUTION_PLAN_ATTR_NAME;
+  if (method_name != "forward") {
+    stitched_name = "_" + method_name + "_stitched";
+    plan_name = "_" + method_name + "_execution_plan";
+  }
+
+  auto stitched_method = mod._ivalue()->compilation_unit()->create_function(stitched_name, stitched_g);
+  auto stitched_schema = util::GenerateGraphSchema(stitched_method->name(), stitched_g);
+  mod.type()->addMethod(stitched_method);
+  stitched_method->setSchema(stitched_schema);
+
+  mod.register_attribute(
+      plan_name,
+      c10::getCustomClassType<c10::intrusive_ptr<runtime::ExecutionPlanHolder>>(),
+      c10::IValue(c10::make_intrusive<runtime::ExecutionPlanHolder>(stitched_name)),
+      false);
+
+  // Creates:
+  //   %plan = prim::GetAttr[name="_execution_plan"](%self)
+  //   %inputs : Any[] = prim::ListConstruct(<inputs>)
+  //   %out : Any = tensorrt::execute_plan(%plan, %self, %inputs)
+  //   return (prim::unchecked_cast(%out))
+  auto g = std::make_shared<torch::jit::Graph>();
+  auto self = g->addInput()->copyMetadata(stitched_g->inputs()[0]);
+  std::vector<torch::jit::Value*> plan_inputs;
+  for (size_t i = 1; i < stitched_g->inputs().size(); i++) {
+    plan_inputs.push_back(g->addInput()->copyMetadata(stitched_g->inputs()[i]));
+  }
+  auto plan = g->insertNode(g->createGetAttr(self, plan_name))->output();
+  auto input_list = g->insertNode(g->createList(c10::AnyType::get(), plan_inputs))->output();
+  auto execute_node = g->create(c10::Symbol::fromQualString("tensorrt::execute_plan"), {plan, self, input_list}, 1);
+  g->insertNode(execute_node);
+  auto out = execute_node->output()->setType(c10::AnyType::get());
+
+  if (stitched_g->outputs().size() == 1) {
+    g->registerOutput(g->insertUncheckedCast(out, stitched_g->outputs()[0]->type()));
+  } else {
+    // Multiple outputs are returned by the plan as a tuple
+    std::vector<c10::TypePtr> output_types;
+    for (auto o : stitched_g->outputs()) {
+      output_types.push_back(o->type());
+    }
+    auto tuple = g->insertUncheckedCast(out, c10::TupleType::create(output_types));
+    for (auto o : g->insertNode(g->createTupleUnpack(tuple))->outputs()) {
+      g->registerOutput(o);
+    }
+  }
+
+  LOG_DEBUG(*g << "(AddExecutionPlanToModule)\n");
+  return g;
+}
+
+bool SameWeights(const std::vector<at::Tensor>& a, const std::vector<at::Tensor>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].is_same(b[i])) {
+      continue;
+    }
+    if (a[i].scalar_type() != b[i].scalar_type() || a[i].sizes() != b[i].sizes() || a[i].device() != b[i].device() ||
+        !a[i].equal(b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const EngineCache::Entry* EngineCache::find(const std::string& key, const std::vector<at::Tensor>& weights) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  // The key only holds a hash of the weights, they have to match exactly
+  for (const auto& e : it->second) {
+    if (SameWeights(e.weights, weights)) {
+      num_hits_++;
+      return &e;
+    }
+  }
+  return nullptr;
+}
+
+const EngineCache::Entry& EngineCache::insert(const std::string& key, Entry entry) {
+  num_entries_++;
+  auto& bucket = entries_[key];
+  bucket.push_back(std::move(entry));
+  return bucket.back();
+}
+
+// Settings which affect the engine built from a graph
+std::string CanonicalizeEngineSettings(const conversion::BuilderSettings& settings) {
+  std::ostringstream os;
+  os << settings << "\n    Sparse Weights: " << settings.sparse_weights
+     << "\n    Allow Shape Tensors: " << settings.allow_shape_tensors
+     << "\n    Engine Compression Level: " << settings.engine_compression_level
+     << "\n    Calibrator: " << static_cast<const void*>(settings.calibrator) << '\n';
+  return os.str();
+}
+
+std::string CanonicalizeGraphForEngine(
+    const std::shared_ptr<torch::jit::Graph>& g,
+    const ir::StaticParams& static_params,
+    const conversion::ConversionInfo& convert_info,
+    std::vector<at::Tensor>* weights) {
+  // Precision constraints refer to nodes by name, which is not part of the canonical form
+  if (!convert_info.engine_settings.layer_precisions.empty()) {
+    return "";
+  }
+  std::ostringstream os;
+  os << CanonicalizeEngineSettings(convert_info.engine_settings);
+  for (auto in : g->inputs()) {
+    auto param = static_params.find(in);
+    if (param != static_params.end()) {
+      // Weights passed as inputs (ex. modules which are not frozen) are not part of the canonical form of the graph
+      if (param->second.isTensor()) {
+        return "";
+      }
+      os << "param: " << param->second << '\n';
+      continue;
+    }
+    os << "input: ";
+    auto spec = convert_info.collection_input_spec_map.find(in);
+    if (spec != convert_info.collection_input_spec_map.end()) {
+      for (const auto& i : spec->second) {
+        os << i << ", ";
+      }
+    }
+    os << '\n';
+  }
+
+  auto canonical = partitioning::canonicalizeBlockWithWeights(g->block(), weights);
+  if (canonical.empty()) {
+    return "";
+  }
+  os << canonical;
+  return os.str();
+}
+
 bool CheckMethodOperatorSupport(const torch::jit::script::Module& mod, std::string method_name) {
   // Go through Lowering to simplify graph
   auto graph_and_parameters = lowering::Lower(mod, method_name, lowering::LowerInfo());
@@ -139,7 +313,8 @@ partitioning::GraphAndMapping BuildHybridGraph(
     CompileSpec cfg,
     ir::StaticParams static_params,
     ir::CollectionTypeMap first_use_types,
-    bool expect_full_compilation = false) {
+    bool expect_full_compilation = false,
+    EngineCache* engine_cache = nullptr) {
   auto convert_info = cfg.convert_info;
   auto partitioning_info = cfg.partitioning_info;
 
@@ -157,7 +332,35 @@ partitioning::GraphAndMapping BuildHybridGraph(
     int num_torch_segments = 0;
     int num_trt_segments = 0;
 
-    for (auto& seg_block : segmented_blocks) {
+    // If requested, structurally identical TensorRT segments (ex. repeated layers of a transformer) are built once as a
+    // refittable engine, the engines of the other segments in the group are produced by refitting it with their own
+    // weights
+    std::unordered_map<size_t, size_t> segment_group;
+    std::vector<size_t> group_sizes;
+    auto& engine_settings = convert_info.engine_settings;
+    // Precision constraints refer to nodes by name, which identical segments do not share
+    bool share_identical_segments = engine_settings.layer_precisions.empty();
+    // Weights refit into an engine calibrated for other weights would run with the wrong INT8 ranges
+    bool int8 = engine_settings.calibrator != nullptr ||
+        engine_settings.enabled_precisions.find(nvinfer1::DataType::kINT8) != engine_settings.enabled_precisions.end();
+    bool refit_identical_segments = partitioning_info.refit_identical_segments &&
+        engine_settings.device.device_type == nvinfer1::DeviceType::kGPU &&
+        engine_settings.capability == TRT_ENGINE_CAPABILITY_STANDARD && share_identical_segments && !int8;
+    if (refit_identical_segments) {
+      for (auto& group : partitioning::groupIdenticalSegments(segmented_blocks)) {
+        for (auto i : group) {
+          segment_group[i] = group_sizes.size();
+        }
+        group_sizes.push_back(group.size());
+      }
+    }
+    std::unordered_map<size_t, std::pair<conversion::RefitTemplate, std::chrono::duration<double>>> refit_templates;
+    std::chrono::duration<double> build_time_saved(0);
+    int num_refit_segments = 0;
+    int num_shared_segments = 0;
+
+    for (size_t seg_idx = 0; seg_idx < segmented_blocks.size(); seg_idx++) {
+      auto& seg_block = segmented_blocks[seg_idx];
       LOG_INFO("Block segment:" << seg_block);
       std::ostringstream trt_engine_id;
       trt_engine_id << reinterpret_cast<const int*>(&seg_block);
@@ -169,19 +372,68 @@ partitioning::GraphAndMapping BuildHybridGraph(
         convert_info.inputs = ir::associate_specs_with_inputs(seg_block.g(), inputs, static_params);
 
         // TODO mapping Inputs Ivalue to flatten one here
-        auto engine = conversion::ConvertBlockToEngine(seg_block.block(), convert_info, static_params);
         auto temp_g = std::make_shared<torch::jit::Graph>();
-        auto device_spec = convert_info.engine_settings.device;
-        auto cuda_device = runtime::RTDevice(device_spec.gpu_id, device_spec.device_type);
-        AddEngineToGraph(
-            new_mod,
-            temp_g,
-            engine,
-            cuda_device,
-            std::vector<std::string>(),
-            std::vector<std::string>(),
-            trt_engine_id.str(),
-            true);
+
+        // Segments identical to one an engine was already built for in this compilation, including segments of other
+        // methods or modules, use that engine
+        std::string cache_key;
+        std::vector<at::Tensor> cache_weights;
+        const EngineCache::Entry* cached = nullptr;
+        if (engine_cache && share_identical_segments) {
+          auto canonical = partitioning::canonicalizeSegmentedBlock(seg_block, &cache_weights);
+          if (!canonical.empty()) {
+            cache_key = CanonicalizeEngineSettings(engine_settings) + canonical;
+            cached = engine_cache->find(cache_key, cache_weights);
+          }
+        }
+
+        if (cached) {
+          num_shared_segments++;
+          LOG_DEBUG("Segment " << seg_idx << " is identical to a segment already built, sharing its engine");
+          AddEngineToGraph(new_mod, temp_g, cached->engine, true);
+        } else {
+          std::string engine;
+          conversion::WeightNameMap weight_name_map;
+          auto group = segment_group.find(seg_idx);
+          if (group != segment_group.end() && group_sizes[group->second] > 1) {
+            auto start = std::chrono::steady_clock::now();
+            auto tmpl = refit_templates.find(group->second);
+            if (tmpl == refit_templates.end()) {
+              auto refit_template =
+                  conversion::ConvertBlockToRefitTemplate(seg_block.block(), convert_info, static_params);
+              engine = refit_template.serialized_engine;
+              weight_name_map = refit_template.weight_name_map;
+              refit_templates[group->second] = {std::move(refit_template), std::chrono::steady_clock::now() - start};
+            } else {
+              engine = conversion::RefitTemplateWithBlock(
+                  seg_block.block(), convert_info, static_params, tmpl->second.first, &weight_name_map);
+              if (!engine.empty()) {
+                num_refit_segments++;
+                build_time_saved += tmpl->second.second - (std::chrono::steady_clock::now() - start);
+                LOG_DEBUG(
+                    "Produced the engine for segment " << seg_idx
+                                                       << " by refitting the engine of an identical segment");
+              }
+            }
+          }
+          if (engine.empty()) {
+            engine =
+                conversion::ConvertBlockToEngine(seg_block.block(), convert_info, static_params, &weight_name_map);
+          }
+          auto device_spec = convert_info.engine_settings.device;
+          auto cuda_device = runtime::RTDevice(device_spec.gpu_id, device_spec.device_type);
+          auto engine_ptr = c10::make_intrusive<runtime::TRTEngine>(
+              new_mod._ivalue()->name() + "_engine_" + trt_engine_id.str(),
+              engine,
+              cuda_device,
+              std::vector<std::string>(),
+              std::vector<std::string>());
+          engine_ptr->compression_level = engine_settings.engine_compression_level;
+          if (!cache_key.empty()) {
+            engine_cache->insert(cache_key, {engine_ptr, std::move(cache_weights)});
+          }
+          AddEngineToGraph(new_mod, temp_g, engine_ptr, true, engine_settings.refit ? &weight_name_map : nullptr);
+        }
 
         seg_block.update_graph(temp_g);
       } else {
@@ -203,6 +455,18 @@ partitioning::GraphAndMapping BuildHybridGraph(
       }
     }
 
+    if (num_shared_segments > 0) {
+      LOG_INFO(
+          "Shared the engines of " << num_shared_segments << " of " << num_trt_segments
+                                   << " TensorRT segments with identical segments compiled before them");
+    }
+    if (num_refit_segments > 0) {
+      LOG_INFO(
+          "Refit " << num_refit_segments << " of " << num_trt_segments
+                   << " TensorRT segments from the engines of structurally identical segments instead of building them,"
+                   << " saving an estimated " << build_time_saved.count() << "s of build time");
+    }
+
     // If full compilation is expected, cannot have more than 2 Torch segments
     // (one for preprocessing inputs, one for post-processing outputs) and 1 TRT segment
     if (expect_full_compilation && !(num_torch_segments <= 2 && num_trt_segments == 1)) {
@@ -212,7 +476,11 @@ partitioning::GraphAndMapping BuildHybridGraph(
     }
   }
 
-  return partitioning::stitch(&partitioning_ctx, block);
+  auto graph_and_mapping = partitioning::stitch(&partitioning_ctx, block);
+  if (partitioning_info.plan_segment_memory) {
+    LOG_INFO(partitioning::planSegmentMemory(&partitioning_ctx, block, graph_and_mapping));
+  }
+  return graph_and_mapping;
 }
 
 ir::TypeMap MapInputsAndDetermineDTypes(
@@ -297,7 +565,12 @@ ir::TypeMap MapInputsAndDetermineDTypes(
   return inferred_dtypes;
 }
 
-std::string ConvertGraphToTRTEngine(const torch::jit::script::Module& mod, std::string method_name, CompileSpec cfg) {
+// Lowers a method which is to be converted into a single TensorRT engine and checks it can be, returns the lowered
+// graph and its static parameters
+std::pair<std::shared_ptr<torch::jit::Graph>, ir::StaticParams> PrepareGraphForEngine(
+    const torch::jit::script::Module& mod,
+    std::string method_name,
+    CompileSpec& cfg) {
   // Go through Lowering to simplify graph and extract weight parameters
   auto graph_and_parameters = lowering::Lower(mod, method_name, cfg.lower_info);
 
@@ -321,109 +594,313 @@ std::string ConvertGraphToTRTEngine(const torch::jit::script::Module& mod, std::
     }
   }
 
-  auto engine = conversion::ConvertBlockToEngine(g->block(), cfg.convert_info, static_params);
+  return {g, static_params};
+}
+
+std::string ConvertGraphToTRTEngine(const torch::jit::script::Module& mod, std::string method_name, CompileSpec cfg) {
+  auto graph_and_static_params = PrepareGraphForEngine(mod, method_name, cfg);
+  auto g = graph_and_static_params.first;
+  auto engine = conversion::ConvertBlockToEngine(g->block(), cfg.convert_info, graph_and_static_params.second);
 
   return engine;
 }
 
+void ConvertGraphToTRTEngineFile(
+    const torch::jit::script::Module& mod,
+    std::string method_name,
+    CompileSpec cfg,
+    const std::string& path) {
+  auto graph_and_static_params = PrepareGraphForEngine(mod, method_name, cfg);
+  auto g = graph_and_static_params.first;
+  conversion::ConvertBlockToEngineFile(g->block(), cfg.convert_info, graph_and_static_params.second, path);
+}
+
 bool userRequestedFallback(CompileSpec& cfg) {
   return cfg.lower_info.forced_fallback_modules.size() != 0 ||
       cfg.partitioning_info.forced_fallback_operators.size() != 0;
 }
 
-torch::jit::Module CompileGraph(const torch::jit::Module& mod, CompileSpec cfg) {
-  torch::jit::Module new_mod(mod._ivalue()->name() + "_trt");
-
+// Compiles one method of mod into new_mod, returns the graph of the compiled method. If no TensorRT engines were
+// generated for it the graph runs the method in Torch
+std::shared_ptr<torch::jit::Graph> CompileMethod(
+    const torch::jit::Module& mod,
+    torch::jit::Module& new_mod,
+    const std::string& method_name,
+    CompileSpec cfg,
+    EngineCache* engine_cache) {
   auto device_spec = cfg.convert_info.engine_settings.device;
   auto cuda_device = runtime::RTDevice(device_spec.gpu_id, device_spec.device_type);
 
-  for (const torch::jit::Method& method : mod.get_methods()) {
-    if (method.name().compare("forward") == 0) {
-      auto new_g = std::make_shared<torch::jit::Graph>();
+  if (cfg.convert_info.engine_settings.refit) {
+    // Engines of a refittable module are not shared, the weight name map of a shared engine would only name the
+    // parameters of the first graph or segment it was built for and refitting would leave the others stale
+    engine_cache = nullptr;
+    // Lowering freezes a shallow copy of the module so its constants share data with the parameters, this is how
+    // weights are traced back to the parameters they were created from
+    for (const auto& p : mod.named_parameters()) {
+      cfg.convert_info.named_params.push_back({p.name, p.value});
+    }
+    for (const auto& b : mod.named_buffers()) {
+      cfg.convert_info.named_params.push_back({b.name, b.value});
+    }
+  }
 
-      auto graph_and_parameters = lowering::Lower(mod, method.name(), cfg.lower_info);
+  auto new_g = std::make_shared<torch::jit::Graph>();
 
-      auto g = graph_and_parameters.first;
-      auto params = graph_and_parameters.second;
-      auto static_params = ir::get_static_params(g->inputs(), params);
-      // Infer the type of an input from the weights of the calculation
-      auto first_use_types = ir::get_block_first_calc_dtypes_opt_collection(g->block());
+  auto graph_and_parameters = lowering::Lower(mod, method_name, cfg.lower_info);
 
-      // Determine if the block is convertible/has collection output, and based on the result,
-      // whether full compilation can be expected
-      auto isBlockConvertible = conversion::VerifyConverterSupportForBlock(g->block(), true);
-      auto inputIsCollection = conversion::InputIsCollection(g->block());
-      auto outputIsCollection = conversion::OutputIsCollection(g->block());
-      auto requires_collection_handling = (isBlockConvertible && (inputIsCollection || outputIsCollection));
+  auto g = graph_and_parameters.first;
+  auto params = graph_and_parameters.second;
+  auto static_params = ir::get_static_params(g->inputs(), params);
+  // Infer the type of an input from the weights of the calculation
+  auto first_use_types = ir::get_block_first_calc_dtypes_opt_collection(g->block());
 
-      // Determine whether user specifications necessitate partitioning
-      auto isFallbackRequested = userRequestedFallback(cfg);
+  // Determine if the block is convertible/has collection output, and based on the result,
+  // whether full compilation can be expected
+  conversion::NodeBindingTable node_bindings;
+  node_bindings.bind(g->block());
+  auto isBlockConvertible = conversion::VerifyConverterSupportForBlock(g->block(), true, &node_bindings);
+  auto inputIsCollection = conversion::InputIsCollection(g->block());
+  auto outputIsCollection = conversion::OutputIsCollection(g->block());
+  auto requires_collection_handling = (isBlockConvertible && (inputIsCollection || outputIsCollection));
+
+  // Determine whether user specifications necessitate partitioning
+  auto isFallbackRequested = userRequestedFallback(cfg);
+
+  // Extract map of IValue to DType
+  auto type_map = MapInputsAndDetermineDTypes(cfg, g, static_params, first_use_types, requires_collection_handling);
+
+  // Check whether any of the input types are Long
+  bool user_requested_long = false;
+  for (auto dtype : type_map) {
+    user_requested_long |= dtype.second && (dtype.second.value() == at::kLong);
+  }
 
-      // Extract map of IValue to DType
-      auto type_map = MapInputsAndDetermineDTypes(cfg, g, static_params, first_use_types, requires_collection_handling);
+  // Use dtype map to autocast Tensor-type inputs to Long dtype as necessary
+  if (cfg.partitioning_info.enabled && cfg.partitioning_info.truncate_long_and_double && user_requested_long) {
+    auto casts_inserted = lowering::AutocastLongInputs(g, type_map, cfg.lower_info.getGPUDeviceString());
+    user_requested_long &= (casts_inserted > 0);
+  }
 
-      // Check whether any of the input types are Long
-      bool user_requested_long = false;
-      for (auto dtype : type_map) {
-        user_requested_long |= dtype.second && (dtype.second.value() == at::kLong);
-      }
+  // Partitioning is required if:
+  // 1. User requested some modules/operators fallback
+  // 2. The block (graph) cannot be converted due to operator coverage
+  // 3. The output of the graph is a collection
+  // 4. The user requested a non-TRT data type input
+  auto isPartitioningRequired =
+      (isFallbackRequested || !isBlockConvertible || outputIsCollection || user_requested_long);
+
+  // The user did not require full compilation, but the model can be fully compiled
+  if (cfg.partitioning_info.enabled && !isPartitioningRequired) {
+    LOG_INFO("Skipping partitioning since model is fully supported");
+  }
 
-      // Use dtype map to autocast Tensor-type inputs to Long dtype as necessary
-      if (cfg.partitioning_info.enabled && cfg.partitioning_info.truncate_long_and_double && user_requested_long) {
-        auto casts_inserted = lowering::AutocastLongInputs(g, type_map, cfg.lower_info.getGPUDeviceString());
-        user_requested_long &= (casts_inserted > 0);
-      }
+  // The user did not require full compilation, and the model can be fully compiled
+  // or, the user required full compilation but the I/O of the graph use collections
+  if ((cfg.partitioning_info.enabled && isPartitioningRequired) || requires_collection_handling) {
+    // If the model is fully-compilable and the user has specified full compilation, run partitioning
+    // to generate collection-processing code in Torch
+    auto expect_full_compilation = (requires_collection_handling && !cfg.partitioning_info.enabled);
+
+    auto graph_and_mapping = BuildHybridGraph(
+        new_mod, g->block(), cfg, static_params, first_use_types, expect_full_compilation, engine_cache);
+    new_g = graph_and_mapping.first;
+    // renaming the input name of graph after fallback to ensure pytorch deserialize it correctly
+    for (size_t i = 0; i < new_g->inputs().size(); ++i) {
+      new_g->inputs()[i]->setDebugName(std::string("input_") + std::to_string(i));
+    }
+    LOG_INFO(*new_g << "(GraphAfterFallback)");
+
+    // if there is no tensorrt engine self in fallback graph, there is no conversion, the method runs in Torch and
+    // only takes the module as self to be one of its methods
+    if (new_g->inputs()[0]->type()->str().find("__torch__") == std::string::npos) {
+      LOG_WARNING("Method " << method_name << " does not run any operations in TensorRT, it is kept to run in Torch");
+      new_g->insertInput(0, "self_1")->setType(new_mod.type());
+      return new_g;
+    }
 
-      // Partitioning is required if:
-      // 1. User requested some modules/operators fallback
-      // 2. The block (graph) cannot be converted due to operator coverage
-      // 3. The output of the graph is a collection
-      // 4. The user requested a non-TRT data type input
-      auto isPartitioningRequired =
-          (isFallbackRequested || !isBlockConvertible || outputIsCollection || user_requested_long);
-
-      // The user did not require full compilation, but the model can be fully compiled
-      if (cfg.partitioning_info.enabled && !isPartitioningRequired) {
-        LOG_INFO("Skipping partitioning since model is fully supported");
+    if (cfg.partitioning_info.use_execution_plan) {
+      new_g = AddExecutionPlanToModule(new_mod, new_g, method_name);
+    }
+  } else {
+    TORCHTRT_CHECK(
+        conversion::VerifyConverterSupportForBlock(g->block(), false, &node_bindings),
+        "Not all operations in graph are supported by the compiler");
+    // The whole graph is a single engine, which is shared with any identical method compiled before it. Keying the
+    // graph copies and hashes all of its weights, so it is only done when other methods use the same cache
+    std::vector<at::Tensor> cache_weights;
+    std::string cache_key;
+    if (engine_cache) {
+      cache_key = CanonicalizeGraphForEngine(g, static_params, cfg.convert_info, &cache_weights);
+    }
+    auto cached = cache_key.empty() ? nullptr : engine_cache->find(cache_key, cache_weights);
+    if (cached) {
+      LOG_INFO("Method " << method_name << " is identical to a graph already compiled, sharing its engine");
+      AddEngineToGraph(new_mod, new_g, cached->engine, false);
+    } else {
+      // TODO find the right
+      conversion::WeightNameMap weight_name_map;
+      auto engine = conversion::ConvertBlockToEngine(g->block(), cfg.convert_info, static_params, &weight_name_map);
+      auto engine_ptr = c10::make_intrusive<runtime::TRTEngine>(
+          new_mod._ivalue()->name() + "_engine_" + (method_name == "forward" ? "" : method_name),
+          engine,
+          cuda_device,
+          std::vector<std::string>(),
+          std::vector<std::string>());
+      engine_ptr->compression_level = cfg.convert_info.engine_settings.engine_compression_level;
+      if (!cache_key.empty()) {
+        engine_cache->insert(cache_key, {engine_ptr, std::move(cache_weights)});
       }
+      AddEngineToGraph(
+          new_mod,
+          new_g,
+          engine_ptr,
+          false,
+          cfg.convert_info.engine_settings.refit ? &weight_name_map : nullptr);
+    }
+  }
+  return new_g;
+}
 
-      // The user did not require full compilation, and the model can be fully compiled
-      // or, the user required full compilation but the I/O of the graph use collections
-      if ((cfg.partitioning_info.enabled && isPartitioningRequired) || requires_collection_handling) {
-        // If the model is fully-compilable and the user has specified full compilation, run partitioning
-        // to generate collection-processing code in Torch
-        auto expect_full_compilation = (requires_collection_handling && !cfg.partitioning_info.enabled);
-
-        auto graph_and_mapping =
-            BuildHybridGraph(new_mod, g->block(), cfg, static_params, first_use_types, expect_full_compilation);
-        new_g = graph_and_mapping.first;
-        // renaming the input name of graph after fallback to ensure pytorch deserialize it correctly
-        for (size_t i = 0; i < new_g->inputs().size(); ++i) {
-          new_g->inputs()[i]->setDebugName(std::string("input_") + std::to_string(i));
-        }
-        LOG_INFO(*new_g << "(GraphAfterFallback)");
+torch::jit::Module CompileGraph(const torch::jit::Module& mod, CompileSpec cfg) {
+  return CompileGraph(mod, std::vector<MethodCompileSpec>{{"forward", cfg}}, nullptr);
+}
 
-        // if there is no tensorrt engine self in fallback graph, there is no conversion, we just return the initial
-        // module
-        if (new_g->inputs()[0]->type()->str().find("__torch__") == std::string::npos) {
-          LOG_WARNING("Didn't generate any TensorRT engines, the compiler did nothing\n");
-          return mod;
-        }
-      } else {
+torch::jit::Module CompileGraph(
+    const torch::jit::Module& mod,
+    const std::vector<MethodCompileSpec>& method_specs,
+    EngineCache* engine_cache) {
+  torch::jit::Module new_mod(mod._ivalue()->name() + "_trt");
+  // A single method has nothing to share engines with, nor do the methods of a refittable module
+  bool refit = false;
+  for (const auto& spec : method_specs) {
+    refit = refit || spec.cfg.convert_info.engine_settings.refit;
+  }
+  EngineCache local_engine_cache;
+  if (!engine_cache && !refit && method_specs.size() > 1) {
+    engine_cache = &local_engine_cache;
+  }
+
+  for (const auto& spec : method_specs) {
+    TORCHTRT_CHECK(mod.find_method(spec.method_name), "Module does not have a method named " << spec.method_name);
+    auto new_g = CompileMethod(mod, new_mod, spec.method_name, spec.cfg, engine_cache);
+    auto new_method = new_mod._ivalue()->compilation_unit()->create_function(spec.method_name, new_g);
+    auto schema = util::GenerateGraphSchema(new_method->name(), new_g);
+    new_mod.type()->addMethod(new_method);
+    new_method->setSchema(schema);
+  }
+
+  // if there is no tensorrt engine in any of the methods, there is no conversion, we just return the initial module
+  auto engine_type = c10::getCustomClassType<c10::intrusive_ptr<runtime::TRTEngine>>();
+  bool has_engines = false;
+  for (const auto& attr : new_mod.named_attributes(/*recurse=*/false)) {
+    has_engines = has_engines || attr.value.type() == engine_type;
+  }
+  if (!has_engines) {
+    LOG_WARNING("Didn't generate any TensorRT engines, the compiler did nothing\n");
+    return mod;
+  }
+  if (engine_cache && engine_cache->num_hits() > 0) {
+    LOG_INFO(
+        "Built " << engine_cache->size() << " TensorRT engines, " << engine_cache->num_hits()
+                 << " identical graphs or segments reused one of them");
+  }
+  return new_mod;
+}
+
+std::vector<torch::jit::Module> CompileGraphs(
+    const std::vector<std::pair<torch::jit::Module, std::vector<MethodCompileSpec>>>& modules) {
+  // Refittable engines are only shared within a module, refitting a module should not change the weights of another
+  std::vector<bool> refit(modules.size(), false);
+  size_t num_shared_methods = 0;
+  for (size_t i = 0; i < modules.size(); i++) {
+    for (const auto& spec : modules[i].second) {
+      refit[i] = refit[i] || spec.cfg.convert_info.engine_settings.refit;
+    }
+    if (!refit[i]) {
+      num_shared_methods += modules[i].second.size();
+    }
+  }
+
+  EngineCache shared_engine_cache;
+  std::vector<torch::jit::Module> compiled;
+  for (size_t i = 0; i < modules.size(); i++) {
+    // Without a cache CompileGraph only shares engines between the methods of the module, if it has several
+    auto engine_cache = !refit[i] && num_shared_methods > 1 ? &shared_engine_cache : nullptr;
+    compiled.push_back(CompileGraph(modules[i].first, modules[i].second, engine_cache));
+  }
+  return compiled;
+}
+
+void RefitModule(torch::jit::Module& mod, const std::unordered_map<std::string, at::Tensor>& new_params) {
+  auto engine_type = c10::getCustomClassType<c10::intrusive_ptr<runtime::TRTEngine>>();
+  std::unordered_set<std::string> refit_params;
+  int num_engines = 0;
+
+  for (const auto& attr : mod.named_attributes(/*recurse=*/false)) {
+    if (attr.value.type() != engine_type) {
+      continue;
+    }
+    num_engines++;
+    auto map_name = attr.name + WEIGHT_NAME_MAP_SUFFIX;
+    TORCHTRT_CHECK(
+        mod.hasattr(map_name),
+        "Engine " << attr.name
+                  << " was not built refittable, compile the module with refit enabled to update its weights");
+    auto weight_name_map = conversion::WeightNameMap::deserialize(mod.attr(map_name).toStringRef());
+    auto engine = attr.value.toCustomClass<runtime::TRTEngine>();
+    engine->wait_until_deserialized();
+
+    std::unique_lock<std::mutex> lock(engine->mu);
+    runtime::set_rt_device(engine->device_info);
+    auto refitter = make_trt(nvinfer1::createInferRefitter(*engine->cuda_engine, util::logging::get_logger()));
+    TORCHTRT_CHECK(refitter, "Unable to create a refitter for engine " << attr.name);
+
+    // The refitter does not copy the weights, they must stay alive until the engine is refit
+    std::vector<at::Tensor> new_weights;
+    for (const auto& p : new_params) {
+      for (const auto& entry : weight_name_map.lookup(p.first)) {
+        auto t = p.second.to(at::kCPU).to(util::TRTDataTypeToScalarType(entry.dtype)).contiguous();
+        TORCHTRT_CHECK(
+            t.numel() == entry.count,
+            "Parameter " << p.first << " has " << t.numel() << " elements, the engine was built with " << entry.count);
+        new_weights.push_back(t);
+        auto weights = nvinfer1::Weights{entry.dtype, t.data_ptr(), entry.count};
         TORCHTRT_CHECK(
-            conversion::VerifyConverterSupportForBlock(g->block()),
-            "Not all operations in graph are supported by the compiler");
-        // TODO find the right
-        auto engine = conversion::ConvertBlockToEngine(g->block(), cfg.convert_info, static_params);
-        AddEngineToGraph(new_mod, new_g, engine, cuda_device, std::vector<std::string>(), std::vector<std::string>());
+            refitter->setWeights(entry.layer_name.c_str(), entry.role, weights),
+            "Unable to set the weights of layer " << entry.layer_name << " from parameter " << p.first);
+        refit_params.insert(p.first);
       }
-      auto new_method = new_mod._ivalue()->compilation_unit()->create_function(method.name(), new_g);
-      auto schema = util::GenerateGraphSchema(new_method->name(), new_g);
-      new_mod.type()->addMethod(new_method);
-      new_method->setSchema(schema);
+    }
+    if (new_weights.empty()) {
+      continue;
+    }
+
+    auto num_missing = refitter->getMissing(0, nullptr, nullptr);
+    if (num_missing > 0) {
+      std::vector<const char*> layer_names(num_missing);
+      std::vector<nvinfer1::WeightsRole> roles(num_missing);
+      refitter->getMissing(num_missing, layer_names.data(), roles.data());
+      std::stringstream ss;
+      for (auto l : layer_names) {
+        ss << "\n    " << l;
+      }
+      TORCHTRT_THROW_ERROR(
+          "Refitting engine " << attr.name << " also requires new weights for the following layers, which were not "
+                              << "created directly from parameters of the module:" << ss.str());
+    }
+    TORCHTRT_CHECK(refitter->refitCudaEngine(), "Failed to refit engine " << attr.name);
+    LOG_DEBUG("Refit engine " << attr.name << " with " << new_weights.size() << " new weights");
+  }
+
+  TORCHTRT_CHECK(num_engines > 0, "Module does not contain any TensorRT engines to refit");
+  for (const auto& p : new_params) {
+    if (refit_params.find(p.first) == refit_params.end()) {
+      LOG_WARNING(
+          "Parameter " << p.first << " does not correspond to weights of any engine and was not updated, it may have "
+                       << "been folded into other weights during compilation or be used by operations run in PyTorch");
     }
   }
-  return new_mod;
 }
 
 torch::jit::script::Module EmbedEngineInNewModule(
@@ -444,6 +921,29 @@ torch::jit::script::Module EmbedEngineInNewModule(
   return new_mod;
 }
 
+torch::jit::script::Module EmbedEngineFileInNewModule(
+    const std::string& path,
+    runtime::RTDevice cuda_device,
+    const std::vector<std::string>& input_binding_names,
+    const std::vector<std::string>& output_binding_names) {
+  // The mapping is released once the engine is deserialized, TensorRT keeps its own copy of the engine
+  auto blob = util::EngineBlob::MapFile(path);
+  std::ostringstream engine_id;
+  engine_id << reinterpret_cast<const int*>(blob.get());
+  torch::jit::script::Module new_mod("tensorrt_engine_mod_" + engine_id.str());
+  auto engine_ptr = c10::make_intrusive<runtime::TRTEngine>(
+      new_mod._ivalue()->name() + "_engine_", *blob, cuda_device, input_binding_names, output_binding_names);
+  blob.reset();
+  auto new_g = std::make_shared<torch::jit::Graph>();
+  AddEngineToGraph(new_mod, new_g, engine_ptr);
+  auto new_method = new_mod._ivalue()->compilation_unit()->create_function("forward", new_g);
+  auto schema = util::GenerateGraphSchema(new_method->name(), new_g);
+  new_mod.type()->addMethod(new_method);
+  new_method->setSchema(schema);
+
+  return new_mod;
+}
+
 void set_device(const int gpu_id) {
   TORCHTRT_ASSERT(cudaSetDevice(gpu_id) == cudaSuccess, "Unable to set CUDA device: " << gpu_id);
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cuda_runtime.h>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "core/conversion/conversion.h"
 #include "core/ir/ir.h"
@@ -22,18 +24,95 @@ struct CompileSpec {
   partitioning::PartitioningInfo partitioning_info;
 };
 
+// Compilation settings for one method of a module
+struct MethodCompileSpec {
+  std::string method_name;
+  CompileSpec cfg;
+};
+
+// TensorRT engines built during a single compilation call, shared by the methods and modules compiled in that call.
+// Engines are keyed by the canonical form of the graph they were built from, including a hash of its weights, and by
+// the settings they were built with. The weights themselves are kept to confirm a match exactly
+class EngineCache {
+ public:
+  struct Entry {
+    c10::intrusive_ptr<runtime::TRTEngine> engine;
+    std::vector<at::Tensor> weights;
+  };
+
+  // Returns the engine built for key from the same weights, nullptr if there is none
+  const Entry* find(const std::string& key, const std::vector<at::Tensor>& weights);
+  const Entry& insert(const std::string& key, Entry entry);
+
+  size_t size() const {
+    return num_entries_;
+  }
+  size_t num_hits() const {
+    return num_hits_;
+  }
+
+ private:
+  std::unordered_map<std::string, std::vector<Entry>> entries_;
+  size_t num_entries_ = 0;
+  size_t num_hits_ = 0;
+};
+
+// Key of the engine built for a whole lowered graph with the given settings, empty if the graph cannot be
+// canonicalized. The weights of the graph are appended to weights
+std::string CanonicalizeGraphForEngine(
+    const std::shared_ptr<torch::jit::Graph>& g,
+    const ir::StaticParams& static_params,
+    const conversion::ConversionInfo& convert_info,
+    std::vector<at::Tensor>* weights);
+
 bool CheckMethodOperatorSupport(const torch::jit::script::Module& mod, std::string method_name);
 
 std::string ConvertGraphToTRTEngine(const torch::jit::script::Module& mod, std::string method_name, CompileSpec cfg);
 
+// Converts a method into a TensorRT engine written to path. Unlike ConvertGraphToTRTEngine the engine is never copied
+// out of the memory TensorRT serialized it to, which keeps peak host memory down for very large engines
+void ConvertGraphToTRTEngineFile(
+    const torch::jit::script::Module& mod,
+    std::string method_name,
+    CompileSpec cfg,
+    const std::string& path);
+
 torch::jit::script::Module CompileGraph(const torch::jit::script::Module& module, CompileSpec cfg);
 
+// Compiles several methods of a module into one module. Identical graphs or segments in different methods are built
+// into a single engine which the methods share, through engine_cache if given (ex. to share with other modules) or a
+// cache of the call if there are several methods. Engines are not shared when refit is enabled. Methods which run
+// no operations in TensorRT are kept to run in Torch, the original module is returned if none does
+torch::jit::script::Module CompileGraph(
+    const torch::jit::script::Module& module,
+    const std::vector<MethodCompileSpec>& method_specs,
+    EngineCache* engine_cache = nullptr);
+
+// Compiles the methods of several modules in one call. Engines are shared between all of the methods of all of the
+// modules, except by modules compiled refittable which keep their own engines so refitting one does not affect others
+std::vector<torch::jit::script::Module> CompileGraphs(
+    const std::vector<std::pair<torch::jit::script::Module, std::vector<MethodCompileSpec>>>& modules);
+
+// Suffix of the module attribute holding the serialized weight name map of a refittable engine
+extern const char WEIGHT_NAME_MAP_SUFFIX[];
+
+// Updates the weights of the refittable engines in a compiled module from a new set of named parameters
+void RefitModule(torch::jit::Module& mod, const std::unordered_map<std::string, at::Tensor>& new_params);
+
 torch::jit::script::Module EmbedEngineInNewModule(
     const std::string& engine,
     runtime::RTDevice cuda_device,
     const std::vector<std::string>& input_binding_names,
     const std::vector<std::string>& output_binding_names);
 
+// Same as EmbedEngineInNewModule for an engine written to path, the file is memory mapped rather than read into host
+// memory while the engine is deserialized
+torch::jit::script::Module EmbedEngineFileInNewModule(
+    const std::string& path,
+    runtime::RTDevice cuda_device,
+    const std::vector<std::string>& input_binding_names,
+    const std::vector<std::string>& output_binding_names);
+
 void set_device(const int gpu_id);
 
 } // namespace core
@@ -23,6 +23,39 @@ bool OpSupported(const torch::jit::Node* n) {
   return evaluators::shouldEvalAtConversionTime(n) || converters::node_is_convertable(n);
 }
 
+NodeBinding BindNode(const torch::jit::Node* n) {
+  NodeBinding binding;
+  binding.evaluator = evaluators::findNodeEvaluator(n);
+  binding.converter = converters::find_node_converter(n);
+  return binding;
+}
+
+void NodeBindingTable::bind(const torch::jit::Block* b) {
+  for (const auto n : b->nodes()) {
+    if (bindings_.find(n) == bindings_.end()) {
+      bindings_.emplace(n, BindNode(n));
+    }
+    for (const auto sub_b : n->blocks()) {
+      bind(sub_b);
+    }
+  }
+}
+
+const NodeBinding& NodeBindingTable::get(const torch::jit::Node* n) {
+  auto iter = bindings_.find(n);
+  if (iter == bindings_.end()) {
+    iter = bindings_.emplace(n, BindNode(n)).first;
+  }
+  return iter->second;
+}
+
+NodeBindingTable& GetNodeBindings(ConversionCtx* ctx) {
+  if (!ctx->node_bindings) {
+    ctx->node_bindings = std::make_shared<NodeBindingTable>();
+  }
+  return *ctx->node_bindings;
+}
+
 bool SpecialCaseSupport(const torch::jit::Node* n) {
   return n->kind() == torch::jit::prim::Loop || n->kind() == torch::jit::prim::If;
 }
@@ -46,7 +79,7 @@ c10::optional<torch::jit::IValue> EvaluateNode(ConversionCtx* ctx, const torch::
       eval_args[eval_in] = &(ctx->evaluated_value_map[eval_in]);
     } else if (ctx->value_tensor_map.find(eval_in) != ctx->value_tensor_map.end()) {
       eval_args[eval_in] = ctx->value_tensor_map[eval_in];
-    } else if (evaluators::shouldEvalAtConversionTime(eval_in->node())) {
+    } else if (GetNodeBindings(ctx).get(eval_in->node()).evaluated()) {
       auto result = EvaluateNode(ctx, eval_in->node(), level++, limit);
       if (result) {
         // WARN: If the converter returns None then should pass through
@@ -68,13 +101,17 @@ c10::optional<torch::jit::IValue> EvaluateNode(ConversionCtx* ctx, const torch::
       return {};
     }
   }
-  auto eval = evaluators::EvalNode(ctx, n, eval_args);
+  auto& evaluator = GetNodeBindings(ctx).get(n).evaluator;
+  TORCHTRT_CHECK(
+      evaluator, "Requested evaluator for " << n->kind().toQualString() << ", but no such evaluator was found");
+  auto eval = evaluator(ctx, n, eval_args);
   return eval;
 }
 
 void AddLayer(ConversionCtx* ctx, const torch::jit::Node* n) {
   LOG_INFO(ctx->logger, "Adding Layer " << util::node_info(n) << " (ctx.AddLayer)");
   converters::args node_args;
+  node_args.reserve(n->inputs().size());
   for (auto input : n->inputs()) {
     auto input_node = input->node();
     if (ctx->value_tensor_map.find(input) != ctx->value_tensor_map.end()) {
@@ -85,7 +122,7 @@ void AddLayer(ConversionCtx* ctx, const torch::jit::Node* n) {
       // Node input is a value that has already been evaluated
       LOG_DEBUG(ctx->logger, "Node input is a result of a previously evaluated value");
       node_args.push_back(&(ctx->evaluated_value_map[input]));
-    } else if (evaluators::shouldEvalAtConversionTime(input_node)) {
+    } else if (GetNodeBindings(ctx).get(input_node).evaluated()) {
       // Node input is a node that needs to be evaluated before
       // the node can be converted
       LOG_DEBUG(ctx->logger, "Node input is a value that needs to be evaluated");
@@ -121,7 +158,7 @@ void AddLayer(ConversionCtx* ctx, const torch::jit::Node* n) {
   auto schema = n->maybeSchema();
   TORCHTRT_CHECK(schema, "Unable to get schema for Node " << util::node_info(n) << " (conversion.AddLayer)");
 
-  auto converter = converters::get_node_converter_for(schema);
+  auto& converter = GetNodeBindings(ctx).get(n).converter;
   TORCHTRT_CHECK(
       converter,
       "Unable to convert node: "
@@ -129,10 +166,12 @@ void AddLayer(ConversionCtx* ctx, const torch::jit::Node* n) {
           << " requested, but no such converter was found.\nIf you need a converter for this operator, you can try implementing one yourself\n"
           << "or request a converter: https://www.github.com/NVIDIA/Torch-TensorRT/issues");
 
+  auto first_layer = ctx->net->getNbLayers();
   TORCHTRT_CHECK(
       converter(ctx, n, node_args),
       "Converter for " << *schema << " failed to convert node: " << util::node_info(n)
                        << "please report this error to https://www.github.com/NVIDIA/Torch-TensorRT/issues");
+  ctx->ApplyLayerPrecision(n, first_layer);
 }
 
 void AddInputs(ConversionCtx* ctx, c10::ArrayRef<const torch::jit::Value*> inputs, ConversionInfo& conversion_info) {
@@ -331,7 +370,7 @@ void EvaluateConditionalBlock(ConversionCtx* ctx, const torch::jit::Node* n, boo
       EvaluateLoopBlock(ctx, bn);
     } else if (bn->kind() == torch::jit::prim::If) {
       EvaluateConditionalBlock(ctx, bn, contained_in_loop);
-    } else if (evaluators::shouldEvalAtConversionTime(bn)) {
+    } else if (GetNodeBindings(ctx).get(bn).evaluated()) {
       auto eval = EvaluateNode(ctx, bn);
       if (!eval.value().isTensor()) {
         LOG_DEBUG(ctx->logger, "(Conditional Evaluation) Found the value to be: " << eval.value());
@@ -345,7 +384,7 @@ void EvaluateConditionalBlock(ConversionCtx* ctx, const torch::jit::Node* n, boo
                                                                               << ')');
       }
       ctx->AssociateValueAndIValue(bn->output(0), eval.value());
-    } else if (converters::node_is_convertable(bn)) {
+    } else if (GetNodeBindings(ctx).get(bn).convertable()) {
       AddLayer(ctx, bn);
     } else {
       TORCHTRT_THROW_ERROR(
@@ -381,7 +420,7 @@ void EvaluateLoopBlock(ConversionCtx* ctx, const torch::jit::Node* n) {
         EvaluateConditionalBlock(ctx, bn, true);
       } else {
         TORCHTRT_CHECK(
-            evaluators::shouldEvalAtConversionTime(bn),
+            GetNodeBindings(ctx).get(bn).evaluated(),
             "Torch-TensorRT.TorchScript currently can only compile loops that are evaluatable at conversion time but node "
                 << *bn << " cannot be evaluated.");
         auto eval = EvaluateNode(ctx, bn);
@@ -413,21 +452,37 @@ void ConvertBlockToNetDef(
   LOG_INFO(ctx->logger, "Converting Block");
   LOG_DEBUG(ctx->logger, *b->owningGraph());
 
+  if (ctx->settings.refit) {
+    for (auto& p : build_info.named_params) {
+      if (p.second.defined()) {
+        ctx->named_params.insert({p.second.data_ptr(), p});
+      }
+    }
+  }
+
   auto inputs = b->inputs();
   AddParamsToCtxValueMap(ctx, static_params);
   AddInputs(ctx, inputs, build_info);
 
   auto nodes = b->nodes();
+  // Resolve the evaluator or converter of every node up front so nodes checked several times (ex. inputs of other
+  // nodes, nodes in conditionals) are only looked up in the registries once
+  auto& bindings = GetNodeBindings(ctx);
+  bindings.bind(b);
+  // Shape arithmetic, constant lists and tensors created from them only depend on static values, so they are
+  // evaluated before building the network with independent nodes evaluated in parallel
+  auto static_results = EvaluateStaticNodes(ctx, b);
 
   for (const auto n : nodes) {
-    bool to_eval = evaluators::shouldEvalAtConversionTime(n);
+    bool to_eval = bindings.get(n).evaluated();
     bool ignored = isNodeConversionIgnored(n);
     if (n->kind() == torch::jit::prim::Loop) {
       EvaluateLoopBlock(ctx, n);
     } else if (n->kind() == torch::jit::prim::If) {
       EvaluateConditionalBlock(ctx, n);
     } else if (to_eval) {
-      auto eval = EvaluateNode(ctx, n);
+      auto static_result = static_results.find(n);
+      auto eval = static_result != static_results.end() ? static_result->second : EvaluateNode(ctx, n);
       if (eval) {
         if (n->outputs().size() > 1) { // For ListUnpack scenario
           if (eval.value().isTuple()) {
@@ -497,20 +552,41 @@ void ConvertBlockToNetDef(
 std::string ConvertBlockToEngine(
     const torch::jit::Block* b,
     ConversionInfo build_info,
-    ir::StaticParams& static_params) {
+    ir::StaticParams& static_params,
+    WeightNameMap* weight_name_map) {
   ConversionCtx ctx(build_info.engine_settings);
   ConvertBlockToNetDef(&ctx, b, build_info, static_params);
   std::string engine = ctx.SerializeEngine();
+  if (weight_name_map) {
+    *weight_name_map = ctx.GetWeightNameMap();
+  }
   return engine;
 }
 
-std::unordered_map<c10::OperatorName, std::string> GetUnsupportedOpsInBlock(const torch::jit::Block* b) {
+void ConvertBlockToEngineFile(
+    const torch::jit::Block* b,
+    ConversionInfo build_info,
+    ir::StaticParams& static_params,
+    const std::string& path,
+    WeightNameMap* weight_name_map) {
+  ConversionCtx ctx(build_info.engine_settings);
+  ConvertBlockToNetDef(&ctx, b, build_info, static_params);
+  ctx.SerializeEngineToFile(path);
+  if (weight_name_map) {
+    *weight_name_map = ctx.GetWeightNameMap();
+  }
+}
+
+std::unordered_map<c10::OperatorName, std::string> GetUnsupportedOpsInBlock(
+    const torch::jit::Block* b,
+    NodeBindingTable* bindings) {
   std::unordered_map<c10::OperatorName, std::string> unsupported_ops;
   for (const auto n : b->nodes()) {
     auto schema = n->maybeSchema();
     // Some ops like torch::jit::prim::Loop, torch::jit::prim::If, torch::jit::prim::DictConstruct don't have a schema
     // but they are supported. torch::jit::prim::DictConstruct is supported via fallback only
-    if (!OpSupported(n) && !SpecialCaseSupport(n)) {
+    bool supported = bindings ? bindings->get(n).supported() : OpSupported(n);
+    if (!supported && !SpecialCaseSupport(n)) {
       if (schema) {
         std::stringstream ss;
         ss << *schema;
@@ -525,25 +601,25 @@ std::unordered_map<c10::OperatorName, std::string> GetUnsupportedOpsInBlock(cons
     }
 
     for (const auto sub_b : n->blocks()) {
-      auto sub_b_unsupported_ops = GetUnsupportedOpsInBlock(sub_b);
+      auto sub_b_unsupported_ops = GetUnsupportedOpsInBlock(sub_b, bindings);
       unsupported_ops.insert(sub_b_unsupported_ops.begin(), sub_b_unsupported_ops.end());
     }
   }
   return unsupported_ops;
 }
 
-std::set<std::string> ConvertableOpsInBlock(const torch::jit::Block* b) {
+std::set<std::string> ConvertableOpsInBlock(const torch::jit::Block* b, NodeBindingTable* bindings) {
   std::set<std::string> convertable_ops;
   for (const auto n : b->nodes()) {
-    if (n->kind() == torch::jit::prim::Loop || n->kind() == torch::jit::prim::If ||
-        converters::node_is_convertable(n)) {
+    bool convertable = bindings ? bindings->get(n).convertable() : converters::node_is_convertable(n);
+    if (n->kind() == torch::jit::prim::Loop || n->kind() == torch::jit::prim::If || convertable) {
       if (n->blocks().size() > 0) {
         for (const auto sub_b : n->blocks()) {
-          auto sub_b_convertable_ops = ConvertableOpsInBlock(sub_b);
+          auto sub_b_convertable_ops = ConvertableOpsInBlock(sub_b, bindings);
           convertable_ops.insert(sub_b_convertable_ops.begin(), sub_b_convertable_ops.end());
         }
       }
-      if (converters::node_is_convertable(n)) {
+      if (convertable) {
         auto schema = n->maybeSchema();
         TORCHTRT_CHECK(
             schema, "Unable to get schema for Node " << util::node_info(n) << " (conversion.CheckForConvertableOps)");
@@ -576,8 +652,8 @@ bool OutputIsCollection(const torch::jit::Block* b) {
   return false;
 }
 
-bool VerifyConverterSupportForBlock(const torch::jit::Block* b, bool suppress_errors) {
-  auto unsupported_ops = GetUnsupportedOpsInBlock(b);
+bool VerifyConverterSupportForBlock(const torch::jit::Block* b, bool suppress_errors, NodeBindingTable* bindings) {
+  auto unsupported_ops = GetUnsupportedOpsInBlock(b, bindings);
   if (unsupported_ops.size() != 0) {
     std::stringstream unsupported_msg;
     unsupported_msg
@@ -634,7 +710,7 @@ bool VerifyConverterSupportForBlock(const torch::jit::Block* b, bool suppress_er
     return false;
   }
 
-  if (ConvertableOpsInBlock(b).size() == 0) {
+  if (ConvertableOpsInBlock(b, bindings).size() == 0) {
     std::stringstream unsupported_msg;
     unsupported_msg
         << "Method requested cannot be compiled by Torch-TensorRT.TorchScript.\nThere is no work to be done since the resulting compiled program will contain an engine that is empty."
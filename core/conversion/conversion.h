@@ -1,9 +1,13 @@
 #pragma once
 
 #include <map>
+#include <string>
+#include <vector>
 
 #include "NvInfer.h"
 #include "core/conversion/conversionctx/ConversionCtx.h"
+#include "core/conversion/converters/converters.h"
+#include "core/conversion/evaluators/evaluators.h"
 #include "core/ir/ir.h"
 #include "torch/csrc/jit/ir/ir.h"
 
@@ -15,22 +19,113 @@ struct ConversionInfo {
   ir::InputSpecMap inputs;
   ir::CollectionInputSpecMap collection_input_spec_map;
   BuilderSettings engine_settings;
+  // Parameters and buffers of the module by name, used to record which weights of refittable engines they become
+  std::vector<std::pair<std::string, at::Tensor>> named_params;
 };
 
 // Converts a already lowered block (blocks with no sub blocks) to
 // a serialized TensorRT engine that can be deserialized and run
+// If the engine is refittable and weight_name_map is provided, it is filled with the weights created from the
+// named parameters
 std::string ConvertBlockToEngine(
+    const torch::jit::Block* b,
+    ConversionInfo build_info,
+    ir::StaticParams& static_params,
+    WeightNameMap* weight_name_map = nullptr);
+
+// Same as ConvertBlockToEngine but writes the serialized engine to path instead of returning it, so that the host
+// never holds more than the copy of the engine TensorRT serialized it to
+void ConvertBlockToEngineFile(
+    const torch::jit::Block* b,
+    ConversionInfo build_info,
+    ir::StaticParams& static_params,
+    const std::string& path,
+    WeightNameMap* weight_name_map = nullptr);
+
+// A refittable engine built from one block, along with what is needed to produce the engines of structurally
+// identical blocks by refitting it with their weights instead of building them
+struct RefitTemplate {
+  std::string serialized_engine;
+  // Names of the layers of the network the engine was built from, in the order they were added
+  std::vector<std::string> layer_names;
+  // Structure of the network the engine was built from, used to check other blocks convert to the same network
+  std::string network_signature;
+  // Weights of the template engine created from the named parameters
+  WeightNameMap weight_name_map;
+};
+
+RefitTemplate ConvertBlockToRefitTemplate(
     const torch::jit::Block* b,
     ConversionInfo build_info,
     ir::StaticParams& static_params);
 
+// Converts a block structurally identical to the one the template was built from and refits a copy of the template
+// engine with its weights. Returns an empty string if the block's network does not match the template
+std::string RefitTemplateWithBlock(
+    const torch::jit::Block* b,
+    ConversionInfo build_info,
+    ir::StaticParams& static_params,
+    const RefitTemplate& tmpl,
+    WeightNameMap* weight_name_map = nullptr);
+
+// How the conversion phase handles a node, resolved once from the evaluator and converter registries. A node can
+// have both, in which case it is evaluated
+struct NodeBinding {
+  evaluators::NodeEvaluator evaluator;
+  converters::OpConverter converter;
+
+  bool evaluated() const {
+    return evaluator != nullptr;
+  }
+  bool convertable() const {
+    return converter != nullptr;
+  }
+  // Same as OpSupported
+  bool supported() const {
+    return evaluated() || convertable();
+  }
+};
+
+NodeBinding BindNode(const torch::jit::Node* n);
+
+// Side table of the bindings of the nodes of a graph so the registries are only searched once per node no matter how
+// many times the node is checked during verification, partitioning and conversion. Nodes are keyed by address, so a
+// table must not outlive the graph or be used across passes which destroy nodes
+class NodeBindingTable {
+ public:
+  // Binds every node of the block and of its sub blocks
+  void bind(const torch::jit::Block* b);
+  // Binding of the node, nodes which were not bound yet (ex. created after bind) are bound on first use
+  const NodeBinding& get(const torch::jit::Node* n);
+  size_t size() const {
+    return bindings_.size();
+  }
+
+ private:
+  std::unordered_map<const torch::jit::Node*, NodeBinding> bindings_;
+};
+
+// Results of the evaluator nodes of a block which were evaluated ahead of conversion, nullopt if the node evaluated to
+// None
+typedef std::unordered_map<const torch::jit::Node*, c10::optional<torch::jit::IValue>> StaticEvaluationResults;
+
+// Evaluates the evaluator nodes of the block which only depend on values already in the evaluated value map (ex.
+// parameters) or on other such nodes, in dependency order with independent nodes evaluated on num_threads threads (0
+// to use one per core). The results are not associated with the outputs of the nodes, conversion does that when it
+// reaches each node. Nothing is evaluated if any node of the block modifies a value in place
+StaticEvaluationResults EvaluateStaticNodes(ConversionCtx* ctx, const torch::jit::Block* b, size_t num_threads = 0);
+
 bool OpSupported(const torch::jit::Node* n);
 
 bool InputIsCollection(const torch::jit::Block* b);
 
 bool OutputIsCollection(const torch::jit::Block* b);
 
-bool VerifyConverterSupportForBlock(const torch::jit::Block* b, bool suppress_errors = false);
+// If bindings is provided the nodes are looked up in it instead of the registries
+bool VerifyConverterSupportForBlock(
+    const torch::jit::Block* b,
+    bool suppress_errors = false,
+    NodeBindingTable* bindings = nullptr);
 
 c10::optional<torch::jit::IValue> EvaluateNode(
     ConversionCtx* ctx,
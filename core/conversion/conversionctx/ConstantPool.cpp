@@ -0,0 +1,102 @@
+#include <cstring>
+
+#include "core/conversion/conversionctx/ConstantPool.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace conversion {
+
+namespace {
+const uint64_t kMul = 0x9E3779B97F4A7C15ULL;
+
+inline uint64_t mix(uint64_t h, uint64_t v) {
+  h ^= v * kMul;
+  h = (h << 31) | (h >> 33);
+  return h * 0xBF58476D1CE4E5B9ULL;
+}
+} // namespace
+
+uint64_t HashBytes(const void* data, size_t nbytes, uint64_t seed) {
+  auto bytes = static_cast<const unsigned char*>(data);
+  uint64_t h = seed ^ (nbytes * kMul);
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= nbytes; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + i, sizeof(uint64_t));
+    h = mix(h, word);
+  }
+  uint64_t tail = 0;
+  for (size_t j = 0; i + j < nbytes; j++) {
+    tail |= static_cast<uint64_t>(bytes[i + j]) << (8 * j);
+  }
+  h = mix(h, tail);
+  h ^= h >> 32;
+  return h;
+}
+
+const void* ConstantPool::intern(
+    nvinfer1::DataType dtype,
+    const std::vector<int64_t>& shape,
+    const void* data,
+    size_t nbytes) {
+  stats_.num_requests++;
+  stats_.bytes_requested += nbytes;
+
+  auto key = mix(static_cast<uint64_t>(dtype), shape.size());
+  for (auto d : shape) {
+    key = mix(key, static_cast<uint64_t>(d));
+  }
+  key = HashBytes(data, nbytes, key);
+
+  auto& bucket = entries_[key];
+  for (const auto& e : bucket) {
+    // Hashes only find candidates, the contents have to match exactly
+    if (e->dtype == dtype && e->shape == shape && e->nbytes == nbytes && memcmp(e->data.get(), data, nbytes) == 0) {
+      stats_.num_hits++;
+      return e->data.get();
+    }
+    stats_.num_collisions++;
+  }
+
+  auto e = std::make_unique<Entry>();
+  e->dtype = dtype;
+  e->shape = shape;
+  e->nbytes = nbytes;
+  // Zero sized constants still get a unique non null buffer
+  e->data = std::unique_ptr<char[]>(new char[nbytes > 0 ? nbytes : 1]);
+  memcpy(e->data.get(), data, nbytes);
+  const void* buf = e->data.get();
+  entries_by_buffer_[buf] = e.get();
+  bucket.push_back(std::move(e));
+  num_entries_++;
+  stats_.bytes_stored += nbytes;
+  return buf;
+}
+
+nvinfer1::ITensor* ConstantPool::find_tensor(const void* buffer) {
+  auto it = entries_by_buffer_.find(buffer);
+  if (it == entries_by_buffer_.end() || !it->second->tensor) {
+    return nullptr;
+  }
+  stats_.num_shared_tensors++;
+  return it->second->tensor;
+}
+
+void ConstantPool::record_tensor(const void* buffer, nvinfer1::ITensor* tensor) {
+  auto it = entries_by_buffer_.find(buffer);
+  if (it != entries_by_buffer_.end()) {
+    it->second->tensor = tensor;
+  }
+}
+
+std::ostream& operator<<(std::ostream& os, const ConstantPool::Stats& s) {
+  os << "Constant Pool:" << "\n    Constants requested: " << s.num_requests << " (" << s.bytes_requested << " bytes)"
+     << "\n    Unique constants stored: " << s.num_requests - s.num_hits << " (" << s.bytes_stored << " bytes)"
+     << "\n    Deduplicated constants: " << s.num_hits << " (" << s.bytes_requested - s.bytes_stored << " bytes saved)"
+     << "\n    Shared constant tensors: " << s.num_shared_tensors << "\n    Hash collisions: " << s.num_collisions;
+  return os;
+}
+
+} // namespace conversion
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "NvInfer.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace conversion {
+
+// Content addressed storage for the constants and weights of a network. Constants with the same type, shape and bytes
+// (ex. tied embeddings, shared projections, the ones and zeros created by converters) share a single host buffer and
+// a single constant ITensor instead of each getting their own copy and IConstantLayer
+class ConstantPool {
+ public:
+  struct Stats {
+    // Number of constants added to the pool
+    uint64_t num_requests = 0;
+    // Number of constants which were already in the pool
+    uint64_t num_hits = 0;
+    // Number of hash matches which turned out to have different contents
+    uint64_t num_collisions = 0;
+    // Number of constant ITensors which were reused instead of adding a new IConstantLayer
+    uint64_t num_shared_tensors = 0;
+    uint64_t bytes_requested = 0;
+    uint64_t bytes_stored = 0;
+  };
+
+  ConstantPool() = default;
+  ConstantPool(const ConstantPool&) = delete;
+  ConstantPool& operator=(const ConstantPool&) = delete;
+
+  // Returns a buffer owned by the pool holding a copy of the data, identical constants get the same buffer
+  const void* intern(nvinfer1::DataType dtype, const std::vector<int64_t>& shape, const void* data, size_t nbytes);
+  // The constant ITensor created from a buffer returned by intern, nullptr if there is none yet
+  nvinfer1::ITensor* find_tensor(const void* buffer);
+  void record_tensor(const void* buffer, nvinfer1::ITensor* tensor);
+
+  const Stats& stats() const {
+    return stats_;
+  }
+  size_t size() const {
+    return num_entries_;
+  }
+
+ private:
+  struct Entry {
+    nvinfer1::DataType dtype;
+    std::vector<int64_t> shape;
+    std::unique_ptr<char[]> data;
+    size_t nbytes;
+    nvinfer1::ITensor* tensor = nullptr;
+  };
+
+  // Entries keyed by a hash of their type, shape and contents
+  std::unordered_map<uint64_t, std::vector<std::unique_ptr<Entry>>> entries_;
+  std::unordered_map<const void*, Entry*> entries_by_buffer_;
+  size_t num_entries_ = 0;
+  Stats stats_;
+};
+
+// Fast non cryptographic hash of a byte buffer, reads 8 bytes at a time
+uint64_t HashBytes(const void* data, size_t nbytes, uint64_t seed = 0);
+
+std::ostream& operator<<(std::ostream& os, const ConstantPool::Stats& s);
+
+} // namespace conversion
+} // namespace core
+} // namespace torch_tensorrt
@@ -1,8 +1,11 @@
 #include "core/conversion/conversionctx/ConversionCtx.h"
 #include <iostream>
 #include <sstream>
+#include <unordered_set>
 #include <utility>
 
+#include "core/util/engine_io.h"
+
 namespace torch_tensorrt {
 namespace core {
 namespace conversion {
@@ -24,7 +27,8 @@ std::ostream& operator<<(std::ostream& os, const BuilderSettings& s) {
        << "\n    Max Workspace Size: " << s.workspace_size                                 \
        << "\n    DLA SRAM Size: " << s.dla_sram_size                                       \
        << "\n    DLA Local DRAM Size: " << s.dla_local_dram_size                           \
-       << "\n    DLA Global DRAM Size: " << s.dla_global_dram_size;
+       << "\n    DLA Global DRAM Size: " << s.dla_global_dram_size                         \
+       << "\n    Layer Precision Constraints: " << s.layer_precisions.size();
 
     os << "\n    Device Type: " << s.device.device_type                                    \
        << "\n    GPU ID: " << s.device.gpu_id;
@@ -106,6 +110,10 @@ ConversionCtx::ConversionCtx(BuilderSettings build_settings)
     cfg->setFlag(nvinfer1::BuilderFlag::kGPU_FALLBACK);
   }
 
+  if (!settings.layer_precisions.empty()) {
+    cfg->setFlag(nvinfer1::BuilderFlag::kPREFER_PRECISION_CONSTRAINTS);
+  }
+
   cfg->setAvgTimingIterations(settings.num_avg_timing_iters);
   if (settings.workspace_size != 0) {
     cfg->setMemoryPoolLimit(nvinfer1::MemoryPoolType::kWORKSPACE, settings.workspace_size);
@@ -144,10 +152,47 @@ ConversionCtx::~ConversionCtx() {
 
 nvinfer1::ITensor* ConversionCtx::AssociateValueAndTensor(const torch::jit::Value* value, nvinfer1::ITensor* tensor) {
   RecordNewITensor(value, tensor);
+  // INT8 tensors are named after the values they hold so entries of calibration caches written by
+  // core::ptq::ActivationRangeCollector match them. Network inputs keep their binding names
+  bool int8 = settings.calibrator != nullptr ||
+      settings.enabled_precisions.find(nvinfer1::DataType::kINT8) != settings.enabled_precisions.end();
+  if (int8 && !tensor->isNetworkInput()) {
+    tensor->setName(value->debugName().c_str());
+  }
 
   return tensor;
 }
 
+void ConversionCtx::ApplyLayerPrecision(const torch::jit::Node* n, int32_t first_layer) {
+  if (settings.layer_precisions.empty() || n->outputs().empty()) {
+    return;
+  }
+  auto precision = settings.layer_precisions.find(n->outputs()[0]->debugName());
+  if (precision == settings.layer_precisions.end()) {
+    return;
+  }
+  for (int32_t i = first_layer; i < net->getNbLayers(); i++) {
+    auto layer = net->getLayer(i);
+    if (layer->getType() == nvinfer1::LayerType::kCONSTANT) {
+      continue;
+    }
+    // Layers computing shapes or indices keep their types
+    bool computes_floats = layer->getNbOutputs() > 0;
+    for (int32_t o = 0; o < layer->getNbOutputs(); o++) {
+      auto type = layer->getOutput(o)->getType();
+      computes_floats &= type == nvinfer1::DataType::kFLOAT || type == nvinfer1::DataType::kHALF;
+    }
+    if (!computes_floats) {
+      continue;
+    }
+    layer->setPrecision(precision->second);
+    for (int32_t o = 0; o < layer->getNbOutputs(); o++) {
+      layer->setOutputType(o, precision->second);
+    }
+  }
+  LOG_DEBUG(logger, "Constrained the layers of " << util::node_info(n) << " to " << precision->second);
+}
+
 torch::jit::IValue* ConversionCtx::AssociateValueAndIValue(const torch::jit::Value* value, torch::jit::IValue ivalue) {
   this->evaluated_value_map[value] = std::move(ivalue);
   return &this->evaluated_value_map[value];
@@ -162,9 +207,13 @@ void ConversionCtx::RecordNewITensor(const torch::jit::Value* value, nvinfer1::I
   }
 }
 
-std::string ConversionCtx::SerializeEngine() {
+std::shared_ptr<nvinfer1::IHostMemory> ConversionCtx::BuildSerializedNetwork() {
+  if (settings.refit) {
+    MakeLayerNamesUnique();
+  }
+  LOG_DEBUG(constant_pool.stats());
 #if NV_TENSORRT_MAJOR > 7
-  auto serialized_network = builder->buildSerializedNetwork(*net, *cfg);
+  auto serialized_network = make_trt(builder->buildSerializedNetwork(*net, *cfg));
   if (!serialized_network) {
     TORCHTRT_THROW_ERROR("Building serialized network failed in TensorRT");
   }
@@ -173,13 +222,24 @@ std::string ConversionCtx::SerializeEngine() {
   if (!engine) {
     TORCHTRT_THROW_ERROR("Building TensorRT engine failed");
   }
-  auto serialized_network = engine->serialize();
+  auto serialized_network = make_trt(engine->serialize());
   engine->destroy();
 #endif
+  return serialized_network;
+}
+
+std::string ConversionCtx::SerializeEngine() {
+  auto serialized_network = BuildSerializedNetwork();
   auto engine_str = std::string((const char*)serialized_network->data(), serialized_network->size());
   return engine_str;
 }
 
+void ConversionCtx::SerializeEngineToFile(const std::string& path) {
+  auto serialized_network = BuildSerializedNetwork();
+  util::WriteEngineFile(path, serialized_network->data(), serialized_network->size());
+  LOG_DEBUG("Wrote a " << serialized_network->size() << " byte TensorRT engine to " << path);
+}
+
 bool ConversionCtx::CheckLayerAddition(const torch::jit::Node* n) {
   for (auto out : n->outputs()) {
     auto iter_t = this->value_tensor_map.find(out);
@@ -197,6 +257,66 @@ bool ConversionCtx::CheckLayerAddition(const torch::jit::Node* n) {
   return true;
 }
 
+std::string ConversionCtx::LookupParamName(const at::Tensor& t) {
+  if (named_params.empty() || !t.defined()) {
+    return "";
+  }
+  auto it = named_params.find(t.data_ptr());
+  if (it == named_params.end()) {
+    return "";
+  }
+  // Views of a parameter share its data pointer, only the parameter itself can be refit
+  auto& param = it->second.second;
+  if (param.scalar_type() != t.scalar_type() || param.sizes() != t.sizes() || param.strides() != t.strides()) {
+    return "";
+  }
+  return it->second.first;
+}
+
+void ConversionCtx::RecordRefittableWeights(
+    nvinfer1::ILayer* layer,
+    nvinfer1::WeightsRole role,
+    const std::string& param_name,
+    const nvinfer1::Weights& weights) {
+  if (!settings.refit || param_name.empty() || !layer) {
+    return;
+  }
+  refittable_weights.push_back({layer, role, param_name, weights});
+}
+
+WeightNameMap ConversionCtx::GetWeightNameMap(const std::vector<std::string>* layer_names) {
+  std::unordered_map<nvinfer1::ILayer*, std::string> names;
+  if (layer_names) {
+    TORCHTRT_CHECK(
+        static_cast<int32_t>(layer_names->size()) == net->getNbLayers(),
+        "Expected a name for each of the " << net->getNbLayers() << " layers of the network, got "
+                                           << layer_names->size());
+    for (int32_t i = 0; i < net->getNbLayers(); i++) {
+      names[net->getLayer(i)] = (*layer_names)[i];
+    }
+  }
+
+  WeightNameMap m;
+  for (auto& w : refittable_weights) {
+    auto name = layer_names ? names[w.layer] : std::string(w.layer->getName());
+    m.record(w.param_name, {name, w.role, w.weights.type, w.weights.count});
+  }
+  return m;
+}
+
+void ConversionCtx::MakeLayerNamesUnique() {
+  std::unordered_set<std::string> seen_names;
+  for (int32_t i = 0; i < net->getNbLayers(); i++) {
+    auto layer = net->getLayer(i);
+    std::string name = layer->getName();
+    if (!seen_names.insert(name).second) {
+      name += " [" + std::to_string(i) + "]";
+      layer->setName(name.c_str());
+      seen_names.insert(name);
+    }
+  }
+}
+
 } // namespace conversion
 } // namespace core
 } // namespace torch_tensorrt
@@ -9,6 +9,8 @@
 #include "torch/csrc/jit/ir/ir.h"
 
 #include <cuda_runtime.h>
+#include "core/conversion/conversionctx/ConstantPool.h"
+#include "core/conversion/conversionctx/WeightNameMap.h"
 #include "core/ir/ir.h"
 #include "core/util/prelude.h"
 
@@ -32,19 +34,45 @@ struct BuilderSettings {
   uint64_t dla_sram_size = DLA_SRAM_SIZE;
   uint64_t dla_local_dram_size = DLA_LOCAL_DRAM_SIZE;
   uint64_t dla_global_dram_size = DLA_GLOBAL_DRAM_SIZE;
+  // Precisions the layers converted from a node are constrained to, keyed by the name of the first output of the node
+  std::map<std::string, nvinfer1::DataType> layer_precisions;
+  // Level the engine is compressed with when the compiled module is serialized, 0 stores it uncompressed. Does not
+  // change the engine itself
+  int64_t engine_compression_level = 0;
 
   BuilderSettings() = default;
   BuilderSettings(const BuilderSettings& other) = default;
   friend std::ostream& operator<<(std::ostream& os, const BuilderSettings& s);
 };
 
+// Defined in core/conversion/conversion.h
+class NodeBindingTable;
+
 struct ConversionCtx {
   ConversionCtx(BuilderSettings settings);
+  // Builds the engine from the network, the serialized engine is held in memory owned by TensorRT
+  std::shared_ptr<nvinfer1::IHostMemory> BuildSerializedNetwork();
   std::string SerializeEngine();
+  // Builds the engine and writes it to path in chunks, without copying it out of the memory TensorRT serialized it to
+  void SerializeEngineToFile(const std::string& path);
   nvinfer1::ITensor* AssociateValueAndTensor(const torch::jit::Value* value, nvinfer1::ITensor* tensor);
   void RecordNewITensor(const torch::jit::Value* value, nvinfer1::ITensor* tensor);
   torch::jit::IValue* AssociateValueAndIValue(const torch::jit::Value* value, torch::jit::IValue tensor);
   bool CheckLayerAddition(const torch::jit::Node* n);
+  // Applies the precision constraint of n, if there is one, to the layers added to the network since first_layer
+  void ApplyLayerPrecision(const torch::jit::Node* n, int32_t first_layer);
+  // Name of the module parameter the tensor is, empty if it is not a parameter or refit is not enabled
+  std::string LookupParamName(const at::Tensor& t);
+  void RecordRefittableWeights(
+      nvinfer1::ILayer* layer,
+      nvinfer1::WeightsRole role,
+      const std::string& param_name,
+      const nvinfer1::Weights& weights);
+  // Resolves the recorded refittable weights to the names of their layers. If layer_names is provided the i-th layer
+  // of the network is named layer_names[i] instead of its own name
+  WeightNameMap GetWeightNameMap(const std::vector<std::string>* layer_names = nullptr);
+  // The refitter addresses weights by layer name so refittable engines cannot have duplicate layer names
+  void MakeLayerNamesUnique();
 
   ~ConversionCtx();
 
@@ -59,16 +87,30 @@ struct ConversionCtx {
   util::logging::TorchTRTLogger logger;
   // Pointers to data that needs to remain alive until conversion is done
   // All data will be freed when the destructor is called
-  // The weights class is the main consumer of this, each time a weight object
-  // is constructed from a PyTorch Tensor it allocates the data here to store a
-  // copy of the values
   std::vector<void*> builder_resources;
+  // Storage for the values of weights and constants, each time a weight object
+  // is constructed from a PyTorch Tensor a copy of the values is stored here,
+  // identical values are only stored once
+  ConstantPool constant_pool;
 
   std::unordered_map<const torch::jit::Value*, nvinfer1::ITensor*> value_tensor_map;
   std::unordered_map<const torch::jit::Value*, torch::jit::IValue> evaluated_value_map;
+  // Evaluators and converters of the nodes of the block being converted
+  std::shared_ptr<NodeBindingTable> node_bindings;
 
   // record already named ITensors to prevent rewriting another name to the same tensor
   std::unordered_set<nvinfer1::ITensor*> seen_itensors;
+
+  // Parameters of the module being converted keyed by the address of their data, only populated for refittable
+  // engines
+  std::unordered_map<const void*, std::pair<std::string, at::Tensor>> named_params;
+  struct RefittableWeights {
+    nvinfer1::ILayer* layer;
+    nvinfer1::WeightsRole role;
+    std::string param_name;
+    nvinfer1::Weights weights;
+  };
+  std::vector<RefittableWeights> refittable_weights;
 };
 
 } // namespace conversion
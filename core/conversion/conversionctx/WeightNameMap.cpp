@@ -0,0 +1,116 @@
+#include <sstream>
+
+#include "core/conversion/conversionctx/WeightNameMap.h"
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace conversion {
+
+namespace {
+const std::string kWeightNameMapVersion = "1";
+
+// Strings are length prefixed since layer names are generated from arbitrary node printouts
+void write_string(std::ostream& os, const std::string& s) {
+  os << s.size() << ':' << s;
+}
+
+std::string read_string(std::istream& is) {
+  size_t len = 0;
+  char delim = '\0';
+  is >> len;
+  is.get(delim);
+  TORCHTRT_CHECK(is && delim == ':', "Malformed serialized weight name map");
+  std::string s(len, '\0');
+  is.read(&s[0], len);
+  TORCHTRT_CHECK(is, "Malformed serialized weight name map");
+  return s;
+}
+} // namespace
+
+void WeightNameMap::record(const std::string& param_name, Entry entry) {
+  entries[param_name].push_back(std::move(entry));
+}
+
+const std::vector<WeightNameMap::Entry>& WeightNameMap::lookup(const std::string& param_name) const {
+  static const std::vector<Entry> no_entries;
+  auto it = entries.find(param_name);
+  if (it == entries.end()) {
+    return no_entries;
+  }
+  return it->second;
+}
+
+std::vector<std::string> WeightNameMap::param_names() const {
+  std::vector<std::string> names;
+  for (const auto& e : entries) {
+    names.push_back(e.first);
+  }
+  return names;
+}
+
+std::string WeightNameMap::serialize() const {
+  std::stringstream ss;
+  ss << kWeightNameMapVersion << ' ' << entries.size();
+  for (const auto& param : entries) {
+    ss << ' ';
+    write_string(ss, param.first);
+    ss << ' ' << param.second.size();
+    for (const auto& e : param.second) {
+      ss << ' ';
+      write_string(ss, e.layer_name);
+      ss << ' ' << static_cast<int32_t>(e.role) << ' ' << static_cast<int32_t>(e.dtype) << ' ' << e.count;
+    }
+  }
+  return ss.str();
+}
+
+WeightNameMap WeightNameMap::deserialize(const std::string& serialized_map) {
+  std::stringstream ss(serialized_map);
+  std::string version;
+  size_t num_params = 0;
+  ss >> version >> num_params;
+  TORCHTRT_CHECK(ss, "Malformed serialized weight name map");
+  TORCHTRT_CHECK(
+      version == kWeightNameMapVersion,
+      "Unsupported weight name map version " << version << " (expected " << kWeightNameMapVersion << ")");
+
+  WeightNameMap m;
+  for (size_t i = 0; i < num_params; i++) {
+    ss >> std::ws;
+    auto param_name = read_string(ss);
+    size_t num_entries = 0;
+    ss >> num_entries;
+    for (size_t j = 0; j < num_entries; j++) {
+      Entry e;
+      int32_t role = 0;
+      int32_t dtype = 0;
+      ss >> std::ws;
+      e.layer_name = read_string(ss);
+      ss >> role >> dtype >> e.count;
+      TORCHTRT_CHECK(ss, "Malformed serialized weight name map");
+      e.role = static_cast<nvinfer1::WeightsRole>(role);
+      e.dtype = static_cast<nvinfer1::DataType>(dtype);
+      m.record(param_name, std::move(e));
+    }
+  }
+  return m;
+}
+
+std::ostream& operator<<(std::ostream& os, const WeightNameMap& m) {
+  os << "{";
+  for (const auto& param : m.entries) {
+    os << "\n    " << param.first << " -> [";
+    for (const auto& e : param.second) {
+      os << "(" << e.layer_name << ", role: " << static_cast<int32_t>(e.role) << ", " << e.dtype << " x " << e.count
+         << "), ";
+    }
+    os << "]";
+  }
+  os << "\n}";
+  return os;
+}
+
+} // namespace conversion
+} // namespace core
+} // namespace torch_tensorrt
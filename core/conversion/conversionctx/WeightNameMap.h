@@ -0,0 +1,53 @@
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "NvInfer.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace conversion {
+
+// Records which refittable weights of a TensorRT engine were created from which parameters of the original module,
+// so that the engine can be refit when the parameters change without converting the module again
+struct WeightNameMap {
+  struct Entry {
+    std::string layer_name;
+    nvinfer1::WeightsRole role;
+    nvinfer1::DataType dtype;
+    int64_t count;
+
+    bool operator==(const Entry& other) const {
+      return layer_name == other.layer_name && role == other.role && dtype == other.dtype && count == other.count;
+    }
+  };
+
+  void record(const std::string& param_name, Entry entry);
+  // Weights created from the parameter, empty if the parameter did not directly become weights of the engine
+  const std::vector<Entry>& lookup(const std::string& param_name) const;
+  std::vector<std::string> param_names() const;
+  size_t size() const {
+    return entries.size();
+  }
+  bool empty() const {
+    return entries.empty();
+  }
+  bool operator==(const WeightNameMap& other) const {
+    return entries == other.entries;
+  }
+
+  std::string serialize() const;
+  static WeightNameMap deserialize(const std::string& serialized_map);
+
+  // Ordered so that the serialized form is deterministic
+  std::map<std::string, std::vector<Entry>> entries;
+};
+
+std::ostream& operator<<(std::ostream& os, const WeightNameMap& m);
+
+} // namespace conversion
+} // namespace core
+} // namespace torch_tensorrt
@@ -69,19 +69,20 @@ class NodeConverterRegistry {
   }
 
   bool Convertable(const torch::jit::Node* n) {
+    return FindConverter(n) != nullptr;
+  }
+
+  const OpConverter* FindConverter(const torch::jit::Node* n) {
     auto schema = n->maybeSchema();
-    if (schema) {
-      auto name = schema->operator_name();
-      auto iter = converter_lut_.find(name);
-      if (iter == converter_lut_.end()) {
-        return false;
-      } else {
-        return true;
-      }
-    } else {
+    if (!schema) {
       LOG_DEBUG("Unable to get schema for Node " << util::node_info(n) << " (NodeConverterRegistry.Convertable)");
-      return false;
+      return nullptr;
+    }
+    auto iter = converter_lut_.find(schema->operator_name());
+    if (iter == converter_lut_.end()) {
+      return nullptr;
     }
+    return &iter->second;
   }
 
   std::vector<std::string> GetRegisteredConverterList() {
@@ -124,6 +125,11 @@ bool node_is_convertable(const torch::jit::Node* n) {
   return get_converter_registry().Convertable(n);
 }
 
+OpConverter find_node_converter(const torch::jit::Node* n) {
+  auto converter = get_converter_registry().FindConverter(n);
+  return converter ? *converter : nullptr;
+}
+
 std::vector<std::string> get_converter_list() {
   return get_converter_registry().GetRegisteredConverterList();
 }
@@ -19,11 +19,8 @@ Weights::Weights(ConversionCtx* ctx, float val) {
   this->num_output_maps = 1;
 
   this->data.type = nvinfer1::DataType::kFLOAT;
-  float* buf = reinterpret_cast<float*>(malloc(1 * sizeof(float)));
-  buf[0] = val;
-  this->data.values = buf;
+  this->data.values = ctx->constant_pool.intern(this->data.type, {}, &val, sizeof(float));
   this->data.count = 1;
-  ctx->builder_resources.push_back(buf);
 
   this->shape.nbDims = 0;
   this->kernel_shape.nbDims = 0;
@@ -34,17 +31,15 @@ Weights::Weights(ConversionCtx* ctx, int32_t val) {
   this->num_output_maps = 1;
 
   this->data.type = nvinfer1::DataType::kINT32;
-  int32_t* buf = reinterpret_cast<int32_t*>(malloc(1 * sizeof(int32_t)));
-  buf[0] = val;
-  this->data.values = buf;
+  this->data.values = ctx->constant_pool.intern(this->data.type, {}, &val, sizeof(int32_t));
   this->data.count = 1;
-  ctx->builder_resources.push_back(buf);
 
   this->shape.nbDims = 0;
   this->kernel_shape.nbDims = 0;
 }
 
 Weights::Weights(ConversionCtx* ctx, at::Tensor t) {
+  this->param_name = ctx->LookupParamName(t);
   if (t.sizes().size() > nvinfer1::Dims::MAX_DIMS) {
     TORCHTRT_THROW_ERROR(
         "The tensor requested to be converted to nvinfer1::Weights exceeds the max number of dimensions for TensorRT");
@@ -81,30 +76,25 @@ Weights::Weights(ConversionCtx* ctx, at::Tensor t) {
   }
 
   // Store the data in the conversion context so it remains until building is
-  // complete
-
-  void* buf = nullptr;
-
-  if (dtype_optional.value() == nvinfer1::DataType::kFLOAT) {
-    buf = malloc(t_cpu.numel() * sizeof(float));
-    memcpy(buf, t_cpu.data_ptr(), t_cpu.numel() * sizeof(float));
-  } else if (dtype_optional.value() == nvinfer1::DataType::kHALF) {
-    buf = malloc(t_cpu.numel() * (sizeof(float) / 2));
-    memcpy(buf, t_cpu.data_ptr(), t_cpu.numel() * (sizeof(float) / 2));
-  } else if (dtype_optional.value() == nvinfer1::DataType::kINT8) {
-    buf = malloc(t_cpu.numel() * sizeof(char));
-    memcpy(buf, t_cpu.data_ptr(), t_cpu.numel() * sizeof(char));
-  } else if (dtype_optional.value() == nvinfer1::DataType::kINT32) {
-    buf = malloc(t_cpu.numel() * sizeof(int));
-    memcpy(buf, t_cpu.data_ptr(), t_cpu.numel() * sizeof(int));
-  } else if (dtype_optional.value() == nvinfer1::DataType::kBOOL) {
-    buf = malloc(t_cpu.numel() * sizeof(bool));
-    memcpy(buf, t_cpu.data_ptr(), t_cpu.numel() * sizeof(bool));
-  } else {
-    TORCHTRT_THROW_ERROR("Found unsupported data type for tensor to weight conversion");
+  // complete, identical tensors share the same copy
+  size_t elem_size = 0;
+  switch (dtype_optional.value()) {
+    case nvinfer1::DataType::kFLOAT:
+    case nvinfer1::DataType::kINT32:
+      elem_size = 4;
+      break;
+    case nvinfer1::DataType::kHALF:
+      elem_size = 2;
+      break;
+    case nvinfer1::DataType::kINT8:
+    case nvinfer1::DataType::kBOOL:
+      elem_size = 1;
+      break;
+    default:
+      TORCHTRT_THROW_ERROR("Found unsupported data type for tensor to weight conversion");
   }
-
-  ctx->builder_resources.push_back(buf);
+  auto buf = ctx->constant_pool.intern(
+      dtype_optional.value(), t_cpu.sizes().vec(), t_cpu.data_ptr(), t_cpu.numel() * elem_size);
 
   this->data.type = dtype_optional.value();
   this->data.count = t_cpu.numel();
@@ -14,6 +14,9 @@ struct Weights {
   nvinfer1::Dims shape;
   int64_t num_input_maps;
   int64_t num_output_maps;
+  // Name of the module parameter the weights were created from, empty if they were not created directly from a
+  // parameter (or the engine is not refittable)
+  std::string param_name;
 
   Weights();
   Weights(ConversionCtx* ctx, at::Tensor t);
@@ -260,10 +260,23 @@ nvinfer1::ITensor* tensor_to_const(ConversionCtx* ctx, at::Tensor t, const std::
     weights = Weights(ctx, t);
   }
 
+  // Identical constants share one IConstantLayer, except for the parameters of refittable engines which need their own
+  // layer to be refit independently
+  bool shareable = !(ctx->settings.refit && !weights.param_name.empty());
+  auto shared = shareable ? ctx->constant_pool.find_tensor(weights.data.values) : nullptr;
+  if (shared) {
+    LOG_DEBUG(ctx->logger, "Reusing constant tensor " << shared->getName() << " for an identical tensor");
+    return post_freeze_cast ? castITensor(ctx, shared, post_freeze_cast_type) : shared;
+  }
+
   auto const_layer = ctx->net->addConstant(weights.shape, weights.data);
   TORCHTRT_CHECK(const_layer, "Unable to freeze tensor");
+  ctx->RecordRefittableWeights(const_layer, nvinfer1::WeightsRole::kCONSTANT, weights.param_name, weights.data);
 
   auto out = const_layer->getOutput(0);
+  if (shareable) {
+    ctx->constant_pool.record_tensor(weights.data.values, out);
+  }
 
   std::ostringstream tensor_id;
   tensor_id << reinterpret_cast<int*>(out);
@@ -40,6 +40,8 @@ class RegisterNodeConversionPatterns {
 
 bool node_is_convertable(const torch::jit::Node* n);
 OpConverter get_node_converter_for(const torch::jit::FunctionSchema* signature);
+// Converter for the schema of the node, nullptr if the node has no schema or there is no converter for it
+OpConverter find_node_converter(const torch::jit::Node* n);
 std::vector<std::string> get_converter_list();
 
 } // namespace converters
@@ -175,6 +175,10 @@ bool add_conv_deconv(ConversionCtx* ctx, const torch::jit::Node* n, args& args)
     auto deconv = ctx->net->addDeconvolutionNd(
         *in, w.shape.d[1] * groups, w.kernel_shape, w.data, hasOutputPadding ? nvinfer1::Weights{} : bias.data);
     TORCHTRT_CHECK(deconv, "Unable to create deconvolution layer from node: " << *n);
+    ctx->RecordRefittableWeights(deconv, nvinfer1::WeightsRole::kKERNEL, w.param_name, w.data);
+    if (!hasOutputPadding) {
+      ctx->RecordRefittableWeights(deconv, nvinfer1::WeightsRole::kBIAS, bias.param_name, bias.data);
+    }
 
     deconv->setStrideNd(stride);
     deconv->setPrePadding(begPadding);
@@ -231,6 +235,7 @@ bool add_conv_deconv(ConversionCtx* ctx, const torch::jit::Node* n, args& args)
       constantDims.d[diff - 1] =
           bias.shape.d[0]; // Set C dimension to bias dim and other dimensions to 1 to enable broadcast
       auto const_layer = ctx->net->addConstant(constantDims, bias.data);
+      ctx->RecordRefittableWeights(const_layer, nvinfer1::WeightsRole::kCONSTANT, bias.param_name, bias.data);
       auto add_bias_layer =
           ctx->net->addElementWise(*tensorPtr, *const_layer->getOutput(0), nvinfer1::ElementWiseOperation::kSUM);
 
@@ -242,6 +247,8 @@ bool add_conv_deconv(ConversionCtx* ctx, const torch::jit::Node* n, args& args)
     // shape of convolution's weight: [out, in/groups, ...]
     auto conv = ctx->net->addConvolutionNd(*in, w.shape.d[0], w.kernel_shape, w.data, bias.data);
     TORCHTRT_CHECK(conv, "Unable to create convolution layer from node: " << *n);
+    ctx->RecordRefittableWeights(conv, nvinfer1::WeightsRole::kKERNEL, w.param_name, w.data);
+    ctx->RecordRefittableWeights(conv, nvinfer1::WeightsRole::kBIAS, bias.param_name, bias.data);
 
     conv->setStrideNd(stride);
     conv->setPaddingMode(nvinfer1::PaddingMode::kCAFFE_ROUND_DOWN);
@@ -47,12 +47,14 @@ auto linear_registrations TORCHTRT_UNUSED = RegisterNodeConversionPatterns().pat
        if (!args[2].IValue()->isNone()) {
          Weights b(ctx, args[2].IValue()->toTensor());
          new_layer = ctx->net->addFullyConnected(*in, w.num_output_maps, w.data, b.data);
+         ctx->RecordRefittableWeights(new_layer, nvinfer1::WeightsRole::kBIAS, b.param_name, b.data);
        } else {
          LOG_DEBUG("There is no bias for the linear layer");
          new_layer = ctx->net->addFullyConnected(*in, w.num_output_maps, w.data, Weights().data);
        }
 
        TORCHTRT_CHECK(new_layer, "Unable to create linear layer from node: " << *n);
+       ctx->RecordRefittableWeights(new_layer, nvinfer1::WeightsRole::kKERNEL, w.param_name, w.data);
 
        new_layer->setName(util::node_info(n).c_str());
        auto out_tensor = ctx->AssociateValueAndTensor(n->outputs()[0], new_layer->getOutput(0));
@@ -1,4 +1,5 @@
 #include "core/conversion/converters/converters.h"
+#include "core/conversion/converters/typed_args.h"
 
 #include "torch/torch.h"
 
@@ -123,61 +124,57 @@ static auto shuffle_registrations TORCHTRT_UNUSED =
 
                return true;
              }})
-        .pattern(
-            {"aten::permute(Tensor(a) self, int[] dims) -> (Tensor(a))",
-             [](ConversionCtx* ctx, const torch::jit::Node* n, args& args) -> bool {
-               auto in = args[0].ITensorOrFreeze(ctx);
-               auto in_shape = util::toVec(in->getDimensions());
-               auto new_order = args[1].unwrapToIntList().vec();
-
-               LOG_DEBUG("Shuffle to: " << util::toDims(new_order));
-
-               auto shuffle = ctx->net->addShuffle(*in);
-               TORCHTRT_CHECK(shuffle, "Unable to create shuffle layer from node: " << *n);
-               nvinfer1::Permutation permute;
-               std::copy(new_order.begin(), new_order.end(), permute.order);
-               shuffle->setSecondTranspose(permute);
-               shuffle->setName(util::node_info(n).c_str());
-
-               auto out_tensor = ctx->AssociateValueAndTensor(n->outputs()[0], shuffle->getOutput(0));
-               LOG_DEBUG("Output tensor shape: " << out_tensor->getDimensions());
-
-               return true;
-             }})
-        .pattern(
-            {"aten::transpose.int(Tensor(a) self, int dim0, int dim1) -> (Tensor(a))",
-             [](ConversionCtx* ctx, const torch::jit::Node* n, args& args) -> bool {
-               auto in = args[0].ITensorOrFreeze(ctx);
-               auto in_shape = util::toVec(in->getDimensions());
-               auto ndims = in_shape.size();
-               auto dim0 = args[1].unwrapToInt();
-               auto dim1 = args[2].unwrapToInt();
-
-               std::vector<int64_t> new_order;
-               for (size_t i = 0; i < ndims; i++) {
-                 new_order.push_back(i);
-               }
-               dim0 = dim0 < 0 ? (dim0 + ndims) : dim0;
-               dim1 = dim1 < 0 ? (dim1 + ndims) : dim1;
-               auto tmp = dim0;
-               new_order[dim0] = new_order[dim1];
-               new_order[dim1] = tmp;
-
-               LOG_DEBUG("Shuffle to: " << util::toDims(new_order));
-
-               auto shuffle = ctx->net->addShuffle(*in);
-               TORCHTRT_CHECK(shuffle, "Unable to create shuffle layer from node: " << *n);
-               nvinfer1::Permutation permute;
-               std::copy(new_order.begin(), new_order.end(), permute.order);
-
-               shuffle->setSecondTranspose(permute);
-               shuffle->setName(util::node_info(n).c_str());
-
-               auto out_tensor = ctx->AssociateValueAndTensor(n->outputs()[0], shuffle->getOutput(0));
-               LOG_DEBUG("Output tensor shape: " << out_tensor->getDimensions());
-
-               return true;
-             }})
+        .pattern(typed_pattern<nvinfer1::ITensor*, ListArg<int64_t>>(
+            "aten::permute(Tensor(a) self, int[] dims) -> (Tensor(a))",
+            [](ConversionCtx* ctx, const torch::jit::Node* n, nvinfer1::ITensor* in, ListArg<int64_t> dims) -> bool {
+              auto new_order = dims.vec();
+
+              LOG_DEBUG("Shuffle to: " << util::toDims(new_order));
+
+              auto shuffle = ctx->net->addShuffle(*in);
+              TORCHTRT_CHECK(shuffle, "Unable to create shuffle layer from node: " << *n);
+              nvinfer1::Permutation permute;
+              std::copy(new_order.begin(), new_order.end(), permute.order);
+              shuffle->setSecondTranspose(permute);
+              shuffle->setName(util::node_info(n).c_str());
+
+              auto out_tensor = ctx->AssociateValueAndTensor(n->outputs()[0], shuffle->getOutput(0));
+              LOG_DEBUG("Output tensor shape: " << out_tensor->getDimensions());
+
+              return true;
+            }))
+        .pattern(typed_pattern<nvinfer1::ITensor*, int64_t, int64_t>(
+            "aten::transpose.int(Tensor(a) self, int dim0, int dim1) -> (Tensor(a))",
+            [](ConversionCtx* ctx, const torch::jit::Node* n, nvinfer1::ITensor* in, int64_t dim0, int64_t dim1)
+                -> bool {
+              auto in_shape = util::toVec(in->getDimensions());
+              auto ndims = in_shape.size();
+
+              std::vector<int64_t> new_order;
+              for (size_t i = 0; i < ndims; i++) {
+                new_order.push_back(i);
+              }
+              dim0 = dim0 < 0 ? (dim0 + ndims) : dim0;
+              dim1 = dim1 < 0 ? (dim1 + ndims) : dim1;
+              auto tmp = dim0;
+              new_order[dim0] = new_order[dim1];
+              new_order[dim1] = tmp;
+
+              LOG_DEBUG("Shuffle to: " << util::toDims(new_order));
+
+              auto shuffle = ctx->net->addShuffle(*in);
+              TORCHTRT_CHECK(shuffle, "Unable to create shuffle layer from node: " << *n);
+              nvinfer1::Permutation permute;
+              std::copy(new_order.begin(), new_order.end(), permute.order);
+
+              shuffle->setSecondTranspose(permute);
+              shuffle->setName(util::node_info(n).c_str());
+
+              auto out_tensor = ctx->AssociateValueAndTensor(n->outputs()[0], shuffle->getOutput(0));
+              LOG_DEBUG("Output tensor shape: " << out_tensor->getDimensions());
+
+              return true;
+            }))
         .pattern(
             {"aten::t(Tensor self) -> Tensor",
              [](ConversionCtx* ctx, const torch::jit::Node* n, args& args) -> bool {
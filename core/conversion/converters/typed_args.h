@@ -0,0 +1,227 @@
+#pragma once
+
+#include <functional>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "torch/csrc/jit/frontend/function_schema_parser.h"
+
+#include "core/conversion/converters/converters.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace conversion {
+namespace converters {
+
+// View of an evaluated list argument which reads the elements in place instead of copying the list
+template <typename T>
+class ListArg {
+ public:
+  ListArg() = default;
+  explicit ListArg(c10::ArrayRef<torch::jit::IValue> elems) : elems_(elems) {}
+
+  size_t size() const {
+    return elems_.size();
+  }
+  bool empty() const {
+    return elems_.empty();
+  }
+  T operator[](size_t i) const {
+    return elems_[i].to<T>();
+  }
+  std::vector<T> vec() const {
+    std::vector<T> out;
+    out.reserve(elems_.size());
+    for (const auto& e : elems_) {
+      out.push_back(e.to<T>());
+    }
+    return out;
+  }
+  c10::ArrayRef<torch::jit::IValue> ivalues() const {
+    return elems_;
+  }
+
+ private:
+  c10::ArrayRef<torch::jit::IValue> elems_;
+};
+
+// How a C++ argument type of a typed converter maps to a schema argument type and is read from the converter args.
+// Supported types are nvinfer1::ITensor* (ITensors and frozen constants), at::Tensor (static tensors), int64_t,
+// double, bool, c10::Scalar, std::string, ListArg<int64_t>, ListArg<double>, ListArg<bool>, c10::optional of those
+// and Var for anything else
+template <typename T>
+struct ArgTraits;
+
+namespace detail {
+inline const torch::jit::IValue& StaticArg(const Var& var, const char* expected) {
+  TORCHTRT_CHECK(
+      var.isIValue(),
+      "Requested " << expected << " argument assuming it was an IValue, however arg type is " << var.type_name());
+  return *var.IValue();
+}
+} // namespace detail
+
+template <>
+struct ArgTraits<Var> {
+  static bool matches(const c10::TypePtr&) {
+    return true;
+  }
+  static Var unwrap(ConversionCtx*, Var& var) {
+    return var;
+  }
+};
+
+template <>
+struct ArgTraits<nvinfer1::ITensor*> {
+  static bool matches(const c10::TypePtr& type) {
+    return type->kind() == c10::TypeKind::TensorType || type->kind() == c10::TypeKind::NumberType ||
+        type->kind() == c10::TypeKind::IntType || type->kind() == c10::TypeKind::FloatType;
+  }
+  static nvinfer1::ITensor* unwrap(ConversionCtx* ctx, Var& var) {
+    return var.isITensor() ? var.ITensor() : var.ITensorOrFreeze(ctx);
+  }
+};
+
+template <>
+struct ArgTraits<at::Tensor> {
+  static bool matches(const c10::TypePtr& type) {
+    return type->kind() == c10::TypeKind::TensorType;
+  }
+  static at::Tensor unwrap(ConversionCtx*, Var& var) {
+    const auto& ivalue = detail::StaticArg(var, "Tensor");
+    TORCHTRT_CHECK(ivalue.isTensor(), "Expected a Tensor argument, however type is " << *ivalue.type());
+    return ivalue.toTensor();
+  }
+};
+
+#define DEFINE_SCALAR_ARG_TRAITS(arg_type, schema_kind, method_variant)                                         \
+  template <>                                                                                                   \
+  struct ArgTraits<arg_type> {                                                                                  \
+    static bool matches(const c10::TypePtr& type) {                                                             \
+      return type->kind() == c10::TypeKind::schema_kind;                                                        \
+    }                                                                                                           \
+    static arg_type unwrap(ConversionCtx*, Var& var) {                                                          \
+      const auto& ivalue = detail::StaticArg(var, #method_variant);                                             \
+      TORCHTRT_CHECK(                                                                                           \
+          ivalue.is##method_variant(),                                                                          \
+          "Expected a " << #method_variant << " argument, however type is " << *ivalue.type());                 \
+      return ivalue.to##method_variant();                                                                       \
+    }                                                                                                           \
+  };
+
+DEFINE_SCALAR_ARG_TRAITS(int64_t, IntType, Int)
+DEFINE_SCALAR_ARG_TRAITS(double, FloatType, Double)
+DEFINE_SCALAR_ARG_TRAITS(bool, BoolType, Bool)
+DEFINE_SCALAR_ARG_TRAITS(c10::Scalar, NumberType, Scalar)
+
+#undef DEFINE_SCALAR_ARG_TRAITS
+
+template <>
+struct ArgTraits<std::string> {
+  static bool matches(const c10::TypePtr& type) {
+    return type->kind() == c10::TypeKind::StringType;
+  }
+  static std::string unwrap(ConversionCtx*, Var& var) {
+    const auto& ivalue = detail::StaticArg(var, "String");
+    TORCHTRT_CHECK(ivalue.isString(), "Expected a String argument, however type is " << *ivalue.type());
+    return ivalue.toStringRef();
+  }
+};
+
+template <typename T>
+struct ArgTraits<ListArg<T>> {
+  static bool matches(const c10::TypePtr& type) {
+    if (type->kind() != c10::TypeKind::ListType) {
+      return false;
+    }
+    auto elem = type->containedType(0);
+    if (std::is_same<T, int64_t>::value) {
+      return elem->kind() == c10::TypeKind::IntType;
+    } else if (std::is_same<T, double>::value) {
+      return elem->kind() == c10::TypeKind::FloatType;
+    } else if (std::is_same<T, bool>::value) {
+      return elem->kind() == c10::TypeKind::BoolType;
+    }
+    return false;
+  }
+  static ListArg<T> unwrap(ConversionCtx*, Var& var) {
+    const auto& ivalue = detail::StaticArg(var, "list");
+    TORCHTRT_CHECK(ivalue.isList(), "Expected a list argument, however type is " << *ivalue.type());
+    return ListArg<T>(ivalue.toListRef());
+  }
+};
+
+template <typename T>
+struct ArgTraits<c10::optional<T>> {
+  static bool matches(const c10::TypePtr& type) {
+    return type->kind() == c10::TypeKind::OptionalType && ArgTraits<T>::matches(type->containedType(0));
+  }
+  static c10::optional<T> unwrap(ConversionCtx* ctx, Var& var) {
+    if (var.isNone() || (var.isIValue() && var.IValue()->isNone())) {
+      return {};
+    }
+    return ArgTraits<T>::unwrap(ctx, var);
+  }
+};
+
+namespace detail {
+template <typename... Args, size_t... I>
+void CheckSchemaArgs(
+    const c10::FunctionSchema& schema,
+    const std::string& signature,
+    std::index_sequence<I...>) {
+  const auto& schema_args = schema.arguments();
+  TORCHTRT_CHECK(
+      schema_args.size() == sizeof...(Args),
+      "Typed converter for " << signature << " takes " << sizeof...(Args) << " arguments, but the schema has "
+                             << schema_args.size());
+  bool matches[] = {true, ArgTraits<Args>::matches(schema_args[I].type())...};
+  for (size_t i = 0; i < sizeof...(Args); i++) {
+    TORCHTRT_CHECK(
+        matches[i + 1],
+        "Typed converter for " << signature << " cannot take argument " << schema_args[i].name() << " of type "
+                               << *schema_args[i].type());
+  }
+}
+
+template <typename... Args, typename F, size_t... I>
+bool InvokeTyped(F& fn, ConversionCtx* ctx, const torch::jit::Node* n, args& a, std::index_sequence<I...>) {
+  // Braced initialization unwraps the arguments in schema order, which matters since freezing a constant into an
+  // ITensor adds a layer to the network
+  std::tuple<Args...> typed_args{ArgTraits<Args>::unwrap(ctx, a[I])...};
+  return fn(ctx, n, std::get<I>(std::move(typed_args))...);
+}
+} // namespace detail
+
+// Builds a conversion pattern from a converter taking its arguments as typed values instead of args, ex.
+//
+//   typed_pattern<nvinfer1::ITensor*, int64_t, int64_t>(
+//       "aten::flatten.using_ints(Tensor self, int start_dim=0, int end_dim=-1) -> (Tensor)",
+//       [](ConversionCtx* ctx, const torch::jit::Node* n, nvinfer1::ITensor* in, int64_t start, int64_t end) {...})
+//
+// The argument types are checked against the schema once when the pattern is built, at conversion time each argument
+// is read from the node args with a single type check and lists are passed as views. The pattern is registered with
+// RegisterNodeConversionPatterns like any other
+template <typename... Args, typename F>
+ConversionPattern typed_pattern(std::string signature, F fn) {
+  static_assert(
+      std::is_invocable_r<bool, F&, ConversionCtx*, const torch::jit::Node*, Args...>::value,
+      "Typed converters must take (ConversionCtx*, const torch::jit::Node*, Args...) and return bool");
+  auto schema = torch::jit::parseSchema(signature);
+  detail::CheckSchemaArgs<Args...>(schema, signature, std::index_sequence_for<Args...>{});
+  return {std::move(signature), [fn](ConversionCtx* ctx, const torch::jit::Node* n, args& a) mutable -> bool {
+            TORCHTRT_CHECK(
+                a.size() == sizeof...(Args),
+                "Expected " << sizeof...(Args) << " arguments for node " << *n << ", but got " << a.size());
+            return detail::InvokeTyped<Args...>(fn, ctx, n, a, std::index_sequence_for<Args...>{});
+          }};
+}
+
+} // namespace converters
+} // namespace conversion
+} // namespace core
+} // namespace torch_tensorrt
@@ -17,8 +17,8 @@ namespace evaluators {
 namespace {
 using EvaluatorLUT = std::unordered_map<torch::jit::NodeKind, EvalRegistration>;
 
-bool FindInVec(std::vector<c10::OperatorName>& names, c10::OperatorName target) {
-  for (auto n : names) {
+bool FindInVec(const std::vector<c10::OperatorName>& names, const c10::OperatorName& target) {
+  for (const auto& n : names) {
     if (n == target) {
       return true;
     }
@@ -48,7 +48,7 @@ class NodeEvaluatorRegistry {
     if (iter == evaluator_lut_.end()) {
       return nullptr;
     }
-    auto eval_reg = iter->second;
+    const auto& eval_reg = iter->second;
     if (eval_reg.options.use()) {
       for (auto o : n->outputs()) {
         if (eval_reg.options.blacklisted_output_types.find(o->type()) !=
@@ -110,6 +110,10 @@ bool shouldEvalAtConversionTime(const torch::jit::Node* n) {
   return get_evaluator_registry().EvalAtConversionTime(n);
 }
 
+NodeEvaluator findNodeEvaluator(const torch::jit::Node* n) {
+  return get_evaluator_registry().FindEvaluator(n);
+}
+
 std::vector<std::string> getEvaluatorList() {
   return get_evaluator_registry().GetRegisteredEvaluatorList();
 }
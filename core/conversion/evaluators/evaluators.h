@@ -56,7 +56,7 @@ struct EvalOptions {
     }
     return *this;
   }
-  bool use() {
+  bool use() const {
     return use_options;
   }
 
@@ -77,6 +77,8 @@ struct EvalRegistration {
 
 c10::optional<torch::jit::IValue> EvalNode(ConversionCtx* ctx, const torch::jit::Node* n, kwargs& args);
 bool shouldEvalAtConversionTime(const torch::jit::Node* n);
+// Evaluator for the node, nullptr if the node cannot be evaluated at conversion time
+NodeEvaluator findNodeEvaluator(const torch::jit::Node* n);
 std::vector<std::string> getEvaluatorList();
 void register_node_evaluator(torch::jit::NodeKind node_kind, NodeEvaluator evaluator);
 void register_node_evaluator(EvalRegistration r);
@@ -0,0 +1,186 @@
+#include <sstream>
+
+#include "core/conversion/conversion.h"
+#include "core/conversion/conversionctx/ConversionCtx.h"
+#include "core/util/prelude.h"
+#include "core/util/trt_util.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace conversion {
+
+// Defined in core/conversion/conversion.cpp
+void ConvertBlockToNetDef(
+    ConversionCtx* ctx,
+    const torch::jit::Block* b,
+    ConversionInfo& build_info,
+    ir::StaticParams& static_params);
+
+namespace {
+const std::vector<nvinfer1::WeightsRole> kWeightsRoles = {
+    nvinfer1::WeightsRole::kKERNEL,
+    nvinfer1::WeightsRole::kBIAS,
+    nvinfer1::WeightsRole::kSHIFT,
+    nvinfer1::WeightsRole::kSCALE,
+    nvinfer1::WeightsRole::kCONSTANT,
+};
+
+c10::optional<nvinfer1::Weights> GetLayerWeights(nvinfer1::ILayer* layer, nvinfer1::WeightsRole role) {
+  switch (layer->getType()) {
+    case nvinfer1::LayerType::kCONVOLUTION: {
+      auto conv = static_cast<nvinfer1::IConvolutionLayer*>(layer);
+      if (role == nvinfer1::WeightsRole::kKERNEL) {
+        return conv->getKernelWeights();
+      } else if (role == nvinfer1::WeightsRole::kBIAS) {
+        return conv->getBiasWeights();
+      }
+      break;
+    }
+    case nvinfer1::LayerType::kDECONVOLUTION: {
+      auto deconv = static_cast<nvinfer1::IDeconvolutionLayer*>(layer);
+      if (role == nvinfer1::WeightsRole::kKERNEL) {
+        return deconv->getKernelWeights();
+      } else if (role == nvinfer1::WeightsRole::kBIAS) {
+        return deconv->getBiasWeights();
+      }
+      break;
+    }
+    case nvinfer1::LayerType::kFULLY_CONNECTED: {
+      auto fc = static_cast<nvinfer1::IFullyConnectedLayer*>(layer);
+      if (role == nvinfer1::WeightsRole::kKERNEL) {
+        return fc->getKernelWeights();
+      } else if (role == nvinfer1::WeightsRole::kBIAS) {
+        return fc->getBiasWeights();
+      }
+      break;
+    }
+    case nvinfer1::LayerType::kSCALE: {
+      auto scale = static_cast<nvinfer1::IScaleLayer*>(layer);
+      if (role == nvinfer1::WeightsRole::kSCALE) {
+        return scale->getScale();
+      } else if (role == nvinfer1::WeightsRole::kSHIFT) {
+        return scale->getShift();
+      }
+      break;
+    }
+    case nvinfer1::LayerType::kCONSTANT: {
+      if (role == nvinfer1::WeightsRole::kCONSTANT) {
+        return static_cast<nvinfer1::IConstantLayer*>(layer)->getWeights();
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return {};
+}
+
+// Summary of everything about a network except the values of its weights and the names of its layers. Networks
+// converted from blocks with the same canonical form should only differ in weights, this guards against weights which
+// were consumed at conversion time (and so became part of the network structure) instead of ending up in TensorRT
+// weights
+std::string NetworkSignature(nvinfer1::INetworkDefinition* net) {
+  std::stringstream ss;
+  for (int32_t i = 0; i < net->getNbInputs(); i++) {
+    ss << "input " << net->getInput(i)->getDimensions() << ' ' << net->getInput(i)->getType() << '\n';
+  }
+  for (int32_t i = 0; i < net->getNbLayers(); i++) {
+    auto layer = net->getLayer(i);
+    ss << static_cast<int32_t>(layer->getType()) << " inputs: " << layer->getNbInputs() << " outputs:";
+    for (int32_t j = 0; j < layer->getNbOutputs(); j++) {
+      ss << ' ' << layer->getOutput(j)->getDimensions() << ' ' << layer->getOutput(j)->getType();
+    }
+    for (auto role : kWeightsRoles) {
+      auto weights = GetLayerWeights(layer, role);
+      if (weights) {
+        ss << " weights(" << static_cast<int32_t>(role) << "): " << weights->type << " x " << weights->count;
+      }
+    }
+    ss << '\n';
+  }
+  return ss.str();
+}
+} // namespace
+
+RefitTemplate ConvertBlockToRefitTemplate(
+    const torch::jit::Block* b,
+    ConversionInfo build_info,
+    ir::StaticParams& static_params) {
+  build_info.engine_settings.refit = true;
+  ConversionCtx ctx(build_info.engine_settings);
+  ConvertBlockToNetDef(&ctx, b, build_info, static_params);
+
+  RefitTemplate tmpl;
+  tmpl.network_signature = NetworkSignature(ctx.net.get());
+  // Layer names are made unique when a refittable engine is serialized
+  tmpl.serialized_engine = ctx.SerializeEngine();
+  for (int32_t i = 0; i < ctx.net->getNbLayers(); i++) {
+    tmpl.layer_names.push_back(ctx.net->getLayer(i)->getName());
+  }
+  tmpl.weight_name_map = ctx.GetWeightNameMap();
+  return tmpl;
+}
+
+std::string RefitTemplateWithBlock(
+    const torch::jit::Block* b,
+    ConversionInfo build_info,
+    ir::StaticParams& static_params,
+    const RefitTemplate& tmpl,
+    WeightNameMap* weight_name_map) {
+  build_info.engine_settings.refit = true;
+  ConversionCtx ctx(build_info.engine_settings);
+  ConvertBlockToNetDef(&ctx, b, build_info, static_params);
+
+  if (NetworkSignature(ctx.net.get()) != tmpl.network_signature) {
+    LOG_DEBUG("Network converted from block does not match the refit template, falling back to a full build");
+    return "";
+  }
+
+  std::unordered_map<std::string, int32_t> layer_idx;
+  for (size_t i = 0; i < tmpl.layer_names.size(); i++) {
+    layer_idx[tmpl.layer_names[i]] = i;
+  }
+
+  auto rt = make_trt(nvinfer1::createInferRuntime(util::logging::get_logger()));
+  auto engine = make_trt(rt->deserializeCudaEngine(tmpl.serialized_engine.data(), tmpl.serialized_engine.size()));
+  TORCHTRT_CHECK(engine, "Unable to deserialize the refit template engine");
+  auto refitter = make_trt(nvinfer1::createInferRefitter(*engine, util::logging::get_logger()));
+  TORCHTRT_CHECK(refitter, "Unable to create a refitter for the refit template engine");
+
+  auto num_weights = refitter->getAll(0, nullptr, nullptr);
+  std::vector<const char*> layer_names(num_weights);
+  std::vector<nvinfer1::WeightsRole> roles(num_weights);
+  refitter->getAll(num_weights, layer_names.data(), roles.data());
+
+  // Layers are added in the same order for both blocks so the weights of the template's i-th layer are found in the
+  // i-th layer of this block's network
+  for (int32_t i = 0; i < num_weights; i++) {
+    auto it = layer_idx.find(layer_names[i]);
+    if (it == layer_idx.end()) {
+      LOG_DEBUG("Refittable weights of unknown layer " << layer_names[i] << ", falling back to a full build");
+      return "";
+    }
+    auto weights = GetLayerWeights(ctx.net->getLayer(it->second), roles[i]);
+    if (!weights || !refitter->setWeights(layer_names[i], roles[i], weights.value())) {
+      LOG_DEBUG("Unable to refit the weights of layer " << layer_names[i] << ", falling back to a full build");
+      return "";
+    }
+  }
+
+  if (refitter->getMissing(0, nullptr, nullptr) != 0 || !refitter->refitCudaEngine()) {
+    LOG_DEBUG("Refitting the template engine failed, falling back to a full build");
+    return "";
+  }
+
+  if (weight_name_map) {
+    // The refit engine keeps the layer names of the template
+    *weight_name_map = ctx.GetWeightNameMap(&tmpl.layer_names);
+  }
+
+  auto serialized_engine = make_trt(engine->serialize());
+  return std::string((const char*)serialized_engine->data(), serialized_engine->size());
+}
+
+} // namespace conversion
+} // namespace core
+} // namespace torch_tensorrt
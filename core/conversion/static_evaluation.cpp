@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <future>
+#include <thread>
+
+#include "core/conversion/conversion.h"
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace conversion {
+
+// Defined in core/conversion/conversion.cpp
+NodeBindingTable& GetNodeBindings(ConversionCtx* ctx);
+
+namespace {
+// Levels smaller than this are evaluated on the calling thread since they are not worth the overhead of the workers
+const size_t kMinParallelLevelSize = 64;
+
+struct StaticNode {
+  const torch::jit::Node* node;
+  const evaluators::NodeEvaluator* evaluator;
+};
+
+// Records the outputs of an evaluated node as static values, outputs which are not plain IValues (ex. ITensors created
+// by the evaluator) are left out so the nodes using them are not evaluated ahead of conversion
+void RecordStaticOutputs(
+    const torch::jit::Node* n,
+    const torch::jit::IValue& eval,
+    std::unordered_map<const torch::jit::Value*, torch::jit::IValue>& values) {
+  if (n->outputs().size() > 1) {
+    if (!eval.isTuple() || eval.toTuple()->elements().size() != n->outputs().size()) {
+      return;
+    }
+    auto tuple = eval.toTuple();
+    const auto& elems = tuple->elements();
+    for (size_t i = 0; i < elems.size(); i++) {
+      if (!elems[i].isCustomClass()) {
+        values[n->output(i)] = elems[i];
+      }
+    }
+  } else if (n->outputs().size() == 1 && !eval.isCustomClass()) {
+    values[n->output(0)] = eval;
+  }
+}
+} // namespace
+
+StaticEvaluationResults EvaluateStaticNodes(ConversionCtx* ctx, const torch::jit::Block* b, size_t num_threads) {
+  StaticEvaluationResults results;
+  if (util::BlockHasMutation(b)) {
+    LOG_DEBUG(ctx->logger, "Block modifies values in place, skipping evaluation of static nodes ahead of conversion");
+    return results;
+  }
+
+  auto& bindings = GetNodeBindings(ctx);
+  bindings.bind(b);
+
+  // Group the evaluator nodes which only depend on values already in the evaluated value map (parameters, constant
+  // inputs) and on other such nodes by depth, nodes in the same level do not depend on each other
+  std::unordered_map<const torch::jit::Value*, size_t> static_value_levels;
+  std::vector<std::vector<StaticNode>> levels;
+  for (const auto n : b->nodes()) {
+    auto& binding = bindings.get(n);
+    if (!binding.evaluated() || n->blocks().size() > 0 || n->hasSideEffects()) {
+      continue;
+    }
+    bool is_static = true;
+    size_t level = 0;
+    for (const auto in : n->inputs()) {
+      if (ctx->evaluated_value_map.find(in) != ctx->evaluated_value_map.end()) {
+        continue;
+      }
+      auto iter = static_value_levels.find(in);
+      if (iter == static_value_levels.end()) {
+        is_static = false;
+        break;
+      }
+      level = std::max(level, iter->second + 1);
+    }
+    if (!is_static) {
+      continue;
+    }
+    if (levels.size() <= level) {
+      levels.resize(level + 1);
+    }
+    levels[level].push_back({n, &binding.evaluator});
+    for (const auto out : n->outputs()) {
+      static_value_levels[out] = level;
+    }
+  }
+
+  if (num_threads == 0) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  // Values produced by the evaluated nodes, only written between levels so workers can read it without locking
+  std::unordered_map<const torch::jit::Value*, torch::jit::IValue> values;
+  values.reserve(static_value_levels.size());
+  for (auto& level : levels) {
+    std::vector<c10::optional<torch::jit::IValue>> level_results(level.size());
+    std::vector<char> evaluated(level.size(), false);
+
+    auto evaluate = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        auto n = level[i].node;
+        evaluators::kwargs args;
+        bool inputs_available = true;
+        for (const auto in : n->inputs()) {
+          auto param = ctx->evaluated_value_map.find(in);
+          if (param != ctx->evaluated_value_map.end()) {
+            args[in] = &param->second;
+            continue;
+          }
+          auto value = values.find(in);
+          if (value == values.end()) {
+            // The node producing the input evaluated to None or to an ITensor, leave this node to conversion
+            inputs_available = false;
+            break;
+          }
+          args[in] = &value->second;
+        }
+        if (inputs_available) {
+          level_results[i] = (*level[i].evaluator)(ctx, n, args);
+          evaluated[i] = true;
+        }
+      }
+    };
+
+    size_t num_workers = std::min(num_threads, level.size() / kMinParallelLevelSize);
+    if (num_workers <= 1) {
+      evaluate(0, level.size());
+    } else {
+      size_t chunk = (level.size() + num_workers - 1) / num_workers;
+      std::vector<std::future<void>> workers;
+      for (size_t begin = 0; begin < level.size(); begin += chunk) {
+        workers.push_back(std::async(std::launch::async, evaluate, begin, std::min(begin + chunk, level.size())));
+      }
+      for (auto& w : workers) {
+        w.get();
+      }
+    }
+
+    for (size_t i = 0; i < level.size(); i++) {
+      if (!evaluated[i]) {
+        continue;
+      }
+      if (level_results[i]) {
+        RecordStaticOutputs(level[i].node, level_results[i].value(), values);
+      }
+      results[level[i].node] = std::move(level_results[i]);
+    }
+  }
+
+  LOG_DEBUG(
+      ctx->logger,
+      "Evaluated " << results.size() << " static nodes in " << levels.size() << " levels ahead of conversion");
+  return results;
+}
+
+} // namespace conversion
+} // namespace core
+} // namespace torch_tensorrt
@@ -15,6 +15,7 @@ std::ostream& operator<<(std::ostream& os, const LowerInfo& l) {
     os << "      " << i << std::endl;
   }
   os << "    ]";
+  os << std::endl << "    Prune Sparse Weights: " << l.prune_sparse_weights;
   return os;
 }
 
@@ -152,6 +152,9 @@ void LowerGraph(std::shared_ptr<torch::jit::Graph>& g, std::vector<torch::jit::I
   passes::UnpackAndCastFull(g, lower_info.getGPUDeviceString());
   passes::ReplaceScalarImplicit(g);
   passes::RewriteInputsWithParams(g, params);
+  if (lower_info.prune_sparse_weights) {
+    passes::PruneWeightsTo2by4(g, params);
+  }
   passes::ReplaceAtenPad(g);
   LOG_GRAPH(*g);
 }
@@ -163,7 +166,12 @@ torch::jit::Module LowerModule(const torch::jit::Module& mod, std::string method
     passes::NotateModuleForFallback(mod, "", method_name, forced_fallback_modules);
     LOG_GRAPH("After MLF notation pass: " << *mod.get_method(method_name).graph());
   }
-  auto mod_ = torch::jit::freeze_module(mod);
+  // Freezing only keeps forward unless other methods are preserved explicitly
+  std::vector<std::string> preserved_methods;
+  if (method_name != "forward") {
+    preserved_methods.push_back(method_name);
+  }
+  auto mod_ = torch::jit::freeze_module(mod, preserved_methods);
   LOG_GRAPH("After freeze: " << *mod_.get_method(method_name).graph());
   return mod_;
 }
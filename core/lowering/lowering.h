@@ -17,6 +17,11 @@ struct LowerInfo {
   // pass. Disable this in order to not disturb TensorRT's QAT optimizations.
   bool disable_cse = false;
 
+  // Prune the weights of convolution and fully connected layers to 2:4 structured sparsity by magnitude, so TensorRT
+  // can run them with sparse kernels. Changes the results of the model, the error can be checked beforehand with
+  // ptq::AnalyzeSparsity
+  bool prune_sparse_weights = false;
+
   // Whether the originating caller is `convert_method_to_trt_engine` (true) or `compile` (false)
   bool converting_to_trt_engine = false;
 
@@ -50,6 +50,27 @@ void UnpackAndCastNumToTensor(std::shared_ptr<torch::jit::Graph>& graph, std::st
 void UnpackAndCastFull(std::shared_ptr<torch::jit::Graph>& graph, std::string target_device_name);
 void ReplaceScalarImplicit(std::shared_ptr<torch::jit::Graph>& graph);
 void ReplaceAtenPad(std::shared_ptr<torch::jit::Graph>& graph);
+void PruneWeightsTo2by4(std::shared_ptr<torch::jit::Graph>& graph, std::vector<torch::jit::IValue>& params);
+
+// Weights of a convolution or fully connected layer TensorRT can run with 2:4 structured sparsity, which needs at
+// least 2 zeros in every group of 4 consecutive elements along the dimension the layer reduces over
+struct SparseWeightUse {
+  torch::jit::Node* node;
+  // Constant or parameter holding the weights, before any transpose
+  torch::jit::Value* weight;
+  at::Tensor tensor;
+  int64_t reduction_dim;
+  int64_t output_dim;
+};
+
+// Top level layers whose weights are constants or parameters (the last inputs of graph)
+std::vector<SparseWeightUse> FindSparseWeightUses(
+    const std::shared_ptr<torch::jit::Graph>& graph,
+    const std::vector<torch::jit::IValue>& params);
+// Number of groups of 4 along dim with more than 2 non zero elements, 0 if weight is 2:4 sparse
+int64_t Count2by4DenseGroups(const at::Tensor& weight, int64_t dim);
+// Zeros the 2 elements of smallest magnitude in every group of 4 along dim
+at::Tensor PruneTo2by4(const at::Tensor& weight, int64_t dim);
 
 // utility functions exposed for testing
 std::string unmangle_cls_name(const std::string& name);
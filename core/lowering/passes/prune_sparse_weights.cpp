@@ -0,0 +1,191 @@
+#include <atomic>
+#include <unordered_set>
+
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec/vec.h"
+#include "core/lowering/passes/passes.h"
+#include "core/util/prelude.h"
+#include "torch/csrc/jit/ir/constants.h"
+#include "torch/torch.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace lowering {
+namespace passes {
+
+namespace {
+using Vec = at::vec::Vectorized<float>;
+
+constexpr int64_t kGroupSize = 4;
+constexpr int64_t kGrainSize = 1 << 14;
+// Counts are accumulated per lane in floats, which are exact up to 2^24, and flushed before that
+constexpr int64_t kFlushInterval = 1 << 20;
+
+// Lays the weights out as 4 rows holding the first, second, third and fourth element of each group of 4 consecutive
+// elements along dim, so a vector load from each row holds Vec::size() whole groups. Like TensorRT, dim is padded with
+// zeros to a multiple of 4
+at::Tensor ToGroupRows(const at::Tensor& weight, int64_t dim) {
+  auto w = weight.to(at::kCPU, at::kFloat).movedim(dim, -1);
+  auto pad = (kGroupSize - w.size(-1) % kGroupSize) % kGroupSize;
+  if (pad) {
+    w = at::constant_pad_nd(w, {0, pad});
+  }
+  return w.reshape({-1, kGroupSize}).t().contiguous();
+}
+
+at::Tensor FromGroupRows(const at::Tensor& rows, const at::Tensor& weight, int64_t dim) {
+  auto sizes = weight.movedim(dim, -1).sizes().vec();
+  auto channels = sizes.back();
+  sizes.back() = (channels + kGroupSize - 1) / kGroupSize * kGroupSize;
+  return rows.t().reshape(sizes).narrow(-1, 0, channels).movedim(-1, dim).to(weight.options()).contiguous();
+}
+
+bool IsFloatingPointTensor(const c10::optional<torch::jit::IValue>& v) {
+  return v && v->isTensor() && v->toTensor().is_floating_point();
+}
+} // namespace
+
+std::vector<SparseWeightUse> FindSparseWeightUses(
+    const std::shared_ptr<torch::jit::Graph>& graph,
+    const std::vector<torch::jit::IValue>& params) {
+  size_t num_inputs = graph->inputs().size() - params.size();
+  std::vector<SparseWeightUse> uses;
+  for (auto n : graph->nodes()) {
+    torch::jit::Value* weight = nullptr;
+    int64_t reduction_dim = 0, output_dim = 0;
+    bool is_convolution = false;
+    if (n->kind() == torch::jit::aten::_convolution) {
+      auto transposed = torch::jit::toIValue(n->input(6));
+      // TensorRT only runs sparse kernels for forward convolutions
+      if (!transposed || !transposed->isBool() || transposed->toBool()) {
+        continue;
+      }
+      weight = n->input(1);
+      reduction_dim = 1;
+      is_convolution = true;
+    } else if (n->kind() == torch::jit::aten::linear) {
+      weight = n->input(1);
+      reduction_dim = 1;
+    } else if (n->kind() == torch::jit::aten::matmul || n->kind() == torch::jit::aten::mm) {
+      weight = n->input(1);
+      output_dim = 1;
+    } else if (n->kind() == torch::jit::aten::addmm) {
+      weight = n->input(2);
+      output_dim = 1;
+    } else {
+      continue;
+    }
+
+    // Linear layers are lowered to a matmul with the transpose of the weights
+    if (weight->node()->kind() == torch::jit::aten::t) {
+      weight = weight->node()->input(0);
+      std::swap(reduction_dim, output_dim);
+    }
+
+    c10::optional<torch::jit::IValue> value;
+    if (weight->node()->kind() == torch::jit::prim::Param) {
+      if (weight->offset() >= num_inputs) {
+        value = params[weight->offset() - num_inputs];
+      }
+    } else {
+      value = torch::jit::toIValue(weight);
+    }
+    if (!IsFloatingPointTensor(value)) {
+      continue;
+    }
+    auto tensor = value->toTensor();
+    if (is_convolution ? tensor.dim() < 3 : tensor.dim() != 2) {
+      continue;
+    }
+    uses.push_back({n, weight, tensor, reduction_dim, output_dim});
+  }
+  return uses;
+}
+
+int64_t Count2by4DenseGroups(const at::Tensor& weight, int64_t dim) {
+  auto rows = ToGroupRows(weight, dim);
+  auto num_groups = rows.size(1);
+  const float* r = rows.data_ptr<float>();
+  std::atomic<int64_t> dense_groups{0};
+  at::parallel_for(0, num_groups, kGrainSize, [&](int64_t begin, int64_t end) {
+    const Vec zero(0.f), two(2.f);
+    for (int64_t block = begin; block < end; block += kFlushInterval) {
+      auto block_end = std::min(end, block + kFlushInterval);
+      Vec dense(0.f);
+      for (int64_t i = block; i < block_end; i += Vec::size()) {
+        auto count = std::min<int64_t>(Vec::size(), block_end - i);
+        // Lanes past count are loaded as zeros and never count as dense
+        auto non_zeros = Vec::loadu(r + i, count).ne(zero) + Vec::loadu(r + num_groups + i, count).ne(zero) +
+            Vec::loadu(r + 2 * num_groups + i, count).ne(zero) + Vec::loadu(r + 3 * num_groups + i, count).ne(zero);
+        dense = dense + non_zeros.gt(two);
+      }
+      float lanes[Vec::size()];
+      dense.store(lanes);
+      int64_t block_dense = 0;
+      for (auto lane : lanes) {
+        block_dense += static_cast<int64_t>(lane);
+      }
+      dense_groups += block_dense;
+    }
+  });
+  return dense_groups;
+}
+
+at::Tensor PruneTo2by4(const at::Tensor& weight, int64_t dim) {
+  auto rows = ToGroupRows(weight, dim);
+  auto num_groups = rows.size(1);
+  float* r = rows.data_ptr<float>();
+  at::parallel_for(0, num_groups, kGrainSize, [&](int64_t begin, int64_t end) {
+    const Vec zero(0.f), two(2.f);
+    for (int64_t i = begin; i < end; i += Vec::size()) {
+      auto count = std::min<int64_t>(Vec::size(), end - i);
+      Vec values[kGroupSize], magnitudes[kGroupSize];
+      for (int64_t k = 0; k < kGroupSize; k++) {
+        values[k] = Vec::loadu(r + k * num_groups + i, count);
+        magnitudes[k] = values[k].abs();
+      }
+      // The rank of each element by magnitude within its group, ties go to the earlier element. The two largest are
+      // kept, which is branch free over all the groups in the vector
+      for (int64_t k = 0; k < kGroupSize; k++) {
+        Vec rank = zero;
+        for (int64_t j = 0; j < kGroupSize; j++) {
+          if (j != k) {
+            rank = rank + (j < k ? magnitudes[j].ge(magnitudes[k]) : magnitudes[j].gt(magnitudes[k]));
+          }
+        }
+        (values[k] * rank.lt(two)).store(r + k * num_groups + i, count);
+      }
+    }
+  });
+  return FromGroupRows(rows, weight, dim);
+}
+
+void PruneWeightsTo2by4(std::shared_ptr<torch::jit::Graph>& graph, std::vector<torch::jit::IValue>& params) {
+  size_t num_inputs = graph->inputs().size() - params.size();
+  std::unordered_set<const torch::jit::Value*> visited;
+  for (auto& use : FindSparseWeightUses(graph, params)) {
+    // Weights shared by several layers are pruned for the first one
+    if (!visited.insert(use.weight).second) {
+      continue;
+    }
+    auto dense_groups = Count2by4DenseGroups(use.tensor, use.reduction_dim);
+    if (!dense_groups) {
+      continue;
+    }
+    auto pruned = PruneTo2by4(use.tensor, use.reduction_dim);
+    if (use.weight->node()->kind() == torch::jit::prim::Constant) {
+      use.weight->node()->t_(torch::jit::attr::value, pruned);
+    } else {
+      params[use.weight->offset() - num_inputs] = pruned;
+    }
+    LOG_DEBUG(
+        "Pruned " << dense_groups << " groups of the weights of %" << use.node->output()->debugName() << " ("
+                  << use.node->kind().toQualString() << ") to 2:4 sparsity");
+  }
+  LOG_GRAPH("After PruneWeightsTo2by4: " << *graph);
+}
+
+} // namespace passes
+} // namespace lowering
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include "core/partitioning/partitioning.h"
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace partitioning {
+
+namespace {
+size_t alignUp(size_t n, size_t alignment) {
+  return (n + alignment - 1) / alignment * alignment;
+}
+
+// Follows view-like ops (outputs annotated as aliasing an input in their schema) back to the value owning the memory.
+// TensorRT engines always produce fresh outputs so only nodes run in Torch can create aliases
+torch::jit::Value* aliasRoot(torch::jit::Value* v, const std::unordered_set<torch::jit::Node*>& torch_nodes) {
+  while (torch_nodes.count(v->node())) {
+    auto n = v->node();
+    const auto* schema = n->maybeSchema();
+    if (!schema || v->offset() >= schema->returns().size()) {
+      break;
+    }
+    const at::AliasInfo* out_alias = schema->returns()[v->offset()].alias_info();
+    if (!out_alias) {
+      break;
+    }
+    torch::jit::Value* src = nullptr;
+    for (size_t i = 0; i < schema->arguments().size() && i < n->inputs().size(); i++) {
+      const at::AliasInfo* in_alias = schema->arguments()[i].alias_info();
+      if (in_alias && in_alias->beforeSets() == out_alias->beforeSets()) {
+        src = n->inputs()[i];
+        break;
+      }
+    }
+    if (!src) {
+      break;
+    }
+    v = src;
+  }
+  return v;
+}
+} // namespace
+
+MemoryPlan assignArenaOffsets(std::vector<TensorLifetime> tensors, size_t alignment) {
+  MemoryPlan plan;
+  plan.tensors = std::move(tensors);
+  const auto& ts = plan.tensors;
+
+  for (const auto& t : ts) {
+    plan.naive_size += alignUp(t.size, alignment);
+  }
+  // The set of live tensors only grows when a tensor is defined so the peak is reached at the definition of a tensor
+  for (const auto& t : ts) {
+    size_t live = 0;
+    for (const auto& other : ts) {
+      if (other.first_use <= t.first_use && t.first_use <= other.last_use) {
+        live += alignUp(other.size, alignment);
+      }
+    }
+    plan.live_peak = std::max(plan.live_peak, live);
+  }
+
+  std::vector<size_t> order(ts.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return ts[a].size != ts[b].size ? ts[a].size > ts[b].size : ts[a].first_use < ts[b].first_use;
+  });
+
+  // Offset of each placed tensor, indexed like the tensors
+  std::vector<size_t> offsets(ts.size());
+  std::vector<size_t> placed;
+  for (auto i : order) {
+    auto size = alignUp(ts[i].size, alignment);
+    std::vector<std::pair<size_t, size_t>> occupied;
+    for (auto j : placed) {
+      if (ts[j].first_use <= ts[i].last_use && ts[i].first_use <= ts[j].last_use) {
+        occupied.push_back({offsets[j], alignUp(ts[j].size, alignment)});
+      }
+    }
+    std::sort(occupied.begin(), occupied.end());
+
+    auto best_offset = std::numeric_limits<size_t>::max();
+    auto best_gap = std::numeric_limits<size_t>::max();
+    size_t prev_end = 0;
+    for (const auto& o : occupied) {
+      if (o.first >= prev_end) {
+        auto gap = o.first - prev_end;
+        if (gap >= size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = prev_end;
+        }
+      }
+      prev_end = std::max(prev_end, o.first + o.second);
+    }
+    if (best_offset == std::numeric_limits<size_t>::max()) {
+      best_offset = prev_end;
+    }
+
+    offsets[i] = best_offset;
+    placed.push_back(i);
+    plan.offsets[ts[i].value] = best_offset;
+    plan.arena_size = std::max(plan.arena_size, best_offset + size);
+  }
+  return plan;
+}
+
+MemoryPlan planSegmentMemory(PartitioningCtx* ctx, torch::jit::Block* block, GraphAndMapping& stitched) {
+  auto& new_g = stitched.first;
+  auto& old_to_new_g = stitched.second;
+  auto& segmented_blocks = ctx->partitioned_blocks[block];
+
+  std::unordered_set<torch::jit::Node*> torch_nodes;
+  for (auto& seg_block : segmented_blocks) {
+    if (seg_block.target() == SegmentedBlock::kTorch) {
+      torch_nodes.insert(seg_block.raw_nodes().begin(), seg_block.raw_nodes().end());
+    }
+  }
+
+  // Shape analysis registers the shapes and types of the tensor inputs of each segment in order. Max shapes are only
+  // registered for dynamic inputs, with static inputs the opt shapes are the only ones
+  std::unordered_map<torch::jit::Value*, size_t> sizes;
+  for (auto& seg_block : segmented_blocks) {
+    auto max_shapes = seg_block.in_max_shapes();
+    if (max_shapes.empty()) {
+      max_shapes = seg_block.in_opt_shapes();
+    }
+    const auto& types = seg_block.in_types();
+    size_t tensor_idx = 0;
+    for (auto in : seg_block.raw_inputs()) {
+      if (!in->type()->isSubtypeOf(c10::TensorType::get())) {
+        continue;
+      }
+      // Inputs of the graph are owned by the caller
+      if (tensor_idx < max_shapes.size() && tensor_idx < types.size() && in->node() != block->param_node()) {
+        int64_t numel = 1;
+        for (auto d : max_shapes[tensor_idx]) {
+          numel *= d;
+        }
+        sizes[in] = numel * c10::elementSize(types[tensor_idx]);
+      }
+      tensor_idx++;
+    }
+  }
+
+  std::unordered_map<const torch::jit::Node*, size_t> position;
+  size_t pos = 0;
+  for (auto n : new_g->nodes()) {
+    position[n] = pos++;
+  }
+  position[new_g->return_node()] = pos;
+
+  // Tensors returned from the graph outlive the run so they cannot be placed in a reused arena
+  std::function<bool(const torch::jit::Value*)> escapes = [&](const torch::jit::Value* v) {
+    for (const auto& use : v->uses()) {
+      auto kind = use.user->kind();
+      if (kind == torch::jit::prim::Return) {
+        return true;
+      }
+      if ((kind == torch::jit::prim::TupleConstruct || kind == torch::jit::prim::ListConstruct) &&
+          escapes(use.user->output())) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  auto stitched_lifetime = [&](torch::jit::Value* raw) -> c10::optional<std::pair<size_t, size_t>> {
+    auto it = old_to_new_g.find(raw);
+    if (it == old_to_new_g.end()) {
+      return {};
+    }
+    auto v = it->second;
+    if (v->node()->kind() == torch::jit::prim::Param || v->node()->owningBlock() != new_g->block() || escapes(v)) {
+      return {};
+    }
+    auto first_use = position.at(v->node());
+    auto last_use = first_use;
+    for (const auto& use : v->uses()) {
+      auto user = use.user;
+      while (user->owningBlock() != new_g->block()) {
+        user = user->owningBlock()->owningNode();
+      }
+      last_use = std::max(last_use, position.at(user));
+    }
+    return std::make_pair(first_use, last_use);
+  };
+
+  // Views share the memory of the tensor they were created from, so they extend its lifetime instead of being planned
+  // on their own
+  std::unordered_map<torch::jit::Value*, std::vector<torch::jit::Value*>> alias_groups;
+  for (const auto& s : sizes) {
+    alias_groups[aliasRoot(s.first, torch_nodes)].push_back(s.first);
+  }
+
+  std::vector<TensorLifetime> lifetimes;
+  size_t num_unplanned = 0;
+  for (auto& group : alias_groups) {
+    auto root = group.first;
+    bool plannable = sizes.count(root);
+    TensorLifetime lifetime = {nullptr, std::numeric_limits<size_t>::max(), 0, plannable ? sizes[root] : 0};
+    for (auto raw : group.second) {
+      auto l = stitched_lifetime(raw);
+      if (!l) {
+        plannable = false;
+        break;
+      }
+      lifetime.first_use = std::min(lifetime.first_use, l->first);
+      lifetime.last_use = std::max(lifetime.last_use, l->second);
+    }
+    if (!plannable) {
+      num_unplanned += group.second.size();
+      continue;
+    }
+    lifetime.value = old_to_new_g.at(root);
+    lifetimes.push_back(lifetime);
+    num_unplanned += group.second.size() - 1;
+  }
+
+  // Sort by definition so the plan is deterministic
+  std::sort(lifetimes.begin(), lifetimes.end(), [](const TensorLifetime& a, const TensorLifetime& b) {
+    return a.first_use != b.first_use ? a.first_use < b.first_use : a.value->unique() < b.value->unique();
+  });
+
+  auto plan = assignArenaOffsets(std::move(lifetimes));
+  plan.num_unplanned = num_unplanned;
+  return plan;
+}
+
+std::ostream& operator<<(std::ostream& os, const MemoryPlan& plan) {
+  os << "Memory plan for tensors passed between segments:" << "\n    Planned tensors: " << plan.tensors.size()
+     << "\n    Unplanned tensors: " << plan.num_unplanned << "\n    Arena size (planned peak): " << plan.arena_size
+     << " bytes" << "\n    Naive peak: " << plan.naive_size << " bytes"
+     << "\n    Live peak (lower bound): " << plan.live_peak << " bytes";
+  for (const auto& t : plan.tensors) {
+    os << "\n    %" << t.value->debugName() << ": offset " << plan.offsets.at(t.value) << ", " << t.size
+       << " bytes, live [" << t.first_use << ", " << t.last_use << "]";
+  }
+  return os;
+}
+
+} // namespace partitioning
+} // namespace core
+} // namespace torch_tensorrt
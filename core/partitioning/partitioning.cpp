@@ -48,15 +48,15 @@ void setInputsOutputsConnectedNodes(PartitioningCtx* ctx, torch::jit::Block* blo
 }
 
 // Need to check if this makes sense might be a root cause of some issues of over aggressive fallback
-bool checkLoopEvaluatable(torch::jit::Node* n) {
+bool checkLoopEvaluatable(PartitioningCtx* ctx, torch::jit::Node* n) {
   bool compile_to_trt = true;
   for (auto bn : n->blocks()[0]->nodes()) {
     if (bn->kind() == torch::jit::prim::Loop) {
-      compile_to_trt = compile_to_trt && checkLoopEvaluatable(bn);
+      compile_to_trt = compile_to_trt && checkLoopEvaluatable(ctx, bn);
     } else if (bn->kind() == torch::jit::prim::If) {
       compile_to_trt = compile_to_trt && containNonTensorOutputs(bn);
     } else {
-      compile_to_trt = compile_to_trt && core::conversion::evaluators::shouldEvalAtConversionTime(bn);
+      compile_to_trt = compile_to_trt && ctx->node_bindings.get(bn).evaluated();
     }
   }
   return compile_to_trt;
@@ -74,9 +74,9 @@ void setExplicitFallbackNodes(PartitioningCtx* ctx, torch::jit::Block* block) {
       continue;
     }
 
-    if (n->kind() == torch::jit::prim::Loop && checkLoopEvaluatable(n)) {
+    if (n->kind() == torch::jit::prim::Loop && checkLoopEvaluatable(ctx, n)) {
       ctx->setNodeExecutorDecision(n, NodeExecutorDecision::kCONVERT);
-    } else if (!conversion::OpSupported(n)) {
+    } else if (!ctx->node_bindings.get(n).supported()) {
       // If the op is not supported by the conversion phase it should run in PyTorch
       ctx->setNodeExecutorDecision(n, NodeExecutorDecision::kUNSUPPORTED);
     } else if (ctx->forced_fallback_ops.find(n->kind().toQualString()) != ctx->forced_fallback_ops.end()) {
@@ -95,13 +95,17 @@ void setExplicitFallbackNodes(PartitioningCtx* ctx, torch::jit::Block* block) {
 
 // For a given set of fallback nodes, check their inputs/outputs, if any inputs/outputs of them are NonTensor,
 // then the nodes that produces/consumes those values should also fallback
-void setNonTensorConnectedNodes(PartitioningCtx* ctx, std::vector<torch::jit::Node*>& initial_fallback_nodes) {
+// Returns the nodes whose decision was changed by this function
+std::vector<torch::jit::Node*> setNonTensorConnectedNodes(
+    PartitioningCtx* ctx,
+    std::vector<torch::jit::Node*>& initial_fallback_nodes) {
   // initial_fallback_nodes are the fallback nodes that we have before we run BFS in this function
   std::queue<torch::jit::Node*> q;
   for (auto& node : initial_fallback_nodes) {
     q.push(node);
   }
 
+  std::vector<torch::jit::Node*> changed_nodes;
   while (!q.empty()) {
     auto cur_node = q.front();
     q.pop();
@@ -110,6 +114,7 @@ void setNonTensorConnectedNodes(PartitioningCtx* ctx, std::vector<torch::jit::No
       if (!isTensor(input) && input->node()->kind() != torch::jit::prim::Constant &&
           ctx->shouldNodeRunInTensorRT(input->node())) {
         ctx->setNodeExecutorDecision(input->node(), NodeExecutorDecision::kNON_TENSOR);
+        changed_nodes.push_back(input->node());
         q.push(input->node());
       }
     }
@@ -120,12 +125,14 @@ void setNonTensorConnectedNodes(PartitioningCtx* ctx, std::vector<torch::jit::No
           auto node = use.user;
           if (node->kind() != torch::jit::prim::Constant && ctx->shouldNodeRunInTensorRT(node)) {
             ctx->setNodeExecutorDecision(node, NodeExecutorDecision::kNON_TENSOR);
+            changed_nodes.push_back(node);
             q.push(node);
           }
         }
       }
     }
   }
+  return changed_nodes;
 }
 
 std::set<torch::jit::Node*> getDependentNodes(torch::jit::Node* n) {
@@ -151,42 +158,143 @@ std::set<torch::jit::Node*> getDependentNodes(torch::jit::Node* n) {
   return dependent_nodes;
 }
 
-// Sub-function that traverses the entire block and check if TensorRT node sequence satisfy min_block_size
-std::vector<torch::jit::Node*> traverseNodesForMinBlockSize(PartitioningCtx* ctx, torch::jit::Block* block) {
-  auto nodes = block->nodes();
-  std::vector<torch::jit::Node*> cur_trt_nodes;
-  std::unordered_set<torch::jit::Node*> cur_trt_nodes_uses;
-  std::vector<torch::jit::Node*> min_block_fallback_nodes;
-  for (const auto n : nodes) {
-    if (n->kind() == torch::jit::prim::Constant) {
-      continue;
+// Index based view of the (non constant) nodes of a block used to resolve min_block_size.
+//
+// A traversal walks the nodes in order, accumulating TensorRT nodes into a run until it reaches a Torch node that
+// depends on the run, at which point the run is "cut" and the state is reset. Runs smaller than min_block_size fall
+// back. Since the state is empty after a cut, a traversal that reaches a position which was a cut both before and
+// after a set of decision changes will produce exactly the same result as before from there on. This lets us only
+// re-traverse the regions around nodes whose decision changed instead of the whole block on every iteration.
+class MinBlockSizeResolver {
+ public:
+  MinBlockSizeResolver(PartitioningCtx* ctx, torch::jit::Block* block) : ctx_(ctx) {
+    for (const auto n : block->nodes()) {
+      if (n->kind() == torch::jit::prim::Constant) {
+        continue;
+      }
+      node_idx_[n] = nodes_.size();
+      nodes_.push_back(n);
     }
 
-    // check if current node fallback or not
-    if (!ctx->shouldNodeRunInTorch(n)) {
-      cur_trt_nodes.push_back(n);
-      auto dependent_nodes = getDependentNodes(n);
-      cur_trt_nodes_uses.insert(dependent_nodes.begin(), dependent_nodes.end());
-    } else {
-      if (cur_trt_nodes_uses.count(n)) {
-        if (cur_trt_nodes.size() < ctx->settings.min_block_size) {
-          min_block_fallback_nodes.insert(min_block_fallback_nodes.end(), cur_trt_nodes.begin(), cur_trt_nodes.end());
+    // Dependencies only depend on the structure of the graph so they are computed once. Users which are not
+    // top level nodes of this block (e.g. nodes in nested blocks or the return node) are never visited during the
+    // traversal so they are dropped here
+    dependents_.resize(nodes_.size());
+    run_in_torch_.resize(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      for (auto dependent : getDependentNodes(nodes_[i])) {
+        auto iter = node_idx_.find(dependent);
+        if (iter != node_idx_.end()) {
+          dependents_[i].push_back(iter->second);
+        }
+      }
+      run_in_torch_[i] = ctx_->shouldNodeRunInTorch(nodes_[i]);
+    }
+    is_cut_.assign(nodes_.size(), false);
+    use_stamp_.assign(nodes_.size(), 0);
+  }
+
+  // Traverses the entire block and returns the nodes of TensorRT runs which do not satisfy min_block_size
+  std::vector<torch::jit::Node*> traverse() {
+    std::vector<torch::jit::Node*> min_block_fallback_nodes;
+    std::vector<size_t> dirty;
+    size_t next_dirty = 0;
+    traverseFrom(0, dirty, next_dirty, min_block_fallback_nodes);
+    return min_block_fallback_nodes;
+  }
+
+  // Re-traverses only the regions of the block affected by the nodes whose decision has changed since the last
+  // traversal. Returns the same nodes a full traversal would.
+  std::vector<torch::jit::Node*> retraverse(const std::vector<torch::jit::Node*>& changed_nodes) {
+    std::vector<size_t> dirty;
+    for (auto n : changed_nodes) {
+      auto iter = node_idx_.find(n);
+      if (iter != node_idx_.end()) {
+        dirty.push_back(iter->second);
+        run_in_torch_[iter->second] = ctx_->shouldNodeRunInTorch(n);
+      }
+    }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    std::vector<torch::jit::Node*> min_block_fallback_nodes;
+    size_t next_dirty = 0;
+    size_t scanned_until = 0;
+    while (next_dirty < dirty.size()) {
+      // Regions start right after the last cut preceding the first unprocessed dirty node
+      size_t start = dirty[next_dirty];
+      while (start > scanned_until && !is_cut_[start - 1]) {
+        --start;
+      }
+      scanned_until = traverseFrom(start, dirty, next_dirty, min_block_fallback_nodes);
+    }
+    return min_block_fallback_nodes;
+  }
+
+ private:
+  // Traverses from start (where the in progress run is empty) until reaching a cut shared with the previous
+  // traversal past all dirty nodes, or the end of the block. Returns the position the traversal stopped at.
+  size_t traverseFrom(
+      size_t start,
+      const std::vector<size_t>& dirty,
+      size_t& next_dirty,
+      std::vector<torch::jit::Node*>& min_block_fallback_nodes) {
+    std::vector<size_t> cur_trt_nodes;
+    ++run_id_;
+    for (size_t i = start; i < nodes_.size(); ++i) {
+      while (next_dirty < dirty.size() && dirty[next_dirty] <= i) {
+        ++next_dirty;
+      }
+
+      if (!run_in_torch_[i]) {
+        cur_trt_nodes.push_back(i);
+        for (auto d : dependents_[i]) {
+          use_stamp_[d] = run_id_;
         }
+        is_cut_[i] = false;
+        continue;
+      }
+
+      bool was_cut = is_cut_[i];
+      is_cut_[i] = use_stamp_[i] == run_id_;
+      if (is_cut_[i]) {
+        collectSmallRun(cur_trt_nodes, min_block_fallback_nodes);
         cur_trt_nodes.clear();
-        cur_trt_nodes_uses.clear();
+        ++run_id_;
+        if (was_cut && (next_dirty == dirty.size() || dirty[next_dirty] > i)) {
+          return i + 1;
+        }
       }
     }
+    collectSmallRun(cur_trt_nodes, min_block_fallback_nodes);
+    return nodes_.size();
   }
-  if (cur_trt_nodes.size() < ctx->settings.min_block_size) {
-    min_block_fallback_nodes.insert(min_block_fallback_nodes.end(), cur_trt_nodes.begin(), cur_trt_nodes.end());
+
+  void collectSmallRun(const std::vector<size_t>& run, std::vector<torch::jit::Node*>& min_block_fallback_nodes) {
+    if (run.size() < ctx_->settings.min_block_size) {
+      for (auto i : run) {
+        min_block_fallback_nodes.push_back(nodes_[i]);
+      }
+    }
   }
-  return min_block_fallback_nodes;
-}
+
+  PartitioningCtx* ctx_;
+  std::vector<torch::jit::Node*> nodes_;
+  std::unordered_map<torch::jit::Node*, size_t> node_idx_;
+  std::vector<std::vector<size_t>> dependents_;
+  std::vector<bool> run_in_torch_;
+  // whether the in progress run was cut at this node in the last traversal that visited it
+  std::vector<bool> is_cut_;
+  // run_id of the last run which has this node as a dependent, avoids rebuilding a set per run
+  std::vector<uint64_t> use_stamp_;
+  uint64_t run_id_ = 0;
+};
 
 // Set the nodes that fallback because of min_block_size
 void setMinBlockFallbackNodes(PartitioningCtx* ctx, torch::jit::Block* block) {
+  MinBlockSizeResolver resolver(ctx, block);
   // first traverse all the nodes to find the initial nodes that don't meet the min_block_size requirement
-  auto min_block_fallback_nodes = traverseNodesForMinBlockSize(ctx, block);
+  auto min_block_fallback_nodes = resolver.traverse();
 
   // keep fallback until all segments meet the min_block_size requirement
   while (!min_block_fallback_nodes.empty()) {
@@ -194,9 +302,11 @@ void setMinBlockFallbackNodes(PartitioningCtx* ctx, torch::jit::Block* block) {
       ctx->setNodeExecutorDecision(i, NodeExecutorDecision::kMIN_BLOCK_FALLBACK);
     }
     // find the fallback nodes because of dependency with min_block_size caused fallback nodes
-    setNonTensorConnectedNodes(ctx, min_block_fallback_nodes);
-    // keep traverse the graph until there is no node fallback because of min_block_size
-    min_block_fallback_nodes = traverseNodesForMinBlockSize(ctx, block);
+    auto changed_nodes = setNonTensorConnectedNodes(ctx, min_block_fallback_nodes);
+    changed_nodes.insert(changed_nodes.end(), min_block_fallback_nodes.begin(), min_block_fallback_nodes.end());
+    // only revisit the parts of the graph affected by the new fallback nodes until there is no node fallback because
+    // of min_block_size
+    min_block_fallback_nodes = resolver.retraverse(changed_nodes);
   }
 }
 
@@ -383,7 +493,7 @@ void setNodeExecutorLUT(PartitioningCtx* ctx, torch::jit::Block* block) {
   setNonTensorConnectedNodes(ctx, cur_fallback_nodes);
 
   // Finally, check if all current tensorrt blocks satisfy the min_block_size requirement.
-  // We need to traverse the whole graph many times here
+  // Only the regions of the graph affected by new fallback nodes are traversed again after the first pass
   setMinBlockFallbackNodes(ctx, block);
 }
 
@@ -595,13 +705,17 @@ void partition(PartitioningCtx* ctx, bool expect_full_compilation) {
     LOG_DEBUG("Registering input/output torch::jit::Value for segmented graphs");
     registerSegmentsOutputs(ctx, block);
 
+    // Infer the min/opt/max shapes of the segmented blocks without running them when possible
+    if (ctx->settings.symbolic_shape_analysis && runSymbolicShapeAnalysis(ctx, block)) {
+      LOG_DEBUG("Inferred the input shapes of the segmented blocks symbolically");
+      continue;
+    }
+
     // Incase of dynamic shape inputs, run shape analysis on each segmented block for min/opt/max ranges and register
     // output shapes for each block accordingly
     if (isInputDynamic(ctx)) {
       LOG_DEBUG("Performing shape analysis for segmented blocks using min/opt/max shapes for inputs");
-      runShapeAnalysis(ctx, block, ctx->min_input_ivalues_map, ir::ShapeMode::kMIN);
-      runShapeAnalysis(ctx, block, ctx->opt_input_ivalues_map, ir::ShapeMode::kOPT);
-      runShapeAnalysis(ctx, block, ctx->max_input_ivalues_map, ir::ShapeMode::kMAX);
+      runDynamicShapeAnalysis(ctx, block);
     } else {
       LOG_DEBUG("Performing shape analysis for segmented blocks using static shapes for inputs");
       runShapeAnalysis(ctx, block, ctx->opt_input_ivalues_map, ir::ShapeMode::kOPT);
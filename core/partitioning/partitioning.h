@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "torch/csrc/jit/ir/ir.h"
@@ -45,10 +47,135 @@ void runShapeAnalysis(
     ExampleIValues& ivalues_maps,
     const ir::ShapeMode& shape_mode);
 
+// Runs shape analysis for the min, opt and max input IValues concurrently and registers the results of all three
+// modes on each segmented block
+void runDynamicShapeAnalysis(PartitioningCtx* ctx, torch::jit::Block* block);
+
 void segmentGraph(PartitioningCtx* ctx, torch::jit::Block* block);
 
 GraphAndMapping stitch(PartitioningCtx* ctx, torch::jit::Block* block);
 
+// Canonical form of a segment's graph and input shapes in which tensor constants (the frozen weights) are replaced by
+// their type and shape, so two segments with equal canonical forms only differ in their weights. If weights is given,
+// the tensor constants are also identified by a hash of their contents and appended to weights in order, so segments
+// with equal canonical forms and equal weights compute the same function. Returns an empty string if the segment
+// cannot be canonicalized
+std::string canonicalizeSegmentedBlock(SegmentedBlock& seg_block, std::vector<at::Tensor>* weights = nullptr);
+
+// Canonical form of a block including a hash of its tensor constants, which are appended to weights in order. Returns
+// an empty string if the block cannot be canonicalized (ex. it uses values defined outside of it)
+std::string canonicalizeBlockWithWeights(const torch::jit::Block* b, std::vector<at::Tensor>* weights);
+
+// Groups structurally identical TensorRT segments by their canonical form. Each group lists the indices of its
+// segments in order of appearance
+std::vector<std::vector<size_t>> groupIdenticalSegments(PartitionedGraph& segmented_blocks);
+
+// Lifetime of a tensor passed between segments, in positions of the top level nodes of the stitched graph
+struct TensorLifetime {
+  torch::jit::Value* value;
+  size_t first_use;
+  size_t last_use;
+  size_t size;
+};
+
+// Offsets of the tensors passed between segments in a single arena which is reused across tensors whose lifetimes do
+// not overlap
+struct MemoryPlan {
+  std::vector<TensorLifetime> tensors;
+  std::unordered_map<torch::jit::Value*, size_t> offsets;
+  // Planned peak, the size of the arena
+  size_t arena_size = 0;
+  // Peak if every tensor got its own allocation for the whole run
+  size_t naive_size = 0;
+  // Largest total size of tensors alive at the same time, the lower bound for the arena size
+  size_t live_peak = 0;
+  // Tensors passed between segments which are not in the arena (graph outputs, aliases, unknown shapes)
+  size_t num_unplanned = 0;
+};
+
+const size_t kArenaAlignment = 256;
+
+// Places the tensors in an arena greedily by size, each tensor goes into the smallest gap left by the tensors with
+// overlapping lifetimes that were already placed
+MemoryPlan assignArenaOffsets(std::vector<TensorLifetime> tensors, size_t alignment = kArenaAlignment);
+
+// Plans the memory of the tensors passed between the segments of a block from the max shapes found by shape analysis
+// (the opt shapes for static inputs) and the lifetimes of the tensors in the stitched graph
+MemoryPlan planSegmentMemory(PartitioningCtx* ctx, torch::jit::Block* block, GraphAndMapping& stitched);
+
+std::ostream& operator<<(std::ostream& os, const MemoryPlan& plan);
+
+// Number of input shapes (min, opt, max) tracked by symbolic shape inference, lanes are indexed by ir::ShapeMode
+const size_t kNumShapeLanes = 3;
+
+// A dimension or integer of the graph, given by its value at the min, opt and max input shapes and the symbolic
+// expression it was derived from in terms of the dynamic input dimensions (s0, s1, ...). The expression is empty if
+// the value is the same for all input shapes
+struct SymDim {
+  SymDim() = default;
+  explicit SymDim(int64_t v) : lanes{{v, v, v}} {}
+
+  std::array<int64_t, kNumShapeLanes> lanes = {{0, 0, 0}};
+  std::string expr;
+
+  int64_t min() const {
+    return lanes[0];
+  }
+  int64_t opt() const {
+    return lanes[1];
+  }
+  int64_t max() const {
+    return lanes[2];
+  }
+  bool is_static() const {
+    return lanes[0] == lanes[1] && lanes[1] == lanes[2];
+  }
+  // The expression, or the value if the dimension is static
+  std::string str() const;
+};
+
+// What symbolic shape inference knows about a value of the graph
+struct SymValue {
+  enum class Kind {
+    kUnknown,
+    kTensor,
+    kInt,
+    kList,
+    kConstant,
+  };
+
+  Kind kind = Kind::kUnknown;
+  // kTensor
+  std::vector<SymDim> dims;
+  c10::optional<at::ScalarType> dtype;
+  // kInt, also set for 0-d tensors holding a known integer
+  c10::optional<SymDim> scalar;
+  // kList, used for both lists and tuples
+  std::vector<SymValue> elems;
+  // kConstant, also set for constant tensors and lists
+  c10::optional<c10::IValue> constant;
+
+  std::vector<int64_t> shape(ir::ShapeMode mode) const;
+};
+
+typedef std::unordered_map<const torch::jit::Value*, SymValue> SymbolicShapeMap;
+
+// Propagates the min, opt and max input shapes and the input types through the block. Common ATen ops are handled by
+// shape functions, other ops are run on CPU example inputs for each input shape. Values depending on ops which can do
+// neither (ex. control flow, ops with side effects) are left as kUnknown, as is every value of blocks which modify
+// values in place
+SymbolicShapeMap inferSymbolicShapes(PartitioningCtx* ctx, torch::jit::Block* block);
+
+// Registers the input shapes and types of every segmented block and inserts the casts around Torch blocks using
+// symbolic shape inference instead of running the blocks. Returns false without modifying the blocks if the inputs or
+// outputs of any block could not be inferred, in which case the regular shape analysis has to be run
+bool runSymbolicShapeAnalysis(PartitioningCtx* ctx, torch::jit::Block* block);
+
+std::ostream& operator<<(std::ostream& os, const SymDim& d);
+std::ostream& operator<<(std::ostream& os, const SymValue& v);
+
+bool isInputDynamic(PartitioningCtx* ctx);
+
 void partition(PartitioningCtx* ctx, bool expect_full_compilation = false);
 
 } // namespace partitioning
@@ -12,6 +12,7 @@ PartitioningCtx::PartitioningCtx(torch::jit::Block* b, PartitioningInfo info)
       forced_fallback_ops(info.forced_fallback_operators.begin(), info.forced_fallback_operators.end()) {
   LOG_DEBUG(settings);
   _load_nodes_into_decision_map(b);
+  node_bindings.bind(b);
 }
 
 void PartitioningCtx::_load_nodes_into_decision_map(torch::jit::Block* b) {
@@ -5,6 +5,7 @@
 #include <utility>
 #include <vector>
 
+#include "core/conversion/conversion.h"
 #include "core/partitioning/partitioninginfo/PartitioningInfo.h"
 #include "core/partitioning/segmentedblock/SegmentedBlock.h"
 
@@ -57,6 +58,8 @@ struct PartitioningCtx {
   // LUT of the segmented blocks for each blocks in the module
   std::unordered_map<torch::jit::Block*, PartitionedGraph> partitioned_blocks;
   std::unordered_set<std::string> forced_fallback_ops;
+  // Evaluators and converters of the nodes of the original blocks, used to decide which nodes are supported
+  conversion::NodeBindingTable node_bindings;
 
   PartitioningCtx(torch::jit::Block* b, PartitioningInfo info);
   void setNodeExecutorDecision(torch::jit::Node* n, NodeExecutorDecision decision);
@@ -19,6 +19,10 @@ std::ostream& operator<<(std::ostream& os, const PartitioningInfo& s) {
       os <<"\n        " << i << ',';
     }
     os << "\n     ]";
+    os << "\n    \"use_execution_plan\": " << (s.use_execution_plan ? "True" : "False");
+    os << "\n    \"refit_identical_segments\": " << (s.refit_identical_segments ? "True" : "False");
+    os << "\n    \"plan_segment_memory\": " << (s.plan_segment_memory ? "True" : "False");
+    os << "\n    \"symbolic_shape_analysis\": " << (s.symbolic_shape_analysis ? "True" : "False");
   } else {
     os << "False";
   }
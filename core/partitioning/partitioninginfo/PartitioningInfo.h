@@ -18,6 +18,16 @@ struct PartitioningInfo {
   bool truncate_long_and_double;
   ir::Device target_device;
   bool cast_int8_inputs = false;
+  // Run the stitched graph through a precompiled execution plan instead of the TorchScript interpreter
+  bool use_execution_plan = false;
+  // Build structurally identical TensorRT segments once as a refittable engine and refit it with the weights of the
+  // others. Refittable engines may run slower and INT8 engines are not refit since their calibration would not match
+  bool refit_identical_segments = false;
+  // Plan the memory of the tensors passed between segments and log the plan, the plan is only reported
+  bool plan_segment_memory = false;
+  // Infer the input shapes of segmented blocks symbolically instead of running them on example inputs, blocks are
+  // still run if any of their shapes cannot be inferred or the graph modifies values in place
+  bool symbolic_shape_analysis = false;
 
   std::string getGPUDeviceString() const {
     return "cuda:" + std::to_string(target_device.gpu_id);
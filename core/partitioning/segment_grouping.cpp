@@ -0,0 +1,211 @@
+#include <sstream>
+
+#include "torch/csrc/jit/ir/constants.h"
+
+#include "core/conversion/conversionctx/ConstantPool.h"
+#include "core/partitioning/partitioning.h"
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace partitioning {
+
+namespace {
+void canonicalizeType(std::ostream& os, const torch::jit::Value* v) {
+  // The shapes recorded on tensor types are not reliable after lowering, input shapes are taken from the shapes
+  // registered by shape analysis instead
+  if (v->type()->isSubtypeOf(c10::TensorType::get())) {
+    os << "Tensor";
+  } else {
+    os << v->type()->str();
+  }
+}
+
+void canonicalizeWeights(std::ostream& os, const at::Tensor& t, std::vector<at::Tensor>* weights) {
+  os << "Weights(" << t.scalar_type() << ", " << t.sizes() << ", " << t.device();
+  if (weights) {
+    auto data = t.to(at::kCPU).contiguous();
+    os << ", " << std::hex << conversion::HashBytes(data.data_ptr(), data.nbytes()) << std::dec;
+    weights->push_back(t);
+  }
+  os << ")";
+}
+
+bool canonicalizeConstant(std::ostream& os, const torch::jit::Node* n, std::vector<at::Tensor>* weights) {
+  auto ivalue = torch::jit::toIValue(n->output());
+  if (!ivalue) {
+    return false;
+  }
+  if (ivalue->isTensor()) {
+    // Unless requested, weights are abstracted to their type and shape so segments differing only in weights compare
+    // equal
+    canonicalizeWeights(os, ivalue->toTensor(), weights);
+  } else {
+    os << *ivalue;
+  }
+  return true;
+}
+
+bool canonicalizeBlock(
+    std::ostream& os,
+    const torch::jit::Block* b,
+    std::unordered_map<const torch::jit::Value*, size_t>& value_ids,
+    std::vector<at::Tensor>* weights) {
+  auto id_of = [&](const torch::jit::Value* v) {
+    auto it = value_ids.find(v);
+    if (it == value_ids.end()) {
+      it = value_ids.insert({v, value_ids.size()}).first;
+    }
+    return it->second;
+  };
+
+  os << "block(";
+  for (auto in : b->inputs()) {
+    os << '%' << id_of(in) << " : ";
+    canonicalizeType(os, in);
+    os << ", ";
+  }
+  os << ")\n";
+
+  for (const auto n : b->nodes()) {
+    for (auto out : n->outputs()) {
+      os << '%' << id_of(out) << " : ";
+      canonicalizeType(os, out);
+      os << ", ";
+    }
+    os << "= " << n->kind().toQualString();
+
+    if (n->kind() == torch::jit::prim::Constant) {
+      os << '[';
+      if (!canonicalizeConstant(os, n, weights)) {
+        return false;
+      }
+      os << ']';
+    } else if (n->hasAttributes()) {
+      for (auto name : n->attributeNames()) {
+        auto kind = n->kindOf(name);
+        if (kind == torch::jit::AttributeKind::t || kind == torch::jit::AttributeKind::ts) {
+          // Tensors are only expected as the value of a constant
+          return false;
+        }
+      }
+      n->printAttributes(os);
+    }
+
+    os << '(';
+    for (auto in : n->inputs()) {
+      auto it = value_ids.find(in);
+      if (it == value_ids.end()) {
+        // Value defined outside of the segment
+        return false;
+      }
+      os << '%' << it->second << ", ";
+    }
+    os << ')';
+
+    if (auto schema = n->maybeSchema()) {
+      os << " # " << *schema;
+    }
+    os << '\n';
+
+    for (auto sub_b : n->blocks()) {
+      if (!canonicalizeBlock(os, sub_b, value_ids, weights)) {
+        return false;
+      }
+    }
+  }
+
+  os << "return(";
+  for (auto out : b->outputs()) {
+    auto it = value_ids.find(out);
+    if (it == value_ids.end()) {
+      return false;
+    }
+    os << '%' << it->second << ", ";
+  }
+  os << ")\n";
+  return true;
+}
+
+void canonicalizeShapes(std::ostream& os, const std::vector<std::vector<int64_t>>& shapes) {
+  for (auto& s : shapes) {
+    os << c10::IntArrayRef(s) << ", ";
+  }
+  os << '\n';
+}
+} // namespace
+
+std::string canonicalizeSegmentedBlock(SegmentedBlock& seg_block, std::vector<at::Tensor>* weights) {
+  std::ostringstream os;
+  os << SegmentedBlock::target_to_str(seg_block.target()) << '\n';
+
+  os << "min: ";
+  canonicalizeShapes(os, seg_block.in_min_shapes());
+  os << "opt: ";
+  canonicalizeShapes(os, seg_block.in_opt_shapes());
+  os << "max: ";
+  canonicalizeShapes(os, seg_block.in_max_shapes());
+  os << "types: ";
+  for (auto t : seg_block.in_types()) {
+    os << t << ", ";
+  }
+  os << '\n';
+
+  std::unordered_map<const torch::jit::Value*, size_t> value_ids;
+  if (!canonicalizeBlock(os, seg_block.block(), value_ids, weights)) {
+    LOG_DEBUG(
+        "Unable to canonicalize segment " << seg_block.get_id() << ", it will not be grouped with other segments");
+    return "";
+  }
+  return os.str();
+}
+
+std::string canonicalizeBlockWithWeights(const torch::jit::Block* b, std::vector<at::Tensor>* weights) {
+  std::ostringstream os;
+  std::unordered_map<const torch::jit::Value*, size_t> value_ids;
+  if (!canonicalizeBlock(os, b, value_ids, weights)) {
+    return "";
+  }
+  return os.str();
+}
+
+std::vector<std::vector<size_t>> groupIdenticalSegments(PartitionedGraph& segmented_blocks) {
+  std::vector<std::vector<size_t>> groups;
+  std::vector<std::string> group_keys;
+  std::unordered_map<size_t, std::vector<size_t>> groups_by_hash;
+
+  for (size_t i = 0; i < segmented_blocks.size(); ++i) {
+    auto& seg_block = segmented_blocks[i];
+    if (seg_block.target() != SegmentedBlock::kTensorRT) {
+      continue;
+    }
+
+    auto key = canonicalizeSegmentedBlock(seg_block);
+    if (key.empty()) {
+      groups.push_back({i});
+      group_keys.push_back(key);
+      continue;
+    }
+
+    // Hash collisions are resolved by comparing the full canonical forms
+    auto& candidates = groups_by_hash[std::hash<std::string>{}(key)];
+    bool found = false;
+    for (auto g : candidates) {
+      if (group_keys[g] == key) {
+        groups[g].push_back(i);
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      candidates.push_back(groups.size());
+      groups.push_back({i});
+      group_keys.push_back(std::move(key));
+    }
+  }
+  return groups;
+}
+
+} // namespace partitioning
+} // namespace core
+} // namespace torch_tensorrt
@@ -1,3 +1,4 @@
+#include <future>
 #include <queue>
 #include "ATen/ATen.h"
 #include "torch/csrc/jit/api/module.h"
@@ -147,15 +148,13 @@ torch::jit::Node* createCastNode(
   return cast_node;
 }
 
+// Runs copy_g, a private copy of the segment's graph, on the IValues recorded for the segment's inputs and records
+// the resulting IValues for the segment's outputs. Only copy_g and ivalues_maps are modified so this can run
+// concurrently for different shape modes.
 void getSegmentsOutputByRunning(
     SegmentedBlock& seg_block,
-    std::unordered_map<const torch::jit::Value*, torch::jit::IValue>& ivalues_maps,
-    const PartitioningInfo& partitioning_info,
-    const ir::ShapeMode& shape_mode) {
-  // create a module to run the graph
-  auto g = seg_block.g();
-  auto copy_g = g->copy();
-
+    std::shared_ptr<torch::jit::Graph> copy_g,
+    std::unordered_map<const torch::jit::Value*, torch::jit::IValue>& ivalues_maps) {
   // create tuple for multiple outputs
   if (seg_block.raw_outputs().size() > 1) {
     auto new_output_node = copy_g->appendNode(copy_g->createTuple(copy_g->outputs()));
@@ -234,7 +233,14 @@ void getSegmentsOutputByRunning(
   for (auto& output : seg_block.raw_outputs()) {
     ivalues_maps[output] = jit_results[idx++];
   }
+}
 
+// Inserts the int64 <=> int32 and int8 <=> int32 casts required around Torch segments based on the IValues
+// observed for the segment's inputs and outputs while running shape analysis
+void insertSegmentCastNodes(
+    SegmentedBlock& seg_block,
+    std::unordered_map<const torch::jit::Value*, torch::jit::IValue>& ivalues_maps,
+    const PartitioningInfo& partitioning_info) {
   auto target_device = partitioning_info.getGPUDeviceString();
 
   // auto int64 <=> int32 conversion + int8 <=> int32 conversion for non-quantized models
@@ -293,7 +299,14 @@ void getSegmentsOutputByRunning(
       }
     }
   }
+}
 
+// Records the input shapes for shape_mode and input types of the segment from the IValues observed for its inputs
+void registerSegmentInputShapes(
+    SegmentedBlock& seg_block,
+    std::unordered_map<const torch::jit::Value*, torch::jit::IValue>& ivalues_maps,
+    const PartitioningInfo& partitioning_info,
+    const ir::ShapeMode& shape_mode) {
   // set input shape for each segmented block so we wil use it in conversion process
   std::vector<std::vector<int64_t>> input_shapes;
   std::vector<at::ScalarType> input_types;
@@ -351,11 +364,107 @@ void runShapeAnalysis(
   for (auto& seg_block : ctx->partitioned_blocks[block]) {
     LOG_GRAPH("Running shape analysis on block " << seg_block);
     torch::jit::ConstantPooling(seg_block.g());
-    getSegmentsOutputByRunning(seg_block, example_tensor_map, ctx->settings, shape_mode);
+    getSegmentsOutputByRunning(seg_block, seg_block.g()->copy(), example_tensor_map);
+    insertSegmentCastNodes(seg_block, example_tensor_map, ctx->settings);
+    registerSegmentInputShapes(seg_block, example_tensor_map, ctx->settings, shape_mode);
+  }
+  return;
+}
+
+void runDynamicShapeAnalysis(PartitioningCtx* ctx, torch::jit::Block* block) {
+  auto& segmented_blocks = ctx->partitioned_blocks[block];
+  const std::vector<ir::ShapeMode> shape_modes = {ir::ShapeMode::kMIN, ir::ShapeMode::kOPT, ir::ShapeMode::kMAX};
+  std::vector<ExampleIValues*> example_tensor_maps = {
+      &ctx->min_input_ivalues_map, &ctx->opt_input_ivalues_map, &ctx->max_input_ivalues_map};
+
+  // Each shape mode runs on its own copies of the segment graphs so that the modes never share graph state
+  std::vector<std::vector<std::shared_ptr<torch::jit::Graph>>> mode_graphs(shape_modes.size());
+  for (auto& seg_block : segmented_blocks) {
+    LOG_GRAPH("Running shape analysis on block " << seg_block);
+    torch::jit::ConstantPooling(seg_block.g());
+    for (auto& graphs : mode_graphs) {
+      graphs.push_back(seg_block.g()->copy());
+    }
+  }
+
+  // Segments have to be run in order within a mode, since later segments consume earlier segments' outputs, but
+  // the modes themselves are independent
+  std::vector<std::future<void>> mode_analyses;
+  for (size_t m = 0; m < shape_modes.size(); ++m) {
+    mode_analyses.push_back(
+        std::async(std::launch::async, [&segmented_blocks, &mode_graphs, &example_tensor_maps, m]() {
+          for (size_t i = 0; i < segmented_blocks.size(); ++i) {
+            getSegmentsOutputByRunning(segmented_blocks[i], mode_graphs[m][i], *example_tensor_maps[m]);
+          }
+        }));
+  }
+  for (auto& mode_analysis : mode_analyses) {
+    mode_analysis.get();
+  }
+
+  // Merge the results of every mode into the segments in a fixed order. Casts depend only on data types, which are
+  // the same across modes, so they are inserted once based on the opt run
+  for (auto& seg_block : segmented_blocks) {
+    for (size_t m = 0; m < shape_modes.size(); ++m) {
+      registerSegmentInputShapes(seg_block, *example_tensor_maps[m], ctx->settings, shape_modes[m]);
+    }
+    insertSegmentCastNodes(seg_block, ctx->opt_input_ivalues_map, ctx->settings);
   }
   return;
 }
 
+bool runSymbolicShapeAnalysis(PartitioningCtx* ctx, torch::jit::Block* block) {
+  auto shapes = inferSymbolicShapes(ctx, block);
+  auto& segmented_blocks = ctx->partitioned_blocks[block];
+
+  // Shape registration and cast insertion only look at the type and shape of the tensors passed between segments, so
+  // empty meta tensors stand in for the IValues shape analysis would have produced by running the segments
+  const std::vector<ir::ShapeMode> shape_modes = {ir::ShapeMode::kMIN, ir::ShapeMode::kOPT, ir::ShapeMode::kMAX};
+  std::vector<ExampleIValues> example_tensor_maps(shape_modes.size());
+  for (auto& seg_block : segmented_blocks) {
+    std::vector<torch::jit::Value*> values(seg_block.raw_inputs().begin(), seg_block.raw_inputs().end());
+    values.insert(values.end(), seg_block.raw_outputs().begin(), seg_block.raw_outputs().end());
+    for (auto v : values) {
+      if (!v->type()->isSubtypeOf(torch::jit::TensorType::get())) {
+        continue;
+      }
+      auto it = shapes.find(v);
+      if (it == shapes.end() || it->second.kind != SymValue::Kind::kTensor || !it->second.dtype) {
+        LOG_DEBUG(
+            "Could not infer the shape of %" << v->debugName() << " produced from " << util::node_info(v->node())
+                                             << " symbolically, falling back to running the segmented blocks");
+        return false;
+      }
+      for (size_t m = 0; m < shape_modes.size(); ++m) {
+        example_tensor_maps[m][v] = at::empty(
+            it->second.shape(shape_modes[m]), at::TensorOptions().dtype(*it->second.dtype).device(at::kMeta));
+      }
+    }
+  }
+
+  auto& opt_map = example_tensor_maps[static_cast<size_t>(ir::ShapeMode::kOPT)];
+  bool dynamic = isInputDynamic(ctx);
+  for (auto& seg_block : segmented_blocks) {
+    LOG_GRAPH("Running symbolic shape analysis on block " << seg_block);
+    torch::jit::ConstantPooling(seg_block.g());
+    for (size_t i = 0; i < seg_block.raw_inputs().size(); ++i) {
+      auto it = shapes.find(seg_block.raw_inputs()[i]);
+      if (it != shapes.end()) {
+        LOG_DEBUG("Input %" << seg_block.raw_inputs()[i]->debugName() << ": " << it->second);
+      }
+    }
+    insertSegmentCastNodes(seg_block, opt_map, ctx->settings);
+    if (dynamic) {
+      for (size_t m = 0; m < shape_modes.size(); ++m) {
+        registerSegmentInputShapes(seg_block, example_tensor_maps[m], ctx->settings, shape_modes[m]);
+      }
+    } else {
+      registerSegmentInputShapes(seg_block, opt_map, ctx->settings, ir::ShapeMode::kOPT);
+    }
+  }
+  return true;
+}
+
 } // namespace partitioning
 } // namespace core
 } // namespace torch_tensorrt
@@ -0,0 +1,1738 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include "ATen/ATen.h"
+#include "torch/csrc/jit/ir/constants.h"
+
+#include "core/partitioning/partitioning.h"
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace partitioning {
+
+namespace {
+using Kind = SymValue::Kind;
+typedef std::vector<const SymValue*> SymInputs;
+typedef std::vector<SymValue> SymOutputs;
+typedef std::function<bool(const torch::jit::Node*, const SymInputs&, SymOutputs&)> ShapeFn;
+
+bool isKind(const torch::jit::Node* n, const char* kind) {
+  return n->kind() == c10::Symbol::fromQualString(kind);
+}
+
+// Input of the node bound to the named argument of its schema, nullptr if the node has no such argument
+const SymValue* arg(const torch::jit::Node* n, const SymInputs& in, const char* name) {
+  const auto* schema = n->maybeSchema();
+  if (!schema) {
+    return nullptr;
+  }
+  auto idx = schema->argumentIndexWithName(name);
+  if (!idx || static_cast<size_t>(*idx) >= in.size()) {
+    return nullptr;
+  }
+  return in[*idx];
+}
+
+int64_t floorDivide(int64_t a, int64_t b) {
+  auto q = a / b;
+  if (a % b != 0 && ((a < 0) != (b < 0))) {
+    q--;
+  }
+  return q;
+}
+
+SymDim combine(
+    const SymDim& a,
+    const SymDim& b,
+    const std::function<int64_t(int64_t, int64_t)>& f,
+    const std::string& op) {
+  SymDim r;
+  for (size_t i = 0; i < kNumShapeLanes; i++) {
+    r.lanes[i] = f(a.lanes[i], b.lanes[i]);
+  }
+  if (!r.is_static()) {
+    r.expr = "(" + a.str() + op + b.str() + ")";
+  }
+  return r;
+}
+
+SymDim mapDim(const SymDim& a, const std::function<int64_t(int64_t)>& f, const std::string& name) {
+  SymDim r;
+  for (size_t i = 0; i < kNumShapeLanes; i++) {
+    r.lanes[i] = f(a.lanes[i]);
+  }
+  if (!r.is_static()) {
+    r.expr = name + "(" + a.str() + ")";
+  }
+  return r;
+}
+
+bool isConstant(const SymDim& d, int64_t v) {
+  return d.is_static() && d.min() == v;
+}
+
+SymDim sub(const SymDim& a, const SymDim& b) {
+  if (isConstant(b, 0)) {
+    return a;
+  }
+  return combine(a, b, std::minus<int64_t>(), "-");
+}
+
+SymDim add(const SymDim& a, const SymDim& b) {
+  if (isConstant(b, 0)) {
+    return a;
+  }
+  if (isConstant(a, 0)) {
+    return b;
+  }
+  if (b.is_static() && b.min() < 0) {
+    return sub(a, SymDim(-b.min()));
+  }
+  return combine(a, b, std::plus<int64_t>(), "+");
+}
+
+SymDim mul(const SymDim& a, const SymDim& b) {
+  if (isConstant(b, 1)) {
+    return a;
+  }
+  if (isConstant(a, 1)) {
+    return b;
+  }
+  return combine(a, b, std::multiplies<int64_t>(), "*");
+}
+
+// Callers have to make sure b is non zero in every lane
+SymDim floorDiv(const SymDim& a, const SymDim& b) {
+  if (isConstant(b, 1)) {
+    return a;
+  }
+  return combine(a, b, floorDivide, "/");
+}
+
+bool nonZero(const SymDim& d) {
+  return std::none_of(d.lanes.begin(), d.lanes.end(), [](int64_t v) { return v == 0; });
+}
+
+bool nonNegative(const std::vector<SymDim>& dims) {
+  for (const auto& d : dims) {
+    if (std::any_of(d.lanes.begin(), d.lanes.end(), [](int64_t v) { return v < 0; })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SymDim numel(const std::vector<SymDim>& dims) {
+  SymDim n(1);
+  for (const auto& d : dims) {
+    n = mul(n, d);
+  }
+  return n;
+}
+
+SymValue tensorValue(std::vector<SymDim> dims, c10::optional<at::ScalarType> dtype) {
+  SymValue v;
+  v.kind = Kind::kTensor;
+  v.dims = std::move(dims);
+  v.dtype = dtype;
+  return v;
+}
+
+SymValue intValue(SymDim d) {
+  SymValue v;
+  v.kind = Kind::kInt;
+  v.scalar = std::move(d);
+  return v;
+}
+
+SymValue listValue(std::vector<SymValue> elems) {
+  SymValue v;
+  v.kind = Kind::kList;
+  v.elems = std::move(elems);
+  return v;
+}
+
+SymValue constantValue(c10::IValue iv) {
+  SymValue v;
+  v.kind = Kind::kConstant;
+  v.constant = std::move(iv);
+  return v;
+}
+
+bool isTensor(const SymValue* v) {
+  return v && v->kind == Kind::kTensor;
+}
+
+bool isNone(const SymValue* v) {
+  return v && v->kind == Kind::kConstant && v->constant->isNone();
+}
+
+c10::optional<int64_t> staticInt(const SymValue* v) {
+  if (!v || v->kind != Kind::kInt || !v->scalar->is_static()) {
+    return {};
+  }
+  return v->scalar->min();
+}
+
+c10::optional<bool> staticBool(const SymValue* v) {
+  if (!v || v->kind != Kind::kConstant || !v->constant->isBool()) {
+    return {};
+  }
+  return v->constant->toBool();
+}
+
+c10::optional<std::vector<SymDim>> intList(const SymValue* v) {
+  if (!v || v->kind != Kind::kList) {
+    return {};
+  }
+  std::vector<SymDim> dims;
+  for (const auto& e : v->elems) {
+    if (e.kind != Kind::kInt) {
+      return {};
+    }
+    dims.push_back(*e.scalar);
+  }
+  return dims;
+}
+
+c10::optional<std::vector<int64_t>> staticIntList(const SymValue* v) {
+  auto dims = intList(v);
+  if (!dims) {
+    return {};
+  }
+  std::vector<int64_t> values;
+  for (const auto& d : *dims) {
+    if (!d.is_static()) {
+      return {};
+    }
+    values.push_back(d.min());
+  }
+  return values;
+}
+
+c10::optional<at::ScalarType> staticDtype(const SymValue* v) {
+  auto t = staticInt(v);
+  if (!t) {
+    return {};
+  }
+  return static_cast<at::ScalarType>(*t);
+}
+
+// Wraps negative dimension indices, returns -1 for out of range indices
+int64_t normalizeDim(int64_t dim, size_t rank) {
+  auto r = static_cast<int64_t>(rank);
+  if (dim < 0) {
+    dim += r;
+  }
+  return dim >= 0 && dim < r ? dim : -1;
+}
+
+int typeCategory(at::ScalarType t) {
+  if (t == at::kBool) {
+    return 0;
+  }
+  return c10::isIntegralType(t, /*includeBool=*/false) ? 1 : 2;
+}
+
+// Follows at::result_type: dimensioned tensors take priority over 0-d tensors which take priority over scalars, unless
+// a lower priority operand is of a higher category (bool < integral < floating point)
+c10::optional<at::ScalarType> resultType(const SymInputs& operands) {
+  c10::optional<at::ScalarType> dim_type;
+  c10::optional<at::ScalarType> zero_dim_type;
+  c10::optional<at::ScalarType> scalar_type;
+  auto promote = [](c10::optional<at::ScalarType>& slot, at::ScalarType t) {
+    slot = slot ? c10::promoteTypes(*slot, t) : t;
+  };
+  for (auto v : operands) {
+    if (isTensor(v)) {
+      if (!v->dtype) {
+        return {};
+      }
+      promote(v->dims.empty() ? zero_dim_type : dim_type, *v->dtype);
+    } else if (v->kind == Kind::kInt) {
+      promote(scalar_type, at::kLong);
+    } else if (v->kind == Kind::kConstant && v->constant->isDouble()) {
+      promote(scalar_type, at::kDouble);
+    } else if (v->kind == Kind::kConstant && v->constant->isBool()) {
+      promote(scalar_type, at::kBool);
+    } else if (!isNone(v)) {
+      return {};
+    }
+  }
+  if (!dim_type && !zero_dim_type) {
+    return {};
+  }
+  auto result = dim_type ? *dim_type : *zero_dim_type;
+  if (dim_type && zero_dim_type && typeCategory(*zero_dim_type) > typeCategory(result)) {
+    result = *zero_dim_type;
+  }
+  if (scalar_type && typeCategory(*scalar_type) > typeCategory(result)) {
+    // Python scalars are promoted to the default type of their category
+    result = typeCategory(*scalar_type) == 2 ? at::kFloat : at::kLong;
+  }
+  return result;
+}
+
+// Broadcasts the shapes lane by lane, keeping the expression of the dimension the result is equal to
+c10::optional<std::vector<SymDim>> broadcast(const std::vector<const std::vector<SymDim>*>& shapes) {
+  size_t rank = 0;
+  for (auto s : shapes) {
+    rank = std::max(rank, s->size());
+  }
+  std::vector<SymDim> out(rank);
+  for (size_t i = 0; i < rank; i++) {
+    SymDim r(1);
+    for (auto s : shapes) {
+      if (i >= s->size()) {
+        continue;
+      }
+      const auto& d = (*s)[s->size() - 1 - i];
+      auto merged = r;
+      for (size_t l = 0; l < kNumShapeLanes; l++) {
+        if (d.lanes[l] == 1) {
+          continue;
+        }
+        if (r.lanes[l] != 1 && r.lanes[l] != d.lanes[l]) {
+          return {};
+        }
+        merged.lanes[l] = d.lanes[l];
+      }
+      if (merged.lanes != r.lanes) {
+        merged.expr = merged.lanes == d.lanes ? d.expr : "max(" + r.str() + "," + d.str() + ")";
+      }
+      if (merged.is_static()) {
+        merged.expr.clear();
+      }
+      r = merged;
+    }
+    out[rank - 1 - i] = r;
+  }
+  return out;
+}
+
+bool unaryShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  if (!isTensor(in[0])) {
+    return false;
+  }
+  out[0] = tensorValue(in[0]->dims, in[0]->dtype);
+  return true;
+}
+
+// Unary ops which compute in floating point, integer inputs produce float outputs
+bool floatUnaryShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  if (!unaryShape(n, in, out)) {
+    return false;
+  }
+  if (out[0].dtype && typeCategory(*out[0].dtype) < 2) {
+    out[0].dtype = at::kFloat;
+  }
+  return true;
+}
+
+bool softmaxShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  if (!unaryShape(n, in, out)) {
+    return false;
+  }
+  if (auto dtype = staticDtype(arg(n, in, "dtype"))) {
+    out[0].dtype = dtype;
+  }
+  return true;
+}
+
+bool intArithmeticShape(const torch::jit::Node* n, const SymDim& a, const SymDim& b, SymOutputs& out) {
+  if (isKind(n, "aten::add")) {
+    out[0] = intValue(add(a, b));
+  } else if (isKind(n, "aten::sub")) {
+    out[0] = intValue(sub(a, b));
+  } else if (isKind(n, "aten::mul")) {
+    out[0] = intValue(mul(a, b));
+  } else if (isKind(n, "aten::floordiv") && nonZero(b)) {
+    out[0] = intValue(floorDiv(a, b));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool binaryShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  if (in.size() >= 2 && in[0]->kind == Kind::kInt && in[1]->kind == Kind::kInt) {
+    return intArithmeticShape(n, *in[0]->scalar, *in[1]->scalar, out);
+  }
+  bool is_where = isKind(n, "aten::where");
+  size_t num_operands = is_where ? 3 : 2;
+  if (in.size() < num_operands) {
+    return false;
+  }
+
+  std::vector<const std::vector<SymDim>*> shapes;
+  for (size_t i = 0; i < num_operands; i++) {
+    if (in[i]->kind == Kind::kUnknown) {
+      return false;
+    }
+    if (isTensor(in[i])) {
+      shapes.push_back(&in[i]->dims);
+    }
+  }
+  if (shapes.empty()) {
+    return false;
+  }
+  auto dims = broadcast(shapes);
+  if (!dims) {
+    return false;
+  }
+
+  static const std::unordered_set<std::string> kBoolOps = {
+      "aten::eq",
+      "aten::ne",
+      "aten::lt",
+      "aten::gt",
+      "aten::le",
+      "aten::ge",
+      "aten::logical_and",
+      "aten::logical_or",
+      "aten::logical_xor",
+  };
+  std::string kind = n->kind().toQualString();
+  // In place ops (ex. aten::add_, but not aten::__and__) keep the type of self
+  bool in_place = kind.back() == '_' && kind[kind.size() - 2] != '_';
+  c10::optional<at::ScalarType> dtype;
+  if (kBoolOps.count(kind)) {
+    dtype = at::kBool;
+  } else if (in_place) {
+    dtype = in[0]->dtype;
+  } else if (is_where) {
+    dtype = resultType({in[1], in[2]});
+  } else if (isKind(n, "aten::masked_fill")) {
+    dtype = in[0]->dtype;
+  } else {
+    dtype = resultType({in[0], in[1]});
+    // True division always produces floating point results
+    bool true_div = isKind(n, "aten::div") && (in.size() < 3 || isNone(in[2]));
+    if (dtype && true_div && typeCategory(*dtype) < 2) {
+      dtype = at::kFloat;
+    }
+  }
+  if (!dtype) {
+    return false;
+  }
+  out[0] = tensorValue(*dims, dtype);
+  return true;
+}
+
+// Size of a convolution or pooling output along one spatial dimension
+SymDim slidingWindowDim(const SymDim& x, int64_t kernel, int64_t stride, int64_t padding, int64_t dilation) {
+  auto offset = 2 * padding - dilation * (kernel - 1) - 1;
+  if (stride == 1) {
+    return add(x, SymDim(offset + 1));
+  }
+  return add(floorDiv(add(x, SymDim(offset)), SymDim(stride)), SymDim(1));
+}
+
+int64_t param(const std::vector<int64_t>& values, size_t i, int64_t default_value) {
+  if (values.empty()) {
+    return default_value;
+  }
+  return values.size() == 1 ? values[0] : (i < values.size() ? values[i] : default_value);
+}
+
+bool convolutionShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* input = arg(n, in, "input");
+  const auto* weight = arg(n, in, "weight");
+  if (!isTensor(input) || !isTensor(weight) || weight->dims.size() < 3) {
+    return false;
+  }
+  for (const auto& d : weight->dims) {
+    if (!d.is_static()) {
+      return false;
+    }
+  }
+
+  bool transposed = std::string(n->kind().toQualString()).find("conv_transpose") != std::string::npos;
+  if (auto t = arg(n, in, "transposed")) {
+    auto value = staticBool(t);
+    if (!value) {
+      return false;
+    }
+    transposed = *value;
+  }
+  auto stride = staticIntList(arg(n, in, "stride"));
+  auto padding = staticIntList(arg(n, in, "padding"));
+  auto dilation = staticIntList(arg(n, in, "dilation"));
+  auto groups = staticInt(arg(n, in, "groups"));
+  c10::optional<std::vector<int64_t>> output_padding = std::vector<int64_t>();
+  if (transposed) {
+    output_padding = staticIntList(arg(n, in, "output_padding"));
+  }
+  // Padding can also be given as a string ("same", "valid") which is left to execution
+  if (!stride || !padding || !dilation || !groups || !output_padding) {
+    return false;
+  }
+
+  auto num_spatial = weight->dims.size() - 2;
+  bool batched = input->dims.size() == weight->dims.size();
+  if (!batched && input->dims.size() + 1 != weight->dims.size()) {
+    return false;
+  }
+
+  std::vector<SymDim> dims;
+  if (batched) {
+    dims.push_back(input->dims[0]);
+  }
+  dims.push_back(transposed ? SymDim(weight->dims[1].min() * *groups) : weight->dims[0]);
+  auto offset = batched ? 2 : 1;
+  for (size_t i = 0; i < num_spatial; i++) {
+    const auto& x = input->dims[offset + i];
+    auto k = weight->dims[2 + i].min();
+    auto s = param(*stride, i, 1);
+    auto p = param(*padding, i, 0);
+    auto d = param(*dilation, i, 1);
+    if (s <= 0) {
+      return false;
+    }
+    if (transposed) {
+      auto op = param(*output_padding, i, 0);
+      dims.push_back(add(mul(x, SymDim(s)), SymDim(-s - 2 * p + d * (k - 1) + op + 1)));
+    } else {
+      dims.push_back(slidingWindowDim(x, k, s, p, d));
+    }
+  }
+  if (!nonNegative(dims)) {
+    return false;
+  }
+  out[0] = tensorValue(dims, input->dtype);
+  return true;
+}
+
+bool poolingShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  std::string kind = n->kind().toQualString();
+  if (!isTensor(self) || kind.back() != 'd') {
+    return false;
+  }
+  size_t num_spatial = kind[kind.size() - 2] - '0';
+  auto kernel = staticIntList(arg(n, in, "kernel_size"));
+  auto stride = staticIntList(arg(n, in, "stride"));
+  auto padding = staticIntList(arg(n, in, "padding"));
+  auto ceil_mode = staticBool(arg(n, in, "ceil_mode"));
+  c10::optional<std::vector<int64_t>> dilation = std::vector<int64_t>();
+  if (auto d = arg(n, in, "dilation")) {
+    dilation = staticIntList(d);
+  }
+  if (!kernel || kernel->empty() || !stride || !padding || !ceil_mode || !dilation) {
+    return false;
+  }
+  if (self->dims.size() != num_spatial + 1 && self->dims.size() != num_spatial + 2) {
+    return false;
+  }
+
+  std::vector<SymDim> dims(self->dims.begin(), self->dims.end() - num_spatial);
+  for (size_t i = 0; i < num_spatial; i++) {
+    const auto& x = self->dims[self->dims.size() - num_spatial + i];
+    auto k = param(*kernel, i, 1);
+    // An empty stride defaults to the kernel size
+    auto s = stride->empty() ? k : param(*stride, i, 1);
+    auto p = param(*padding, i, 0);
+    auto d = param(*dilation, i, 1);
+    if (s <= 0) {
+      return false;
+    }
+    if (!*ceil_mode) {
+      dims.push_back(slidingWindowDim(x, k, s, p, d));
+      continue;
+    }
+    dims.push_back(mapDim(
+        x,
+        [=](int64_t v) {
+          auto o = floorDivide(v + 2 * p - d * (k - 1) - 1 + s - 1, s) + 1;
+          // The last window has to start inside the input or the left padding
+          if ((o - 1) * s >= v + p) {
+            o--;
+          }
+          return o;
+        },
+        "ceil_pool"));
+  }
+  if (!nonNegative(dims)) {
+    return false;
+  }
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool adaptivePoolingShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  auto output_size = intList(arg(n, in, "output_size"));
+  if (!isTensor(self) || !output_size || output_size->size() > self->dims.size()) {
+    return false;
+  }
+  std::vector<SymDim> dims(self->dims.begin(), self->dims.end() - output_size->size());
+  dims.insert(dims.end(), output_size->begin(), output_size->end());
+  out[0] = tensorValue(dims, self->dtype);
+  // adaptive_max_pool also returns the indices
+  if (out.size() > 1) {
+    out[1] = tensorValue(dims, at::kLong);
+  }
+  return true;
+}
+
+bool linearShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  const auto* input = in[0];
+  const auto* weight = in[1];
+  if (!isTensor(input) || !isTensor(weight) || input->dims.empty() || weight->dims.size() > 2 ||
+      weight->dims.empty()) {
+    return false;
+  }
+  std::vector<SymDim> dims(input->dims.begin(), input->dims.end() - 1);
+  if (weight->dims.size() == 2) {
+    dims.push_back(weight->dims[0]);
+  }
+  out[0] = tensorValue(dims, input->dtype);
+  return true;
+}
+
+bool matmulShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  // addmm(self, mat1, mat2, beta, alpha) multiplies its second and third inputs
+  size_t first = isKind(n, "aten::addmm") ? 1 : 0;
+  if (in.size() < first + 2 || !isTensor(in[first]) || !isTensor(in[first + 1])) {
+    return false;
+  }
+  auto a = in[first]->dims;
+  auto b = in[first + 1]->dims;
+  if (a.empty() || b.empty()) {
+    return false;
+  }
+  bool a_vector = a.size() == 1;
+  bool b_vector = b.size() == 1;
+  if (a_vector) {
+    a.insert(a.begin(), SymDim(1));
+  }
+  if (b_vector) {
+    b.push_back(SymDim(1));
+  }
+
+  std::vector<SymDim> a_batch(a.begin(), a.end() - 2);
+  std::vector<SymDim> b_batch(b.begin(), b.end() - 2);
+  auto dims = broadcast({&a_batch, &b_batch});
+  if (!dims) {
+    return false;
+  }
+  if (!a_vector) {
+    dims->push_back(a[a.size() - 2]);
+  }
+  if (!b_vector) {
+    dims->push_back(b.back());
+  }
+  out[0] = tensorValue(*dims, resultType({in[first], in[first + 1]}));
+  return out[0].dtype.has_value();
+}
+
+bool flattenShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  auto start = staticInt(arg(n, in, "start_dim"));
+  auto end = staticInt(arg(n, in, "end_dim"));
+  if (!isTensor(self) || !start || !end) {
+    return false;
+  }
+  if (self->dims.empty()) {
+    out[0] = tensorValue({SymDim(1)}, self->dtype);
+    return true;
+  }
+  auto s = normalizeDim(*start, self->dims.size());
+  auto e = normalizeDim(*end, self->dims.size());
+  if (s < 0 || e < s) {
+    return false;
+  }
+  std::vector<SymDim> dims(self->dims.begin(), self->dims.begin() + s);
+  dims.push_back(numel(std::vector<SymDim>(self->dims.begin() + s, self->dims.begin() + e + 1)));
+  dims.insert(dims.end(), self->dims.begin() + e + 1, self->dims.end());
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool reshapeShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  auto size = intList(in[1]);
+  if (!isTensor(self) || !size) {
+    return false;
+  }
+  auto dims = *size;
+  int64_t inferred = -1;
+  SymDim known(1);
+  for (size_t i = 0; i < dims.size(); i++) {
+    if (isConstant(dims[i], -1)) {
+      if (inferred >= 0) {
+        return false;
+      }
+      inferred = i;
+    } else if (!nonNegative({dims[i]})) {
+      return false;
+    } else {
+      known = mul(known, dims[i]);
+    }
+  }
+
+  auto total = numel(self->dims);
+  if (inferred >= 0) {
+    if (!nonZero(known)) {
+      return false;
+    }
+    for (size_t l = 0; l < kNumShapeLanes; l++) {
+      if (total.lanes[l] % known.lanes[l] != 0) {
+        return false;
+      }
+    }
+    dims[inferred] = floorDiv(total, known);
+  } else if (total.lanes != known.lanes) {
+    return false;
+  }
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool permuteShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  auto order = staticIntList(in[1]);
+  if (!isTensor(self) || !order || order->size() != self->dims.size()) {
+    return false;
+  }
+  std::vector<SymDim> dims;
+  for (auto d : *order) {
+    auto idx = normalizeDim(d, self->dims.size());
+    if (idx < 0) {
+      return false;
+    }
+    dims.push_back(self->dims[idx]);
+  }
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool transposeShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  if (!isTensor(self)) {
+    return false;
+  }
+  auto dims = self->dims;
+  if (isKind(n, "aten::t")) {
+    if (dims.size() > 2) {
+      return false;
+    }
+    std::reverse(dims.begin(), dims.end());
+  } else {
+    auto d0 = staticInt(in[1]);
+    auto d1 = staticInt(in[2]);
+    if (!d0 || !d1) {
+      return false;
+    }
+    auto a = normalizeDim(*d0, dims.size());
+    auto b = normalizeDim(*d1, dims.size());
+    if (a < 0 || b < 0) {
+      return false;
+    }
+    std::swap(dims[a], dims[b]);
+  }
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool unsqueezeShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  auto dim = staticInt(in[1]);
+  if (!isTensor(self) || !dim) {
+    return false;
+  }
+  auto idx = normalizeDim(*dim, self->dims.size() + 1);
+  if (idx < 0) {
+    return false;
+  }
+  auto dims = self->dims;
+  dims.insert(dims.begin() + idx, SymDim(1));
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool squeezeShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  if (!isTensor(self)) {
+    return false;
+  }
+  std::vector<int64_t> selected;
+  if (in.size() == 1) {
+    for (size_t i = 0; i < self->dims.size(); i++) {
+      selected.push_back(i);
+    }
+  } else if (auto dim = staticInt(in[1])) {
+    selected.push_back(*dim);
+  } else if (auto dim_list = staticIntList(in[1])) {
+    selected = *dim_list;
+  } else {
+    return false;
+  }
+  std::vector<bool> squeezed(self->dims.size(), false);
+  for (auto d : selected) {
+    auto idx = normalizeDim(d, self->dims.size());
+    if (idx >= 0) {
+      squeezed[idx] = true;
+    }
+  }
+
+  std::vector<SymDim> dims;
+  for (size_t i = 0; i < self->dims.size(); i++) {
+    const auto& d = self->dims[i];
+    bool any_one = std::any_of(d.lanes.begin(), d.lanes.end(), [](int64_t v) { return v == 1; });
+    if (squeezed[i] && isConstant(d, 1)) {
+      continue;
+    }
+    // The rank would depend on the input shape
+    if (squeezed[i] && any_one) {
+      return false;
+    }
+    dims.push_back(d);
+  }
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool catShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* tensors = in[0];
+  auto dim = staticInt(arg(n, in, "dim"));
+  if (!tensors || tensors->kind != Kind::kList || tensors->elems.empty() || !dim) {
+    return false;
+  }
+  bool stack = isKind(n, "aten::stack");
+  std::vector<const SymValue*> parts;
+  for (const auto& e : tensors->elems) {
+    if (!isTensor(&e) || !e.dtype) {
+      return false;
+    }
+    // cat skips legacy empty 1-d tensors
+    if (!stack && e.dims.size() == 1 && isConstant(e.dims[0], 0)) {
+      continue;
+    }
+    parts.push_back(&e);
+  }
+  if (parts.empty()) {
+    out[0] = tensorValue({SymDim(0)}, tensors->elems[0].dtype);
+    return true;
+  }
+
+  auto dims = parts[0]->dims;
+  auto dtype = *parts[0]->dtype;
+  for (auto p : parts) {
+    dtype = c10::promoteTypes(dtype, *p->dtype);
+  }
+  if (stack) {
+    auto idx = normalizeDim(*dim, dims.size() + 1);
+    if (idx < 0) {
+      return false;
+    }
+    dims.insert(dims.begin() + idx, SymDim(parts.size()));
+  } else {
+    auto idx = normalizeDim(*dim, dims.size());
+    if (idx < 0) {
+      return false;
+    }
+    for (size_t i = 1; i < parts.size(); i++) {
+      if (parts[i]->dims.size() != dims.size()) {
+        return false;
+      }
+      dims[idx] = add(dims[idx], parts[i]->dims[idx]);
+    }
+  }
+  out[0] = tensorValue(dims, dtype);
+  return true;
+}
+
+bool sliceShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  auto dim = staticInt(arg(n, in, "dim"));
+  auto step = staticInt(arg(n, in, "step"));
+  const auto* start = arg(n, in, "start");
+  const auto* end = arg(n, in, "end");
+  if (!isTensor(self) || !dim || !step || *step <= 0 || !start || !end) {
+    return false;
+  }
+  auto idx = normalizeDim(*dim, self->dims.size());
+  if (idx < 0 || (!isNone(start) && start->kind != Kind::kInt) || (!isNone(end) && end->kind != Kind::kInt)) {
+    return false;
+  }
+
+  const auto& len = self->dims[idx];
+  SymDim r;
+  for (size_t l = 0; l < kNumShapeLanes; l++) {
+    auto n_elems = len.lanes[l];
+    auto s = isNone(start) ? 0 : start->scalar->lanes[l];
+    auto e = isNone(end) ? n_elems : end->scalar->lanes[l];
+    s = s < 0 ? s + n_elems : s;
+    e = e < 0 ? e + n_elems : e;
+    s = std::min(std::max<int64_t>(s, 0), n_elems);
+    e = std::min(std::max(e, s), n_elems);
+    r.lanes[l] = (e - s + *step - 1) / *step;
+  }
+  if (r.lanes == len.lanes) {
+    r.expr = len.expr;
+  } else if (!r.is_static()) {
+    r.expr = "slice(" + len.str() + ")";
+  }
+  auto dims = self->dims;
+  dims[idx] = r;
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool selectShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  auto dim = staticInt(arg(n, in, "dim"));
+  if (!isTensor(self) || !dim) {
+    return false;
+  }
+  auto idx = normalizeDim(*dim, self->dims.size());
+  if (idx < 0) {
+    return false;
+  }
+  auto dims = self->dims;
+  dims.erase(dims.begin() + idx);
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool expandShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  if (!isTensor(self)) {
+    return false;
+  }
+  if (isKind(n, "aten::expand_as")) {
+    if (!isTensor(in[1])) {
+      return false;
+    }
+    out[0] = tensorValue(in[1]->dims, self->dtype);
+    return true;
+  }
+
+  auto size = intList(in[1]);
+  if (!size || size->size() < self->dims.size()) {
+    return false;
+  }
+  auto dims = *size;
+  auto leading = dims.size() - self->dims.size();
+  for (size_t i = 0; i < dims.size(); i++) {
+    if (isConstant(dims[i], -1)) {
+      if (i < leading) {
+        return false;
+      }
+      dims[i] = self->dims[i - leading];
+    }
+  }
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool repeatShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  auto repeats = intList(in[1]);
+  if (!isTensor(self) || !repeats || repeats->size() < self->dims.size()) {
+    return false;
+  }
+  auto dims = *repeats;
+  auto leading = dims.size() - self->dims.size();
+  for (size_t i = leading; i < dims.size(); i++) {
+    dims[i] = mul(self->dims[i - leading], dims[i]);
+  }
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+bool embeddingShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  const auto* weight = in[0];
+  const auto* indices = in[1];
+  if (!isTensor(weight) || !isTensor(indices) || weight->dims.size() != 2) {
+    return false;
+  }
+  auto dims = indices->dims;
+  dims.push_back(weight->dims[1]);
+  out[0] = tensorValue(dims, weight->dtype);
+  return true;
+}
+
+bool padShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  auto pad = staticIntList(in[1]);
+  if (!isTensor(self) || !pad || pad->size() % 2 != 0 || pad->size() / 2 > self->dims.size()) {
+    return false;
+  }
+  auto dims = self->dims;
+  for (size_t i = 0; i < pad->size() / 2; i++) {
+    auto& d = dims[dims.size() - 1 - i];
+    d = add(d, SymDim((*pad)[2 * i] + (*pad)[2 * i + 1]));
+  }
+  if (!nonNegative(dims)) {
+    return false;
+  }
+  out[0] = tensorValue(dims, self->dtype);
+  return true;
+}
+
+// Factory functions (zeros, ones, full, ...) and their _like variants
+bool factoryShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  std::vector<SymDim> dims;
+  c10::optional<at::ScalarType> dtype;
+  std::string kind = n->kind().toQualString();
+  if (kind.size() > 5 && kind.compare(kind.size() - 5, 5, "_like") == 0) {
+    if (!isTensor(in[0])) {
+      return false;
+    }
+    dims = in[0]->dims;
+    dtype = in[0]->dtype;
+  } else {
+    auto size = intList(arg(n, in, "size"));
+    if (!size || !nonNegative(*size)) {
+      return false;
+    }
+    dims = *size;
+    if (auto fill = arg(n, in, "fill_value")) {
+      if (fill->kind == Kind::kInt) {
+        dtype = at::kLong;
+      } else if (fill->kind == Kind::kConstant && fill->constant->isDouble()) {
+        dtype = at::kFloat;
+      } else if (fill->kind == Kind::kConstant && fill->constant->isBool()) {
+        dtype = at::kBool;
+      }
+    } else {
+      dtype = at::kFloat;
+    }
+  }
+
+  const auto* dtype_arg = arg(n, in, "dtype");
+  if (dtype_arg && !isNone(dtype_arg)) {
+    dtype = staticDtype(dtype_arg);
+  }
+  if (!dtype) {
+    return false;
+  }
+  out[0] = tensorValue(dims, dtype);
+  return true;
+}
+
+bool reductionShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  if (!isTensor(self) || !self->dtype) {
+    return false;
+  }
+  // max(self, other) and min(self, other) are elementwise
+  if (in.size() > 1 && isTensor(in[1])) {
+    return binaryShape(n, in, out);
+  }
+
+  std::vector<bool> reduced(self->dims.size(), false);
+  const auto* dim_arg = arg(n, in, "dim");
+  if (!dim_arg || isNone(dim_arg)) {
+    std::fill(reduced.begin(), reduced.end(), true);
+  } else if (auto dim = staticInt(dim_arg)) {
+    auto idx = normalizeDim(*dim, self->dims.size());
+    if (idx < 0) {
+      return false;
+    }
+    reduced[idx] = true;
+  } else if (auto dims = staticIntList(dim_arg)) {
+    // An empty list reduces over all dimensions
+    if (dims->empty()) {
+      std::fill(reduced.begin(), reduced.end(), true);
+    }
+    for (auto d : *dims) {
+      auto idx = normalizeDim(d, self->dims.size());
+      if (idx < 0) {
+        return false;
+      }
+      reduced[idx] = true;
+    }
+  } else {
+    return false;
+  }
+
+  bool keepdim = false;
+  if (const auto* keepdim_arg = arg(n, in, "keepdim")) {
+    auto value = staticBool(keepdim_arg);
+    if (!value) {
+      return false;
+    }
+    keepdim = *value;
+  }
+  std::vector<SymDim> dims;
+  for (size_t i = 0; i < self->dims.size(); i++) {
+    if (!reduced[i]) {
+      dims.push_back(self->dims[i]);
+    } else if (keepdim) {
+      dims.push_back(SymDim(1));
+    }
+  }
+
+  std::string kind = n->kind().toQualString();
+  auto dtype = *self->dtype;
+  if (kind == "aten::argmax" || kind == "aten::argmin") {
+    dtype = at::kLong;
+  } else if (kind == "aten::any" || kind == "aten::all") {
+    dtype = at::kBool;
+  } else if ((kind == "aten::sum" || kind == "aten::prod") && typeCategory(dtype) < 2) {
+    dtype = at::kLong;
+  }
+  const auto* dtype_arg = arg(n, in, "dtype");
+  if (dtype_arg && !isNone(dtype_arg)) {
+    auto t = staticDtype(dtype_arg);
+    if (!t) {
+      return false;
+    }
+    dtype = *t;
+  }
+  out[0] = tensorValue(dims, dtype);
+  // max.dim and min.dim also return the indices
+  if (out.size() > 1) {
+    out[1] = tensorValue(dims, at::kLong);
+  }
+  return true;
+}
+
+bool castShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  if (!isTensor(self)) {
+    return false;
+  }
+  auto dtype = self->dtype;
+  if (isKind(n, "aten::type_as") || (in.size() > 1 && isTensor(in[1]))) {
+    dtype = in[1]->dtype;
+  } else if (const auto* dtype_arg = arg(n, in, "dtype")) {
+    if (!isNone(dtype_arg)) {
+      dtype = staticDtype(dtype_arg);
+    }
+  }
+  if (!dtype) {
+    return false;
+  }
+  out[0] = tensorValue(self->dims, dtype);
+  return true;
+}
+
+bool sizeShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  const auto* self = in[0];
+  if (!isTensor(self)) {
+    return false;
+  }
+  if (isKind(n, "aten::dim")) {
+    out[0] = intValue(SymDim(self->dims.size()));
+    return true;
+  }
+  if (isKind(n, "aten::numel")) {
+    out[0] = intValue(numel(self->dims));
+    return true;
+  }
+  if (in.size() == 1) {
+    std::vector<SymValue> elems;
+    for (const auto& d : self->dims) {
+      elems.push_back(intValue(d));
+    }
+    out[0] = listValue(elems);
+    return true;
+  }
+  auto dim = staticInt(in[1]);
+  if (!dim) {
+    return false;
+  }
+  auto idx = normalizeDim(*dim, self->dims.size());
+  if (idx < 0) {
+    return false;
+  }
+  out[0] = intValue(self->dims[idx]);
+  return true;
+}
+
+// Conversions between integers and 0-d tensors, which lowering inserts around size computations
+bool scalarShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  if (isKind(n, "prim::NumToTensor")) {
+    if (in[0]->kind != Kind::kInt) {
+      return false;
+    }
+    out[0] = tensorValue({}, at::kLong);
+    out[0].scalar = in[0]->scalar;
+    return true;
+  }
+  if (!isTensor(in[0]) || !in[0]->scalar) {
+    return false;
+  }
+  out[0] = intValue(*in[0]->scalar);
+  return true;
+}
+
+bool collectionShape(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  if (isKind(n, "prim::ListConstruct") || isKind(n, "prim::TupleConstruct")) {
+    std::vector<SymValue> elems;
+    for (auto v : in) {
+      elems.push_back(*v);
+    }
+    out[0] = listValue(elems);
+    return true;
+  }
+  if (in.empty() || in[0]->kind != Kind::kList) {
+    return false;
+  }
+  const auto& elems = in[0]->elems;
+  if (isKind(n, "prim::ListUnpack") || isKind(n, "prim::TupleUnpack")) {
+    if (elems.size() != out.size()) {
+      return false;
+    }
+    std::copy(elems.begin(), elems.end(), out.begin());
+    return true;
+  }
+  if (isKind(n, "aten::len")) {
+    out[0] = intValue(SymDim(elems.size()));
+    return true;
+  }
+  // aten::__getitem__ and prim::TupleIndex
+  auto idx = in.size() > 1 ? staticInt(in[1]) : c10::nullopt;
+  if (!idx) {
+    return false;
+  }
+  auto i = normalizeDim(*idx, elems.size());
+  if (i < 0) {
+    return false;
+  }
+  out[0] = elems[i];
+  return true;
+}
+
+bool dtypeShape(const torch::jit::Node*, const SymInputs& in, SymOutputs& out) {
+  if (!isTensor(in[0]) || !in[0]->dtype) {
+    return false;
+  }
+  out[0] = intValue(SymDim(static_cast<int64_t>(*in[0]->dtype)));
+  return true;
+}
+
+const std::unordered_map<c10::Symbol, ShapeFn>& shapeFunctions() {
+  static const auto fns = []() {
+    std::unordered_map<c10::Symbol, ShapeFn> m;
+    auto reg = [&m](std::initializer_list<const char*> kinds, ShapeFn fn) {
+      for (auto kind : kinds) {
+        m[c10::Symbol::fromQualString(kind)] = fn;
+      }
+    };
+    reg({"aten::relu",
+         "aten::relu_",
+         "aten::relu6",
+         "aten::neg",
+         "aten::abs",
+         "aten::clone",
+         "aten::contiguous",
+         "aten::detach",
+         "aten::dropout",
+         "aten::dropout_",
+         "aten::feature_dropout",
+         "aten::alpha_dropout",
+         "aten::hardtanh",
+         "aten::hardtanh_",
+         "aten::leaky_relu",
+         "aten::leaky_relu_",
+         "aten::clamp",
+         "aten::clamp_min",
+         "aten::clamp_max",
+         "aten::floor",
+         "aten::ceil",
+         "aten::round",
+         "aten::sign",
+         "aten::hardswish",
+         "aten::prelu",
+         "aten::fill_",
+         "aten::zero_"},
+        unaryShape);
+    reg({"aten::sigmoid",
+         "aten::sigmoid_",
+         "aten::tanh",
+         "aten::tanh_",
+         "aten::exp",
+         "aten::log",
+         "aten::sqrt",
+         "aten::rsqrt",
+         "aten::log_sigmoid",
+         "aten::gelu",
+         "aten::silu",
+         "aten::mish",
+         "aten::elu",
+         "aten::selu",
+         "aten::celu",
+         "aten::softplus",
+         "aten::hardsigmoid",
+         "aten::erf",
+         "aten::sin",
+         "aten::cos",
+         "aten::reciprocal",
+         "aten::batch_norm",
+         "aten::layer_norm",
+         "aten::instance_norm",
+         "aten::group_norm"},
+        floatUnaryShape);
+    reg({"aten::softmax", "aten::log_softmax"}, softmaxShape);
+    reg({"aten::add",
+         "aten::add_",
+         "aten::sub",
+         "aten::sub_",
+         "aten::mul",
+         "aten::mul_",
+         "aten::div",
+         "aten::div_",
+         "aten::pow",
+         "aten::rsub",
+         "aten::maximum",
+         "aten::minimum",
+         "aten::floor_divide",
+         "aten::floordiv",
+         "aten::remainder",
+         "aten::fmod",
+         "aten::atan2",
+         "aten::bitwise_and",
+         "aten::bitwise_or",
+         "aten::bitwise_xor",
+         "aten::__and__",
+         "aten::__or__",
+         "aten::__xor__",
+         "aten::logical_and",
+         "aten::logical_or",
+         "aten::logical_xor",
+         "aten::eq",
+         "aten::ne",
+         "aten::lt",
+         "aten::gt",
+         "aten::le",
+         "aten::ge",
+         "aten::where",
+         "aten::masked_fill",
+         "aten::masked_fill_"},
+        binaryShape);
+    reg({"aten::_convolution",
+         "aten::conv1d",
+         "aten::conv2d",
+         "aten::conv3d",
+         "aten::conv_transpose1d",
+         "aten::conv_transpose2d",
+         "aten::conv_transpose3d"},
+        convolutionShape);
+    reg({"aten::max_pool1d",
+         "aten::max_pool2d",
+         "aten::max_pool3d",
+         "aten::avg_pool1d",
+         "aten::avg_pool2d",
+         "aten::avg_pool3d"},
+        poolingShape);
+    reg({"aten::adaptive_avg_pool1d",
+         "aten::adaptive_avg_pool2d",
+         "aten::adaptive_avg_pool3d",
+         "aten::adaptive_max_pool1d",
+         "aten::adaptive_max_pool2d",
+         "aten::adaptive_max_pool3d"},
+        adaptivePoolingShape);
+    reg({"aten::linear"}, linearShape);
+    reg({"aten::matmul", "aten::mm", "aten::bmm", "aten::addmm"}, matmulShape);
+    reg({"aten::flatten"}, flattenShape);
+    reg({"aten::view", "aten::reshape"}, reshapeShape);
+    reg({"aten::permute"}, permuteShape);
+    reg({"aten::transpose", "aten::t"}, transposeShape);
+    reg({"aten::unsqueeze"}, unsqueezeShape);
+    reg({"aten::squeeze"}, squeezeShape);
+    reg({"aten::cat", "aten::stack"}, catShape);
+    reg({"aten::slice"}, sliceShape);
+    reg({"aten::select"}, selectShape);
+    reg({"aten::expand", "aten::expand_as"}, expandShape);
+    reg({"aten::repeat"}, repeatShape);
+    reg({"aten::embedding"}, embeddingShape);
+    reg({"aten::constant_pad_nd", "aten::pad"}, padShape);
+    reg({"aten::zeros",
+         "aten::ones",
+         "aten::empty",
+         "aten::full",
+         "aten::rand",
+         "aten::randn",
+         "aten::zeros_like",
+         "aten::ones_like",
+         "aten::empty_like",
+         "aten::full_like",
+         "aten::rand_like",
+         "aten::randn_like"},
+        factoryShape);
+    reg({"aten::sum",
+         "aten::mean",
+         "aten::prod",
+         "aten::amax",
+         "aten::amin",
+         "aten::max",
+         "aten::min",
+         "aten::argmax",
+         "aten::argmin",
+         "aten::any",
+         "aten::all"},
+        reductionShape);
+    reg({"aten::to", "aten::type_as"}, castShape);
+    reg({"aten::size", "aten::dim", "aten::numel"}, sizeShape);
+    reg({"prim::NumToTensor", "aten::Int", "aten::IntImplicit", "aten::ScalarImplicit"}, scalarShape);
+    reg({"prim::ListConstruct",
+         "prim::TupleConstruct",
+         "prim::ListUnpack",
+         "prim::TupleUnpack",
+         "prim::TupleIndex",
+         "aten::__getitem__",
+         "aten::len"},
+        collectionShape);
+    reg({"prim::dtype"}, dtypeShape);
+    return m;
+  }();
+  return fns;
+}
+
+SymValue fromConstant(const c10::IValue& iv) {
+  if (iv.isInt()) {
+    return intValue(SymDim(iv.toInt()));
+  }
+  if (iv.isTensor()) {
+    auto t = iv.toTensor();
+    std::vector<SymDim> dims;
+    for (auto d : t.sizes()) {
+      dims.push_back(SymDim(d));
+    }
+    auto v = tensorValue(dims, t.scalar_type());
+    v.constant = iv;
+    if (t.dim() == 0 && t.device().is_cpu() && c10::isIntegralType(t.scalar_type(), /*includeBool=*/false)) {
+      v.scalar = SymDim(t.item<int64_t>());
+    }
+    return v;
+  }
+  if (iv.isList() || iv.isTuple()) {
+    std::vector<SymValue> elems;
+    if (iv.isList()) {
+      for (const auto& e : iv.toListRef()) {
+        elems.push_back(fromConstant(e));
+      }
+    } else {
+      for (const auto& e : iv.toTupleRef().elements()) {
+        elems.push_back(fromConstant(e));
+      }
+    }
+    auto v = listValue(elems);
+    v.constant = iv;
+    return v;
+  }
+  return constantValue(iv);
+}
+
+// Example IValue of the value for the input shape of the given lane
+c10::optional<c10::IValue> materialize(const c10::TypePtr& type, const SymValue& v, size_t lane) {
+  if (v.constant) {
+    return v.constant;
+  }
+  if (v.kind == Kind::kInt) {
+    return c10::IValue(v.scalar->lanes[lane]);
+  }
+  if (v.kind == Kind::kTensor) {
+    if (!v.dtype) {
+      return {};
+    }
+    std::vector<int64_t> shape;
+    for (const auto& d : v.dims) {
+      shape.push_back(d.lanes[lane]);
+    }
+    if (v.scalar && shape.empty()) {
+      return c10::IValue(at::scalar_tensor(v.scalar->lanes[lane], at::TensorOptions().dtype(*v.dtype)));
+    }
+    // Same value range as the default range of the example inputs of shape analysis
+    return c10::IValue((2 * at::rand(shape)).to(*v.dtype));
+  }
+  if (v.kind != Kind::kList) {
+    return {};
+  }
+
+  auto t = type;
+  if (auto opt = t->cast<c10::OptionalType>()) {
+    t = opt->getElementType();
+  }
+  if (auto list_type = t->cast<c10::ListType>()) {
+    c10::impl::GenericList list(list_type->getElementType());
+    for (const auto& e : v.elems) {
+      auto iv = materialize(list_type->getElementType(), e, lane);
+      if (!iv) {
+        return {};
+      }
+      list.push_back(*iv);
+    }
+    return c10::IValue(list);
+  }
+  if (auto tuple_type = t->cast<c10::TupleType>()) {
+    if (tuple_type->elements().size() != v.elems.size()) {
+      return {};
+    }
+    std::vector<c10::IValue> elems;
+    for (size_t i = 0; i < v.elems.size(); i++) {
+      auto iv = materialize(tuple_type->elements()[i], v.elems[i], lane);
+      if (!iv) {
+        return {};
+      }
+      elems.push_back(*iv);
+    }
+    return c10::IValue(c10::ivalue::Tuple::create(std::move(elems)));
+  }
+  return {};
+}
+
+// Merges the outputs of an op run once per lane. Dimensions which differ between lanes have no known expression
+SymValue fromLanes(const std::array<c10::IValue, kNumShapeLanes>& ivs) {
+  const auto& first = ivs[0];
+  if (first.isTensor()) {
+    auto t = first.toTensor();
+    std::vector<SymDim> dims(t.dim());
+    for (size_t l = 0; l < kNumShapeLanes; l++) {
+      if (!ivs[l].isTensor() || ivs[l].toTensor().dim() != t.dim() ||
+          ivs[l].toTensor().scalar_type() != t.scalar_type()) {
+        return SymValue();
+      }
+      for (size_t i = 0; i < dims.size(); i++) {
+        dims[i].lanes[l] = ivs[l].toTensor().size(i);
+      }
+    }
+    for (auto& d : dims) {
+      d.expr = d.is_static() ? "" : "?";
+    }
+    return tensorValue(dims, t.scalar_type());
+  }
+  if (first.isInt()) {
+    SymDim d;
+    for (size_t l = 0; l < kNumShapeLanes; l++) {
+      if (!ivs[l].isInt()) {
+        return SymValue();
+      }
+      d.lanes[l] = ivs[l].toInt();
+    }
+    d.expr = d.is_static() ? "" : "?";
+    return intValue(d);
+  }
+  if (first.isList() || first.isTuple()) {
+    std::array<std::vector<c10::IValue>, kNumShapeLanes> elems;
+    for (size_t l = 0; l < kNumShapeLanes; l++) {
+      if (ivs[l].isList()) {
+        elems[l] = ivs[l].toListRef().vec();
+      } else if (ivs[l].isTuple()) {
+        elems[l] = ivs[l].toTupleRef().elements().vec();
+      }
+      if (elems[l].size() != elems[0].size()) {
+        return SymValue();
+      }
+    }
+    std::vector<SymValue> values;
+    for (size_t i = 0; i < elems[0].size(); i++) {
+      values.push_back(fromLanes({elems[0][i], elems[1][i], elems[2][i]}));
+    }
+    return listValue(values);
+  }
+  for (size_t l = 1; l < kNumShapeLanes; l++) {
+    if (!c10::_fastEqualsForContainer(first, ivs[l])) {
+      return SymValue();
+    }
+  }
+  return constantValue(first);
+}
+
+// Fallback for ops without a shape function: runs the op on CPU example inputs for each lane. Ops which would do more
+// than compute their outputs when run once per lane (ex. prim::Print, in place ops, RNG ops) are not run
+bool runOnLanes(const torch::jit::Node* n, const SymInputs& in, SymOutputs& out) {
+  if (!n->blocks().empty() || !n->maybeOperator() || n->hasSideEffects() || n->isNondeterministic()) {
+    return false;
+  }
+  auto schema = n->maybeSchema();
+  if (schema && schema->is_mutable()) {
+    return false;
+  }
+  std::array<torch::jit::Stack, kNumShapeLanes> results;
+  for (size_t l = 0; l < kNumShapeLanes; l++) {
+    torch::jit::Stack stack;
+    for (size_t i = 0; i < in.size(); i++) {
+      auto iv = materialize(n->inputs()[i]->type(), *in[i], l);
+      if (!iv) {
+        return false;
+      }
+      stack.push_back(*iv);
+    }
+    try {
+      n->getOperation()(stack);
+    } catch (const std::exception& e) {
+      LOG_DEBUG("Could not run " << util::node_info(n) << " for symbolic shape inference: " << e.what());
+      return false;
+    }
+    if (stack.size() != out.size()) {
+      return false;
+    }
+    results[l] = std::move(stack);
+  }
+  for (size_t o = 0; o < out.size(); o++) {
+    out[o] = fromLanes({results[0][o], results[1][o], results[2][o]});
+  }
+  return true;
+}
+
+SymValue inputValue(
+    PartitioningCtx* ctx,
+    const ir::Input& spec,
+    const torch::jit::Value* in,
+    size_t idx,
+    size_t& num_syms) {
+  std::vector<SymDim> dims;
+  for (int i = 0; i < spec.opt.nbDims; i++) {
+    SymDim d;
+    d.lanes = {{spec.min.d[i], spec.opt.d[i], spec.max.d[i]}};
+    if (!d.is_static()) {
+      d.expr = "s" + std::to_string(num_syms++);
+    }
+    dims.push_back(d);
+  }
+
+  // Use the same type as the example inputs of shape analysis
+  c10::optional<at::ScalarType> dtype;
+  auto example = ctx->opt_input_ivalues_map.find(in);
+  if (example != ctx->opt_input_ivalues_map.end()) {
+    const auto& iv = example->second;
+    if (iv.isTensor() && idx == 0) {
+      dtype = iv.toTensor().scalar_type();
+    } else if (iv.isList() && idx < iv.toListRef().size() && iv.toListRef()[idx].isTensor()) {
+      dtype = iv.toListRef()[idx].toTensor().scalar_type();
+    } else if (iv.isTuple()) {
+      const auto& elems = iv.toTupleRef().elements();
+      if (idx < elems.size() && elems[idx].isTensor()) {
+        dtype = elems[idx].toTensor().scalar_type();
+      }
+    }
+  }
+  auto types = ctx->input_types_map.find(in);
+  if (!dtype && types != ctx->input_types_map.end() && idx < types->second.size()) {
+    dtype = types->second[idx];
+  }
+  return tensorValue(dims, dtype ? *dtype : at::kFloat);
+}
+} // namespace
+
+std::string SymDim::str() const {
+  return expr.empty() ? std::to_string(opt()) : expr;
+}
+
+std::vector<int64_t> SymValue::shape(ir::ShapeMode mode) const {
+  std::vector<int64_t> s;
+  for (const auto& d : dims) {
+    s.push_back(d.lanes[static_cast<size_t>(mode)]);
+  }
+  return s;
+}
+
+SymbolicShapeMap inferSymbolicShapes(PartitioningCtx* ctx, torch::jit::Block* block) {
+  SymbolicShapeMap shapes;
+  // Values are given a single shape when they are produced, which values modified later on (ex. by aten::append or in
+  // place ops, possibly through an alias or in a loop) would not keep
+  if (util::BlockHasMutation(block)) {
+    LOG_DEBUG("Block modifies values in place, leaving the shapes of its values to shape analysis");
+    return shapes;
+  }
+  size_t num_syms = 0;
+  for (auto in : block->inputs()) {
+    auto spec = ctx->settings.collection_input_spec_map.find(in);
+    if (spec == ctx->settings.collection_input_spec_map.end() || spec->second.empty()) {
+      continue;
+    }
+    auto kind = in->type()->kind();
+    if (kind == torch::jit::TypeKind::ListType || kind == torch::jit::TypeKind::TupleType) {
+      std::vector<SymValue> elems;
+      for (size_t i = 0; i < spec->second.size(); i++) {
+        elems.push_back(inputValue(ctx, spec->second[i], in, i, num_syms));
+      }
+      shapes[in] = listValue(elems);
+    } else {
+      shapes[in] = inputValue(ctx, spec->second[0], in, 0, num_syms);
+    }
+    LOG_DEBUG("Symbolic shape of input %" << in->debugName() << ": " << shapes[in]);
+  }
+
+  const auto& fns = shapeFunctions();
+  const SymValue unknown;
+  size_t num_inferred = 0;
+  size_t num_run = 0;
+  size_t num_unresolved = 0;
+  for (auto n : block->nodes()) {
+    SymOutputs out(n->outputs().size());
+    bool resolved = false;
+    if (n->kind() == torch::jit::prim::Constant) {
+      auto iv = torch::jit::toIValue(n->output());
+      if (iv) {
+        out[0] = fromConstant(*iv);
+        resolved = true;
+      }
+    } else if (n->blocks().empty()) {
+      SymInputs in;
+      bool all_known = true;
+      for (auto v : n->inputs()) {
+        auto it = shapes.find(v);
+        in.push_back(it == shapes.end() ? &unknown : &it->second);
+        all_known = all_known && it != shapes.end() && it->second.kind != Kind::kUnknown;
+      }
+      auto fn = fns.find(n->kind());
+      if (fn != fns.end()) {
+        resolved = fn->second(n, in, out);
+        num_inferred += resolved;
+      }
+      if (!resolved && all_known) {
+        out = SymOutputs(n->outputs().size());
+        resolved = runOnLanes(n, in, out);
+        num_run += resolved;
+      }
+    }
+    if (!resolved) {
+      out = SymOutputs(n->outputs().size());
+      num_unresolved++;
+    }
+    for (size_t i = 0; i < out.size(); i++) {
+      shapes[n->outputs()[i]] = std::move(out[i]);
+    }
+  }
+  LOG_DEBUG(
+      "Symbolic shape inference: " << num_inferred << " nodes inferred with shape functions, " << num_run
+                                   << " nodes run on example inputs, " << num_unresolved << " nodes unresolved");
+  return shapes;
+}
+
+std::ostream& operator<<(std::ostream& os, const SymDim& d) {
+  if (d.is_static()) {
+    return os << d.min();
+  }
+  return os << d.str() << "{" << d.min() << ", " << d.opt() << ", " << d.max() << "}";
+}
+
+std::ostream& operator<<(std::ostream& os, const SymValue& v) {
+  switch (v.kind) {
+    case Kind::kTensor:
+      os << "Tensor[";
+      for (size_t i = 0; i < v.dims.size(); i++) {
+        os << (i > 0 ? ", " : "") << v.dims[i];
+      }
+      os << "]";
+      if (v.dtype) {
+        os << "(" << *v.dtype << ")";
+      }
+      return os;
+    case Kind::kInt:
+      return os << "int " << *v.scalar;
+    case Kind::kList:
+      os << "(";
+      for (size_t i = 0; i < v.elems.size(); i++) {
+        os << (i > 0 ? ", " : "") << v.elems[i];
+      }
+      return os << ")";
+    case Kind::kConstant:
+      return os << *v.constant;
+    default:
+      return os << "unknown";
+  }
+}
+
+} // namespace partitioning
+} // namespace core
+} // namespace torch_tensorrt
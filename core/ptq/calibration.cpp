@@ -0,0 +1,489 @@
+#include "core/ptq/calibration.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ATen/Parallel.h"
+#include "c10/core/InferenceMode.h"
+#include "torch/csrc/jit/runtime/custom_operator.h"
+#include "torch/csrc/jit/runtime/interpreter.h"
+#include "torch/torch.h"
+
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace ptq {
+
+namespace {
+const std::string OBSERVE_OP_NAME = "tensorrt::observe_activation";
+// Probability given to empty bins of quantized distributions
+const double kSmoothing = 1e-4;
+
+// Histograms the activations observed on this thread are added to, set while a collector runs the graph
+thread_local std::vector<Histogram>* observed_histograms = nullptr;
+
+static auto TORCHTRT_UNUSED observe_activation_reg = torch::jit::RegisterOperators({torch::jit::Operator(
+    OBSERVE_OP_NAME + "(Tensor x, int index) -> ()",
+    [](torch::jit::Stack& stack) {
+      auto index = torch::jit::pop(stack).toInt();
+      auto x = torch::jit::pop(stack).toTensor();
+      // Only floating point tensors are quantized
+      if (observed_histograms && x.is_floating_point()) {
+        (*observed_histograms)[index].Add(x);
+      }
+    },
+    c10::AliasAnalysisKind::CONSERVATIVE)});
+
+const char* AlgorithmName(CalibrationAlgorithm algorithm) {
+  switch (algorithm) {
+    case CalibrationAlgorithm::kMINMAX:
+      return "MinMaxCalibration";
+    case CalibrationAlgorithm::kENTROPY:
+    default:
+      return "EntropyCalibration2";
+  }
+}
+
+bool IsTensor(const torch::jit::Value* v) {
+  return v->type()->isSubtypeOf(c10::TensorType::get());
+}
+} // namespace
+
+Histogram::Histogram(size_t num_bins) : counts_(num_bins, 0) {
+  TORCHTRT_CHECK(num_bins % 2 == 0, "Expected an even number of histogram bins, got " << num_bins);
+}
+
+void Histogram::Add(const at::Tensor& t) {
+  if (!t.numel()) {
+    return;
+  }
+  auto x = t.detach().to(at::kCPU, at::kFloat).abs().flatten();
+  auto amax = x.max().item<float>();
+  TORCHTRT_CHECK(std::isfinite(amax), "Found non finite values in an activation while collecting its range");
+  amax_ = std::max(amax_, amax);
+  if (counts_.empty()) {
+    return;
+  }
+
+  if (amax == 0 && range_ == 0) {
+    pending_zeros_ += x.numel();
+    return;
+  }
+  if (amax >= range_) {
+    // Smallest power of two larger than amax
+    int exp = 0;
+    std::frexp(amax, &exp);
+    GrowTo(std::ldexp(1.0, exp));
+  }
+
+  int64_t num_bins = counts_.size();
+  // The scale is a power of two so the bin of a value does not depend on the range it was first added with
+  auto bins = (x * static_cast<float>(num_bins / range_)).floor_().clamp_max_(num_bins - 1).to(at::kLong);
+  auto binned = at::bincount(bins, {}, num_bins);
+  auto binned_a = binned.accessor<int64_t, 1>();
+  for (int64_t i = 0; i < num_bins; i++) {
+    counts_[i] += binned_a[i];
+  }
+}
+
+void Histogram::GrowTo(double range) {
+  if (range_ == 0) {
+    range_ = range;
+    counts_[0] += pending_zeros_;
+    pending_zeros_ = 0;
+    return;
+  }
+  if (range <= range_) {
+    return;
+  }
+  // Both ranges are powers of two, each new bin covers 2^shift old ones
+  auto shift = std::ilogb(range) - std::ilogb(range_);
+  size_t factor = shift >= 62 ? counts_.size() : (size_t(1) << shift);
+  std::vector<int64_t> grown(counts_.size(), 0);
+  for (size_t i = 0; i < counts_.size(); i++) {
+    grown[std::min(i / factor, grown.size() - 1)] += counts_[i];
+  }
+  counts_ = std::move(grown);
+  range_ = range;
+}
+
+void Histogram::Merge(const Histogram& other) {
+  TORCHTRT_CHECK(
+      other.counts_.size() == counts_.size(),
+      "Cannot merge histograms with " << counts_.size() << " and " << other.counts_.size() << " bins");
+  amax_ = std::max(amax_, other.amax_);
+  if (counts_.empty()) {
+    return;
+  }
+
+  pending_zeros_ += other.pending_zeros_;
+  if (other.range_ == 0) {
+    if (range_ != 0) {
+      counts_[0] += pending_zeros_;
+      pending_zeros_ = 0;
+    }
+    return;
+  }
+
+  Histogram aligned = other;
+  aligned.pending_zeros_ = 0;
+  if (aligned.range_ < range_) {
+    aligned.GrowTo(range_);
+  } else {
+    GrowTo(aligned.range_);
+  }
+  for (size_t i = 0; i < counts_.size(); i++) {
+    counts_[i] += aligned.counts_[i];
+  }
+}
+
+float Histogram::EntropyAmax(size_t num_quantized_bins) const {
+  if (counts_.empty() || range_ == 0) {
+    return amax_;
+  }
+  // Bins past the largest value are empty, ranges ending after it are not considered
+  size_t last = counts_.size();
+  while (last > 0 && counts_[last - 1] == 0) {
+    last--;
+  }
+  if (last <= num_quantized_bins) {
+    return amax_;
+  }
+
+  std::vector<double> outliers(last + 1, 0);
+  for (size_t i = last; i-- > 0;) {
+    outliers[i] = outliers[i + 1] + counts_[i];
+  }
+
+  double best_divergence = std::numeric_limits<double>::infinity();
+  size_t best_i = last;
+  std::vector<double> reference, quantized;
+  for (size_t i = num_quantized_bins; i <= last; i++) {
+    // Reference distribution clipped to the first i bins, the clipped values are added to the last bin
+    reference.assign(counts_.begin(), counts_.begin() + i);
+    reference[i - 1] += outliers[i];
+
+    // The first i bins quantized to num_quantized_bins bins, then expanded back over the non empty bins
+    quantized.assign(i, 0);
+    for (size_t q = 0; q < num_quantized_bins; q++) {
+      size_t start = (q * i + num_quantized_bins - 1) / num_quantized_bins;
+      size_t end = ((q + 1) * i + num_quantized_bins - 1) / num_quantized_bins;
+      double sum = 0;
+      size_t nonzero = 0;
+      for (size_t j = start; j < end; j++) {
+        sum += counts_[j];
+        nonzero += counts_[j] != 0;
+      }
+      for (size_t j = start; j < end && nonzero; j++) {
+        if (counts_[j] != 0) {
+          quantized[j] = sum / nonzero;
+        }
+      }
+    }
+
+    double reference_total = outliers[0];
+    double quantized_total = outliers[0] - outliers[i];
+    double divergence = 0;
+    for (size_t j = 0; j < i; j++) {
+      if (reference[j] == 0) {
+        continue;
+      }
+      // Empty bins of the quantized distribution are smoothed, otherwise clipped values folded into an empty bin
+      // would make the divergence infinite
+      auto p = reference[j] / reference_total;
+      auto q = std::max(quantized[j] / quantized_total, kSmoothing);
+      divergence += p * std::log(p / q);
+    }
+    // Ties go to the larger range
+    if (divergence <= best_divergence) {
+      best_divergence = divergence;
+      best_i = i;
+    }
+  }
+  return std::min(amax_, static_cast<float>(best_i * (range_ / counts_.size())));
+}
+
+std::string WriteCalibrationCache(const TensorRanges& scales, CalibrationAlgorithm algorithm, int32_t trt_version) {
+  std::stringstream ss;
+  ss << "TRT-" << trt_version << '-' << AlgorithmName(algorithm) << '\n';
+  for (const auto& s : scales) {
+    // Scales are stored as the hex representation of their bits
+    uint32_t bits = 0;
+    std::memcpy(&bits, &s.second, sizeof(bits));
+    char hex[9];
+    std::snprintf(hex, sizeof(hex), "%08x", bits);
+    ss << s.first << ": " << hex << '\n';
+  }
+  return ss.str();
+}
+
+TensorRanges ReadCalibrationCache(const std::string& cache, CalibrationAlgorithm* algorithm) {
+  std::istringstream ss(cache);
+  std::string line;
+  TORCHTRT_CHECK(
+      std::getline(ss, line) && line.rfind("TRT-", 0) == 0, "Calibration cache is missing its TRT-<version> header");
+  auto algorithm_name = line.substr(line.rfind('-') + 1);
+  if (algorithm) {
+    if (algorithm_name == AlgorithmName(CalibrationAlgorithm::kMINMAX)) {
+      *algorithm = CalibrationAlgorithm::kMINMAX;
+    } else if (algorithm_name == AlgorithmName(CalibrationAlgorithm::kENTROPY)) {
+      *algorithm = CalibrationAlgorithm::kENTROPY;
+    } else {
+      TORCHTRT_THROW_ERROR("Unsupported calibration algorithm in calibration cache: " << algorithm_name);
+    }
+  }
+
+  TensorRanges scales;
+  while (std::getline(ss, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    auto delim = line.rfind(": ");
+    TORCHTRT_CHECK(delim != std::string::npos, "Malformed calibration cache entry: " << line);
+    uint32_t bits = std::stoul(line.substr(delim + 2), nullptr, 16);
+    float scale = 0;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    scales.push_back({line.substr(0, delim), scale});
+  }
+  return scales;
+}
+
+void RetargetConstantsToCPU(torch::jit::Block* b) {
+  for (auto n : b->nodes()) {
+    if (n->kind() == torch::jit::prim::Constant && n->hasAttribute(torch::jit::attr::value)) {
+      auto kind = n->kindOf(torch::jit::attr::value);
+      if (n->output()->type()->kind() == c10::TypeKind::DeviceObjType) {
+        if (c10::Device(n->s(torch::jit::attr::value)).is_cuda()) {
+          n->s_(torch::jit::attr::value, "cpu");
+        }
+      } else if (kind == torch::jit::AttributeKind::t) {
+        n->t_(torch::jit::attr::value, n->t(torch::jit::attr::value).to(at::kCPU));
+      }
+    }
+    for (auto sub_block : n->blocks()) {
+      RetargetConstantsToCPU(sub_block);
+    }
+  }
+}
+
+ActivationRangeCollector::ActivationRangeCollector(
+    std::shared_ptr<torch::jit::Graph> g,
+    std::vector<torch::jit::IValue> params,
+    CalibrationAlgorithm algorithm,
+    size_t num_bins)
+    : graph_(g->copy()), algorithm_(algorithm), num_bins_(algorithm == CalibrationAlgorithm::kMINMAX ? 0 : num_bins) {
+  TORCHTRT_CHECK(
+      params.size() <= g->inputs().size(), "Graph has fewer inputs than the " << params.size() << " parameters given");
+  for (auto& p : params) {
+    params_.push_back(p.isTensor() ? torch::jit::IValue(p.toTensor().to(at::kCPU)) : p);
+  }
+  RetargetConstantsToCPU(graph_->block());
+
+  // Names are taken from the original graph, copying it renumbers the values without a debug name. The copy has the
+  // same structure so top level values are matched by position
+  std::unordered_map<const torch::jit::Value*, torch::jit::Value*> copied;
+  for (size_t i = 0; i < g->inputs().size(); i++) {
+    copied[g->inputs()[i]] = graph_->inputs()[i];
+  }
+  auto copied_nodes = graph_->nodes().begin();
+  for (auto n : g->nodes()) {
+    for (size_t i = 0; i < n->outputs().size(); i++) {
+      copied[n->outputs()[i]] = copied_nodes->outputs()[i];
+    }
+    ++copied_nodes;
+  }
+
+  // Network inputs and outputs are named by their position in conversion, everything else after its value
+  std::unordered_map<const torch::jit::Value*, std::string> names;
+  size_t num_inputs = g->inputs().size() - params_.size();
+  std::unordered_set<const torch::jit::Value*> static_values(g->inputs().begin() + num_inputs, g->inputs().end());
+  for (size_t i = 0, input_idx = 0; i < num_inputs; i++) {
+    if (IsTensor(g->inputs()[i])) {
+      names[g->inputs()[i]] = "input_" + std::to_string(input_idx++);
+    }
+  }
+  size_t output_idx = 0;
+  for (auto out : g->outputs()) {
+    auto kind = out->node()->kind();
+    auto elements = kind == torch::jit::prim::TupleConstruct || kind == torch::jit::prim::ListConstruct
+        ? out->node()->inputs()
+        : at::ArrayRef<torch::jit::Value*>(out);
+    for (auto e : elements) {
+      if (IsTensor(e)) {
+        names.insert({e, "output_" + std::to_string(output_idx++)});
+      }
+    }
+  }
+
+  auto observe = [&](const torch::jit::Value* v) {
+    auto name = names.find(v) != names.end() ? names[v] : v->debugName();
+    auto index = graph_->insertConstant(static_cast<int64_t>(names_.size()));
+    graph_->insertNode(graph_->create(c10::Symbol::fromQualString(OBSERVE_OP_NAME), {copied[v], index}, 0));
+    names_.push_back(name);
+  };
+
+  {
+    torch::jit::WithInsertPoint guard(graph_->block()->param_node()->next());
+    for (size_t i = 0; i < num_inputs; i++) {
+      if (IsTensor(g->inputs()[i])) {
+        observe(g->inputs()[i]);
+      }
+    }
+  }
+
+  copied_nodes = graph_->nodes().begin();
+  std::vector<std::pair<const torch::jit::Node*, torch::jit::Node*>> nodes;
+  for (auto n : g->nodes()) {
+    nodes.push_back({n, *copied_nodes});
+    ++copied_nodes;
+  }
+  for (auto& n : nodes) {
+    auto orig = n.first;
+    // Values computed only from constants and parameters are folded into weights during conversion
+    bool is_static = orig->kind() == torch::jit::prim::Constant ||
+        (orig->blocks().empty() && !orig->inputs().empty() &&
+         std::all_of(orig->inputs().begin(), orig->inputs().end(), [&](const torch::jit::Value* in) {
+           return static_values.count(in) != 0;
+         }));
+    if (is_static) {
+      static_values.insert(orig->outputs().begin(), orig->outputs().end());
+      continue;
+    }
+    torch::jit::WithInsertPoint guard(n.second->next());
+    for (auto out : orig->outputs()) {
+      if (IsTensor(out)) {
+        observe(out);
+      }
+    }
+  }
+
+  histograms_.assign(names_.size(), Histogram(num_bins_));
+  LOG_DEBUG("Graph instrumented to collect activation ranges: " << *graph_);
+}
+
+void ActivationRangeCollector::Collect(
+    const std::vector<std::vector<torch::jit::IValue>>& batches,
+    size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = at::get_num_threads();
+  }
+  num_threads = std::max<size_t>(1, std::min(num_threads, batches.size()));
+  size_t num_inputs = graph_->inputs().size() - params_.size();
+
+  // The code is shared, each thread runs it with its own interpreter state and histograms
+  torch::jit::Code code(graph_, "activation_range_collector");
+  std::atomic<size_t> next_batch{0};
+  std::vector<std::vector<Histogram>> thread_histograms(num_threads);
+  std::vector<std::exception_ptr> errors(num_threads);
+  auto worker = [&](size_t thread_idx) {
+    try {
+      c10::InferenceMode guard;
+      auto& histograms = thread_histograms[thread_idx];
+      histograms.assign(names_.size(), Histogram(num_bins_));
+      observed_histograms = &histograms;
+      for (size_t b = next_batch++; b < batches.size(); b = next_batch++) {
+        TORCHTRT_CHECK(
+            batches[b].size() == num_inputs,
+            "Calibration batch " << b << " has " << batches[b].size() << " inputs, expected " << num_inputs);
+        torch::jit::Stack stack;
+        stack.reserve(num_inputs + params_.size());
+        for (const auto& in : batches[b]) {
+          stack.push_back(in.isTensor() ? torch::jit::IValue(in.toTensor().to(at::kCPU)) : in);
+        }
+        stack.insert(stack.end(), params_.begin(), params_.end());
+        torch::jit::InterpreterState(code).run(stack);
+      }
+    } catch (...) {
+      errors[thread_idx] = std::current_exception();
+    }
+    observed_histograms = nullptr;
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(worker, t);
+  }
+  worker(0);
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (auto& e : errors) {
+    if (e) {
+      std::rethrow_exception(e);
+    }
+  }
+
+  for (auto& histograms : thread_histograms) {
+    for (size_t i = 0; i < histograms.size(); i++) {
+      histograms_[i].Merge(histograms[i]);
+    }
+  }
+  LOG_INFO(
+      "Collected the activation ranges of " << names_.size() << " tensors over " << batches.size() << " batches on "
+                                            << num_threads << " threads");
+}
+
+std::vector<std::string> ActivationRangeCollector::TensorNames() const {
+  return names_;
+}
+
+const Histogram& ActivationRangeCollector::GetHistogram(const std::string& name) const {
+  auto it = std::find(names_.begin(), names_.end(), name);
+  TORCHTRT_CHECK(it != names_.end(), "No activations were observed for tensor " << name);
+  return histograms_[it - names_.begin()];
+}
+
+TensorRanges ActivationRangeCollector::Ranges() const {
+  std::vector<float> amaxes(histograms_.size(), 0);
+  // Searching for the entropy range of a histogram is quadratic in its bins, tensors are done in parallel
+  at::parallel_for(0, histograms_.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      amaxes[i] =
+          algorithm_ == CalibrationAlgorithm::kENTROPY ? histograms_[i].EntropyAmax() : histograms_[i].Amax();
+    }
+  });
+
+  TensorRanges ranges;
+  for (size_t i = 0; i < names_.size(); i++) {
+    // Tensors which were never observed or are all zeros have no usable range
+    if (amaxes[i] > 0) {
+      ranges.push_back({names_[i], amaxes[i]});
+    }
+  }
+  return ranges;
+}
+
+std::string ActivationRangeCollector::CalibrationCache() const {
+  auto scales = Ranges();
+  for (auto& s : scales) {
+    s.second /= 127.f;
+  }
+  return WriteCalibrationCache(scales, algorithm_);
+}
+
+std::string CollectCalibrationCache(
+    const torch::jit::Module& mod,
+    std::string method_name,
+    const lowering::LowerInfo& lower_info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches,
+    CalibrationAlgorithm algorithm,
+    size_t num_threads) {
+  auto graph_and_parameters = lowering::Lower(mod, method_name, lower_info);
+  ActivationRangeCollector collector(graph_and_parameters.first, graph_and_parameters.second, algorithm);
+  collector.Collect(batches, num_threads);
+  return collector.CalibrationCache();
+}
+
+} // namespace ptq
+} // namespace core
+} // namespace torch_tensorrt
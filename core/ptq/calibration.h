@@ -0,0 +1,127 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "NvInfer.h"
+#include "core/lowering/lowering.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch/csrc/jit/ir/ir.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace ptq {
+
+enum class CalibrationAlgorithm {
+  // KL divergence based selection of the range, what nvinfer1::IInt8EntropyCalibrator2 reads
+  kENTROPY,
+  // Largest absolute value seen, what nvinfer1::IInt8MinMaxCalibrator reads
+  kMINMAX,
+};
+
+// Pairs of TensorRT tensor names and values (dynamic ranges or scales), in the order the tensors were first seen
+using TensorRanges = std::vector<std::pair<std::string, float>>;
+
+// Histogram of the absolute values of a tensor over [0, range). The range is always a power of two so that it can be
+// grown by merging neighbouring bins, which makes histograms of different batches exact to merge
+class Histogram {
+ public:
+  // With 0 bins only the largest absolute value is tracked, which is all the min-max algorithm needs
+  explicit Histogram(size_t num_bins = 2048);
+
+  void Add(const at::Tensor& t);
+  void Merge(const Histogram& other);
+
+  // Largest absolute value added
+  float Amax() const {
+    return amax_;
+  }
+  // Range the histogram covers, 0 if no non zero value was added yet
+  double Range() const {
+    return range_;
+  }
+  size_t NumBins() const {
+    return counts_.size();
+  }
+  const std::vector<int64_t>& Counts() const {
+    return counts_;
+  }
+
+  // Range which minimizes the KL divergence between the histogram and its quantization into num_quantized_bins bins,
+  // the same selection as TensorRT's entropy calibrator
+  float EntropyAmax(size_t num_quantized_bins = 128) const;
+
+ private:
+  void GrowTo(double range);
+
+  std::vector<int64_t> counts_;
+  double range_ = 0;
+  float amax_ = 0;
+  // Zeros seen before the range was known
+  int64_t pending_zeros_ = 0;
+};
+
+// Serializes scales in the text format of TensorRT calibration caches, readable by readCalibrationCache of a
+// calibrator implementing algorithm
+std::string WriteCalibrationCache(
+    const TensorRanges& scales,
+    CalibrationAlgorithm algorithm,
+    int32_t trt_version = getInferLibVersion());
+// Parses a calibration cache written by TensorRT or WriteCalibrationCache into its scales
+TensorRanges ReadCalibrationCache(const std::string& cache, CalibrationAlgorithm* algorithm = nullptr);
+
+// Collects the ranges of the activations of a lowered graph (as returned by lowering::Lower) by running it on CPU.
+// Ranges are recorded for the graph inputs and every tensor computed by a top level node under the name the tensor is
+// given during conversion, so the resulting calibration cache can be used to build an INT8 engine from the same graph
+// without a calibration pass on the GPU
+class ActivationRangeCollector {
+ public:
+  ActivationRangeCollector(
+      std::shared_ptr<torch::jit::Graph> g,
+      std::vector<torch::jit::IValue> params,
+      CalibrationAlgorithm algorithm = CalibrationAlgorithm::kENTROPY,
+      size_t num_bins = 2048);
+
+  // Runs the graph on each batch (the inputs of one call, without the parameters) and adds the activations to the
+  // histograms. Batches are split between num_threads threads, 0 to use at::get_num_threads()
+  void Collect(const std::vector<std::vector<torch::jit::IValue>>& batches, size_t num_threads = 0);
+
+  // Names of the observed tensors in the order of the graph
+  std::vector<std::string> TensorNames() const;
+  const Histogram& GetHistogram(const std::string& name) const;
+  // Dynamic range (amax) of each tensor with a non zero range
+  TensorRanges Ranges() const;
+  // Calibration cache holding the scales (amax / 127) of Ranges()
+  std::string CalibrationCache() const;
+
+  // The instrumented graph which is run, exposed for debugging
+  std::shared_ptr<torch::jit::Graph> graph() const {
+    return graph_;
+  }
+
+ private:
+  std::shared_ptr<torch::jit::Graph> graph_;
+  std::vector<torch::jit::IValue> params_;
+  CalibrationAlgorithm algorithm_;
+  size_t num_bins_;
+  std::vector<std::string> names_;
+  std::vector<Histogram> histograms_;
+};
+
+// Moves the devices and tensors created by a graph lowered for a CUDA device to the CPU, so it can be analyzed there
+void RetargetConstantsToCPU(torch::jit::Block* b);
+
+// Lowers method_name of mod the way it is lowered for compilation, runs it on the calibration batches and returns the
+// calibration cache
+std::string CollectCalibrationCache(
+    const torch::jit::Module& mod,
+    std::string method_name,
+    const lowering::LowerInfo& lower_info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches,
+    CalibrationAlgorithm algorithm,
+    size_t num_threads = 0);
+
+} // namespace ptq
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,227 @@
+#include "core/ptq/mixed_precision.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ATen/Parallel.h"
+#include "c10/core/InferenceMode.h"
+#include "torch/csrc/jit/ir/constants.h"
+#include "torch/csrc/jit/runtime/interpreter.h"
+#include "torch/torch.h"
+
+#include "core/ptq/calibration.h"
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace ptq {
+
+namespace {
+bool IsTensor(const torch::jit::Value* v) {
+  return v->type()->isSubtypeOf(c10::TensorType::get());
+}
+
+// Inputs of n without repetitions, which are the inputs of the graph n is isolated in
+std::vector<torch::jit::Value*> UniqueInputs(const torch::jit::Node* n) {
+  std::vector<torch::jit::Value*> inputs;
+  for (auto in : n->inputs()) {
+    if (std::find(inputs.begin(), inputs.end(), in) == inputs.end()) {
+      inputs.push_back(const_cast<torch::jit::Value*>(in));
+    }
+  }
+  return inputs;
+}
+
+std::shared_ptr<torch::jit::Graph> IsolateNode(torch::jit::Node* n) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  std::unordered_map<torch::jit::Value*, torch::jit::Value*> env;
+  for (auto in : UniqueInputs(n)) {
+    env[in] = g->addInput()->setType(in->type());
+  }
+  auto clone = g->appendNode(g->createClone(n, [&](torch::jit::Value* v) { return env.at(v); }));
+  for (auto out : clone->outputs()) {
+    g->registerOutput(out);
+  }
+  return g;
+}
+
+// Rounds floating point tensors to precision, keeping their type so the computation itself stays in FP32
+torch::jit::IValue RoundToPrecision(const torch::jit::IValue& v, at::ScalarType precision) {
+  if (v.isTensor()) {
+    auto t = v.toTensor();
+    return t.is_floating_point() ? t.to(precision).to(t.scalar_type()) : t;
+  }
+  if (v.isTensorList()) {
+    c10::List<at::Tensor> rounded;
+    for (const at::Tensor& t : v.toTensorList()) {
+      rounded.push_back(RoundToPrecision(t, precision).toTensor());
+    }
+    return rounded;
+  }
+  return v;
+}
+
+double RelativeError(const at::Tensor& reference, const at::Tensor& reduced) {
+  if (!reference.numel()) {
+    return 0;
+  }
+  auto ref = reference.to(at::kDouble);
+  auto out = reduced.to(at::kDouble);
+  if (!at::isfinite(out).all().item<bool>() && at::isfinite(ref).all().item<bool>()) {
+    // The node overflows the reduced precision
+    return std::numeric_limits<double>::infinity();
+  }
+  auto scale = ref.abs().max().item<double>();
+  auto diff = (out - ref).abs().max().item<double>();
+  return scale > 0 ? diff / scale : diff;
+}
+} // namespace
+
+MixedPrecisionPlanner::MixedPrecisionPlanner(
+    std::shared_ptr<torch::jit::Graph> g,
+    std::vector<torch::jit::IValue> params,
+    at::ScalarType reduced_precision,
+    double tolerance)
+    : graph_(g->copy()), reduced_precision_(reduced_precision), tolerance_(tolerance) {
+  TORCHTRT_CHECK(
+      reduced_precision == at::kHalf || reduced_precision == at::kBFloat16,
+      "Mixed precision can only be planned for FP16 or BF16, got " << reduced_precision);
+  TORCHTRT_CHECK(
+      params.size() <= g->inputs().size(), "Graph has fewer inputs than the " << params.size() << " parameters given");
+  for (auto& p : params) {
+    params_.push_back(p.isTensor() ? torch::jit::IValue(p.toTensor().to(at::kCPU)) : p);
+  }
+  RetargetConstantsToCPU(graph_->block());
+
+  // Names are taken from the original graph, copying it renumbers the values without a debug name
+  size_t num_inputs = graph_->inputs().size() - params_.size();
+  std::unordered_set<const torch::jit::Value*> static_values(
+      graph_->inputs().begin() + num_inputs, graph_->inputs().end());
+  auto orig = g->nodes().begin();
+  for (auto n : graph_->nodes()) {
+    auto orig_n = *orig;
+    ++orig;
+    // Values computed only from constants and parameters are folded into weights during conversion
+    bool is_static = n->kind() == torch::jit::prim::Constant ||
+        (n->blocks().empty() && !n->inputs().empty() &&
+         std::all_of(n->inputs().begin(), n->inputs().end(), [&](const torch::jit::Value* in) {
+           return static_values.count(in) != 0;
+         }));
+    if (is_static) {
+      static_values.insert(n->outputs().begin(), n->outputs().end());
+      continue;
+    }
+    if (!n->blocks().empty() || std::none_of(n->outputs().begin(), n->outputs().end(), IsTensor)) {
+      continue;
+    }
+    sensitivities_.push_back({orig_n->outputs()[0]->debugName(), n->kind().toQualString(), 0});
+    nodes_.push_back(n);
+    node_graphs_.push_back(IsolateNode(n));
+  }
+
+  // Everything computed at the top level is returned, so the inputs of each node are known after running the graph
+  for (auto n : graph_->nodes()) {
+    if (n->kind() != torch::jit::prim::Constant) {
+      for (auto out : n->outputs()) {
+        graph_->registerOutput(out);
+      }
+    }
+  }
+}
+
+void MixedPrecisionPlanner::Analyze(const std::vector<std::vector<torch::jit::IValue>>& batches) {
+  c10::InferenceMode guard;
+  size_t num_inputs = graph_->inputs().size() - params_.size();
+  torch::jit::Code code(graph_, "mixed_precision_planner");
+  std::vector<std::unique_ptr<torch::jit::Code>> node_codes;
+  for (auto& node_graph : node_graphs_) {
+    node_codes.push_back(std::make_unique<torch::jit::Code>(node_graph, "mixed_precision_planner_node"));
+  }
+
+  for (size_t b = 0; b < batches.size(); b++) {
+    TORCHTRT_CHECK(
+        batches[b].size() == num_inputs,
+        "Batch " << b << " has " << batches[b].size() << " inputs, expected " << num_inputs);
+    torch::jit::Stack stack;
+    for (const auto& in : batches[b]) {
+      stack.push_back(in.isTensor() ? torch::jit::IValue(in.toTensor().to(at::kCPU)) : in);
+    }
+    stack.insert(stack.end(), params_.begin(), params_.end());
+
+    std::unordered_map<const torch::jit::Value*, torch::jit::IValue> values;
+    for (size_t i = 0; i < stack.size(); i++) {
+      values[graph_->inputs()[i]] = stack[i];
+    }
+    torch::jit::InterpreterState(code).run(stack);
+    for (size_t i = 0; i < graph_->outputs().size(); i++) {
+      values[graph_->outputs()[i]] = stack[i];
+    }
+
+    // Each node is only read from values and updates its own entry, so nodes are measured in parallel
+    at::parallel_for(0, nodes_.size(), 1, [&](int64_t begin, int64_t end) {
+      c10::InferenceMode node_guard;
+      for (int64_t i = begin; i < end; i++) {
+        auto n = nodes_[i];
+        torch::jit::Stack node_stack;
+        for (auto in : UniqueInputs(n)) {
+          auto value = values.find(in);
+          // Constants are the only inputs which are not computed by the graph
+          auto input = value != values.end() ? c10::optional<torch::jit::IValue>(value->second)
+                                             : torch::jit::toIValue(in);
+          TORCHTRT_CHECK(input, "Unable to find the value of input %" << in->debugName() << " of " << *n);
+          node_stack.push_back(RoundToPrecision(*input, reduced_precision_));
+        }
+        torch::jit::InterpreterState(*node_codes[i]).run(node_stack);
+
+        for (size_t o = 0; o < n->outputs().size(); o++) {
+          const auto& reference = values.at(n->outputs()[o]);
+          if (!reference.isTensor() || !reference.toTensor().is_floating_point()) {
+            continue;
+          }
+          auto reduced = RoundToPrecision(node_stack[o], reduced_precision_).toTensor();
+          sensitivities_[i].error =
+              std::max(sensitivities_[i].error, RelativeError(reference.toTensor(), reduced));
+        }
+      }
+    });
+  }
+
+  size_t num_sensitive = 0;
+  for (const auto& s : sensitivities_) {
+    LOG_DEBUG("Error of %" << s.name << " (" << s.kind << ") in " << reduced_precision_ << ": " << s.error);
+    num_sensitive += s.error > tolerance_;
+  }
+  LOG_INFO(
+      num_sensitive << " of " << sensitivities_.size() << " nodes exceed the tolerance of " << tolerance_ << " in "
+                    << reduced_precision_ << " over " << batches.size() << " batches and are kept in FP32");
+}
+
+LayerPrecisions MixedPrecisionPlanner::Constraints() const {
+  LayerPrecisions constraints;
+  for (const auto& s : sensitivities_) {
+    if (s.error > tolerance_) {
+      constraints[s.name] = nvinfer1::DataType::kFLOAT;
+    }
+  }
+  return constraints;
+}
+
+LayerPrecisions PlanMixedPrecision(
+    const torch::jit::Module& mod,
+    std::string method_name,
+    const lowering::LowerInfo& lower_info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches,
+    at::ScalarType reduced_precision,
+    double tolerance) {
+  auto graph_and_parameters = lowering::Lower(mod, method_name, lower_info);
+  MixedPrecisionPlanner planner(
+      graph_and_parameters.first, graph_and_parameters.second, reduced_precision, tolerance);
+  planner.Analyze(batches);
+  return planner.Constraints();
+}
+
+} // namespace ptq
+} // namespace core
+} // namespace torch_tensorrt
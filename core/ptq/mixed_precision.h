@@ -0,0 +1,75 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "NvInfer.h"
+#include "core/lowering/lowering.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch/csrc/jit/ir/ir.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace ptq {
+
+// Precisions layers are constrained to, keyed by the name of the first output of the node they are converted from
+using LayerPrecisions = std::map<std::string, nvinfer1::DataType>;
+
+struct NodeSensitivity {
+  // Name of the first output of the node
+  std::string name;
+  std::string kind;
+  // Largest error of the outputs of the node in reduced precision, relative to the largest magnitude of the FP32
+  // outputs. Infinite if the node overflows the reduced precision
+  double error = 0;
+};
+
+// Decides which nodes of a lowered graph (as returned by lowering::Lower) can run in reduced precision. Each node is
+// run on CPU on the FP32 values of its inputs, once in FP32 and once with its inputs, weights and outputs rounded to
+// the reduced precision, so the error of a node is measured in isolation from the error of the nodes before it. Nodes
+// whose error exceeds the tolerance are constrained to FP32
+class MixedPrecisionPlanner {
+ public:
+  MixedPrecisionPlanner(
+      std::shared_ptr<torch::jit::Graph> g,
+      std::vector<torch::jit::IValue> params,
+      at::ScalarType reduced_precision = at::kHalf,
+      double tolerance = 1e-2);
+
+  // Runs the graph on each batch (the inputs of one call, without the parameters) and updates the error of every
+  // node. Nodes are measured in parallel
+  void Analyze(const std::vector<std::vector<torch::jit::IValue>>& batches);
+
+  // Nodes which compute tensors in the order of the graph, nodes that only depend on parameters are folded into
+  // weights during conversion and are not included
+  const std::vector<NodeSensitivity>& Sensitivities() const {
+    return sensitivities_;
+  }
+  // FP32 constraints for the nodes whose error exceeds the tolerance, every other node can run in any precision
+  LayerPrecisions Constraints() const;
+
+ private:
+  std::shared_ptr<torch::jit::Graph> graph_;
+  std::vector<torch::jit::IValue> params_;
+  at::ScalarType reduced_precision_;
+  double tolerance_;
+  // Node of graph_ measured for each entry of sensitivities_, with the graph it is run in alone
+  std::vector<torch::jit::Node*> nodes_;
+  std::vector<std::shared_ptr<torch::jit::Graph>> node_graphs_;
+  std::vector<NodeSensitivity> sensitivities_;
+};
+
+// Lowers method_name of mod the way it is lowered for compilation, runs it on the batches and returns the FP32
+// constraints of the nodes too sensitive to run in reduced_precision
+LayerPrecisions PlanMixedPrecision(
+    const torch::jit::Module& mod,
+    std::string method_name,
+    const lowering::LowerInfo& lower_info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches,
+    at::ScalarType reduced_precision = at::kHalf,
+    double tolerance = 1e-2);
+
+} // namespace ptq
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,173 @@
+#include "core/ptq/sparsity.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "c10/core/InferenceMode.h"
+#include "torch/csrc/jit/runtime/interpreter.h"
+#include "torch/torch.h"
+
+#include "core/lowering/passes/passes.h"
+#include "core/ptq/calibration.h"
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace ptq {
+
+namespace {
+void CollectTensors(const torch::jit::IValue& v, std::vector<at::Tensor>& tensors) {
+  if (v.isTensor()) {
+    tensors.push_back(v.toTensor());
+  } else if (v.isTuple()) {
+    for (const auto& e : v.toTupleRef().elements()) {
+      CollectTensors(e, tensors);
+    }
+  } else if (v.isList()) {
+    for (const auto& e : v.toListRef()) {
+      CollectTensors(e, tensors);
+    }
+  }
+}
+
+double RelativeError(const at::Tensor& reference, const at::Tensor& out) {
+  if (!reference.is_floating_point() || !reference.numel()) {
+    return 0;
+  }
+  auto ref = reference.to(at::kDouble);
+  auto scale = ref.abs().max().item<double>();
+  auto diff = (out.to(at::kDouble) - ref).abs().max().item<double>();
+  return scale > 0 ? diff / scale : diff;
+}
+} // namespace
+
+std::ostream& operator<<(std::ostream& os, const SparsityReport& report) {
+  os << "2:4 sparsity of " << report.layers.size() << " layers:";
+  for (const auto& l : report.layers) {
+    os << std::endl << "    %" << l.name << " (" << l.kind << ") " << c10::IntArrayRef(l.weight_shape) << ": ";
+    if (l.IsSparse()) {
+      os << "sparse";
+    } else {
+      os << l.dense_groups << " of " << l.num_groups << " groups dense";
+    }
+    os << ", " << l.flop_share * 100 << "% of FLOPs";
+  }
+  os << std::endl << "    Sparse share of FLOPs: " << report.sparse_flop_share * 100 << "%";
+  os << std::endl << "    Relative error when pruned: " << report.pruned_error;
+  return os;
+}
+
+SparsityReport AnalyzeSparsity(
+    std::shared_ptr<torch::jit::Graph> g,
+    std::vector<torch::jit::IValue> params,
+    const std::vector<std::vector<torch::jit::IValue>>& batches) {
+  TORCHTRT_CHECK(!batches.empty(), "At least one batch is needed to analyze sparsity");
+  TORCHTRT_CHECK(
+      params.size() <= g->inputs().size(), "Graph has fewer inputs than the " << params.size() << " parameters given");
+  for (auto& p : params) {
+    if (p.isTensor()) {
+      p = p.toTensor().to(at::kCPU);
+    }
+  }
+  auto dense = g->copy();
+  RetargetConstantsToCPU(dense->block());
+
+  // Names are taken from the original graph, copying it renumbers the values without a debug name
+  std::unordered_map<const torch::jit::Node*, std::string> names;
+  auto orig = g->nodes().begin();
+  for (auto n : dense->nodes()) {
+    if (n->outputs().size()) {
+      names[n] = (*orig)->outputs()[0]->debugName();
+    }
+    ++orig;
+  }
+
+  auto pruned = dense->copy();
+  auto pruned_params = params;
+  lowering::passes::PruneWeightsTo2by4(pruned, pruned_params);
+
+  SparsityReport report;
+  auto uses = lowering::passes::FindSparseWeightUses(dense, params);
+  for (auto& use : uses) {
+    auto sizes = use.tensor.sizes();
+    auto channels = sizes[use.reduction_dim];
+    LayerSparsity layer;
+    layer.name = names.at(use.node);
+    layer.kind = use.node->kind().toQualString();
+    layer.weight_shape = sizes.vec();
+    layer.dense_groups = lowering::passes::Count2by4DenseGroups(use.tensor, use.reduction_dim);
+    layer.num_groups = use.tensor.numel() / channels * ((channels + 3) / 4);
+    report.layers.push_back(layer);
+  }
+
+  // The outputs of the layers are returned as well to count their FLOPs
+  size_t num_outputs = dense->outputs().size();
+  for (auto& use : uses) {
+    dense->registerOutput(use.node->output());
+  }
+
+  c10::InferenceMode guard;
+  size_t num_inputs = g->inputs().size() - params.size();
+  torch::jit::Code dense_code(dense, "sparsity_analysis_dense");
+  torch::jit::Code pruned_code(pruned, "sparsity_analysis_pruned");
+  for (size_t b = 0; b < batches.size(); b++) {
+    TORCHTRT_CHECK(
+        batches[b].size() == num_inputs,
+        "Batch " << b << " has " << batches[b].size() << " inputs, expected " << num_inputs);
+    torch::jit::Stack inputs;
+    for (const auto& in : batches[b]) {
+      inputs.push_back(in.isTensor() ? torch::jit::IValue(in.toTensor().to(at::kCPU)) : in);
+    }
+    auto dense_stack = inputs;
+    dense_stack.insert(dense_stack.end(), params.begin(), params.end());
+    torch::jit::InterpreterState(dense_code).run(dense_stack);
+    auto pruned_stack = inputs;
+    pruned_stack.insert(pruned_stack.end(), pruned_params.begin(), pruned_params.end());
+    torch::jit::InterpreterState(pruned_code).run(pruned_stack);
+
+    if (b == 0) {
+      for (size_t i = 0; i < uses.size(); i++) {
+        // Each output element is a dot product over the weights of one output channel
+        auto& w = uses[i].tensor;
+        auto out = dense_stack[num_outputs + i].toTensor();
+        report.layers[i].flops = 2 * out.numel() * (w.numel() / w.size(uses[i].output_dim));
+      }
+    }
+
+    for (size_t o = 0; o < num_outputs; o++) {
+      std::vector<at::Tensor> reference, out;
+      CollectTensors(dense_stack[o], reference);
+      CollectTensors(pruned_stack[o], out);
+      for (size_t t = 0; t < std::min(reference.size(), out.size()); t++) {
+        report.pruned_error = std::max(report.pruned_error, RelativeError(reference[t], out[t]));
+      }
+    }
+  }
+
+  int64_t total_flops = 0;
+  for (const auto& l : report.layers) {
+    total_flops += l.flops;
+  }
+  for (auto& l : report.layers) {
+    l.flop_share = total_flops ? static_cast<double>(l.flops) / total_flops : 0;
+    if (l.IsSparse()) {
+      report.sparse_flop_share += l.flop_share;
+    }
+  }
+  LOG_INFO(report);
+  return report;
+}
+
+SparsityReport AnalyzeSparsity(
+    const torch::jit::Module& mod,
+    std::string method_name,
+    lowering::LowerInfo lower_info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches) {
+  lower_info.prune_sparse_weights = false;
+  auto graph_and_parameters = lowering::Lower(mod, method_name, lower_info);
+  return AnalyzeSparsity(graph_and_parameters.first, graph_and_parameters.second, batches);
+}
+
+} // namespace ptq
+} // namespace core
+} // namespace torch_tensorrt
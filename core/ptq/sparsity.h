@@ -0,0 +1,62 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/lowering/lowering.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch/csrc/jit/ir/ir.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace ptq {
+
+struct LayerSparsity {
+  // Name of the output of the layer
+  std::string name;
+  std::string kind;
+  std::vector<int64_t> weight_shape;
+  // Groups of 4 weights along the dimension the layer reduces over with more than 2 non zeros, out of num_groups
+  int64_t dense_groups = 0;
+  int64_t num_groups = 0;
+  // FLOPs of the layer for the first batch and their share of the FLOPs of all analyzed layers
+  int64_t flops = 0;
+  double flop_share = 0;
+
+  // Whether TensorRT can run the layer with sparse kernels as is
+  bool IsSparse() const {
+    return dense_groups == 0;
+  }
+};
+
+struct SparsityReport {
+  // Convolution and fully connected layers with constant weights, in the order of the graph
+  std::vector<LayerSparsity> layers;
+  // Share of the FLOPs of the layers which already are 2:4 sparse
+  double sparse_flop_share = 0;
+  // Largest error of the outputs of the graph once every layer is pruned to 2:4 sparsity, relative to the largest
+  // magnitude of the dense outputs, over all batches
+  double pruned_error = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const SparsityReport& report);
+
+// Reports which layers of a lowered graph (as returned by lowering::Lower) meet the 2:4 structured sparsity pattern
+// TensorRT needs for sparse_weights and the error lowering::passes::PruneWeightsTo2by4 would introduce. The graph is
+// run on CPU on each batch (the inputs of one call, without the parameters), dense and pruned
+SparsityReport AnalyzeSparsity(
+    std::shared_ptr<torch::jit::Graph> g,
+    std::vector<torch::jit::IValue> params,
+    const std::vector<std::vector<torch::jit::IValue>>& batches);
+
+// Lowers method_name of mod the way it is lowered for compilation, without pruning, and analyzes it
+SparsityReport AnalyzeSparsity(
+    const torch::jit::Module& mod,
+    std::string method_name,
+    lowering::LowerInfo lower_info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches);
+
+} // namespace ptq
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,137 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ATen/ATen.h"
+#include "NvInfer.h"
+
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+
+// What execute_engine needs to know about a binding of an engine on every call, computed once when the engine is
+// deserialized so that calls do not look it up by name
+struct BindingInfo {
+  // Index of the binding among the IO tensors of the engine
+  int64_t trt_idx = -1;
+  // Points into the binding names of the engine, which do not change once it is deserialized
+  const char* name = nullptr;
+  at::ScalarType dtype = at::kFloat;
+  int64_t rank = 0;
+};
+
+struct BindingTable {
+  // In the order the engine call takes its inputs and returns its outputs
+  std::vector<BindingInfo> inputs;
+  std::vector<BindingInfo> outputs;
+};
+
+namespace detail {
+template <typename Engine>
+BindingInfo MakeBindingInfo(const Engine& engine, const std::string& name) {
+  BindingInfo info;
+  for (int64_t i = 0; i < engine.getNbIOTensors(); i++) {
+    if (name == engine.getIOTensorName(i)) {
+      info.trt_idx = i;
+      break;
+    }
+  }
+  TORCHTRT_CHECK(info.trt_idx >= 0, "Could not find a TensorRT engine binding named " << name);
+  info.name = name.c_str();
+  info.dtype = util::TRTDataTypeToScalarType(engine.getTensorDataType(name.c_str()));
+  info.rank = engine.getTensorShape(name.c_str()).nbDims;
+  return info;
+}
+
+// Shape of a tensor as TensorRT takes it. Shapes of the rank of the binding are copied as they are, others go through
+// util::toDimsPad as before, which gives 0-dim tensors a single dimension
+inline nvinfer1::Dims InputDims(c10::IntArrayRef sizes, int64_t rank) {
+  if (sizes.empty() || static_cast<int64_t>(sizes.size()) != rank || sizes.size() > nvinfer1::Dims::MAX_DIMS) {
+    return util::toDimsPad(sizes, 1);
+  }
+  nvinfer1::Dims dims;
+  dims.nbDims = static_cast<int32_t>(sizes.size());
+  std::copy(sizes.begin(), sizes.end(), dims.d);
+  return dims;
+}
+} // namespace detail
+
+// Engine is an nvinfer1::ICudaEngine or a stand in for it. The table keeps pointers to the names, which have to outlive
+// it
+template <typename Engine>
+BindingTable MakeBindingTable(
+    const Engine& engine,
+    const std::vector<std::string>& in_binding_names,
+    const std::vector<std::string>& out_binding_names) {
+  BindingTable table;
+  for (const auto& name : in_binding_names) {
+    table.inputs.push_back(detail::MakeBindingInfo(engine, name));
+  }
+  for (const auto& name : out_binding_names) {
+    table.outputs.push_back(detail::MakeBindingInfo(engine, name));
+  }
+  return table;
+}
+
+// Sets the shape and address of each input of an engine call on ctx, an nvinfer1::IExecutionContext or a stand in for
+// it. input_at(i) returns input i, inputs which are not on device are moved there and inputs which are not contiguous
+// are made contiguous by passing the copy to stage(i, t), which input_at has to return from then on. Everything else is
+// bound as it is, checking an input only compares integers
+template <typename Context, typename InputAt, typename Stage>
+void BindInputs(
+    Context& ctx,
+    const BindingTable& table,
+    const at::Device& device,
+    size_t num_inputs,
+    const InputAt& input_at,
+    const Stage& stage) {
+  TORCHTRT_CHECK(
+      num_inputs == table.inputs.size(),
+      "Expected " << table.inputs.size() << " inputs for the engine, found " << num_inputs);
+  for (size_t i = 0; i < num_inputs; i++) {
+    const auto& binding = table.inputs[i];
+    if (input_at(i).device() != device) {
+      LOG_WARNING(
+          "Input " << i << " of the engine was found to be on " << input_at(i).device() << " but should be on "
+                   << device << ". This tensor is being moved by the runtime but "
+                   << "for performance considerations, ensure your inputs are all on GPU "
+                   << "and open an issue here (https://github.com/pytorch/TensorRT/issues) if this "
+                   << "warning persists.");
+      stage(i, input_at(i).to(device));
+    }
+    TORCHTRT_CHECK(
+        input_at(i).scalar_type() == binding.dtype,
+        "Expected input tensors to have type " << binding.dtype << ", found type " << input_at(i).scalar_type());
+    if (!input_at(i).is_contiguous()) {
+      stage(i, input_at(i).contiguous());
+    }
+    const at::Tensor& in = input_at(i);
+    ctx.setInputShape(binding.name, detail::InputDims(in.sizes(), binding.rank));
+    // Padding the shape with ones does not move the data so the address of the input can be used directly
+    ctx.setTensorAddress(binding.name, in.data_ptr());
+  }
+}
+
+// Allocates each output of an engine call on device in the shape ctx infers for it, binds it and hands it to
+// set_output(i, t)
+template <typename Context, typename SetOutput>
+void BindOutputs(Context& ctx, const BindingTable& table, const at::Device& device, const SetOutput& set_output) {
+  int64_t sizes[nvinfer1::Dims::MAX_DIMS];
+  for (size_t i = 0; i < table.outputs.size(); i++) {
+    const auto& binding = table.outputs[i];
+    auto dims = ctx.getTensorShape(binding.name);
+    TORCHTRT_CHECK(dims.nbDims >= 0, "Could not infer the shape of output " << binding.name << " of the engine");
+    std::copy(dims.d, dims.d + dims.nbDims, sizes);
+    auto options = at::TensorOptions().device(device).dtype(binding.dtype);
+    auto output = at::empty(c10::IntArrayRef(sizes, dims.nbDims), options);
+    ctx.setTensorAddress(binding.name, output.data_ptr());
+    set_output(i, std::move(output));
+  }
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
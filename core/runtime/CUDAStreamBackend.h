@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ATen/cuda/CUDAEvent.h"
+#include "c10/cuda/CUDAStream.h"
+
+#include "core/runtime/StreamPipeline.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+
+// Backend of AsyncResult, RunAsync, StreamPipeline and EnqueueOrder which enqueues work on CUDA streams, implemented in
+// execute_engine.cpp
+struct CUDAStreamBackend {
+  using Stream = c10::cuda::CUDAStream;
+  using Event = at::cuda::CUDAEvent;
+
+  static Stream current_stream();
+  static void record(Event& event, const Stream& stream);
+  static void wait(Event& event, const Stream& stream);
+  static bool query(const Event& event);
+  static void synchronize(const Event& event);
+  static AsyncValues run_on(const Stream& stream, const AsyncWork& work);
+  // Records stream on the CUDA caching allocator for every CUDA tensor in value, including ones in lists, tuples and
+  // dicts
+  static void record_use(const c10::IValue& value, const Stream& stream);
+};
+
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,136 @@
+#include <chrono>
+
+#include "core/runtime/EngineLoader.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+
+RuntimeRegistry<nvinfer1::IRuntime>& get_runtime_registry() {
+  // Never destroyed, engines held by static modules may still reference their runtime at exit
+  static auto* registry = new RuntimeRegistry<nvinfer1::IRuntime>(
+      [](int64_t) { return make_trt(nvinfer1::createInferRuntime(util::logging::get_logger())); });
+  return *registry;
+}
+
+LoadTask::LoadTask(std::function<void()> fn) : fn_(std::move(fn)), result_(promise_.get_future().share()) {}
+
+bool LoadTask::run() {
+  if (claimed_.exchange(true)) {
+    return false;
+  }
+  try {
+    fn_();
+    // Drops whatever the task captured, like the serialized engine, as soon as it is no longer needed
+    fn_ = nullptr;
+    promise_.set_value();
+  } catch (...) {
+    fn_ = nullptr;
+    promise_.set_exception(std::current_exception());
+  }
+  return true;
+}
+
+void LoadTask::wait() {
+  run();
+  result_.get();
+}
+
+void LoadTask::cancel() {
+  if (!claimed_.exchange(true)) {
+    fn_ = nullptr;
+    promise_.set_value();
+    return;
+  }
+  result_.wait();
+}
+
+bool LoadTask::done() const {
+  return result_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+EngineLoadPool::EngineLoadPool(size_t num_threads) {
+  TORCHTRT_CHECK(num_threads > 0, "Engine load pool needs at least one thread");
+  for (size_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back([this]() { work(); });
+  }
+}
+
+EngineLoadPool::~EngineLoadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& t : threads_) {
+    t.join();
+  }
+}
+
+std::shared_ptr<LoadTask> EngineLoadPool::submit(std::function<void()> fn) {
+  auto task = std::make_shared<LoadTask>(std::move(fn));
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    queue_.push_back(task);
+  }
+  cv_.notify_one();
+  return task;
+}
+
+void EngineLoadPool::work() {
+  while (true) {
+    std::shared_ptr<LoadTask> task;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      task = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    // Tasks already run by a thread waiting for them are skipped
+    task->run();
+  }
+}
+
+namespace {
+std::mutex engine_load_mu;
+size_t engine_load_threads = 0;
+
+std::shared_ptr<EngineLoadPool>& engine_load_pool() {
+  static auto* pool = new std::shared_ptr<EngineLoadPool>();
+  return *pool;
+}
+} // namespace
+
+void set_engine_load_threads(size_t num_threads) {
+  std::shared_ptr<EngineLoadPool> old_pool;
+  {
+    std::unique_lock<std::mutex> lock(engine_load_mu);
+    if (num_threads == engine_load_threads) {
+      return;
+    }
+    engine_load_threads = num_threads;
+    old_pool = std::move(engine_load_pool());
+    if (num_threads > 0) {
+      engine_load_pool() = std::make_shared<EngineLoadPool>(num_threads);
+    }
+  }
+  // The old pool finishes the deserializations already scheduled on it once the last user releases it
+  old_pool.reset();
+}
+
+size_t get_engine_load_threads() {
+  std::unique_lock<std::mutex> lock(engine_load_mu);
+  return engine_load_threads;
+}
+
+std::shared_ptr<EngineLoadPool> get_engine_load_pool() {
+  std::unique_lock<std::mutex> lock(engine_load_mu);
+  return engine_load_pool();
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
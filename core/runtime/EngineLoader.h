@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "NvInfer.h"
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+
+// Runtimes engines are deserialized with, shared by all of the engines of a device. A runtime is leased to one
+// deserialization at a time, so a device only gets more than one runtime while engines are deserialized concurrently.
+// Engines keep a reference to the runtime they were deserialized with since it has to outlive them
+template <typename Runtime>
+class RuntimeRegistry {
+ public:
+  using Factory = std::function<std::shared_ptr<Runtime>(int64_t device_id)>;
+
+  class Lease {
+   public:
+    Lease(RuntimeRegistry* registry, int64_t device_id, std::shared_ptr<Runtime> runtime)
+        : registry_(registry), device_id_(device_id), runtime_(std::move(runtime)) {}
+    Lease(Lease&& other) noexcept
+        : registry_(other.registry_), device_id_(other.device_id_), runtime_(std::move(other.runtime_)) {
+      other.registry_ = nullptr;
+    }
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    Lease& operator=(Lease&&) = delete;
+    ~Lease() {
+      if (registry_) {
+        registry_->release(device_id_, std::move(runtime_));
+      }
+    }
+
+    const std::shared_ptr<Runtime>& get() const {
+      return runtime_;
+    }
+
+   private:
+    RuntimeRegistry* registry_;
+    int64_t device_id_;
+    std::shared_ptr<Runtime> runtime_;
+  };
+
+  explicit RuntimeRegistry(Factory factory) : factory_(std::move(factory)) {}
+
+  // Leases an idle runtime of the device, creating one if all of them are in use
+  Lease acquire(int64_t device_id) {
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      auto& idle = idle_[device_id];
+      if (!idle.empty()) {
+        auto runtime = std::move(idle.back());
+        idle.pop_back();
+        return Lease(this, device_id, std::move(runtime));
+      }
+    }
+    auto runtime = factory_(device_id);
+    TORCHTRT_CHECK(runtime, "Unable to create a TensorRT runtime for device " << device_id);
+    std::unique_lock<std::mutex> lock(mu_);
+    num_runtimes_[device_id]++;
+    return Lease(this, device_id, std::move(runtime));
+  }
+
+  // Number of runtimes created for the device
+  size_t num_runtimes(int64_t device_id) {
+    std::unique_lock<std::mutex> lock(mu_);
+    return num_runtimes_[device_id];
+  }
+
+ private:
+  void release(int64_t device_id, std::shared_ptr<Runtime> runtime) {
+    std::unique_lock<std::mutex> lock(mu_);
+    idle_[device_id].push_back(std::move(runtime));
+  }
+
+  Factory factory_;
+  std::mutex mu_;
+  std::unordered_map<int64_t, std::vector<std::shared_ptr<Runtime>>> idle_;
+  std::unordered_map<int64_t, size_t> num_runtimes_;
+};
+
+// Process wide registry of the TensorRT runtimes engines are deserialized with
+RuntimeRegistry<nvinfer1::IRuntime>& get_runtime_registry();
+
+// A deserialization scheduled on an EngineLoadPool. Whichever thread gets to the task first runs it, so a thread
+// which needs the result does not wait for the tasks queued before it
+class LoadTask {
+ public:
+  explicit LoadTask(std::function<void()> fn);
+
+  // Runs the task on the calling thread if no other thread started it yet, otherwise waits for it to finish. Rethrows
+  // the exception the task failed with
+  void wait();
+  // Skips the task if no thread started it yet, otherwise waits for it to finish
+  void cancel();
+  bool done() const;
+
+ private:
+  friend class EngineLoadPool;
+  // Runs the task unless another thread claimed it first, returns if it ran
+  bool run();
+
+  std::function<void()> fn_;
+  std::atomic<bool> claimed_{false};
+  std::promise<void> promise_;
+  std::shared_future<void> result_;
+};
+
+// Bounded pool of threads engines are deserialized on while a module is loaded
+class EngineLoadPool {
+ public:
+  explicit EngineLoadPool(size_t num_threads);
+  // Finishes the tasks still queued before the threads are joined
+  ~EngineLoadPool();
+  EngineLoadPool(const EngineLoadPool&) = delete;
+  EngineLoadPool& operator=(const EngineLoadPool&) = delete;
+
+  std::shared_ptr<LoadTask> submit(std::function<void()> fn);
+
+  size_t num_threads() const {
+    return threads_.size();
+  }
+
+ private:
+  void work();
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::shared_ptr<LoadTask>> queue_;
+  bool stopping_ = false;
+  std::vector<std::thread> threads_;
+};
+
+// Sets how many threads engines are deserialized on while modules are loaded. With 0 (the default) each engine is
+// deserialized as it is unpickled, otherwise loading a module only schedules the deserialization of its engines and
+// running an engine waits for its own deserialization
+void set_engine_load_threads(size_t num_threads);
+size_t get_engine_load_threads();
+// Pool engines are deserialized on while modules are loaded, nullptr if they are deserialized as they are unpickled
+std::shared_ptr<EngineLoadPool> get_engine_load_pool();
+
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
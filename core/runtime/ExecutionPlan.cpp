@@ -0,0 +1,347 @@
+#include <unordered_map>
+#include <unordered_set>
+
+#include "core/runtime/runtime.h"
+#include "torch/csrc/jit/ir/constants.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+
+namespace {
+// Engine calls are fused with the list construction of their inputs (for packed calls) and the list unpacking of their
+// outputs when nothing else uses the lists
+bool isFusableEngineCall(
+    const torch::jit::Node* n,
+    c10::Symbol engine_call_kind,
+    c10::Symbol unpacked_engine_call_kind) {
+  if (n->outputs().size() != 1 || n->inputs().size() < 1) {
+    return false;
+  }
+  if (n->kind() == engine_call_kind) {
+    if (n->inputs().size() != 2) {
+      return false;
+    }
+    auto in_list = n->input(0);
+    if (in_list->node()->kind() != torch::jit::prim::ListConstruct || in_list->uses().size() != 1 ||
+        in_list->node()->owningBlock() != n->owningBlock()) {
+      return false;
+    }
+  } else if (n->kind() != unpacked_engine_call_kind) {
+    return false;
+  }
+  auto out_list = n->output();
+  return out_list->uses().size() == 1 && out_list->uses()[0].user->kind() == torch::jit::prim::ListUnpack &&
+      out_list->uses()[0].user->owningBlock() == n->owningBlock();
+}
+
+// Walks up from a node in a nested block to the node of the top level block containing it
+const torch::jit::Node* topLevelNode(const torch::jit::Node* n, const torch::jit::Block* b) {
+  while (n->owningBlock() != b) {
+    n = n->owningBlock()->owningNode();
+  }
+  return n;
+}
+
+std::vector<at::Tensor> runTRTEngine(const c10::IValue& engine, std::vector<at::Tensor> inputs) {
+  std::vector<at::Tensor> outputs;
+  execute_engine(inputs, *engine.toCustomClass<TRTEngine>(), outputs);
+  return outputs;
+}
+} // namespace
+
+ExecutionPlan::ExecutionPlan(
+    std::shared_ptr<torch::jit::Graph> g,
+    EngineRunner engine_runner,
+    c10::Symbol engine_call_kind,
+    c10::Symbol unpacked_engine_call_kind)
+    : engine_runner(engine_runner ? std::move(engine_runner) : EngineRunner(runTRTEngine)) {
+  std::unordered_map<const torch::jit::Value*, size_t> slots;
+  auto slot_of = [&](const torch::jit::Value* v) {
+    auto it = slots.find(v);
+    if (it == slots.end()) {
+      it = slots.insert({v, num_slots++}).first;
+    }
+    return it->second;
+  };
+
+  for (auto in : g->inputs()) {
+    slot_of(in);
+  }
+  num_inputs = g->inputs().size();
+
+  std::unordered_set<const torch::jit::Node*> fused;
+  std::unordered_set<const torch::jit::Node*> engine_calls;
+  for (auto n : g->nodes()) {
+    if (isFusableEngineCall(n, engine_call_kind, unpacked_engine_call_kind)) {
+      engine_calls.insert(n);
+      if (n->kind() == engine_call_kind) {
+        fused.insert(n->input(0)->node());
+      }
+      fused.insert(n->output()->uses()[0].user);
+    }
+  }
+
+  // Consecutive nodes which are neither engine calls nor pre-resolved become one Torch segment
+  std::vector<torch::jit::Node*> torch_nodes;
+  auto add_torch_segment = [&]() {
+    if (torch_nodes.empty()) {
+      return;
+    }
+    std::unordered_set<const torch::jit::Node*> segment_nodes(torch_nodes.begin(), torch_nodes.end());
+    auto segment_g = std::make_shared<torch::jit::Graph>();
+    std::unordered_map<torch::jit::Value*, torch::jit::Value*> env;
+    Instruction instr;
+    instr.kind = InstructionKind::kTorch;
+
+    auto map_value = [&](torch::jit::Value* v) -> torch::jit::Value* {
+      auto it = env.find(v);
+      if (it != env.end()) {
+        return it->second;
+      }
+      torch::jit::Value* new_v = nullptr;
+      if (v->node()->kind() == torch::jit::prim::Constant) {
+        // Constants are cloned into the segment instead of being passed in
+        auto c = segment_g->createClone(v->node(), [](torch::jit::Value* v) { return v; });
+        segment_g->block()->prependNode(c);
+        new_v = c->output();
+      } else {
+        new_v = segment_g->addInput()->copyMetadata(v);
+        instr.inputs.push_back(slots.at(v));
+      }
+      env[v] = new_v;
+      return new_v;
+    };
+
+    for (auto n : torch_nodes) {
+      auto new_n = segment_g->insertNode(segment_g->createClone(n, map_value));
+      for (size_t i = 0; i < n->outputs().size(); i++) {
+        env[n->outputs()[i]] = new_n->outputs()[i];
+      }
+    }
+
+    // Values used after the segment are its outputs
+    for (auto n : torch_nodes) {
+      for (auto out : n->outputs()) {
+        bool escapes = false;
+        for (const auto& use : out->uses()) {
+          escapes |= !segment_nodes.count(topLevelNode(use.user, g->block()));
+        }
+        if (escapes) {
+          segment_g->registerOutput(env.at(out));
+          instr.outputs.push_back(slot_of(out));
+        }
+      }
+    }
+
+    auto segment_name = "torch_segment_" + std::to_string(num_torch_segments());
+    instr.fn = std::make_shared<torch::jit::GraphFunction>(segment_name, segment_g, nullptr);
+    instrs.push_back(std::move(instr));
+    torch_nodes.clear();
+  };
+
+  for (auto n : g->nodes()) {
+    if (fused.count(n)) {
+      continue;
+    }
+
+    if (n->kind() == torch::jit::prim::Constant && n->outputs().size() == 1) {
+      auto ival = torch::jit::toIValue(n->output());
+      if (ival) {
+        constants.push_back({slot_of(n->output()), ival.value()});
+        continue;
+      }
+    }
+
+    // Attributes of the module (ex. engines) are loaded by slot index instead of by name
+    if (n->kind() == torch::jit::prim::GetAttr && n->input()->node() == g->param_node()) {
+      auto cls = n->input()->type()->cast<c10::ClassType>();
+      if (cls && cls->hasAttribute(n->s(torch::jit::attr::name))) {
+        attr_loads.push_back(
+            {slot_of(n->input()), cls->getAttributeSlot(n->s(torch::jit::attr::name)), slot_of(n->output())});
+        continue;
+      }
+    }
+
+    if (engine_calls.count(n)) {
+      add_torch_segment();
+      Instruction instr;
+      instr.kind = InstructionKind::kEngine;
+      if (n->kind() == engine_call_kind) {
+        for (auto in : n->input(0)->node()->inputs()) {
+          instr.inputs.push_back(slot_of(in));
+        }
+      } else {
+        for (size_t i = 0; i + 1 < n->inputs().size(); i++) {
+          instr.inputs.push_back(slot_of(n->input(i)));
+        }
+      }
+      instr.engine = slot_of(n->inputs().back());
+      for (auto out : n->output()->uses()[0].user->outputs()) {
+        instr.outputs.push_back(slot_of(out));
+      }
+      instrs.push_back(std::move(instr));
+      continue;
+    }
+
+    torch_nodes.push_back(n);
+  }
+  add_torch_segment();
+
+  for (auto out : g->outputs()) {
+    output_slots.push_back(slot_of(out));
+  }
+
+  // Release every intermediate value after its last use so that memory is freed as early as under the interpreter
+  std::unordered_map<size_t, size_t> last_use;
+  for (size_t i = 0; i < instrs.size(); i++) {
+    for (auto s : instrs[i].inputs) {
+      last_use[s] = i;
+    }
+    if (instrs[i].kind == InstructionKind::kEngine) {
+      last_use[instrs[i].engine] = i;
+    }
+  }
+  std::unordered_set<size_t> keep(output_slots.begin(), output_slots.end());
+  for (const auto& use : last_use) {
+    if (!keep.count(use.first)) {
+      instrs[use.second].frees.push_back(use.first);
+    }
+  }
+
+  // Constants which are only used inside of Torch segments do not need to be loaded into registers
+  std::unordered_set<size_t> used(keep.begin(), keep.end());
+  for (const auto& use : last_use) {
+    used.insert(use.first);
+  }
+  for (const auto& a : attr_loads) {
+    used.insert(a.obj);
+  }
+  std::vector<std::pair<size_t, c10::IValue>> used_constants;
+  for (auto& c : constants) {
+    if (used.count(c.first)) {
+      used_constants.push_back(std::move(c));
+    }
+  }
+  constants = std::move(used_constants);
+
+  LOG_DEBUG(*this);
+}
+
+std::vector<c10::IValue> ExecutionPlan::run(std::vector<c10::IValue> inputs) const {
+  TORCHTRT_CHECK(
+      inputs.size() == num_inputs,
+      "Execution plan expects " << num_inputs << " inputs but got " << inputs.size() << " inputs");
+
+  std::vector<c10::IValue> regs(num_slots);
+  for (size_t i = 0; i < num_inputs; i++) {
+    regs[i] = std::move(inputs[i]);
+  }
+  for (const auto& c : constants) {
+    regs[c.first] = c.second;
+  }
+  for (const auto& a : attr_loads) {
+    regs[a.dst] = regs[a.obj].toObjectRef().getSlot(a.attr_slot);
+  }
+
+  torch::jit::Stack stack;
+  for (const auto& instr : instrs) {
+    if (instr.kind == InstructionKind::kEngine) {
+      std::vector<at::Tensor> engine_inputs;
+      engine_inputs.reserve(instr.inputs.size());
+      for (auto s : instr.inputs) {
+        engine_inputs.push_back(regs[s].toTensor());
+      }
+      auto engine_outputs = engine_runner(regs[instr.engine], std::move(engine_inputs));
+      TORCHTRT_CHECK(
+          engine_outputs.size() == instr.outputs.size(),
+          "Engine returned " << engine_outputs.size() << " outputs but " << instr.outputs.size() << " were expected");
+      for (size_t i = 0; i < instr.outputs.size(); i++) {
+        regs[instr.outputs[i]] = std::move(engine_outputs[i]);
+      }
+    } else {
+      stack.clear();
+      stack.reserve(instr.inputs.size());
+      for (auto s : instr.inputs) {
+        stack.push_back(regs[s]);
+      }
+      instr.fn->run(stack);
+      for (size_t i = 0; i < instr.outputs.size(); i++) {
+        regs[instr.outputs[i]] = std::move(stack[i]);
+      }
+    }
+    for (auto s : instr.frees) {
+      regs[s] = c10::IValue();
+    }
+  }
+
+  std::vector<c10::IValue> outputs;
+  outputs.reserve(output_slots.size());
+  for (auto s : output_slots) {
+    outputs.push_back(regs[s]);
+  }
+  return outputs;
+}
+
+size_t ExecutionPlan::num_engine_calls() const {
+  size_t n = 0;
+  for (const auto& instr : instrs) {
+    n += instr.kind == InstructionKind::kEngine;
+  }
+  return n;
+}
+
+size_t ExecutionPlan::num_torch_segments() const {
+  return instrs.size() - num_engine_calls();
+}
+
+std::ostream& operator<<(std::ostream& os, const ExecutionPlan& plan) {
+  auto print_slots = [&](const std::vector<size_t>& slots) {
+    os << "(";
+    for (size_t i = 0; i < slots.size(); i++) {
+      os << (i > 0 ? ", " : "") << "%" << slots[i];
+    }
+    os << ")";
+  };
+
+  os << "Execution Plan (" << plan.num_inputs << " inputs, " << plan.num_slots << " registers):";
+  for (const auto& instr : plan.instrs) {
+    os << "\n    ";
+    print_slots(instr.outputs);
+    if (instr.kind == ExecutionPlan::InstructionKind::kEngine) {
+      os << " = engine[%" << instr.engine << "]";
+    } else {
+      os << " = " << instr.fn->name();
+    }
+    print_slots(instr.inputs);
+  }
+  os << "\n    return ";
+  print_slots(plan.output_slots);
+  return os;
+}
+
+ExecutionPlanHolder::ExecutionPlanHolder(std::string method_name) : method_name(std::move(method_name)) {}
+
+c10::IValue ExecutionPlanHolder::run(c10::IValue self, c10::List<c10::IValue> inputs) {
+  std::call_once(built, [&]() {
+    auto& fn = self.toObjectRef().type()->getMethod(method_name);
+    plan = std::make_unique<ExecutionPlan>(torch::jit::toGraphFunction(fn).graph());
+  });
+
+  std::vector<c10::IValue> plan_inputs;
+  plan_inputs.reserve(inputs.size() + 1);
+  plan_inputs.push_back(std::move(self));
+  for (const auto& in : inputs) {
+    plan_inputs.push_back(in);
+  }
+
+  auto outputs = plan->run(std::move(plan_inputs));
+  if (outputs.size() == 1) {
+    return outputs[0];
+  }
+  return c10::ivalue::Tuple::create(std::move(outputs));
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
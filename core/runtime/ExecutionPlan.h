@@ -0,0 +1,99 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ATen/core/ivalue.h"
+#include "torch/csrc/jit/api/function_impl.h"
+#include "torch/csrc/jit/ir/ir.h"
+#include "torch/custom_class.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+
+// Name of the module method holding the stitched graph an execution plan is built from
+const std::string EXECUTION_PLAN_METHOD_NAME = "_forward_stitched";
+// Name of the module attribute holding the execution plan of a compiled module
+const std::string EXECUTION_PLAN_ATTR_NAME = "_execution_plan";
+
+// Runs an engine call of the plan, gets the engine value (usually a TRTEngine) and the input tensors
+using EngineRunner = std::function<std::vector<at::Tensor>(const c10::IValue& engine, std::vector<at::Tensor> inputs)>;
+
+// Flat, pre-resolved list of instructions equivalent to a stitched hybrid graph.
+//
+// Engine calls (prim::ListConstruct -> tensorrt::execute_engine -> prim::ListUnpack, or
+// tensorrt::execute_engine_unpacked -> prim::ListUnpack) become direct calls into the engine without boxing the
+// inputs and outputs into lists, the Torch code between engine calls becomes pre-bound
+// graph functions. Values live in a register file indexed by slots resolved when the plan is built, and are released
+// after their last use.
+class ExecutionPlan {
+ public:
+  enum class InstructionKind {
+    kEngine,
+    kTorch,
+  };
+
+  struct Instruction {
+    InstructionKind kind;
+    std::vector<size_t> inputs;
+    std::vector<size_t> outputs;
+    // Slots released after the instruction runs
+    std::vector<size_t> frees;
+    // kEngine: slot holding the engine
+    size_t engine = 0;
+    // kTorch: the Torch segment
+    std::shared_ptr<torch::jit::GraphFunction> fn;
+  };
+
+  // Builds the plan from a graph, engine calls are nodes of kind engine_call_kind taking (Tensor[] inputs, engine) or
+  // of kind unpacked_engine_call_kind taking (Tensor... inputs, engine)
+  ExecutionPlan(
+      std::shared_ptr<torch::jit::Graph> g,
+      EngineRunner engine_runner = {},
+      c10::Symbol engine_call_kind = c10::Symbol::fromQualString("tensorrt::execute_engine"),
+      c10::Symbol unpacked_engine_call_kind = c10::Symbol::fromQualString("tensorrt::execute_engine_unpacked"));
+
+  // Runs the plan, inputs are the inputs of the graph (including self for module methods)
+  std::vector<c10::IValue> run(std::vector<c10::IValue> inputs) const;
+
+  const std::vector<Instruction>& instructions() const {
+    return instrs;
+  }
+  size_t num_engine_calls() const;
+  size_t num_torch_segments() const;
+
+  friend std::ostream& operator<<(std::ostream& os, const ExecutionPlan& plan);
+
+ private:
+  struct AttrLoad {
+    size_t obj;
+    size_t attr_slot;
+    size_t dst;
+  };
+
+  size_t num_slots = 0;
+  size_t num_inputs = 0;
+  std::vector<std::pair<size_t, c10::IValue>> constants;
+  std::vector<AttrLoad> attr_loads;
+  std::vector<Instruction> instrs;
+  std::vector<size_t> output_slots;
+  EngineRunner engine_runner;
+};
+
+// Execution plan of a compiled module, serialized as the name of the method holding the stitched graph. The plan is
+// built the first time the module runs
+struct ExecutionPlanHolder : torch::CustomClassHolder {
+  std::string method_name;
+  std::once_flag built;
+  std::unique_ptr<ExecutionPlan> plan;
+
+  ExecutionPlanHolder(std::string method_name);
+  c10::IValue run(c10::IValue self, c10::List<c10::IValue> inputs);
+};
+
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,203 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "ATen/core/ivalue.h"
+#include "c10/util/Optional.h"
+
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+
+// Values passed between the stages of a StreamPipeline
+using AsyncValues = std::vector<c10::IValue>;
+// Enqueues work on the stream current while it runs and returns its results without waiting for the work
+using AsyncWork = std::function<AsyncValues()>;
+
+// AsyncResult, RunAsync, StreamPipeline and EnqueueOrder only order work through a Backend, CUDAStreamBackend in the
+// runtime and a fake in the tests. A Backend provides:
+//   Stream, a handle to an in order queue of device work, and Event, a marker recorded on a Stream
+//   Stream current_stream()
+//   void record(Event& event, const Stream& stream): event completes once the work enqueued on stream so far did
+//   void wait(Event& event, const Stream& stream): work enqueued on stream from now on starts after event completes,
+//     without blocking the host
+//   bool query(const Event& event): whether event completed, without blocking the host
+//   void synchronize(const Event& event): blocks the host until event completes
+//   AsyncValues run_on(const Stream& stream, const AsyncWork& work): runs work with stream as the current stream
+//   void record_use(const c10::IValue& value, const Stream& stream): marks the tensors in value as used by work on
+//     stream, so that their memory is not reused before that work completes
+
+// Values produced by work enqueued on a stream and the event which completes with that work
+template <typename Backend>
+class AsyncResult {
+ public:
+  AsyncResult(AsyncValues values, std::shared_ptr<typename Backend::Event> done)
+      : values_(std::move(values)), done_(std::move(done)) {}
+
+  // Whether the work producing the values completed
+  bool ready() const {
+    return Backend::query(*done_);
+  }
+
+  // Blocks the host until the work producing the values completed
+  void wait() const {
+    Backend::synchronize(*done_);
+  }
+
+  // Makes work enqueued on stream from now on wait for the values, the host is not blocked
+  void wait_on(const typename Backend::Stream& stream) const {
+    Backend::wait(*done_, stream);
+    for (const auto& v : values_) {
+      Backend::record_use(v, stream);
+    }
+  }
+
+  // Blocks the host until the values are ready and returns them
+  const AsyncValues& get() const {
+    wait();
+    return values_;
+  }
+
+  // The values without waiting for them, they may only be read by work ordered after the event (see wait_on)
+  const AsyncValues& values() const {
+    return values_;
+  }
+
+  const std::shared_ptr<typename Backend::Event>& event() const {
+    return done_;
+  }
+
+ private:
+  AsyncValues values_;
+  std::shared_ptr<typename Backend::Event> done_;
+};
+
+// Enqueues work on stream after the work enqueued on the current stream so far, which is what produced inputs, and
+// returns as soon as it is enqueued
+template <typename Backend>
+AsyncResult<Backend> RunAsync(
+    const typename Backend::Stream& stream,
+    const AsyncValues& inputs,
+    const AsyncWork& work) {
+  typename Backend::Event inputs_ready;
+  Backend::record(inputs_ready, Backend::current_stream());
+  Backend::wait(inputs_ready, stream);
+  for (const auto& v : inputs) {
+    Backend::record_use(v, stream);
+  }
+  auto outputs = Backend::run_on(stream, work);
+  auto done = std::make_shared<typename Backend::Event>();
+  Backend::record(*done, stream);
+  return AsyncResult<Backend>(std::move(outputs), std::move(done));
+}
+
+// Orders the work enqueued through a resource which may only run on one stream at a time, ex. the execution context
+// of an engine, whose enqueues all share its activation memory. Work enqueued on another stream than the previous
+// work waits on the device for an event recorded after it, the host is not blocked. Callers serialize the enqueues
+template <typename Backend>
+class EnqueueOrder {
+ public:
+  using Stream = typename Backend::Stream;
+
+  // Called right before work is enqueued on stream
+  void before_enqueue(const Stream& stream) {
+    if (last_stream_.has_value() && !(*last_stream_ == stream)) {
+      Backend::wait(last_done_, stream);
+    }
+  }
+
+  // Called right after work was enqueued on stream
+  void after_enqueue(const Stream& stream) {
+    Backend::record(last_done_, stream);
+    last_stream_ = stream;
+  }
+
+ private:
+  c10::optional<Stream> last_stream_;
+  typename Backend::Event last_done_;
+};
+
+// Runs requests through a sequence of stages, each on its own stream. Stage s of a request waits on an event recorded
+// after stage s - 1 of the same request, while the order of the stream of a stage keeps requests in submission order.
+// So stage s of request i can run on the device while stage s + 1 of request i - 1 does, ex. the copy of the next
+// inputs to the device overlaps the engine running on the current ones.
+//
+// Stages are called on the host by submit, they enqueue their work on the current stream and return without waiting
+// for it. At most max_in_flight requests are left on the device, submit blocks on the oldest one beyond that so that
+// the memory of requests does not pile up
+template <typename Backend>
+class StreamPipeline {
+ public:
+  using Stream = typename Backend::Stream;
+  using Stage = std::function<AsyncValues(AsyncValues)>;
+
+  StreamPipeline(std::vector<Stage> stages, std::vector<Stream> streams, size_t max_in_flight)
+      : stages_(std::move(stages)), streams_(std::move(streams)), max_in_flight_(max_in_flight) {
+    TORCHTRT_CHECK(!stages_.empty(), "A stream pipeline needs at least one stage");
+    TORCHTRT_CHECK(
+        stages_.size() == streams_.size(),
+        "Expected a stream for each of the " << stages_.size() << " stages of the pipeline, found "
+                                             << streams_.size());
+    TORCHTRT_CHECK(max_in_flight_ >= 1, "A stream pipeline has to allow at least one request in flight");
+  }
+
+  // Enqueues every stage of a request and returns the outputs of the last stage. Inputs are ordered after the work
+  // enqueued on the current stream so far, errors raised by a stage are thrown from here
+  AsyncResult<Backend> submit(AsyncValues inputs) {
+    std::lock_guard<std::mutex> lock(mu_);
+    while (in_flight_.size() >= max_in_flight_) {
+      Backend::synchronize(*in_flight_.front());
+      in_flight_.pop_front();
+    }
+    auto done = std::make_shared<typename Backend::Event>();
+    Backend::record(*done, Backend::current_stream());
+    for (size_t s = 0; s < stages_.size(); s++) {
+      const auto& stream = streams_[s];
+      Backend::wait(*done, stream);
+      for (const auto& v : inputs) {
+        Backend::record_use(v, stream);
+      }
+      inputs = Backend::run_on(stream, [&]() { return stages_[s](std::move(inputs)); });
+      done = std::make_shared<typename Backend::Event>();
+      Backend::record(*done, stream);
+    }
+    in_flight_.push_back(done);
+    return AsyncResult<Backend>(std::move(inputs), std::move(done));
+  }
+
+  // Blocks the host until every submitted request completed
+  void synchronize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    while (!in_flight_.empty()) {
+      Backend::synchronize(*in_flight_.front());
+      in_flight_.pop_front();
+    }
+  }
+
+  size_t num_stages() const {
+    return stages_.size();
+  }
+
+  const std::vector<Stream>& streams() const {
+    return streams_;
+  }
+
+ private:
+  std::vector<Stage> stages_;
+  std::vector<Stream> streams_;
+  size_t max_in_flight_;
+
+  std::mutex mu_;
+  // Events of the last stage of the requests which may still be running, oldest first
+  std::deque<std::shared_ptr<typename Backend::Event>> in_flight_;
+};
+
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
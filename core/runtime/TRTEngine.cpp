@@ -2,6 +2,7 @@
 
 #include <cuda_runtime.h>
 #include "NvInfer.h"
+#include "c10/cuda/CUDAStream.h"
 #include "torch/csrc/jit/frontend/function_schema_parser.h"
 #include "torch/cuda.h"
 
@@ -35,30 +36,81 @@ TRTEngine::TRTEngine(
     const std::vector<std::string>& _out_binding_names)
     : TRTEngine("deserialized_trt", serialized_engine, cuda_device, _in_binding_names, _out_binding_names) {}
 
-TRTEngine::TRTEngine(std::vector<std::string> serialized_info)
-    : TRTEngine(
-          serialized_info[NAME_IDX],
-          serialized_info[ENGINE_IDX],
-          RTDevice(serialized_info[DEVICE_IDX]),
-          split(serialized_info[INPUT_BINDING_NAMES_IDX], BINDING_DELIM),
-          split(serialized_info[OUTPUT_BINDING_NAMES_IDX], BINDING_DELIM)) {}
+TRTEngine::TRTEngine(std::vector<std::string> serialized_info) {
+  select_device(serialized_info[NAME_IDX], RTDevice(serialized_info[DEVICE_IDX]));
+  auto _in_binding_names = split(serialized_info[INPUT_BINDING_NAMES_IDX], BINDING_DELIM);
+  auto _out_binding_names = split(serialized_info[OUTPUT_BINDING_NAMES_IDX], BINDING_DELIM);
+
+  auto codec = serialized_info.size() > ENGINE_CODEC_IDX ? util::ParseEngineCodec(serialized_info[ENGINE_CODEC_IDX])
+                                                         : util::EngineCodec::kNONE;
+  if (codec == util::EngineCodec::kBLOCK_LZ) {
+    compression_level = util::CompressedEngineLevel(serialized_info[ENGINE_IDX]);
+  }
+
+  auto load_pool = get_engine_load_pool();
+  if (!load_pool) {
+    auto& engine = serialized_info[ENGINE_IDX];
+    if (codec != util::EngineCodec::kNONE) {
+      engine = util::DecompressEngine(engine);
+    }
+    deserialize(util::EngineBlob(engine.data(), engine.size()), _in_binding_names, _out_binding_names);
+    return;
+  }
+
+  // Loading the module only schedules the decompression and deserialization, users of the engine wait for it in
+  // wait_until_deserialized
+  auto engine = std::make_shared<std::string>(std::move(serialized_info[ENGINE_IDX]));
+  load_task = load_pool->submit([this, engine, codec, _in_binding_names, _out_binding_names]() {
+    if (codec != util::EngineCodec::kNONE) {
+      *engine = util::DecompressEngine(*engine);
+    }
+    deserialize(util::EngineBlob(engine->data(), engine->size()), _in_binding_names, _out_binding_names);
+  });
+}
 
 TRTEngine::TRTEngine(
     const std::string& mod_name,
     const std::string& serialized_engine,
     const RTDevice& cuda_device,
     const std::vector<std::string>& _in_binding_names,
+    const std::vector<std::string>& _out_binding_names)
+    : TRTEngine(
+          mod_name,
+          util::EngineBlob(serialized_engine.data(), serialized_engine.size()),
+          cuda_device,
+          _in_binding_names,
+          _out_binding_names) {}
+
+TRTEngine::TRTEngine(
+    const std::string& mod_name,
+    const util::EngineBlob& serialized_engine,
+    const RTDevice& cuda_device,
+    const std::vector<std::string>& _in_binding_names,
     const std::vector<std::string>& _out_binding_names) {
+  select_device(mod_name, cuda_device);
+  deserialize(serialized_engine, _in_binding_names, _out_binding_names);
+}
+
+void TRTEngine::select_device(const std::string& mod_name, const RTDevice& cuda_device) {
   auto most_compatible_device = get_most_compatible_device(cuda_device);
   TORCHTRT_CHECK(most_compatible_device, "No compatible device was found for instantiating TensorRT engine");
   device_info = most_compatible_device.value();
-  set_rt_device(device_info);
-
-  rt = make_trt(nvinfer1::createInferRuntime(util::logging::get_logger()));
-
   name = slugify(mod_name);
+}
+
+void TRTEngine::deserialize(
+    const util::EngineBlob& serialized_engine,
+    const std::vector<std::string>& _in_binding_names,
+    const std::vector<std::string>& _out_binding_names) {
+  // May run on a thread of the engine load pool, the device is set per thread
+  set_rt_device(device_info);
 
-  cuda_engine = make_trt(rt->deserializeCudaEngine(serialized_engine.c_str(), serialized_engine.size()));
+  {
+    // The runtime is only leased while deserializing, other engines of the device reuse it afterwards
+    auto runtime = get_runtime_registry().acquire(device_info.id);
+    rt = runtime.get();
+    cuda_engine = make_trt(rt->deserializeCudaEngine(serialized_engine.data(), serialized_engine.size()));
+  }
   TORCHTRT_CHECK((cuda_engine.get() != nullptr), "Unable to deserialize the TensorRT engine");
 
   exec_ctx = make_trt(cuda_engine->createExecutionContext());
@@ -142,14 +194,25 @@ TRTEngine::TRTEngine(
     }
     num_io = std::make_pair(inputs_size, outputs);
   }
+  bindings = MakeBindingTable(*cuda_engine, in_binding_names, out_binding_names);
 
 #ifndef NDEBUG
-  this->enable_profiling();
+  this->attach_profiler();
 #endif
   LOG_DEBUG(*this);
 }
 
+void TRTEngine::wait_until_deserialized() {
+  if (load_task) {
+    load_task->wait();
+  }
+}
+
 TRTEngine::~TRTEngine() {
+  if (load_task) {
+    // An engine which was never used does not need to be deserialized
+    load_task->cancel();
+  }
   trt_engine_profiler.reset();
   exec_ctx.reset();
   cuda_engine.reset();
@@ -157,6 +220,7 @@ TRTEngine::~TRTEngine() {
 }
 
 void TRTEngine::disable_profiling() {
+  wait_until_deserialized();
   torch::cuda::synchronize(device_info.id);
   profile_execution = false;
   trt_engine_profiler.reset();
@@ -165,6 +229,7 @@ void TRTEngine::disable_profiling() {
 }
 
 void TRTEngine::dump_engine_layer_info_to_file(const std::string& path) {
+  wait_until_deserialized();
   auto inspector = make_trt(cuda_engine->createEngineInspector());
   std::ofstream f(path);
   f << std::string(inspector->getEngineInformation(nvinfer1::LayerInformationFormat::kJSON));
@@ -180,16 +245,59 @@ void TRTEngine::dump_engine_layer_info() {
 }
 
 void TRTEngine::enable_profiling() {
+  wait_until_deserialized();
+  attach_profiler();
+}
+
+void TRTEngine::attach_profiler() {
   profile_execution = true;
   trt_engine_profiler = std::make_unique<TRTEngineProfiler>(name);
   exec_ctx->setProfiler(trt_engine_profiler.get());
 }
 
 std::string TRTEngine::get_engine_layer_info() {
+  wait_until_deserialized();
   auto inspector = cuda_engine->createEngineInspector();
   return inspector->getEngineInformation(nvinfer1::LayerInformationFormat::kJSON);
 }
 
+std::vector<InputProfile> TRTEngine::input_profiles() {
+  wait_until_deserialized();
+  auto profile = exec_ctx->getOptimizationProfile();
+  std::vector<InputProfile> profiles;
+  for (const auto& binding : in_binding_names) {
+    InputProfile p;
+    p.name = binding;
+    p.dtype = util::TRTDataTypeToScalarType(cuda_engine->getTensorDataType(binding.c_str()));
+    p.min = util::toVec(cuda_engine->getProfileShape(binding.c_str(), profile, nvinfer1::OptProfileSelector::kMIN));
+    p.opt = util::toVec(cuda_engine->getProfileShape(binding.c_str(), profile, nvinfer1::OptProfileSelector::kOPT));
+    p.max = util::toVec(cuda_engine->getProfileShape(binding.c_str(), profile, nvinfer1::OptProfileSelector::kMAX));
+    profiles.push_back(std::move(p));
+  }
+  return profiles;
+}
+
+WarmupResult TRTEngine::warmup(const std::vector<WarmupShape>& shapes, int64_t iterations) {
+  wait_until_deserialized();
+  auto device = at::Device(at::kCUDA, device_info.id);
+  auto result = RunWarmup(
+      name,
+      input_profiles(),
+      shapes,
+      iterations,
+      [device](const std::vector<int64_t>& shape, at::ScalarType dtype) {
+        return at::zeros(shape, at::TensorOptions().device(device).dtype(dtype));
+      },
+      [this, device](const std::vector<at::Tensor>& inputs) {
+        // The outputs are freed right away, the caching allocator keeps their memory for the calls which follow
+        std::vector<at::Tensor> outputs;
+        execute_engine(inputs, *this, outputs);
+        c10::cuda::getCurrentCUDAStream(device.index()).synchronize();
+      });
+  warmed_up = result.ready;
+  return result;
+}
+
 void TRTEngine::set_profiling_paths() {
   device_profile_path =
       std::experimental::filesystem::path{profile_path_prefix + "/" + name + "_device_config_profile.trace"}.string();
@@ -240,16 +348,11 @@ std::ostream& operator<<(std::ostream& os, const TRTEngine& engine) {
   return os;
 }
 
-TRTEngine& TRTEngine::operator=(const TRTEngine& other) {
-  rt = other.rt;
-  cuda_engine = other.cuda_engine;
-  device_info = other.device_info;
-  exec_ctx = other.exec_ctx;
-  num_io = other.num_io;
-  return (*this);
-}
-
 void TRTEngine::verify_serialization_fmt(const std::vector<std::string>& serialized_info) {
+  if (serialized_info.size() == ENGINE_CODEC_IDX &&
+      serialized_info[ABI_TARGET_IDX] == ABI_VERSION_WITHOUT_ENGINE_CODEC) {
+    return;
+  }
   TORCHTRT_CHECK(
       serialized_info.size() == SERIALIZATION_LEN,
       "Program to be deserialized targets an incompatible Torch-TensorRT ABI");
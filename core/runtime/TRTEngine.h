@@ -9,7 +9,13 @@
 #include "NvInfer.h"
 #include "torch/custom_class.h"
 
+#include "core/runtime/BindingTable.h"
+#include "core/runtime/CUDAStreamBackend.h"
+#include "core/runtime/EngineLoader.h"
 #include "core/runtime/TRTEngineProfiler.h"
+#include "core/runtime/Warmup.h"
+#include "core/util/engine_codec.h"
+#include "core/util/engine_io.h"
 #include "core/util/prelude.h"
 
 namespace torch_tensorrt {
@@ -17,13 +23,18 @@ namespace core {
 namespace runtime {
 
 struct TRTEngine : torch::CustomClassHolder {
-  // Each engine needs it's own runtime object
+  // Runtime the engine was deserialized with, shared with the other engines of the device
   std::shared_ptr<nvinfer1::IRuntime> rt;
   std::shared_ptr<nvinfer1::ICudaEngine> cuda_engine;
   std::shared_ptr<nvinfer1::IExecutionContext> exec_ctx;
   std::pair<uint64_t, uint64_t> num_io;
   std::string name;
   RTDevice device_info;
+  // Level the engine is compressed with when it is pickled (see util::CompressEngine), 0 stores it uncompressed.
+  // Engines loaded from a compressed payload keep the level they were compressed with
+  int64_t compression_level = 0;
+  // Set once a warmup ran the engine at every shape it was asked for
+  bool warmed_up = false;
 
   std::string profile_path_prefix = std::experimental::filesystem::temp_directory_path().string();
 
@@ -32,6 +43,8 @@ struct TRTEngine : torch::CustomClassHolder {
 
   std::vector<std::string> in_binding_names = {}; // ITO: PYT IDX
   std::vector<std::string> out_binding_names = {}; // ITO: PYT IDX
+  // Built from the binding names once the engine is deserialized and refers to them
+  BindingTable bindings;
 
   ~TRTEngine();
   TRTEngine(
@@ -46,7 +59,21 @@ struct TRTEngine : torch::CustomClassHolder {
       const RTDevice& cuda_device,
       const std::vector<std::string>& in_binding_names,
       const std::vector<std::string>& out_binding_names);
-  TRTEngine& operator=(const TRTEngine& other);
+  // Deserializes the engine directly from the blob, which is only needed for the duration of the constructor
+  TRTEngine(
+      const std::string& mod_name,
+      const util::EngineBlob& serialized_engine,
+      const RTDevice& cuda_device,
+      const std::vector<std::string>& in_binding_names,
+      const std::vector<std::string>& out_binding_names);
+  // The binding table points into the binding names of its engine and the execution context may only be used by one
+  // stream at a time, engines are shared through intrusive pointers instead of being copied
+  TRTEngine(const TRTEngine&) = delete;
+  TRTEngine& operator=(const TRTEngine&) = delete;
+  // Engines unpickled while engines are loaded on a pool (see set_engine_load_threads) are deserialized in the
+  // background, everything using cuda_engine, exec_ctx or the bindings has to wait for the deserialization first. Runs
+  // the deserialization on the calling thread if the pool has not started it yet
+  void wait_until_deserialized();
   std::string to_str() const;
   static void verify_serialization_fmt(const std::vector<std::string>& serialized_info);
   void enable_profiling();
@@ -54,6 +81,11 @@ struct TRTEngine : torch::CustomClassHolder {
   std::string get_engine_layer_info();
   void dump_engine_layer_info_to_file(const std::string& path);
   void dump_engine_layer_info();
+  // Shapes the optimization profile used by exec_ctx allows for each input, in the order of in_binding_names
+  std::vector<InputProfile> input_profiles();
+  // Runs the engine on zeros at the given points of its optimization profile (see RunWarmup) so that the first calls
+  // made by users do not pay for lazy CUDA and TensorRT initialization or for growing the caching allocator
+  WarmupResult warmup(const std::vector<WarmupShape>& shapes = DEFAULT_WARMUP_SHAPES, int64_t iterations = 3);
   friend std::ostream& operator<<(std::ostream& os, const TRTEngine& engine);
   static const char BINDING_DELIM = '%';
   // TODO: Implement a call method
@@ -70,8 +102,21 @@ struct TRTEngine : torch::CustomClassHolder {
   std::string output_profile_path;
   std::string enqueue_profile_path;
   std::string trt_engine_profile_path;
+  // Serializes binding and enqueueing exec_ctx, which is not thread safe
   std::mutex mu;
+  // exec_ctx may only run on one stream at a time, enqueues on another stream than the last one wait for it
+  EnqueueOrder<CUDAStreamBackend> enqueue_order;
   std::unique_ptr<TRTEngineProfiler> trt_engine_profiler;
+  // Pending deserialization of an engine loaded on the engine load pool
+  std::shared_ptr<LoadTask> load_task;
+
+ private:
+  void select_device(const std::string& mod_name, const RTDevice& cuda_device);
+  void deserialize(
+      const util::EngineBlob& serialized_engine,
+      const std::vector<std::string>& in_binding_names,
+      const std::vector<std::string>& out_binding_names);
+  void attach_profiler();
 };
 
 } // namespace runtime
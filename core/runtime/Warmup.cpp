@@ -0,0 +1,128 @@
+#include <chrono>
+
+#include "core/runtime/Warmup.h"
+#include "core/util/prelude.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+
+namespace {
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+std::string WarmupShapeName(WarmupShape shape) {
+  switch (shape) {
+    case WarmupShape::kMIN:
+      return "min";
+    case WarmupShape::kOPT:
+      return "opt";
+    case WarmupShape::kMAX:
+      return "max";
+    default:
+      TORCHTRT_THROW_ERROR("Unknown warmup shape " << static_cast<int>(shape));
+  }
+}
+
+WarmupShape ParseWarmupShape(const std::string& name) {
+  for (auto shape : DEFAULT_WARMUP_SHAPES) {
+    if (name == WarmupShapeName(shape)) {
+      return shape;
+    }
+  }
+  TORCHTRT_THROW_ERROR("Unknown warmup shape " << name << ", expected one of min, opt or max");
+}
+
+const std::vector<int64_t>& InputProfile::at(WarmupShape shape) const {
+  switch (shape) {
+    case WarmupShape::kMIN:
+      return min;
+    case WarmupShape::kOPT:
+      return opt;
+    case WarmupShape::kMAX:
+    default:
+      return max;
+  }
+}
+
+std::vector<WarmupCase> EnumerateWarmupCases(
+    const std::vector<InputProfile>& inputs,
+    const std::vector<WarmupShape>& shapes) {
+  std::vector<WarmupCase> cases;
+  for (auto shape : shapes) {
+    WarmupCase c{shape, {}};
+    for (const auto& in : inputs) {
+      c.input_shapes.push_back(in.at(shape));
+    }
+    bool duplicate = false;
+    for (const auto& earlier : cases) {
+      duplicate |= earlier.input_shapes == c.input_shapes;
+    }
+    if (!duplicate) {
+      cases.push_back(std::move(c));
+    }
+  }
+  return cases;
+}
+
+std::ostream& operator<<(std::ostream& os, const WarmupResult& result) {
+  os << "Warmup of engine " << result.engine << (result.ready ? " finished" : " failed") << " in " << result.total_ms
+     << " ms";
+  for (const auto& t : result.timings) {
+    os << std::endl << "    " << WarmupShapeName(t.warmup_case.shape) << " shapes";
+    for (const auto& s : t.warmup_case.input_shapes) {
+      os << ' ' << c10::IntArrayRef(s);
+    }
+    os << ": first run " << t.first_ms << " ms, then " << t.steady_ms << " ms per run";
+  }
+  if (!result.ready) {
+    os << std::endl << "    Error: " << result.error;
+  }
+  return os;
+}
+
+WarmupResult RunWarmup(
+    const std::string& engine_name,
+    const std::vector<InputProfile>& inputs,
+    const std::vector<WarmupShape>& shapes,
+    int64_t iterations,
+    const WarmupInputFactory& make_input,
+    const WarmupRunner& run) {
+  TORCHTRT_CHECK(iterations >= 1, "Engines have to be warmed up for at least one iteration, got " << iterations);
+  WarmupResult result;
+  result.engine = engine_name;
+  auto start = std::chrono::steady_clock::now();
+  try {
+    for (auto& c : EnumerateWarmupCases(inputs, shapes)) {
+      std::vector<at::Tensor> tensors;
+      for (size_t i = 0; i < inputs.size(); i++) {
+        tensors.push_back(make_input(c.input_shapes[i], inputs[i].dtype));
+      }
+      WarmupTiming timing;
+      auto case_start = std::chrono::steady_clock::now();
+      run(tensors);
+      timing.first_ms = ElapsedMs(case_start);
+      if (iterations > 1) {
+        auto steady_start = std::chrono::steady_clock::now();
+        for (int64_t it = 1; it < iterations; it++) {
+          run(tensors);
+        }
+        timing.steady_ms = ElapsedMs(steady_start) / (iterations - 1);
+      }
+      timing.warmup_case = std::move(c);
+      result.timings.push_back(std::move(timing));
+    }
+    result.ready = true;
+  } catch (const std::exception& e) {
+    result.error = e.what();
+  }
+  result.total_ms = ElapsedMs(start);
+  LOG_INFO(result);
+  return result;
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
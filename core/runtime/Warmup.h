@@ -0,0 +1,119 @@
+#pragma once
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "ATen/ATen.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch/custom_class.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+
+// Points of the optimization profile of an engine it is warmed up at
+enum class WarmupShape : int8_t {
+  kMIN = 0,
+  kOPT,
+  kMAX,
+};
+
+std::string WarmupShapeName(WarmupShape shape);
+// Accepts the names returned by WarmupShapeName: "min", "opt" and "max"
+WarmupShape ParseWarmupShape(const std::string& name);
+const std::vector<WarmupShape> DEFAULT_WARMUP_SHAPES = {WarmupShape::kMIN, WarmupShape::kOPT, WarmupShape::kMAX};
+
+// Shapes an input of an engine accepts, as set by its optimization profile
+struct InputProfile {
+  std::string name;
+  at::ScalarType dtype = at::kFloat;
+  std::vector<int64_t> min;
+  std::vector<int64_t> opt;
+  std::vector<int64_t> max;
+
+  const std::vector<int64_t>& at(WarmupShape shape) const;
+};
+
+// Shapes of all of the inputs of one warmup run
+struct WarmupCase {
+  WarmupShape shape = WarmupShape::kOPT;
+  std::vector<std::vector<int64_t>> input_shapes;
+};
+
+// One case per requested point of the profile, in the order requested. Points which give the same shapes as an earlier
+// one (ex. all of them for engines with static shapes) are only run once
+std::vector<WarmupCase> EnumerateWarmupCases(
+    const std::vector<InputProfile>& inputs,
+    const std::vector<WarmupShape>& shapes);
+
+struct WarmupTiming {
+  WarmupCase warmup_case;
+  // Time of the first run, which pays for lazy initialization, and the average of the runs after it
+  double first_ms = 0;
+  double steady_ms = 0;
+};
+
+struct WarmupResult {
+  std::string engine;
+  // Whether every case ran, otherwise error holds why the warmup stopped
+  bool ready = false;
+  std::string error;
+  std::vector<WarmupTiming> timings;
+  double total_ms = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const WarmupResult& result);
+
+// Creates an input of the given shape and type for a warmup run
+using WarmupInputFactory = std::function<at::Tensor(const std::vector<int64_t>& shape, at::ScalarType dtype)>;
+// Runs the engine once on the inputs and returns once the run completed
+using WarmupRunner = std::function<void(const std::vector<at::Tensor>& inputs)>;
+
+// Runs each case of EnumerateWarmupCases iterations times. Errors are not thrown but reported in the result, the
+// cases after the failing one are not run
+WarmupResult RunWarmup(
+    const std::string& engine_name,
+    const std::vector<InputProfile>& inputs,
+    const std::vector<WarmupShape>& shapes,
+    int64_t iterations,
+    const WarmupInputFactory& make_input,
+    const WarmupRunner& run);
+
+// Engines held by mod and its submodules along with the path of their attribute, engines held by several attributes
+// are only returned once
+template <typename Engine>
+std::vector<std::pair<std::string, c10::intrusive_ptr<Engine>>> FindEngines(const torch::jit::Module& mod) {
+  auto engine_type = c10::getCustomClassType<c10::intrusive_ptr<Engine>>();
+  std::vector<std::pair<std::string, c10::intrusive_ptr<Engine>>> engines;
+  std::unordered_set<const Engine*> seen;
+  for (const auto& attr : mod.named_attributes(/*recurse=*/true)) {
+    if (!attr.value.isCustomClass() || attr.value.type() != engine_type) {
+      continue;
+    }
+    auto engine = attr.value.toCustomClass<Engine>();
+    if (seen.insert(engine.get()).second) {
+      engines.emplace_back(attr.name, std::move(engine));
+    }
+  }
+  return engines;
+}
+
+// Warms up every engine of mod one after the other with Engine::warmup(shapes, iterations)
+template <typename Engine>
+std::vector<WarmupResult> WarmupEngines(
+    const torch::jit::Module& mod,
+    const std::vector<WarmupShape>& shapes,
+    int64_t iterations) {
+  std::vector<WarmupResult> results;
+  for (auto& engine : FindEngines<Engine>(mod)) {
+    results.push_back(engine.second->warmup(shapes, iterations));
+  }
+  return results;
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
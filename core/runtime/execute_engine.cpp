@@ -1,3 +1,5 @@
+#include "c10/cuda/CUDACachingAllocator.h"
+#include "c10/cuda/CUDAGuard.h"
 #include "c10/cuda/CUDAStream.h"
 
 #include "torch/csrc/jit/runtime/custom_operator.h"
@@ -58,137 +60,231 @@ RTDevice select_rt_device(const RTDevice& engine_device) {
   return new_target_device_opt.value();
 }
 
-std::vector<at::Tensor> execute_engine(std::vector<at::Tensor> inputs, c10::intrusive_ptr<TRTEngine> compiled_engine) {
-  LOG_DEBUG("Attempting to run engine (ID: " << compiled_engine->name << ")");
+namespace {
+// Shared by the calling conventions of execute_engine, input_at(i) returns a reference to input i and set_output(i, t)
+// stores output i. Inputs are only copied if they have to be moved to the engine's device or made contiguous
+template <typename InputAt, typename SetOutput>
+void run_engine(size_t num_inputs, const InputAt& input_at, TRTEngine& compiled_engine, const SetOutput& set_output) {
+  LOG_DEBUG("Attempting to run engine (ID: " << compiled_engine.name << ")");
+  // Engines loaded on the engine load pool may still be deserializing, only this engine is waited for
+  compiled_engine.wait_until_deserialized();
 
-  if (compiled_engine->profile_execution) {
+  if (compiled_engine.profile_execution) {
     std::stringstream ss;
     ss << "Execution profiling is enabled, find results here:" << std::endl;
-    compiled_engine->set_profiling_paths();
-    ss << "  Device selection profile: " << compiled_engine->device_profile_path << std::endl;
-    ss << "  Input packing profile: " << compiled_engine->input_profile_path << std::endl;
-    ss << "  Output packing profile: " << compiled_engine->output_profile_path << std::endl;
-    ss << "  TRT enqueue profile: " << compiled_engine->enqueue_profile_path << std::endl;
-    ss << "  Engine execution profile: " << compiled_engine->trt_engine_profile_path << std::endl;
+    compiled_engine.set_profiling_paths();
+    ss << "  Device selection profile: " << compiled_engine.device_profile_path << std::endl;
+    ss << "  Input packing profile: " << compiled_engine.input_profile_path << std::endl;
+    ss << "  Output packing profile: " << compiled_engine.output_profile_path << std::endl;
+    ss << "  TRT enqueue profile: " << compiled_engine.enqueue_profile_path << std::endl;
+    ss << "  Engine execution profile: " << compiled_engine.trt_engine_profile_path << std::endl;
     auto log_info = ss.str();
     LOG_INFO("" << log_info);
   }
 
+  // Copies of inputs which had to be moved or made contiguous, they are kept alive until the engine is enqueued
+  std::vector<at::Tensor> staged;
+  auto input = [&](size_t i) -> const at::Tensor& {
+    return staged.empty() || !staged[i].defined() ? input_at(i) : staged[i];
+  };
+  auto stage = [&](size_t i, at::Tensor t) {
+    if (staged.empty()) {
+      staged.resize(num_inputs);
+    }
+    staged[i] = std::move(t);
+  };
+
+  // Inputs on other devices are moved there when they are bound
+  at::Device target_device(at::kCUDA);
   {
     std::unique_ptr<torch::autograd::profiler::RecordProfile> device_profiler_guard;
-    if (compiled_engine->profile_execution) {
+    if (compiled_engine.profile_execution) {
       device_profiler_guard =
-          std::make_unique<torch::autograd::profiler::RecordProfile>(compiled_engine->device_profile_path);
+          std::make_unique<torch::autograd::profiler::RecordProfile>(compiled_engine.device_profile_path);
     }
 
     RTDevice curr_device = get_current_device();
     LOG_DEBUG("Current Device: " << curr_device);
 
-    // Generic Target Device Prefix
-    std::string target_device = "cuda:";
-
-    if (is_switch_required(curr_device, compiled_engine->device_info)) {
+    if (is_switch_required(curr_device, compiled_engine.device_info)) {
       // Scan through available CUDA devices and set the CUDA device context correctly
-      RTDevice device = select_rt_device(compiled_engine->device_info);
+      RTDevice device = select_rt_device(compiled_engine.device_info);
       set_rt_device(device);
 
       // Target device is new device
-      target_device += std::to_string(device.id);
+      target_device = at::Device(at::kCUDA, device.id);
 
-      for (auto& in : inputs) {
-        in = in.to(torch::Device(target_device));
+      for (size_t i = 0; i < num_inputs; i++) {
+        stage(i, input(i).to(target_device));
       }
     } else {
       // Target device is current device
-      target_device += std::to_string(curr_device.id);
-    }
-
-    // For each input, ensure its current device is the desired target device
-    for (size_t i = 0; i < inputs.size(); i++) {
-      at::Tensor* in = &inputs[i];
-      std::string current_tensor_device = in->device().str();
-
-      // If current device string does not match target device, display warning and move tensor accordingly
-      if (current_tensor_device != target_device) {
-        LOG_WARNING(
-            "Input " << i << " of engine " << compiled_engine->name << " was found to be on " << current_tensor_device
-                     << " but should be on " << target_device << ". This tensor is being moved by the runtime but "
-                     << "for performance considerations, ensure your inputs are all on GPU "
-                     << "and open an issue here (https://github.com/pytorch/TensorRT/issues) if this "
-                     << "warning persists.");
-        *in = in->to(torch::Device(target_device));
-      }
+      target_device = at::Device(at::kCUDA, curr_device.id);
     }
   }
 
+  // nvinfer1::IExecutionContext is not thread safe, calls on other threads must not rebind it before it is enqueued
+  std::unique_lock<std::mutex> lock(compiled_engine.mu);
   {
     std::unique_ptr<torch::autograd::profiler::RecordProfile> input_profiler_guard;
-    if (compiled_engine->profile_execution) {
+    if (compiled_engine.profile_execution) {
       input_profiler_guard =
-          std::make_unique<torch::autograd::profiler::RecordProfile>(compiled_engine->input_profile_path);
-    }
-    for (size_t i = 0; i < inputs.size(); i++) {
-      std::string name = compiled_engine->in_binding_names[i];
-      TORCHTRT_CHECK(
-          inputs[i].is_cuda(), "Expected input tensors to have device cuda, found device " << inputs[i].device());
-      auto expected_type =
-          util::TRTDataTypeToScalarType(compiled_engine->exec_ctx->getEngine().getTensorDataType(name.c_str()));
-      TORCHTRT_CHECK(
-          inputs[i].dtype() == expected_type,
-          "Expected input tensors to have type " << expected_type << ", found type " << inputs[i].dtype());
-      auto dims = core::util::toDimsPad(inputs[i].sizes(), 1);
-      auto shape = core::util::toVec(dims);
-      LOG_DEBUG("Input Name: " << name << " Shape: " << dims);
-      compiled_engine->exec_ctx->setInputShape(name.c_str(), dims);
-      compiled_engine->exec_ctx->setTensorAddress(name.c_str(), inputs[i].view(shape).contiguous().data_ptr());
+          std::make_unique<torch::autograd::profiler::RecordProfile>(compiled_engine.input_profile_path);
     }
+    BindInputs(*compiled_engine.exec_ctx, compiled_engine.bindings, target_device, num_inputs, input, stage);
 
     TORCHTRT_CHECK(
-        compiled_engine->exec_ctx->allInputShapesSpecified(), "Not enough inputs provided (runtime.RunCudaEngine)");
+        compiled_engine.exec_ctx->allInputShapesSpecified(), "Not enough inputs provided (runtime.RunCudaEngine)");
   }
 
-  std::vector<at::Tensor> outputs(compiled_engine->num_io.second);
   {
     std::unique_ptr<torch::autograd::profiler::RecordProfile> output_profiler_guard;
-    if (compiled_engine->profile_execution) {
+    if (compiled_engine.profile_execution) {
       output_profiler_guard =
-          std::make_unique<torch::autograd::profiler::RecordProfile>(compiled_engine->output_profile_path);
+          std::make_unique<torch::autograd::profiler::RecordProfile>(compiled_engine.output_profile_path);
     }
 
-    for (auto output_indices : compiled_engine->out_binding_map) {
-      // out_binding_map stores TRT_IDX: PYT_IDX
-      auto pyt_idx = output_indices.second;
-
-      std::string name = compiled_engine->out_binding_names[pyt_idx];
-      auto out_shape = compiled_engine->exec_ctx->getTensorShape(name.c_str());
-      LOG_DEBUG("Output Name: " << name << " Shape: " << out_shape);
-      auto dims = core::util::toVec(out_shape);
-      auto type = util::TRTDataTypeToScalarType(compiled_engine->exec_ctx->getEngine().getTensorDataType(name.c_str()));
-      outputs[pyt_idx] = std::move(at::empty(dims, {at::kCUDA}).to(type).contiguous());
-      compiled_engine->exec_ctx->setTensorAddress(name.c_str(), outputs[pyt_idx].data_ptr());
-    }
+    BindOutputs(*compiled_engine.exec_ctx, compiled_engine.bindings, target_device, set_output);
   }
 
   {
     std::unique_ptr<torch::autograd::profiler::RecordProfile> enqueue_profiler_guard;
-    if (compiled_engine->profile_execution) {
+    if (compiled_engine.profile_execution) {
       enqueue_profiler_guard =
-          std::make_unique<torch::autograd::profiler::RecordProfile>(compiled_engine->enqueue_profile_path);
+          std::make_unique<torch::autograd::profiler::RecordProfile>(compiled_engine.enqueue_profile_path);
     }
-    c10::cuda::CUDAStream stream = c10::cuda::getCurrentCUDAStream(inputs[0].device().index());
-
-    // nvinfer1::IExecutionContext::enqueue is not thread safe and we need a mutex for it.
-    std::unique_lock<std::mutex> lock(compiled_engine->mu);
-    compiled_engine->exec_ctx->enqueueV3(stream);
-    if (compiled_engine->profile_execution) {
-      LOG_INFO(std::endl << *compiled_engine->trt_engine_profiler);
-      dump_trace(compiled_engine->trt_engine_profile_path, *compiled_engine->trt_engine_profiler);
-      compiled_engine->dump_engine_layer_info();
+    c10::cuda::CUDAStream stream = c10::cuda::getCurrentCUDAStream(input(0).device().index());
+
+    // The previous enqueue may still be running on another stream (ex. calls through execute_engine_async), it has to
+    // complete before the context runs again
+    compiled_engine.enqueue_order.before_enqueue(stream);
+    compiled_engine.exec_ctx->enqueueV3(stream);
+    compiled_engine.enqueue_order.after_enqueue(stream);
+    if (compiled_engine.profile_execution) {
+      LOG_INFO(std::endl << *compiled_engine.trt_engine_profiler);
+      dump_trace(compiled_engine.trt_engine_profile_path, *compiled_engine.trt_engine_profiler);
+      compiled_engine.dump_engine_layer_info();
     }
   }
+}
+} // namespace
+
+std::vector<at::Tensor> execute_engine(std::vector<at::Tensor> inputs, c10::intrusive_ptr<TRTEngine> compiled_engine) {
+  std::vector<at::Tensor> outputs;
+  execute_engine(inputs, *compiled_engine, outputs);
   return outputs;
 }
 
+void execute_engine(at::ArrayRef<at::Tensor> inputs, TRTEngine& compiled_engine, std::vector<at::Tensor>& outputs) {
+  compiled_engine.wait_until_deserialized();
+  outputs.clear();
+  outputs.resize(compiled_engine.num_io.second);
+  run_engine(
+      inputs.size(),
+      [&](size_t i) -> const at::Tensor& { return inputs[i]; },
+      compiled_engine,
+      [&](size_t i, at::Tensor t) { outputs[i] = std::move(t); });
+}
+
+void execute_engine(torch::jit::Stack& stack, size_t num_inputs, TRTEngine& compiled_engine) {
+  TORCHTRT_CHECK(stack.size() >= num_inputs, "Expected " << num_inputs << " inputs on the stack");
+  compiled_engine.wait_until_deserialized();
+  // Slots for the outputs are made before the inputs are borrowed so that growing the stack cannot move them
+  auto base = stack.size() - num_inputs;
+  stack.resize(stack.size() + compiled_engine.num_io.second);
+  run_engine(
+      num_inputs,
+      [&](size_t i) -> const at::Tensor& { return stack[base + i].toTensor(); },
+      compiled_engine,
+      [&](size_t i, at::Tensor t) { stack[base + num_inputs + i] = std::move(t); });
+  stack.erase(stack.begin() + base, stack.begin() + base + num_inputs);
+}
+
+CUDAStreamBackend::Stream CUDAStreamBackend::current_stream() {
+  return c10::cuda::getCurrentCUDAStream();
+}
+
+void CUDAStreamBackend::record(Event& event, const Stream& stream) {
+  event.record(stream);
+}
+
+void CUDAStreamBackend::wait(Event& event, const Stream& stream) {
+  // Does nothing if the event was never recorded
+  event.block(stream);
+}
+
+bool CUDAStreamBackend::query(const Event& event) {
+  return event.query();
+}
+
+void CUDAStreamBackend::synchronize(const Event& event) {
+  event.synchronize();
+}
+
+AsyncValues CUDAStreamBackend::run_on(const Stream& stream, const AsyncWork& work) {
+  // Also makes the device of stream the current device
+  c10::cuda::CUDAStreamGuard guard(stream);
+  return work();
+}
+
+void CUDAStreamBackend::record_use(const c10::IValue& value, const Stream& stream) {
+  if (value.isTensor()) {
+    const auto& t = value.toTensor();
+    if (t.defined() && t.is_cuda() && t.storage().data_ptr().get() != nullptr) {
+      c10::cuda::CUDACachingAllocator::recordStream(t.storage().data_ptr(), stream);
+    }
+  } else if (value.isTensorList()) {
+    for (const auto& t : value.toTensorVector()) {
+      record_use(t, stream);
+    }
+  } else if (value.isTuple()) {
+    for (const auto& v : value.toTupleRef().elements()) {
+      record_use(v, stream);
+    }
+  } else if (value.isList()) {
+    for (const auto& v : value.toListRef()) {
+      record_use(v, stream);
+    }
+  } else if (value.isGenericDict()) {
+    for (const auto& item : value.toGenericDict()) {
+      record_use(item.value(), stream);
+    }
+  }
+}
+
+AsyncEngineResult execute_engine_async(
+    std::vector<at::Tensor> inputs,
+    TRTEngine& compiled_engine,
+    c10::cuda::CUDAStream stream) {
+  // Engines run on the current stream of their own device, which a stream of another device cannot be
+  auto stream_device = static_cast<int64_t>(stream.device_index());
+  TORCHTRT_CHECK(
+      stream_device == compiled_engine.device_info.id,
+      "Engine " << compiled_engine.name << " runs on device " << compiled_engine.device_info.id
+                << " and cannot be enqueued on a stream of device " << stream_device);
+  AsyncValues values(inputs.begin(), inputs.end());
+  return RunAsync<CUDAStreamBackend>(stream, values, [&]() {
+    std::vector<at::Tensor> outputs;
+    execute_engine(inputs, compiled_engine, outputs);
+    return AsyncValues(outputs.begin(), outputs.end());
+  });
+}
+
+torch::jit::Operation make_unpacked_engine_op(size_t num_inputs, StackEngineRunner runner) {
+  return [num_inputs, runner](torch::jit::Stack& stack) {
+    auto engine = torch::jit::pop(stack);
+    auto base = stack.size() - num_inputs;
+    runner(stack, num_inputs, engine);
+    c10::List<at::Tensor> outputs;
+    outputs.reserve(stack.size() - base);
+    for (size_t i = base; i < stack.size(); i++) {
+      outputs.push_back(std::move(stack[i]).toTensor());
+    }
+    stack.resize(base);
+    stack.emplace_back(std::move(outputs));
+  };
+}
+
 } // namespace runtime
 } // namespace core
 } // namespace torch_tensorrt
@@ -1,6 +1,8 @@
 #include <codecvt>
+#include <sstream>
 
 #include "core/runtime/runtime.h"
+#include "torch/csrc/jit/runtime/custom_operator.h"
 
 namespace torch_tensorrt {
 namespace core {
@@ -21,12 +23,22 @@ std::string serialize_bindings(const std::vector<std::string>& bindings) {
   return serialized_binding_info;
 }
 
+// Names of the shapes TRTEngine::warmup runs by default, the default of the TorchBind method
+c10::List<std::string> default_warmup_shape_names() {
+  c10::List<std::string> names;
+  for (auto shape : DEFAULT_WARMUP_SHAPES) {
+    names.push_back(WarmupShapeName(shape));
+  }
+  return names;
+}
+
 static const std::string sym_table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"; //=
-std::string base64_encode(const std::string& in) {
+std::string base64_encode(const char* data, size_t size) {
   std::string out;
+  out.reserve(((size + 2) / 3) * 4);
   int64_t val = 0, valb = -6;
-  for (unsigned char c : in) {
-    val = (val << 8) + c;
+  for (size_t i = 0; i < size; i++) {
+    val = (val << 8) + static_cast<unsigned char>(data[i]);
     valb += 8;
     while (valb >= 0) {
       out.push_back(sym_table[(val >> valb) & 0x3F]);
@@ -44,6 +56,7 @@ std::string base64_encode(const std::string& in) {
 
 std::string base64_decode(const std::string& in) {
   std::string out;
+  out.reserve((in.size() / 4) * 3);
   std::vector<int> T(256, -1);
   for (int i = 0; i < 64; i++) {
     T[sym_table[i]] = i;
@@ -76,29 +89,66 @@ static auto TORCHTRT_UNUSED TRTEngineTSRegistrtion =
         .def(torch::init<std::vector<std::string>>())
         // TODO: .def("__call__", &TRTEngine::Run)
         // TODO: .def("run", &TRTEngine::Run)
-        .def("__str__", &TRTEngine::to_str)
-        .def("__repr__", &TRTEngine::to_str)
+        .def(
+            "__str__",
+            [](const c10::intrusive_ptr<TRTEngine>& self) -> std::string {
+              self->wait_until_deserialized();
+              return self->to_str();
+            })
+        .def(
+            "__repr__",
+            [](const c10::intrusive_ptr<TRTEngine>& self) -> std::string {
+              self->wait_until_deserialized();
+              return self->to_str();
+            })
         .def("enable_profiling", &TRTEngine::enable_profiling)
         .def("disable_profiling", &TRTEngine::disable_profiling)
         .def_readwrite("profile_path_prefix", &TRTEngine::profile_path_prefix)
+        .def_readwrite("compression_level", &TRTEngine::compression_level)
         .def("dump_engine_layer_info_to_file", &TRTEngine::dump_engine_layer_info_to_file)
         .def("dump_engine_layer_info", &TRTEngine::dump_engine_layer_info)
         .def("get_engine_layer_info", &TRTEngine::get_engine_layer_info)
+        .def(
+            "warmup",
+            [](const c10::intrusive_ptr<TRTEngine>& self,
+               std::vector<std::string> shapes,
+               int64_t iterations) -> std::string {
+              std::vector<WarmupShape> warmup_shapes;
+              for (const auto& s : shapes) {
+                warmup_shapes.push_back(ParseWarmupShape(s));
+              }
+              std::ostringstream ss;
+              ss << self->warmup(warmup_shapes, iterations);
+              return ss.str();
+            },
+            "",
+            {torch::arg("shapes") = default_warmup_shape_names(), torch::arg("iterations") = 3})
+        .def("is_ready", [](const c10::intrusive_ptr<TRTEngine>& self) -> bool { return self->warmed_up; })
         .def_pickle(
             [](const c10::intrusive_ptr<TRTEngine>& self) -> std::vector<std::string> {
-              // Serialize TensorRT engine
-              auto serialized_trt_engine = self->cuda_engine->serialize();
+              self->wait_until_deserialized();
+              // Serialize TensorRT engine, the engine is encoded straight from the memory TensorRT serialized it to
+              // so the host does not hold an extra copy of it while large engines are saved
+              auto serialized_trt_engine = make_trt(self->cuda_engine->serialize());
 
               // Adding device info related meta data to the serialized file
-              auto trt_engine = std::string((const char*)serialized_trt_engine->data(), serialized_trt_engine->size());
-
               std::vector<std::string> serialize_info;
               serialize_info.resize(SERIALIZATION_LEN);
 
               serialize_info[ABI_TARGET_IDX] = ABI_VERSION;
               serialize_info[NAME_IDX] = self->name;
               serialize_info[DEVICE_IDX] = self->device_info.serialize();
-              serialize_info[ENGINE_IDX] = base64_encode(trt_engine);
+              if (self->compression_level > 0) {
+                auto compressed = util::CompressEngine(
+                    serialized_trt_engine->data(), serialized_trt_engine->size(), self->compression_level);
+                serialized_trt_engine.reset();
+                serialize_info[ENGINE_IDX] = base64_encode(compressed.data(), compressed.size());
+                serialize_info[ENGINE_CODEC_IDX] = util::EngineCodecName(util::EngineCodec::kBLOCK_LZ);
+              } else {
+                serialize_info[ENGINE_IDX] = base64_encode(
+                    static_cast<const char*>(serialized_trt_engine->data()), serialized_trt_engine->size());
+                serialize_info[ENGINE_CODEC_IDX] = util::EngineCodecName(util::EngineCodec::kNONE);
+              }
               serialize_info[INPUT_BINDING_NAMES_IDX] = serialize_bindings(self->in_binding_names);
               serialize_info[OUTPUT_BINDING_NAMES_IDX] = serialize_bindings(self->out_binding_names);
 
@@ -110,8 +160,40 @@ static auto TORCHTRT_UNUSED TRTEngineTSRegistrtion =
               return c10::make_intrusive<TRTEngine>(serialized_info);
             });
 
+static auto TORCHTRT_UNUSED ExecutionPlanTSRegistrtion =
+    torch::class_<ExecutionPlanHolder>("tensorrt", "ExecutionPlan")
+        .def(torch::init<std::string>())
+        .def_pickle(
+            [](const c10::intrusive_ptr<ExecutionPlanHolder>& self) -> std::string { return self->method_name; },
+            [](std::string method_name) -> c10::intrusive_ptr<ExecutionPlanHolder> {
+              return c10::make_intrusive<ExecutionPlanHolder>(std::move(method_name));
+            });
+
+c10::IValue execute_plan(
+    c10::intrusive_ptr<ExecutionPlanHolder> plan,
+    c10::IValue self,
+    c10::List<c10::IValue> inputs) {
+  return plan->run(std::move(self), std::move(inputs));
+}
+
+void run_trt_engine_on_stack(torch::jit::Stack& stack, size_t num_inputs, const c10::IValue& engine) {
+  execute_engine(stack, num_inputs, *engine.toCustomClass<TRTEngine>());
+}
+
+// tensorrt::execute_engine_unpacked takes a variable number of inputs so it is registered directly with the JIT, the
+// number of inputs of each call is read from its node when the graph is compiled by the interpreter
+static auto TORCHTRT_UNUSED unpacked_engine_op_reg = torch::jit::RegisterOperators({torch::jit::Operator(
+    UNPACKED_ENGINE_OP_NAME + "(...) -> Tensor[]",
+    [](const torch::jit::Node* n) -> torch::jit::Operation {
+      return make_unpacked_engine_op(n->inputs().size() - 1, run_trt_engine_on_stack);
+    },
+    c10::AliasAnalysisKind::CONSERVATIVE)});
+
 TORCH_LIBRARY(tensorrt, m) {
-  m.def("execute_engine", execute_engine);
+  m.def("execute_engine", [](std::vector<at::Tensor> inputs, c10::intrusive_ptr<TRTEngine> engine) {
+    return execute_engine(std::move(inputs), std::move(engine));
+  });
+  m.def("execute_plan", execute_plan);
   m.def("SERIALIZED_ENGINE_BINDING_DELIM", []() -> std::string { return std::string(1, TRTEngine::BINDING_DELIM); });
   m.def("ABI_VERSION", []() -> std::string { return ABI_VERSION; });
 }
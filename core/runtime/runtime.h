@@ -1,13 +1,20 @@
 #pragma once
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <utility>
 #include "ATen/core/function_schema.h"
+#include "ATen/cuda/CUDAEvent.h"
 #include "NvInfer.h"
+#include "c10/cuda/CUDAStream.h"
+#include "core/runtime/CUDAStreamBackend.h"
+#include "core/runtime/ExecutionPlan.h"
 #include "core/runtime/RTDevice.h"
+#include "core/runtime/StreamPipeline.h"
 #include "core/runtime/TRTEngine.h"
 #include "core/util/prelude.h"
+#include "torch/csrc/jit/runtime/operator.h"
 #include "torch/custom_class.h"
 
 namespace torch_tensorrt {
@@ -15,7 +22,9 @@ namespace core {
 namespace runtime {
 
 using EngineID = int64_t;
-const std::string ABI_VERSION = "4";
+const std::string ABI_VERSION = "5";
+// Programs serialized with the previous ABI have every field but ENGINE_CODEC_IDX, their engines are not compressed
+const std::string ABI_VERSION_WITHOUT_ENGINE_CODEC = "4";
 typedef enum {
   ABI_TARGET_IDX = 0,
   NAME_IDX,
@@ -23,14 +32,46 @@ typedef enum {
   ENGINE_IDX,
   INPUT_BINDING_NAMES_IDX,
   OUTPUT_BINDING_NAMES_IDX,
+  // Name of the util::EngineCodec the engine at ENGINE_IDX is stored with
+  ENGINE_CODEC_IDX,
   SERIALIZATION_LEN, // NEVER USED FOR DATA, USED TO DETERMINE LENGTH OF SERIALIZED INFO
 } SerializedInfoIndex;
 
 c10::optional<RTDevice> get_most_compatible_device(const RTDevice& target_device);
 std::vector<RTDevice> find_compatible_devices(const RTDevice& target_device);
 
+// Name of the op engine calls are compiled into, tensorrt::execute_engine_unpacked(Tensor... inputs, Engine engine)
+// -> Tensor[]. Unlike tensorrt::execute_engine the inputs are passed on the stack instead of in a list
+const std::string UNPACKED_ENGINE_OP_NAME = "tensorrt::execute_engine_unpacked";
+
+// Implementation of tensorrt::execute_engine, kept for programs compiled before engine calls were unpacked
 std::vector<at::Tensor> execute_engine(std::vector<at::Tensor> inputs, c10::intrusive_ptr<TRTEngine> compiled_engine);
 
+// Runs the engine and writes its outputs into outputs, which is resized to the number of outputs of the engine. The
+// inputs are only borrowed, they are copied only if they are not on the engine's device or not contiguous
+void execute_engine(at::ArrayRef<at::Tensor> inputs, TRTEngine& compiled_engine, std::vector<at::Tensor>& outputs);
+
+// Runs the engine on the top num_inputs values of the stack, which have to be tensors, and replaces them with the
+// outputs of the engine
+void execute_engine(torch::jit::Stack& stack, size_t num_inputs, TRTEngine& compiled_engine);
+
+using AsyncEngineResult = AsyncResult<CUDAStreamBackend>;
+
+// Enqueues the engine on stream instead of the current stream and returns without waiting for it to run. The inputs
+// are used after the work enqueued on the current stream so far, the outputs are ready once the result is. stream has
+// to be on the device of the engine
+AsyncEngineResult execute_engine_async(
+    std::vector<at::Tensor> inputs,
+    TRTEngine& compiled_engine,
+    c10::cuda::CUDAStream stream);
+
+// Runs an engine on the top num_inputs values of the stack and replaces them with the engine's outputs
+using StackEngineRunner = std::function<void(torch::jit::Stack& stack, size_t num_inputs, const c10::IValue& engine)>;
+
+// Operation of an unpacked engine call with num_inputs input tensors: pops the engine and the inputs off the stack and
+// pushes the outputs as a Tensor[]
+torch::jit::Operation make_unpacked_engine_op(size_t num_inputs, StackEngineRunner runner);
+
 class DeviceList {
   using DeviceMap = std::unordered_map<int, RTDevice>;
   DeviceMap device_list;
@@ -0,0 +1,345 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "ATen/Parallel.h"
+#include "core/util/engine_codec.h"
+#include "core/util/macros.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace util {
+
+namespace {
+// Layout of a kBLOCK_LZ payload, integers are little endian:
+//   u8 format version, u8 level, u32 block size, u64 engine size, u32 number of blocks,
+//   u32 stored size of each block (the top bit is set for blocks stored uncompressed), the blocks
+// Compressed blocks are sequences of literals followed by a back reference into the block, in the spirit of LZ4: a
+// token holding the literal count in its high and the match length - 4 in its low nibble (15 continues in following
+// bytes which are added up until one is not 255), the literals, a u16 offset and the rest of the match length. The
+// last sequence of a block only has literals
+constexpr uint8_t kFormatVersion = 1;
+constexpr size_t kHeaderSize = 1 + 1 + 4 + 8 + 4;
+constexpr uint32_t kStoredFlag = 1u << 31;
+// Every byte of a compressed block produces at most 255 bytes of the engine, through the bytes continuing a length
+constexpr size_t kMaxExpansion = 255;
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashLog = 16;
+// Previous positions with the same hash are kept for the last 64 KiB, as far back as an offset reaches
+constexpr size_t kChainMask = 65535;
+
+void PutU32(std::string& out, uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+  }
+}
+
+void PutU64(std::string& out, uint64_t v) {
+  for (int i = 0; i < 8; i++) {
+    out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+  }
+}
+
+uint64_t GetLE(const uint8_t* p, int num_bytes) {
+  uint64_t v = 0;
+  for (int i = num_bytes - 1; i >= 0; i--) {
+    v = (v << 8) | p[i];
+  }
+  return v;
+}
+
+uint32_t Read32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t Hash(uint32_t v) {
+  return (v * 2654435761u) >> (32 - kHashLog);
+}
+
+void PutLength(std::string& out, size_t length) {
+  length -= 15;
+  while (length >= 255) {
+    out.push_back(static_cast<char>(255));
+    length -= 255;
+  }
+  out.push_back(static_cast<char>(length));
+}
+
+void PutSequence(std::string& out, const uint8_t* literals, size_t num_literals, size_t offset, size_t match_length) {
+  size_t extra_match = match_length ? match_length - kMinMatch : 0;
+  out.push_back(static_cast<char>((std::min<size_t>(num_literals, 15) << 4) | std::min<size_t>(extra_match, 15)));
+  if (num_literals >= 15) {
+    PutLength(out, num_literals);
+  }
+  out.append(reinterpret_cast<const char*>(literals), num_literals);
+  if (!match_length) {
+    return;
+  }
+  out.push_back(static_cast<char>(offset & 0xFF));
+  out.push_back(static_cast<char>(offset >> 8));
+  if (extra_match >= 15) {
+    PutLength(out, extra_match);
+  }
+}
+
+// Greedy LZ77 over a hash chain, higher levels follow the chain further to find longer matches
+std::string CompressBlock(const uint8_t* src, size_t size, int64_t level) {
+  std::string out;
+  out.reserve(size + size / 255 + 16);
+  std::vector<int32_t> head(size_t(1) << kHashLog, -1);
+  std::vector<int32_t> chain(level > 1 ? kChainMask + 1 : 0, -1);
+  size_t max_attempts = size_t(1) << (level - 1);
+  auto insert = [&](size_t pos) {
+    auto h = Hash(Read32(src + pos));
+    if (!chain.empty()) {
+      chain[pos & kChainMask] = head[h];
+    }
+    head[h] = static_cast<int32_t>(pos);
+  };
+
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + kMinMatch <= size) {
+    size_t best_length = 0;
+    size_t best_offset = 0;
+    int64_t candidate = head[Hash(Read32(src + pos))];
+    for (size_t attempt = 0; candidate >= 0 && attempt < max_attempts; attempt++) {
+      size_t offset = pos - candidate;
+      if (offset > kMaxOffset || offset == 0) {
+        break;
+      }
+      if (Read32(src + candidate) == Read32(src + pos)) {
+        size_t length = kMinMatch;
+        while (pos + length < size && src[candidate + length] == src[pos + length]) {
+          length++;
+        }
+        if (length > best_length) {
+          best_length = length;
+          best_offset = offset;
+        }
+      }
+      if (chain.empty()) {
+        break;
+      }
+      candidate = chain[candidate & kChainMask];
+    }
+    insert(pos);
+
+    if (!best_length) {
+      // The fastest level skips ahead quicker the longer nothing matched, which keeps incompressible data cheap
+      pos += level == 1 ? 1 + ((pos - anchor) >> 6) : 1;
+      continue;
+    }
+    PutSequence(out, src + anchor, pos - anchor, best_offset, best_length);
+    auto end = pos + best_length;
+    if (level > 1) {
+      for (pos++; pos < end && pos + kMinMatch <= size; pos++) {
+        insert(pos);
+      }
+    }
+    pos = end;
+    anchor = end;
+  }
+  PutSequence(out, src + anchor, size - anchor, 0, 0);
+  return out;
+}
+
+void DecompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t dst_size) {
+  const uint8_t* ip = src;
+  const uint8_t* iend = src + size;
+  uint8_t* op = dst;
+  uint8_t* oend = dst + dst_size;
+  auto read_length = [&](size_t length) {
+    if (length == 15) {
+      uint8_t b;
+      do {
+        TORCHTRT_CHECK(ip < iend, "Compressed TensorRT engine is truncated");
+        b = *ip++;
+        length += b;
+      } while (b == 255);
+    }
+    return length;
+  };
+
+  while (true) {
+    TORCHTRT_CHECK(ip < iend, "Compressed TensorRT engine is truncated");
+    uint8_t token = *ip++;
+    auto num_literals = read_length(token >> 4);
+    TORCHTRT_CHECK(
+        num_literals <= static_cast<size_t>(iend - ip) && num_literals <= static_cast<size_t>(oend - op),
+        "Compressed TensorRT engine is corrupted");
+    std::memcpy(op, ip, num_literals);
+    ip += num_literals;
+    op += num_literals;
+    if (op == oend) {
+      break;
+    }
+
+    TORCHTRT_CHECK(iend - ip >= 2, "Compressed TensorRT engine is truncated");
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    auto match_length = read_length(token & 15) + kMinMatch;
+    TORCHTRT_CHECK(
+        offset > 0 && offset <= static_cast<size_t>(op - dst) && match_length <= static_cast<size_t>(oend - op),
+        "Compressed TensorRT engine is corrupted");
+    const uint8_t* match = op - offset;
+    if (offset >= match_length) {
+      std::memcpy(op, match, match_length);
+    } else {
+      // Overlapping matches repeat the last offset bytes, the copy doubles in size each step
+      std::memcpy(op, match, offset);
+      for (size_t copied = offset; copied < match_length;) {
+        auto chunk = std::min(copied, match_length - copied);
+        std::memcpy(op + copied, op, chunk);
+        copied += chunk;
+      }
+    }
+    op += match_length;
+  }
+  TORCHTRT_CHECK(ip == iend, "Compressed TensorRT engine is corrupted");
+}
+
+struct PayloadHeader {
+  int64_t level;
+  size_t block_size;
+  size_t size;
+  size_t num_blocks;
+};
+
+PayloadHeader ReadHeader(const std::string& payload) {
+  auto p = reinterpret_cast<const uint8_t*>(payload.data());
+  TORCHTRT_CHECK(payload.size() >= kHeaderSize, "Compressed TensorRT engine is truncated");
+  TORCHTRT_CHECK(
+      p[0] == kFormatVersion,
+      "Compressed TensorRT engine has format version " << static_cast<int>(p[0]) << ", this runtime reads version "
+                                                       << static_cast<int>(kFormatVersion));
+  PayloadHeader header;
+  header.level = p[1];
+  header.block_size = GetLE(p + 2, 4);
+  header.size = GetLE(p + 6, 8);
+  header.num_blocks = GetLE(p + 14, 4);
+  // The engine is allocated from its size, which is checked against what the payload can hold before it is trusted
+  TORCHTRT_CHECK(
+      header.size <= (payload.size() - kHeaderSize) * kMaxExpansion, "Compressed TensorRT engine is corrupted");
+  TORCHTRT_CHECK(
+      header.block_size > 0 && header.num_blocks == (header.size + header.block_size - 1) / header.block_size,
+      "Compressed TensorRT engine is corrupted");
+  return header;
+}
+} // namespace
+
+std::string EngineCodecName(EngineCodec codec) {
+  switch (codec) {
+    case EngineCodec::kNONE:
+      return "none";
+    case EngineCodec::kBLOCK_LZ:
+      return "block_lz";
+    default:
+      TORCHTRT_THROW_ERROR("Unknown engine codec " << static_cast<int>(codec));
+  }
+}
+
+EngineCodec ParseEngineCodec(const std::string& name) {
+  if (name == EngineCodecName(EngineCodec::kNONE)) {
+    return EngineCodec::kNONE;
+  } else if (name == EngineCodecName(EngineCodec::kBLOCK_LZ)) {
+    return EngineCodec::kBLOCK_LZ;
+  }
+  TORCHTRT_THROW_ERROR(
+      "TensorRT engine is stored with codec " << name << " which is not supported by this version of the runtime");
+}
+
+std::string CompressEngine(const void* data, size_t size, int64_t level, size_t block_size) {
+  TORCHTRT_CHECK(
+      level >= 1 && level <= ENGINE_COMPRESSION_LEVEL_MAX,
+      "Engine compression level has to be between 1 and " << ENGINE_COMPRESSION_LEVEL_MAX << ", got " << level);
+  TORCHTRT_CHECK(block_size > 0 && block_size < kStoredFlag, "Engine compression block size has to be below 2 GiB");
+  auto src = static_cast<const uint8_t*>(data);
+  size_t num_blocks = (size + block_size - 1) / block_size;
+
+  std::vector<std::string> blocks(num_blocks);
+  std::vector<char> stored(num_blocks);
+  at::parallel_for(0, num_blocks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      auto block_begin = b * block_size;
+      auto block_length = std::min(block_size, size - block_begin);
+      blocks[b] = CompressBlock(src + block_begin, block_length, level);
+      // Blocks which grow are stored as they are and copied out of the engine when the payload is assembled
+      if (blocks[b].size() >= block_length) {
+        blocks[b].clear();
+        stored[b] = true;
+      }
+    }
+  });
+
+  std::string payload;
+  size_t payload_size = kHeaderSize + 4 * num_blocks;
+  for (size_t b = 0; b < num_blocks; b++) {
+    payload_size += stored[b] ? std::min(block_size, size - b * block_size) : blocks[b].size();
+  }
+  payload.reserve(payload_size);
+  payload.push_back(static_cast<char>(kFormatVersion));
+  payload.push_back(static_cast<char>(level));
+  PutU32(payload, static_cast<uint32_t>(block_size));
+  PutU64(payload, size);
+  PutU32(payload, static_cast<uint32_t>(num_blocks));
+  for (size_t b = 0; b < num_blocks; b++) {
+    auto block_length = std::min(block_size, size - b * block_size);
+    auto entry = stored[b] ? block_length | kStoredFlag : blocks[b].size();
+    PutU32(payload, static_cast<uint32_t>(entry));
+  }
+  for (size_t b = 0; b < num_blocks; b++) {
+    if (stored[b]) {
+      payload.append(reinterpret_cast<const char*>(src + b * block_size), std::min(block_size, size - b * block_size));
+    } else {
+      payload.append(blocks[b]);
+      std::string().swap(blocks[b]);
+    }
+  }
+  return payload;
+}
+
+int64_t CompressedEngineLevel(const std::string& payload) {
+  return ReadHeader(payload).level;
+}
+
+std::string DecompressEngine(const std::string& payload) {
+  auto header = ReadHeader(payload);
+  auto p = reinterpret_cast<const uint8_t*>(payload.data());
+  TORCHTRT_CHECK(payload.size() >= kHeaderSize + 4 * header.num_blocks, "Compressed TensorRT engine is truncated");
+
+  // Offset of each block in the payload
+  std::vector<size_t> offsets(header.num_blocks + 1, kHeaderSize + 4 * header.num_blocks);
+  std::vector<char> stored(header.num_blocks);
+  for (size_t b = 0; b < header.num_blocks; b++) {
+    auto entry = static_cast<uint32_t>(GetLE(p + kHeaderSize + 4 * b, 4));
+    stored[b] = (entry & kStoredFlag) != 0;
+    offsets[b + 1] = offsets[b] + (entry & ~kStoredFlag);
+  }
+  TORCHTRT_CHECK(offsets.back() == payload.size(), "Compressed TensorRT engine is corrupted");
+
+  std::string engine(header.size, '\0');
+  auto dst = reinterpret_cast<uint8_t*>(&engine[0]);
+  at::parallel_for(0, header.num_blocks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      auto block_begin = b * header.block_size;
+      auto block_length = std::min(header.block_size, header.size - block_begin);
+      auto stored_length = offsets[b + 1] - offsets[b];
+      if (stored[b]) {
+        TORCHTRT_CHECK(stored_length == block_length, "Compressed TensorRT engine is corrupted");
+        std::memcpy(dst + block_begin, p + offsets[b], block_length);
+      } else {
+        DecompressBlock(p + offsets[b], stored_length, dst + block_begin, block_length);
+      }
+    }
+  });
+  return engine;
+}
+
+} // namespace util
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace torch_tensorrt {
+namespace core {
+namespace util {
+
+// Codecs serialized engines can be stored with. The codec of an engine is recorded next to it in serialized modules
+enum class EngineCodec : int8_t {
+  // The serialized engine as TensorRT produced it
+  kNONE = 0,
+  // LZ77 compressed blocks which are decompressed independently
+  kBLOCK_LZ = 1,
+};
+
+// Engines are compressed in blocks of this many bytes, which is also the unit decompression is parallelized over
+const size_t ENGINE_CODEC_BLOCK_SIZE = 1024 * 1024;
+const int64_t ENGINE_COMPRESSION_LEVEL_MAX = 9;
+
+std::string EngineCodecName(EngineCodec codec);
+// Throws for codecs this version of the runtime does not know, such as ones recorded by a newer version
+EngineCodec ParseEngineCodec(const std::string& name);
+
+// Compresses a serialized engine with kBLOCK_LZ. Levels go from 1 (fastest) to ENGINE_COMPRESSION_LEVEL_MAX
+// (smallest), blocks are compressed in parallel. Blocks which do not compress are stored as they are
+std::string CompressEngine(const void* data, size_t size, int64_t level, size_t block_size = ENGINE_CODEC_BLOCK_SIZE);
+
+// Level a payload produced by CompressEngine was compressed with
+int64_t CompressedEngineLevel(const std::string& payload);
+
+// Decompresses a payload produced by CompressEngine, blocks are decompressed in parallel straight into the result
+std::string DecompressEngine(const std::string& payload);
+
+} // namespace util
+} // namespace core
+} // namespace torch_tensorrt
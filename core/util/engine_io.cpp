@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "core/util/engine_io.h"
+#include "core/util/macros.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace util {
+
+EngineBlob::EngineBlob(const void* data, size_t size) : data_(static_cast<const char*>(data)), size_(size) {}
+
+EngineBlob::~EngineBlob() {
+#ifndef _WIN32
+  if (mapped_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+#endif
+}
+
+std::shared_ptr<EngineBlob> EngineBlob::MapFile(const std::string& path) {
+  auto blob = std::shared_ptr<EngineBlob>(new EngineBlob());
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  TORCHTRT_CHECK(fd >= 0, "Unable to open TensorRT engine file " << path);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    TORCHTRT_THROW_ERROR("Unable to read the size of TensorRT engine file " << path);
+  }
+  if (st.st_size == 0) {
+    close(fd);
+    TORCHTRT_THROW_ERROR("TensorRT engine file " << path << " is empty");
+  }
+  auto addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the file is closed
+  close(fd);
+  TORCHTRT_CHECK(addr != MAP_FAILED, "Unable to map TensorRT engine file " << path);
+  // The engine is read front to back once during deserialization
+  madvise(addr, st.st_size, MADV_SEQUENTIAL);
+  blob->data_ = static_cast<const char*>(addr);
+  blob->size_ = st.st_size;
+  blob->mapped_ = true;
+#else
+  std::ifstream f(path, std::ios::binary | std::ios::ate);
+  TORCHTRT_CHECK(f, "Unable to open TensorRT engine file " << path);
+  blob->owned_.resize(f.tellg());
+  TORCHTRT_CHECK(!blob->owned_.empty(), "TensorRT engine file " << path << " is empty");
+  f.seekg(0);
+  TORCHTRT_CHECK(f.read(&blob->owned_[0], blob->owned_.size()), "Unable to read TensorRT engine file " << path);
+  blob->data_ = blob->owned_.data();
+  blob->size_ = blob->owned_.size();
+#endif
+  return blob;
+}
+
+void WriteEngineFile(const std::string& path, const void* data, size_t size, size_t chunk_size) {
+  TORCHTRT_CHECK(chunk_size > 0, "Engine file chunk size must be positive");
+  auto tmp_path = path + ".partial";
+  std::ostringstream error;
+  {
+    std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+    TORCHTRT_CHECK(f, "Unable to open " << tmp_path << " to write the TensorRT engine");
+    auto bytes = static_cast<const char*>(data);
+    for (size_t offset = 0; offset < size && error.tellp() == 0; offset += chunk_size) {
+      auto n = std::min(chunk_size, size - offset);
+      if (!f.write(bytes + offset, n)) {
+        error << "Failed to write the TensorRT engine to " << tmp_path << " at offset " << offset;
+      }
+    }
+    if (error.tellp() == 0) {
+      f.flush();
+      if (!f || static_cast<size_t>(f.tellp()) != size) {
+        error << "Failed to write the TensorRT engine to " << tmp_path << ", wrote " << f.tellp() << " of " << size
+              << " bytes";
+      }
+    }
+  }
+  if (error.tellp() == 0 && std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    error << "Unable to move the TensorRT engine from " << tmp_path << " to " << path;
+  }
+  // Whatever was written of the engine is removed on failure, path is left as it was
+  if (error.tellp() != 0) {
+    std::remove(tmp_path.c_str());
+    TORCHTRT_THROW_ERROR(error.str());
+  }
+}
+
+} // namespace util
+} // namespace core
+} // namespace torch_tensorrt
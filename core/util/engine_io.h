@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace torch_tensorrt {
+namespace core {
+namespace util {
+
+// Serialized engines are written to disk in chunks of at most this many bytes
+const size_t ENGINE_FILE_CHUNK_SIZE = 64 * 1024 * 1024;
+
+// Read-only bytes of a serialized engine. Engines read from a file are memory mapped instead of being copied into host
+// memory, pages are only loaded while TensorRT deserializes the engine and can be dropped by the OS afterwards
+class EngineBlob {
+ public:
+  // View of memory owned by the caller, which has to outlive the blob
+  EngineBlob(const void* data, size_t size);
+  ~EngineBlob();
+  EngineBlob(const EngineBlob&) = delete;
+  EngineBlob& operator=(const EngineBlob&) = delete;
+
+  static std::shared_ptr<EngineBlob> MapFile(const std::string& path);
+
+  const char* data() const {
+    return data_;
+  }
+  size_t size() const {
+    return size_;
+  }
+  bool is_mapped() const {
+    return mapped_;
+  }
+
+ private:
+  EngineBlob() = default;
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  // Contents of the file on platforms where it is read instead of mapped
+  std::string owned_;
+};
+
+// Writes a serialized engine to path in chunks of at most chunk_size bytes. The engine goes to a temporary file next to
+// path which replaces path once it is complete, so a partially written engine is never left at path
+void WriteEngineFile(
+    const std::string& path,
+    const void* data,
+    size_t size,
+    size_t chunk_size = ENGINE_FILE_CHUNK_SIZE);
+
+} // namespace util
+} // namespace core
+} // namespace torch_tensorrt
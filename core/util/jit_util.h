@@ -55,6 +55,24 @@ inline c10::FunctionSchema GenerateGraphSchema(std::string method_name, std::sha
   return c10::FunctionSchema(method_name, method_name, args, returns);
 }
 
+// Whether any node of the block, including nodes in loops and conditionals, modifies a value in place (ex.
+// aten::append on a list which other nodes read). Passes which reason about values out of execution order are only
+// safe on blocks without mutation
+inline bool BlockHasMutation(const torch::jit::Block* b) {
+  for (const auto n : b->nodes()) {
+    auto schema = n->maybeSchema();
+    if (schema && schema->is_mutable()) {
+      return true;
+    }
+    for (const auto sub_b : n->blocks()) {
+      if (BlockHasMutation(sub_b)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 inline std::string GetPyTorchSourceCode(const torch::jit::Node* n) {
   std::string source_code = n->sourceRange().str();
   return source_code;
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <chrono>
 #include <iostream>
 #include <sstream>
 
@@ -13,6 +14,7 @@
 #include "accuracy.h"
 #include "fileio.h"
 #include "luts.h"
+#include "manifest.h"
 #include "parser_util.h"
 
 #if defined(_WIN32)
@@ -89,6 +91,12 @@ int main(int argc, char** argv) {
   args::Flag sparse_weights(
       parser, "sparse-weights", "Enable sparsity for weights of conv and FC layers", {"sparse-weights"});
 
+  args::Flag prune_sparse_weights(
+      parser,
+      "prune-sparse-weights",
+      "Prune the weights of conv and FC layers to 2:4 sparsity by magnitude, implies --sparse-weights",
+      {"prune-sparse-weights"});
+
   args::ValueFlagList<std::string> enabled_precisions(
       parser,
       "precision",
@@ -191,6 +199,22 @@ int main(int argc, char** argv) {
       "(repeatable) Shared object/DLL containing custom converters",
       {"custom-converters"});
 
+  args::ValueFlag<std::string> manifest_path(
+      parser,
+      "manifest",
+      "Path to a JSON manifest of models to compile in one run, see the README for its format. Input and output paths and input specs are taken from the manifest",
+      {"manifest"});
+  args::ValueFlag<uint64_t> jobs(
+      parser,
+      "num_jobs",
+      "(Only used with --manifest) Number of models compiled concurrently, overrides the jobs setting of the manifest",
+      {'j', "jobs"});
+  args::Flag dry_run(
+      parser,
+      "dry-run",
+      "(Only used with --manifest) Load each model and check its settings and operator support without compiling it",
+      {"dry-run"});
+
   args::Positional<std::string> input_path(parser, "input_file_path", "Path to input TorchScript file");
   args::Positional<std::string> output_path(
       parser, "output_file_path", "Path for compiled TorchScript (or TensorRT engine) file");
@@ -246,6 +270,45 @@ int main(int argc, char** argv) {
     }
   }
 
+  if (manifest_path) {
+    torchtrtc::manifest::Manifest manifest;
+    try {
+      manifest = torchtrtc::manifest::load_manifest(torchtrtc::fileio::resolve_path(args::get(manifest_path)));
+    } catch (const std::exception& e) {
+      torchtrt::logging::log(torchtrt::logging::Level::kERROR, e.what());
+      return 1;
+    }
+    // Input specs are checked for every model before any of them is compiled. A dry run goes on to report them along
+    // with the other problems of each model
+    size_t num_invalid = 0;
+    for (const auto& job : manifest.models) {
+      try {
+        torchtrtc::manifest::to_compile_spec(job);
+      } catch (const std::exception& e) {
+        torchtrt::logging::log(
+            torchtrt::logging::Level::kERROR, "Invalid compile settings for " + job.name + ": " + e.what());
+        num_invalid++;
+      }
+    }
+    if (num_invalid > 0 && !dry_run) {
+      return 1;
+    }
+
+    auto num_jobs = jobs ? args::get(jobs) : manifest.jobs;
+    auto start = std::chrono::high_resolution_clock::now();
+    auto results = torchtrtc::manifest::run_manifest(
+        manifest, num_jobs, dry_run ? torchtrtc::manifest::check_job : torchtrtc::manifest::compile_job);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << torchtrtc::manifest::summarize(results, std::chrono::duration<double>(end - start).count());
+
+    for (const auto& r : results) {
+      if (!r.success) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+
   auto real_input_path = torchtrtc::fileio::resolve_path(args::get(input_path));
 
   if (check_method_op_support) {
@@ -306,7 +369,12 @@ int main(int argc, char** argv) {
 
   std::vector<torchtrt::Input> ranges;
   for (const auto& spec : args::get(input_shapes)) {
-    ranges.push_back(torchtrtc::parserutil::parse_input(spec));
+    try {
+      ranges.push_back(torchtrtc::parserutil::parse_input(spec));
+    } catch (const std::runtime_error& e) {
+      torchtrt::logging::log(torchtrt::logging::Level::kERROR, e.what());
+      return 1;
+    }
     std::stringstream ss;
     ss << "Parsed Input: " << ranges.back();
     torchtrt::logging::log(torchtrt::logging::Level::kDEBUG, ss.str());
@@ -330,6 +398,10 @@ int main(int argc, char** argv) {
     compile_settings.sparse_weights = true;
   }
 
+  if (prune_sparse_weights) {
+    compile_settings.prune_sparse_weights = true;
+  }
+
   std::string calibration_cache_file_path = "";
   if (calibration_cache_file) {
     calibration_cache_file_path = torchtrtc::fileio::resolve_path(args::get(calibration_cache_file));
@@ -0,0 +1,512 @@
+#include "manifest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "torch/script.h"
+
+#include "torch_tensorrt/logging.h"
+#include "torch_tensorrt/ptq.h"
+
+#include "parser_util.h"
+
+namespace torchtrtc {
+namespace manifest {
+namespace {
+
+// Just enough JSON for manifests: objects, arrays, strings, numbers, booleans and null
+struct JsonValue {
+  enum class Kind { kNull, kBool, kNumber, kString, kArray, kObject };
+  Kind kind = Kind::kNull;
+  bool b = false;
+  double num = 0;
+  std::string str;
+  std::vector<JsonValue> arr;
+  std::map<std::string, JsonValue> obj;
+};
+
+class JsonParser {
+ public:
+  explicit JsonParser(const std::string& text) : text_(text) {}
+
+  JsonValue parse() {
+    auto v = value();
+    skip_ws();
+    if (pos_ != text_.size()) {
+      fail("unexpected trailing characters");
+    }
+    return v;
+  }
+
+ private:
+  [[noreturn]] void fail(const std::string& msg) {
+    size_t line = 1;
+    for (size_t i = 0; i < pos_ && i < text_.size(); i++) {
+      line += text_[i] == '\n';
+    }
+    throw std::runtime_error("Invalid manifest JSON at line " + std::to_string(line) + ": " + msg);
+  }
+
+  void skip_ws() {
+    while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      pos_++;
+    }
+  }
+
+  bool consume(char c) {
+    skip_ws();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char c) {
+    if (!consume(c)) {
+      fail(std::string("expected '") + c + "'");
+    }
+  }
+
+  bool consume_word(const std::string& word) {
+    if (text_.compare(pos_, word.size(), word) == 0) {
+      pos_ += word.size();
+      return true;
+    }
+    return false;
+  }
+
+  JsonValue value() {
+    skip_ws();
+    if (pos_ >= text_.size()) {
+      fail("unexpected end of input");
+    }
+    JsonValue v;
+    char c = text_[pos_];
+    if (c == '{') {
+      pos_++;
+      v.kind = JsonValue::Kind::kObject;
+      if (consume('}')) {
+        return v;
+      }
+      do {
+        skip_ws();
+        auto key = string();
+        expect(':');
+        v.obj[key] = value();
+      } while (consume(','));
+      expect('}');
+    } else if (c == '[') {
+      pos_++;
+      v.kind = JsonValue::Kind::kArray;
+      if (consume(']')) {
+        return v;
+      }
+      do {
+        v.arr.push_back(value());
+      } while (consume(','));
+      expect(']');
+    } else if (c == '"') {
+      v.kind = JsonValue::Kind::kString;
+      v.str = string();
+    } else if (consume_word("true")) {
+      v.kind = JsonValue::Kind::kBool;
+      v.b = true;
+    } else if (consume_word("false")) {
+      v.kind = JsonValue::Kind::kBool;
+    } else if (consume_word("null")) {
+      v.kind = JsonValue::Kind::kNull;
+    } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {
+      const char* start = text_.c_str() + pos_;
+      char* end = nullptr;
+      v.num = std::strtod(start, &end);
+      if (end == start) {
+        fail("invalid number");
+      }
+      v.kind = JsonValue::Kind::kNumber;
+      pos_ += end - start;
+    } else {
+      fail(std::string("unexpected character '") + c + "'");
+    }
+    return v;
+  }
+
+  std::string string() {
+    if (pos_ >= text_.size() || text_[pos_] != '"') {
+      fail("expected a string");
+    }
+    pos_++;
+    std::string s;
+    while (pos_ < text_.size() && text_[pos_] != '"') {
+      char c = text_[pos_++];
+      if (c == '\\') {
+        if (pos_ >= text_.size()) {
+          break;
+        }
+        char e = text_[pos_++];
+        switch (e) {
+          case 'n':
+            s.push_back('\n');
+            break;
+          case 't':
+            s.push_back('\t');
+            break;
+          case 'r':
+            s.push_back('\r');
+            break;
+          case 'b':
+            s.push_back('\b');
+            break;
+          case 'f':
+            s.push_back('\f');
+            break;
+          case 'u':
+            fail("unicode escapes are not supported");
+          default:
+            s.push_back(e);
+        }
+      } else {
+        s.push_back(c);
+      }
+    }
+    if (pos_ >= text_.size()) {
+      fail("unterminated string");
+    }
+    pos_++;
+    return s;
+  }
+
+  const std::string& text_;
+  size_t pos_ = 0;
+};
+
+const JsonValue* lookup(const JsonValue& model, const JsonValue* defaults, const std::string& key) {
+  auto it = model.obj.find(key);
+  if (it != model.obj.end()) {
+    return &it->second;
+  }
+  if (defaults) {
+    auto dit = defaults->obj.find(key);
+    if (dit != defaults->obj.end()) {
+      return &dit->second;
+    }
+  }
+  return nullptr;
+}
+
+void check_kind(const JsonValue& v, JsonValue::Kind kind, const std::string& key, const std::string& expected) {
+  if (v.kind != kind) {
+    throw std::runtime_error("Manifest setting \"" + key + "\" should be " + expected);
+  }
+}
+
+void read(const JsonValue& model, const JsonValue* defaults, const std::string& key, std::string& out) {
+  if (auto v = lookup(model, defaults, key)) {
+    check_kind(*v, JsonValue::Kind::kString, key, "a string");
+    out = v->str;
+  }
+}
+
+void read(const JsonValue& model, const JsonValue* defaults, const std::string& key, bool& out) {
+  if (auto v = lookup(model, defaults, key)) {
+    check_kind(*v, JsonValue::Kind::kBool, key, "true or false");
+    out = v->b;
+  }
+}
+
+void read(const JsonValue& model, const JsonValue* defaults, const std::string& key, uint64_t& out) {
+  if (auto v = lookup(model, defaults, key)) {
+    check_kind(*v, JsonValue::Kind::kNumber, key, "a number");
+    if (v->num < 0) {
+      throw std::runtime_error("Manifest setting \"" + key + "\" should not be negative");
+    }
+    out = static_cast<uint64_t>(v->num);
+  }
+}
+
+void read(const JsonValue& model, const JsonValue* defaults, const std::string& key, std::vector<std::string>& out) {
+  if (auto v = lookup(model, defaults, key)) {
+    check_kind(*v, JsonValue::Kind::kArray, key, "a list of strings");
+    out.clear();
+    for (const auto& e : v->arr) {
+      check_kind(e, JsonValue::Kind::kString, key, "a list of strings");
+      out.push_back(e.str);
+    }
+  }
+}
+
+std::string resolve(const std::string& path, const std::string& base_dir) {
+  if (path.empty() || base_dir.empty() || path[0] == '/') {
+    return path;
+  }
+  return base_dir + "/" + path;
+}
+
+std::string lower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+  return s;
+}
+
+uint64_t count_engines(const torch::jit::Module& mod) {
+  uint64_t num_engines = 0;
+  for (const auto& attr : mod.named_attributes(/*recurse=*/false)) {
+    if (attr.value.isCustomClass() && attr.value.type()->str() == "__torch__.torch.classes.tensorrt.Engine") {
+      num_engines++;
+    }
+  }
+  return num_engines;
+}
+} // namespace
+
+Manifest parse_manifest(const std::string& text, const std::string& base_dir) {
+  auto root = JsonParser(text).parse();
+  if (root.kind != JsonValue::Kind::kObject) {
+    throw std::runtime_error("A manifest should be a JSON object");
+  }
+
+  Manifest manifest;
+  read(root, nullptr, "jobs", manifest.jobs);
+  const JsonValue* defaults = nullptr;
+  auto dit = root.obj.find("defaults");
+  if (dit != root.obj.end()) {
+    check_kind(dit->second, JsonValue::Kind::kObject, "defaults", "an object");
+    defaults = &dit->second;
+  }
+
+  auto mit = root.obj.find("models");
+  if (mit == root.obj.end()) {
+    throw std::runtime_error("A manifest needs a \"models\" list");
+  }
+  check_kind(mit->second, JsonValue::Kind::kArray, "models", "a list of objects");
+  for (const auto& model : mit->second.arr) {
+    check_kind(model, JsonValue::Kind::kObject, "models", "a list of objects");
+    ModelJob job;
+    read(model, nullptr, "input", job.input_path);
+    read(model, nullptr, "output", job.output_path);
+    read(model, nullptr, "name", job.name);
+    auto where = "Model " + std::to_string(manifest.models.size()) + " of the manifest";
+    if (job.input_path.empty()) {
+      throw std::runtime_error(where + " needs an \"input\" path");
+    }
+    if (job.output_path.empty()) {
+      throw std::runtime_error(where + " needs an \"output\" path");
+    }
+    if (job.name.empty()) {
+      job.name = job.input_path;
+    }
+    job.input_path = resolve(job.input_path, base_dir);
+    job.output_path = resolve(job.output_path, base_dir);
+
+    read(model, defaults, "method", job.method);
+    read(model, defaults, "inputs", job.input_specs);
+    read(model, defaults, "enabled_precisions", job.enabled_precisions);
+    read(model, defaults, "device_type", job.device_type);
+    job.device_type = lower(job.device_type);
+    if (job.device_type != "gpu" && job.device_type != "dla") {
+      throw std::runtime_error("Invalid device type for " + job.name + ", options are [ gpu | dla ]");
+    }
+    read(model, defaults, "gpu_id", job.gpu_id);
+    read(model, defaults, "dla_core", job.dla_core);
+    read(model, defaults, "allow_gpu_fallback", job.allow_gpu_fallback);
+    read(model, defaults, "require_full_compilation", job.require_full_compilation);
+    read(model, defaults, "disable_tf32", job.disable_tf32);
+    read(model, defaults, "sparse_weights", job.sparse_weights);
+    read(model, defaults, "prune_sparse_weights", job.prune_sparse_weights);
+    read(model, defaults, "truncate_long_double", job.truncate_long_double);
+    read(model, defaults, "allow_shape_tensors", job.allow_shape_tensors);
+    read(model, defaults, "save_engine", job.save_engine);
+    read(model, defaults, "min_block_size", job.min_block_size);
+    read(model, defaults, "workspace_size", job.workspace_size);
+    read(model, defaults, "num_avg_timing_iters", job.num_avg_timing_iters);
+    read(model, defaults, "calibration_cache_file", job.calibration_cache_file);
+    job.calibration_cache_file = resolve(job.calibration_cache_file, base_dir);
+    read(model, defaults, "torch_executed_ops", job.torch_executed_ops);
+    read(model, defaults, "torch_executed_mods", job.torch_executed_mods);
+
+    for (const auto& p : job.enabled_precisions) {
+      auto dtype = parserutil::parse_dtype(p);
+      if (dtype != torchtrt::DataType::kFloat && dtype != torchtrt::DataType::kHalf &&
+          dtype != torchtrt::DataType::kChar) {
+        throw std::runtime_error(
+            "Invalid precision " + p + " for " + job.name +
+            ", options are [ float | float32 | f32 | fp32 | half | float16 | f16 | fp16 | char | int8 | i8 ]");
+      }
+    }
+    if (job.require_full_compilation && (!job.torch_executed_ops.empty() || !job.torch_executed_mods.empty())) {
+      throw std::runtime_error(
+          "Ops or modules to run in torch were provided for " + job.name + " but full compilation was requested");
+    }
+    manifest.models.push_back(std::move(job));
+  }
+  return manifest;
+}
+
+Manifest load_manifest(const std::string& path) {
+  std::ifstream f(path);
+  if (!f) {
+    throw std::runtime_error("Unable to read manifest " + path);
+  }
+  std::stringstream ss;
+  ss << f.rdbuf();
+  auto slash = path.find_last_of('/');
+  return parse_manifest(ss.str(), slash == std::string::npos ? "" : path.substr(0, slash));
+}
+
+torchtrt::ts::CompileSpec to_compile_spec(const ModelJob& job) {
+  std::vector<torchtrt::Input> inputs;
+  for (const auto& spec : job.input_specs) {
+    inputs.push_back(parserutil::parse_input(spec));
+  }
+  auto compile_settings = torchtrt::ts::CompileSpec(inputs);
+
+  compile_settings.device.gpu_id = job.gpu_id;
+  if (job.device_type == "dla") {
+    compile_settings.device.device_type = torchtrt::Device::DeviceType::kDLA;
+    compile_settings.device.dla_core = job.dla_core;
+  }
+  compile_settings.device.allow_gpu_fallback = job.allow_gpu_fallback;
+  compile_settings.require_full_compilation = job.require_full_compilation;
+  compile_settings.disable_tf32 = job.disable_tf32;
+  compile_settings.sparse_weights = job.sparse_weights;
+  compile_settings.prune_sparse_weights = job.prune_sparse_weights;
+  compile_settings.truncate_long_and_double = job.truncate_long_double;
+  compile_settings.allow_shape_tensors = job.allow_shape_tensors;
+  if (job.min_block_size) {
+    compile_settings.min_block_size = job.min_block_size;
+  }
+  if (job.workspace_size) {
+    compile_settings.workspace_size = job.workspace_size;
+  }
+  if (job.num_avg_timing_iters) {
+    compile_settings.num_avg_timing_iters = job.num_avg_timing_iters;
+  }
+  for (const auto& op : job.torch_executed_ops) {
+    compile_settings.torch_executed_ops.push_back(op);
+  }
+  for (const auto& mod : job.torch_executed_mods) {
+    compile_settings.torch_executed_modules.push_back(mod);
+  }
+
+  for (const auto& precision : job.enabled_precisions) {
+    auto dtype = parserutil::parse_dtype(precision);
+    if (dtype == torchtrt::DataType::kFloat) {
+      compile_settings.enabled_precisions.insert(torch::kF32);
+    } else if (dtype == torchtrt::DataType::kHalf) {
+      compile_settings.enabled_precisions.insert(torch::kF16);
+    } else if (dtype == torchtrt::DataType::kChar) {
+      compile_settings.enabled_precisions.insert(torch::kI8);
+      if (!job.calibration_cache_file.empty()) {
+        compile_settings.ptq_calibrator = torchtrt::ptq::make_int8_cache_calibrator(job.calibration_cache_file);
+      }
+    }
+  }
+  return compile_settings;
+}
+
+std::vector<JobResult> run_manifest(const Manifest& manifest, uint64_t num_jobs, JobFn fn) {
+  std::vector<JobResult> results(manifest.models.size());
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next++; i < manifest.models.size(); i = next++) {
+      const auto& job = manifest.models[i];
+      auto& result = results[i];
+      result.name = job.name;
+      auto start = std::chrono::high_resolution_clock::now();
+      try {
+        result.num_engines = fn(job);
+        result.success = true;
+      } catch (const std::exception& e) {
+        result.error = e.what();
+      }
+      auto end = std::chrono::high_resolution_clock::now();
+      result.seconds = std::chrono::duration<double>(end - start).count();
+
+      std::stringstream ss;
+      ss << "[" << i + 1 << "/" << manifest.models.size() << "] " << job.name
+         << (result.success ? " done in " : " failed after ") << result.seconds << "s";
+      torchtrt::logging::log(
+          result.success ? torchtrt::logging::Level::kINFO : torchtrt::logging::Level::kERROR, ss.str());
+    }
+  };
+
+  auto num_threads = std::max<uint64_t>(1, std::min<uint64_t>(num_jobs, manifest.models.size()));
+  std::vector<std::thread> threads;
+  for (uint64_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+  return results;
+}
+
+uint64_t compile_job(const ModelJob& job) {
+  auto compile_settings = to_compile_spec(job);
+  auto mod = torch::jit::load(job.input_path);
+  if (job.require_full_compilation && !torchtrt::ts::check_method_operator_support(mod, job.method)) {
+    throw std::runtime_error("Method " + job.method + " is not currently supported by Torch-TensorRT end to end");
+  }
+
+  if (job.save_engine) {
+    torchtrt::ts::convert_method_to_trt_engine_file(mod, job.method, compile_settings, job.output_path);
+    return 1;
+  }
+  TORCH_CHECK(job.method == "forward", "Only forward can be compiled into a TorchScript module, got ", job.method);
+  auto trt_mod = torchtrt::ts::compile(mod, compile_settings);
+  trt_mod.save(job.output_path);
+  return count_engines(trt_mod);
+}
+
+uint64_t check_job(const ModelJob& job) {
+  to_compile_spec(job);
+  auto mod = torch::jit::load(job.input_path);
+  TORCH_CHECK(mod.find_method(job.method), "Model has no method named ", job.method);
+  auto supported = torchtrt::ts::check_method_operator_support(mod, job.method);
+  if (!supported && job.require_full_compilation) {
+    throw std::runtime_error("Method " + job.method + " is not currently supported by Torch-TensorRT end to end");
+  }
+  torchtrt::logging::log(
+      torchtrt::logging::Level::kINFO,
+      job.name + (supported ? " is supported end to end" : " needs partial compilation"));
+  return 0;
+}
+
+std::string summarize(const std::vector<JobResult>& results, double wall_seconds) {
+  size_t name_width = 5;
+  for (const auto& r : results) {
+    name_width = std::max(name_width, r.name.size());
+  }
+
+  std::stringstream ss;
+  ss << std::left << std::setw(name_width) << "Model"
+     << "  Status  " << std::right << std::setw(10) << "Time (s)" << std::setw(9) << "Engines" << std::endl;
+  size_t num_failed = 0;
+  double total_seconds = 0;
+  for (const auto& r : results) {
+    ss << std::left << std::setw(name_width) << r.name << "  " << std::setw(6) << (r.success ? "OK" : "FAILED")
+       << "  " << std::right << std::setw(10) << std::fixed << std::setprecision(2) << r.seconds << std::setw(9)
+       << r.num_engines << std::endl;
+    if (!r.success) {
+      num_failed++;
+      ss << "    " << r.error << std::endl;
+    }
+    total_seconds += r.seconds;
+  }
+  ss << results.size() - num_failed << " of " << results.size() << " models compiled, " << num_failed
+     << " failed, " << std::fixed << std::setprecision(2) << total_seconds << "s of compilation in " << wall_seconds
+     << "s" << std::endl;
+  return ss.str();
+}
+
+} // namespace manifest
+} // namespace torchtrtc
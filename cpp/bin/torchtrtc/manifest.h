@@ -0,0 +1,94 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "torch_tensorrt/torch_tensorrt.h"
+
+namespace torchtrtc {
+namespace manifest {
+
+// Settings for compiling one model of a manifest, mirrors the command line options of torchtrtc
+struct ModelJob {
+  // Name the model is reported under, defaults to the input path
+  std::string name;
+  std::string input_path;
+  std::string output_path;
+  std::string method = "forward";
+  // Input specs in the same format as the positional input specs of torchtrtc
+  std::vector<std::string> input_specs;
+  std::vector<std::string> enabled_precisions;
+  std::string device_type = "gpu";
+  uint64_t gpu_id = 0;
+  uint64_t dla_core = 0;
+  bool allow_gpu_fallback = false;
+  bool require_full_compilation = false;
+  bool disable_tf32 = false;
+  bool sparse_weights = false;
+  bool prune_sparse_weights = false;
+  bool truncate_long_double = false;
+  bool allow_shape_tensors = false;
+  // Save the TensorRT engine instead of a TorchScript module
+  bool save_engine = false;
+  uint64_t min_block_size = 0;
+  uint64_t workspace_size = 0;
+  uint64_t num_avg_timing_iters = 0;
+  std::string calibration_cache_file;
+  std::vector<std::string> torch_executed_ops;
+  std::vector<std::string> torch_executed_mods;
+};
+
+struct Manifest {
+  std::vector<ModelJob> models;
+  // Number of models compiled concurrently
+  uint64_t jobs = 1;
+};
+
+// Parses a JSON manifest of the form
+//
+// {
+//   "jobs": 4,
+//   "defaults": { "enabled_precisions": ["fp16"], "min_block_size": 3 },
+//   "models": [
+//     { "name": "resnet50", "input": "resnet50.jit.pt", "output": "resnet50_trt.ts", "inputs": ["(1,3,224,224)"] }
+//   ]
+// }
+//
+// Settings under "defaults" apply to every model unless the model sets them itself. Relative paths are resolved
+// against base_dir. Throws std::runtime_error describing the first problem found
+Manifest parse_manifest(const std::string& text, const std::string& base_dir = "");
+
+// Reads and parses the manifest at path, relative paths in it are resolved against its directory
+Manifest load_manifest(const std::string& path);
+
+// Builds the compile spec of a model, the input specs are parsed as they are on the command line
+torchtrt::ts::CompileSpec to_compile_spec(const ModelJob& job);
+
+// Outcome of one model of a manifest
+struct JobResult {
+  std::string name;
+  bool success = false;
+  std::string error;
+  double seconds = 0;
+  // Number of TensorRT engines in the compiled module
+  uint64_t num_engines = 0;
+};
+
+// Compiles a model and returns the number of TensorRT engines produced, throws if the model cannot be compiled
+using JobFn = std::function<uint64_t(const ModelJob&)>;
+
+// Runs fn for every model of the manifest on up to num_jobs threads. A failing model does not stop the others, the
+// results are in the order of the manifest
+std::vector<JobResult> run_manifest(const Manifest& manifest, uint64_t num_jobs, JobFn fn);
+
+// Compiles the model and saves the result to its output path
+uint64_t compile_job(const ModelJob& job);
+
+// Only loads the model, builds its compile spec and checks its method is supported end to end, nothing is compiled
+uint64_t check_job(const ModelJob& job);
+
+// Per model compile time, engine count and errors followed by the totals of the run
+std::string summarize(const std::vector<JobResult>& results, double wall_seconds);
+
+} // namespace manifest
+} // namespace torchtrtc
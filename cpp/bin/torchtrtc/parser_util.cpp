@@ -63,11 +63,8 @@ std::vector<int64_t> parse_single_dim(std::string shape_str) {
     }
   }
 
-  torchtrt::logging::log(
-      torchtrt::logging::Level::kERROR,
+  throw std::runtime_error(
       "Shapes need dimensions delimited by comma in parentheses, \"(N,..,C,H,W)\"\n e.g \"(3,3,200,200)\"");
-  exit(1);
-  return {};
 }
 
 std::vector<std::vector<int64_t>> parse_dynamic_dim(std::string shape_str) {
@@ -89,10 +86,8 @@ std::vector<std::vector<int64_t>> parse_dynamic_dim(std::string shape_str) {
   shape.push_back(range);
 
   if (shape.size() != 3) {
-    torchtrt::logging::log(
-        torchtrt::logging::Level::kERROR,
+    throw std::runtime_error(
         "Dynamic shapes need three sets of dimensions delimited by semi-colons, \"[(MIN_N,..,MIN_C,MIN_H,MIN_W);(OPT_N,..,OPT_C,OPT_H,OPT_W);(MAX_N,..,MAX_C,MAX_H,MAX_W)]\"\n e.g \"[(3,3,100,100);(3,3,200,200);(3,3,300,300)]\"");
-    exit(1);
   }
 
   return shape;
@@ -116,13 +111,11 @@ torchtrt::Input parse_input(std::string spec) {
 
       auto parsed_dtype = parse_dtype(dtype);
       if (parsed_dtype == torchtrt::DataType::kUnknown) {
-        torchtrt::logging::log(torchtrt::logging::Level::kERROR, "Invalid datatype for input specification " + spec);
-        exit(1);
+        throw std::runtime_error("Invalid datatype for input specification " + spec);
       }
       auto parsed_format = parse_tensor_format(format);
       if (parsed_format == torchtrt::TensorFormat::kUnknown) {
-        torchtrt::logging::log(torchtrt::logging::Level::kERROR, "Invalid format for input specification " + spec);
-        exit(1);
+        throw std::runtime_error("Invalid format for input specification " + spec);
       }
       if (shapes.rfind("(", 0) == 0) {
         return torchtrt::Input(parse_single_dim(shapes), parsed_dtype, parsed_format);
@@ -130,8 +123,7 @@ torchtrt::Input parse_input(std::string spec) {
         auto dyn_shapes = parse_dynamic_dim(shapes);
         return torchtrt::Input(dyn_shapes[0], dyn_shapes[1], dyn_shapes[2], parsed_dtype, parsed_format);
       } else {
-        torchtrt::logging::log(torchtrt::logging::Level::kERROR, spec_err_str);
-        exit(1);
+        throw std::runtime_error(spec_err_str);
       }
       // THERE IS NO SPEC FOR FORMAT
     } else {
@@ -140,8 +132,7 @@ torchtrt::Input parse_input(std::string spec) {
 
       auto parsed_dtype = parse_dtype(dtype);
       if (parsed_dtype == torchtrt::DataType::kUnknown) {
-        torchtrt::logging::log(torchtrt::logging::Level::kERROR, "Invalid datatype for input specification " + spec);
-        exit(1);
+        throw std::runtime_error("Invalid datatype for input specification " + spec);
       }
       if (shapes.rfind("(", 0) == 0) {
         return torchtrt::Input(parse_single_dim(shapes), parsed_dtype);
@@ -149,8 +140,7 @@ torchtrt::Input parse_input(std::string spec) {
         auto dyn_shapes = parse_dynamic_dim(shapes);
         return torchtrt::Input(dyn_shapes[0], dyn_shapes[1], dyn_shapes[2], parsed_dtype);
       } else {
-        torchtrt::logging::log(torchtrt::logging::Level::kERROR, spec_err_str);
-        exit(1);
+        throw std::runtime_error(spec_err_str);
       }
     }
     // THERE IS A SPEC FOR FORMAT BUT NOT DTYPE
@@ -160,8 +150,7 @@ torchtrt::Input parse_input(std::string spec) {
 
     auto parsed_format = parse_tensor_format(format);
     if (parsed_format == torchtrt::TensorFormat::kUnknown) {
-      torchtrt::logging::log(torchtrt::logging::Level::kERROR, "Invalid format for input specification " + spec);
-      exit(1);
+      throw std::runtime_error("Invalid format for input specification " + spec);
     }
     if (shapes.rfind("(", 0) == 0) {
       return torchtrt::Input(parse_single_dim(shapes), parsed_format);
@@ -169,8 +158,7 @@ torchtrt::Input parse_input(std::string spec) {
       auto dyn_shapes = parse_dynamic_dim(shapes);
       return torchtrt::Input(dyn_shapes[0], dyn_shapes[1], dyn_shapes[2], parsed_format);
     } else {
-      torchtrt::logging::log(torchtrt::logging::Level::kERROR, spec_err_str);
-      exit(1);
+      throw std::runtime_error(spec_err_str);
     }
     // JUST SHAPE USE DEFAULT DTYPE
   } else {
@@ -180,8 +168,7 @@ torchtrt::Input parse_input(std::string spec) {
       auto dyn_shapes = parse_dynamic_dim(spec);
       return torchtrt::Input(dyn_shapes[0], dyn_shapes[1], dyn_shapes[2]);
     } else {
-      torchtrt::logging::log(torchtrt::logging::Level::kERROR, spec_err_str);
-      exit(1);
+      throw std::runtime_error(spec_err_str);
     }
   }
 }
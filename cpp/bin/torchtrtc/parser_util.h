@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 #include "NvInfer.h"
 #include "third_party/args/args.hpp"
@@ -27,7 +28,7 @@ std::vector<int64_t> parse_single_dim(std::string shape_str);
 // String to a vector of 3 dimension specs specs (each a vector of ints)
 std::vector<std::vector<int64_t>> parse_dynamic_dim(std::string shape_str);
 
-// String to a torchtrt::Input
+// String to a torchtrt::Input, throws std::runtime_error describing the expected format if the spec is invalid
 torchtrt::Input parse_input(std::string input_specs);
 
 } // namespace parserutil
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) NVIDIA Corporation.
+ * All rights reserved.
+ *
+ * This library is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "c10/cuda/CUDAStream.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch_tensorrt/macros.h"
+
+namespace torch_tensorrt {
+namespace torchscript {
+/**
+ * @brief Handle to values produced by work enqueued on a CUDA stream
+ *
+ * The values are returned as soon as the work producing them is enqueued, their contents are only valid once the
+ * event recorded after that work completed. Either block the host on it with wait or get, or keep the host running
+ * and order further work on another stream after it with wait_on.
+ */
+class AsyncResult {
+ public:
+  struct Impl;
+
+  TORCHTRT_API explicit AsyncResult(std::shared_ptr<Impl> impl);
+
+  /**
+   * @brief Whether the work producing the values completed, does not block
+   */
+  TORCHTRT_API bool ready() const;
+
+  /**
+   * @brief Blocks the host until the work producing the values completed
+   */
+  TORCHTRT_API void wait() const;
+
+  /**
+   * @brief Makes work enqueued on stream from now on wait for the values without blocking the host
+   *
+   * The memory of the values is also marked as used by stream so that it is not reused before that work completed
+   *
+   * @param stream: c10::cuda::CUDAStream - Stream the values are consumed on
+   */
+  TORCHTRT_API void wait_on(const c10::cuda::CUDAStream& stream) const;
+
+  /**
+   * @brief Blocks the host until the values are ready and returns them
+   */
+  TORCHTRT_API const std::vector<torch::jit::IValue>& get() const;
+
+  /**
+   * @brief The values without waiting for them, they may only be read by work ordered after them (see wait_on)
+   */
+  TORCHTRT_API const std::vector<torch::jit::IValue>& values() const;
+
+ private:
+  std::shared_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Runs a method of a module on stream instead of the current stream and returns without waiting for it
+ *
+ * TensorRT engines and the PyTorch ops of the module are enqueued on stream. The inputs are used after the work
+ * enqueued on the current stream so far, so tensors the caller just produced can be passed directly. An engine runs
+ * on one stream at a time, if it was last enqueued on another stream it starts once that call completed.
+ *
+ * ex.
+ * @code
+ * auto stream = c10::cuda::getStreamFromPool();
+ * auto result = torch_tensorrt::ts::run_async(trt_mod, {in}, stream);
+ * // ... prepare the next request on the host
+ * auto out = result.get()[0].toTensor();
+ * @endcode
+ *
+ * @param module: torch::jit::Module - Module to run (typically the result of torch_tensorrt::ts::compile)
+ * @param inputs: std::vector<torch::jit::IValue> - Arguments to the method
+ * @param stream: c10::cuda::CUDAStream - Stream to enqueue the method on
+ * @param method_name: std::string - Name of the method to run
+ *
+ * @return AsyncResult: The return value of the method as its only value
+ */
+TORCHTRT_API AsyncResult run_async(
+    torch::jit::Module& module,
+    std::vector<torch::jit::IValue> inputs,
+    const c10::cuda::CUDAStream& stream,
+    const std::string& method_name = "forward");
+
+/**
+ * @brief Runs requests through a sequence of stages, each enqueued on its own CUDA stream
+ *
+ * Stages are called on the host by submit and enqueue their work on the current stream, which is the stream of the
+ * stage while they run. Stage s of a request starts on the device after stage s - 1 of the same request, while
+ * requests go through each stage in the order they were submitted. Stage s of a request can therefore run at the
+ * same time as stage s + 1 of the request before it, ex. copying the next inputs to the GPU and postprocessing the
+ * previous outputs overlap the engines running on the current request.
+ *
+ * ex.
+ * @code
+ * torch_tensorrt::ts::StreamPipeline pipeline({
+ *     [](std::vector<torch::jit::IValue> in) -> std::vector<torch::jit::IValue> {
+ *       return {in[0].toTensor().to(torch::kCUDA, true)};
+ *     },
+ *     torch_tensorrt::ts::module_stage(trt_mod),
+ *     [](std::vector<torch::jit::IValue> out) -> std::vector<torch::jit::IValue> {
+ *       return {out[0].toTensor().softmax(1)};
+ *     }});
+ * for (auto& batch : batches) {
+ *   results.push_back(pipeline.submit({batch}));
+ * }
+ * pipeline.synchronize();
+ * @endcode
+ */
+class StreamPipeline {
+ public:
+  using Stage = std::function<std::vector<torch::jit::IValue>(std::vector<torch::jit::IValue>)>;
+
+  /**
+   * @brief Construct a new StreamPipeline with a stream from the pool of the current device for each stage
+   *
+   * @param stages: std::vector<Stage> - Stages in the order a request goes through them, each gets the values the
+   * previous one returned
+   * @param max_in_flight: int64_t - Number of requests which may be on the GPU at once, submit waits for the oldest one
+   * beyond that
+   */
+  TORCHTRT_API StreamPipeline(std::vector<Stage> stages, int64_t max_in_flight = 2);
+
+  /**
+   * @brief Construct a new StreamPipeline running stage i on streams[i]
+   */
+  TORCHTRT_API StreamPipeline(
+      std::vector<Stage> stages,
+      std::vector<c10::cuda::CUDAStream> streams,
+      int64_t max_in_flight = 2);
+
+  /**
+   * @brief Waits for every submitted request
+   */
+  TORCHTRT_API ~StreamPipeline();
+
+  StreamPipeline(const StreamPipeline&) = delete;
+  StreamPipeline& operator=(const StreamPipeline&) = delete;
+
+  /**
+   * @brief Enqueue every stage of a request
+   *
+   * @param inputs: std::vector<torch::jit::IValue> - Values passed to the first stage, they are used after the work
+   * enqueued on the current stream so far
+   *
+   * @return AsyncResult: Values returned by the last stage. Errors raised by a stage are thrown from submit
+   */
+  TORCHTRT_API AsyncResult submit(std::vector<torch::jit::IValue> inputs);
+
+  /**
+   * @brief Blocks the host until every submitted request completed
+   */
+  TORCHTRT_API void synchronize();
+
+  /**
+   * @brief Streams of the stages
+   */
+  TORCHTRT_API const std::vector<c10::cuda::CUDAStream>& streams() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Stage of a StreamPipeline which runs a method of a module
+ *
+ * The values given to the stage are the arguments of the method. If the method returns a tuple its elements are
+ * passed on to the next stage as separate values, otherwise its return value is the only value.
+ *
+ * @param module: torch::jit::Module - Module to run (typically the result of torch_tensorrt::ts::compile)
+ * @param method_name: std::string - Name of the method to run
+ */
+TORCHTRT_API StreamPipeline::Stage module_stage(torch::jit::Module module, std::string method_name = "forward");
+} // namespace torchscript
+} // namespace torch_tensorrt
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) NVIDIA Corporation.
+ * All rights reserved.
+ *
+ * This library is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "torch/csrc/jit/api/module.h"
+#include "torch_tensorrt/macros.h"
+#include "torch_tensorrt/torch_tensorrt.h"
+
+namespace torch_tensorrt {
+namespace torchscript {
+/**
+ * Settings for a BatchingExecutor
+ */
+struct BatchingSpec {
+  /**
+   * @brief Input specification the module was compiled with. The range of batch sizes the executor may run is
+   * derived from dimension 0 of these inputs (the largest min_shape[0] and the smallest max_shape[0])
+   */
+  GraphInputs graph_inputs;
+
+  /**
+   * Upper bound on the number of samples coalesced into a single call, 0 uses the max batch size of graph_inputs
+   */
+  uint64_t max_batch_size = 0;
+
+  /**
+   * Maximum amount of time the oldest queued request will wait for other requests before a partial batch is run
+   */
+  std::chrono::microseconds max_queue_delay = std::chrono::microseconds(1000);
+
+  /**
+   * Name of the method to run
+   */
+  std::string method_name = "forward";
+};
+
+/**
+ * @brief Coalesces concurrent requests into batches for a module compiled with a dynamic batch dimension
+ *
+ * Each request is the argument list of a single call to the wrapped method in which every tensor (including ones
+ * nested in tuples and lists) has the request's batch size as dimension 0. Queued requests with matching
+ * layouts are concatenated along dimension 0 until the max batch size is reached or the oldest request has waited
+ * max_queue_delay, the batch is padded to the minimum batch size of the input spec if needed, the method is run
+ * once and every tensor in the result is sliced back along dimension 0 to fulfill each request's future.
+ *
+ * ex.
+ * @code
+ * auto trt_mod = torch_tensorrt::ts::compile(mod, compile_spec);
+ * torch_tensorrt::ts::BatchingSpec batching_spec;
+ * batching_spec.graph_inputs = compile_spec.graph_inputs;
+ * torch_tensorrt::ts::BatchingExecutor executor(trt_mod, batching_spec);
+ * auto out = executor.submit({in}).get();
+ * @endcode
+ */
+class BatchingExecutor {
+ public:
+  /**
+   * @brief Construct a new BatchingExecutor and start its worker thread
+   *
+   * @param module: torch::jit::Module - Module to run (typically the result of torch_tensorrt::ts::compile)
+   * @param spec: BatchingSpec - Batching settings
+   */
+  TORCHTRT_API BatchingExecutor(torch::jit::Module module, BatchingSpec spec);
+
+  /**
+   * @brief Stops the worker thread after running all queued requests
+   */
+  TORCHTRT_API ~BatchingExecutor();
+
+  BatchingExecutor(const BatchingExecutor&) = delete;
+  BatchingExecutor& operator=(const BatchingExecutor&) = delete;
+
+  /**
+   * @brief Queue a request
+   *
+   * @param inputs: std::vector<torch::jit::IValue> - Arguments to the method for this request
+   *
+   * @return std::future<torch::jit::IValue>: Result of the method for this request's samples, or the error raised
+   * while running the batch the request was part of
+   */
+  TORCHTRT_API std::future<torch::jit::IValue> submit(std::vector<torch::jit::IValue> inputs);
+
+  /**
+   * @brief Largest number of samples run in a single call
+   */
+  int64_t max_batch_size() const {
+    return max_batch_size_;
+  }
+
+  /**
+   * @brief Smallest number of samples run in a single call, smaller batches are padded up to it
+   */
+  int64_t min_batch_size() const {
+    return min_batch_size_;
+  }
+
+  /**
+   * @brief Number of calls to the wrapped method made so far
+   */
+  TORCHTRT_API uint64_t num_batches_run();
+
+ private:
+  struct Request {
+    std::vector<torch::jit::IValue> inputs;
+    int64_t batch_size;
+    std::chrono::steady_clock::time_point enqueue_time;
+    std::promise<torch::jit::IValue> result;
+  };
+
+  void worker_loop();
+  void run_batch(std::vector<Request>& batch);
+
+  torch::jit::Module module_;
+  BatchingSpec spec_;
+  int64_t max_batch_size_;
+  int64_t min_batch_size_;
+  uint64_t num_batches_run_ = 0;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<Request> queue_;
+  bool stopping_ = false;
+  std::thread worker_;
+};
+} // namespace torchscript
+} // namespace torch_tensorrt
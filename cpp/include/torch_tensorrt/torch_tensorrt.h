@@ -10,9 +10,11 @@
 
 #include <cuda_runtime.h>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "torch/custom_class.h"
 
@@ -698,6 +700,40 @@ TORCHTRT_API void dump_build_info();
  */
 TORCHTRT_API void set_device(const int gpu_id);
 
+/**
+ * @brief Set the number of threads TensorRT engines are deserialized on while
+ * modules are loaded
+ *
+ * @param num_threads: size_t - Number of deserialization threads, 0 to
+ * deserialize each engine as it is loaded (default)
+ *
+ * With a non zero number of threads, loading a module (e.g. with
+ * torch::jit::load) only schedules the deserialization of its engines, which
+ * then runs concurrently on a bounded pool of threads. Running an engine
+ * waits for that engine alone, so the first call of a method can start before
+ * all of the engines of the module are ready. Errors deserializing an engine
+ * are reported when the engine is first used
+ */
+TORCHTRT_API void set_engine_load_threads(size_t num_threads);
+
+/**
+ * @brief Warm up the TensorRT engines of a compiled module
+ *
+ * @param module: torch::jit::Module - Module compiled with Torch-TensorRT
+ * (e.g. as loaded with torch::jit::load)
+ * @param iterations: int64_t - Number of runs at each shape
+ *
+ * Runs each engine of the module and its submodules on zeros at the min, opt
+ * and max shapes of its optimization profile. This moves lazy CUDA and
+ * TensorRT initialization and the growth of the CUDA caching allocator out of
+ * the first calls of the module. Throws if an engine fails to run, engines
+ * which ran report true from their is_ready method
+ *
+ * @return: std::string: Human readable report of the time each engine took at
+ * each shape
+ */
+TORCHTRT_API std::string warmup_engines(const torch::jit::Module& module, int64_t iterations = 3);
+
 namespace torchscript {
 /**
  * Settings data structure for Torch-TensorRT TorchScript compilation
@@ -776,6 +812,13 @@ struct CompileSpec {
    */
   bool sparse_weights = false;
 
+  /**
+   * Prune the weights of conv and FC layers to 2:4 structured sparsity by
+   * magnitude during lowering, implies sparse_weights. Changes the results of
+   * the model, use analyze_sparsity to check the error beforehand
+   */
+  bool prune_sparse_weights = false;
+
   /**
    * Build a refitable engine
    */
@@ -796,6 +839,20 @@ struct CompileSpec {
    */
   bool allow_shape_tensors = false;
 
+  /**
+   * Level (1 fastest to 9 smallest) the engines are compressed with when the
+   * compiled module is saved, 0 saves them uncompressed. Compressed engines are
+   * decompressed when the module is loaded
+   */
+  int64_t engine_compression_level = 0;
+
+  /**
+   * Precisions the layers converted from a node are constrained to, keyed by the name of the first output of the node
+   * in the lowered graph (e.g. as planned by plan_mixed_precision). Layers of other nodes can run in any of the enabled
+   * precisions
+   */
+  std::map<std::string, DataType> layer_precisions;
+
   /**
    * Target Device
    */
@@ -857,6 +914,32 @@ struct CompileSpec {
    * ``require_full_compilation`` is True
    */
   std::vector<std::string> torch_executed_modules;
+
+  /**
+   * Run modules which are partially compiled to TensorRT through a precompiled execution plan which calls engines and
+   * the PyTorch segments between them directly, instead of through the TorchScript interpreter
+   */
+  bool use_execution_plan = false;
+
+  /**
+   * Build structurally identical TensorRT segments (ex. repeated layers) once as a refittable engine and produce the
+   * engines of the others by refitting it with their weights, which shortens compilation. Refittable engines may run
+   * slower than engines built for their weights. Ignored for GPU engines which are not of the standard capability and
+   * when INT8 is enabled
+   */
+  bool refit_identical_segments = false;
+
+  /**
+   * Log a plan placing the tensors passed between the segments of partially compiled modules in a single reused
+   * arena, to estimate the memory the segments need. The plan is only reported, not applied
+   */
+  bool plan_segment_memory = false;
+
+  /**
+   * Infer the input shapes of the segments of partially compiled modules symbolically instead of running the segments
+   * on example inputs. Segments are still run if a shape cannot be inferred or the module modifies values in place
+   */
+  bool symbolic_shape_analysis = false;
 };
 
 /**
@@ -890,6 +973,57 @@ TORCHTRT_API bool check_method_operator_support(const torch::jit::Module& module
  */
 TORCHTRT_API torch::jit::Module compile(const torch::jit::Module& module, CompileSpec info);
 
+/**
+ * @brief Compile several methods of a TorchScript module for NVIDIA GPUs using TensorRT
+ *
+ * @param module: torch::jit::Module - Existing TorchScript module
+ * @param method_specs: std::map<std::string, CompileSpec> - Compilation settings of each method to compile, by
+ * method name (ex. {{"encode", encode_spec}, {"decode", decode_spec}})
+ *
+ * Compiles each method like compile does with forward, into a single new module. Graphs or TensorRT segments which
+ * are identical across methods, including their weights and input shapes, are built into a single engine which the
+ * methods share, so it is built and serialized only once, unless refit is enabled as each engine must then map to the
+ * parameters of its own graph or segment. Methods which do not run any operations in TensorRT are kept in the new
+ * module to run in PyTorch, with a warning.
+ *
+ * @return: A new module with the compiled methods
+ */
+TORCHTRT_API torch::jit::Module compile(
+    const torch::jit::Module& module,
+    const std::map<std::string, CompileSpec>& method_specs);
+
+/**
+ * @brief Compile the methods of several TorchScript modules for NVIDIA GPUs using TensorRT in one call
+ *
+ * @param modules: std::vector<std::pair<torch::jit::Module, std::map<std::string, CompileSpec>>> - Each module along
+ * with the compilation settings of the methods to compile
+ *
+ * Like compiling each module separately, except that identical graphs or TensorRT segments across all of the methods
+ * of all of the modules (ex. a backbone shared by several model variants) are built once and the compiled modules
+ * share the engine. Modules compiled with refit enabled do not share engines, with other modules or between their
+ * own methods and segments.
+ *
+ * @return: The compiled modules, in the same order
+ */
+TORCHTRT_API std::vector<torch::jit::Module> compile(
+    const std::vector<std::pair<torch::jit::Module, std::map<std::string, CompileSpec>>>& modules);
+
+/**
+ * @brief Update the weights of a compiled module without recompiling it
+ *
+ * @param module: torch::jit::Module - Module returned by torch_tensorrt::ts::compile with refit enabled in its
+ * CompileSpec
+ * @param new_state_dict: std::unordered_map<std::string, at::Tensor> - New values of the parameters and buffers of
+ * the original module, by name (ex. "conv1.weight")
+ *
+ * Refits the TensorRT engines embedded in the module in place with the new parameter values, using the mapping from
+ * parameter names to TensorRT weights recorded during compilation. Parameters which were folded into other weights
+ * during compilation (ex. batch norm statistics) or are used by operations run in PyTorch cannot be updated this way,
+ * a warning is logged for each of them. Throws if an engine requires weights that cannot be derived from
+ * new_state_dict.
+ */
+TORCHTRT_API void refit(torch::jit::Module& module, const std::unordered_map<std::string, at::Tensor>& new_state_dict);
+
 /**
  * @brief Compile a TorchScript method for NVIDIA GPUs using TensorRT
  *
@@ -909,6 +1043,128 @@ TORCHTRT_API std::string convert_method_to_trt_engine(
     std::string method_name,
     CompileSpec info);
 
+/**
+ * @brief Compile a TorchScript method for NVIDIA GPUs using TensorRT and write
+ * the serialized engine to a file
+ *
+ * @param module: torch::jit::Module - Existing TorchScript module
+ * @param method_name: std::string - Name of method to compile
+ * @param info: torch_tensorrt::CompileSpec - Compilation settings
+ * @param path: std::string - File to write the serialized TensorRT engine to
+ *
+ * Same as convert_method_to_trt_engine, but the engine is written to disk in
+ * chunks directly from the memory TensorRT serialized it to instead of being
+ * copied into a string. Use for engines too large to hold several copies of
+ * in host memory. The file is only replaced once the engine has been fully
+ * written
+ */
+TORCHTRT_API void convert_method_to_trt_engine_file(
+    const torch::jit::Module& module,
+    std::string method_name,
+    CompileSpec info,
+    const std::string& path);
+
+/**
+ * @brief Algorithm used to select the dynamic range of each tensor in a
+ * calibration cache
+ */
+enum class CalibrationAlgorithm : int8_t {
+  /// KL divergence based selection, read by nvinfer1::IInt8EntropyCalibrator2
+  kENTROPY,
+  /// Largest absolute value, read by nvinfer1::IInt8MinMaxCalibrator
+  kMINMAX,
+};
+
+/**
+ * @brief Collect the activation ranges of a TorchScript method on CPU and
+ * write them as a TensorRT calibration cache
+ *
+ * @param module: torch::jit::Module - Existing TorchScript module
+ * @param method_name: std::string - Name of method to calibrate
+ * @param info: torch_tensorrt::CompileSpec - Compilation settings the method
+ * will be compiled with
+ * @param batches: std::vector<std::vector<torch::jit::IValue>> - Calibration
+ * data, the inputs of one call of the method per batch
+ * @param cache_file_path: std::string - File to write the calibration cache to
+ * @param algorithm: CalibrationAlgorithm - Range selection algorithm
+ * (Default: kENTROPY)
+ * @param num_threads: size_t - Number of threads batches are run on, 0 to use
+ * the number of intra-op threads (Default: 0)
+ *
+ * The method is lowered the same way it is for compilation and run on CPU,
+ * batches split between threads. A histogram of the activations is kept for
+ * the inputs and outputs of the method and every tensor computed in it, which
+ * TensorRT tensors are named after. The cache can then be read by a calibrator
+ * of the same algorithm (e.g.
+ * ``torch_tensorrt::ptq::make_int8_cache_calibrator<nvinfer1::IInt8MinMaxCalibrator>(cache_file_path)``)
+ * to build an INT8 engine without a calibration pass on the GPU. Tensors
+ * without an entry in the cache, such as intermediate tensors of converters
+ * adding several layers or those of methods only partially compiled, are not
+ * run in INT8
+ */
+TORCHTRT_API void write_calibration_cache(
+    const torch::jit::Module& module,
+    std::string method_name,
+    CompileSpec info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches,
+    const std::string& cache_file_path,
+    CalibrationAlgorithm algorithm = CalibrationAlgorithm::kENTROPY,
+    size_t num_threads = 0);
+
+/**
+ * @brief Find the layers of a TorchScript method which have to stay in FP32
+ * when it is compiled with FP16 enabled
+ *
+ * @param module: torch::jit::Module - Existing TorchScript module
+ * @param method_name: std::string - Name of method to plan
+ * @param info: torch_tensorrt::CompileSpec - Compilation settings the method
+ * will be compiled with
+ * @param batches: std::vector<std::vector<torch::jit::IValue>> - Sample data,
+ * the inputs of one call of the method per batch
+ * @param tolerance: double - Largest error of the outputs of a node relative
+ * to their magnitude in FP32 for it to run in FP16 (Default: 1e-2)
+ *
+ * The method is lowered the same way it is for compilation and run on CPU in
+ * FP32. Each node is then run again on the FP32 values of its inputs with its
+ * inputs, weights and outputs rounded to FP16, so the error of a node does not
+ * include the error of the nodes before it. Nodes which overflow FP16 or whose
+ * error exceeds the tolerance are constrained to FP32
+ *
+ * @return: std::map<std::string, DataType>: Constraints to set as
+ * ``CompileSpec::layer_precisions``
+ */
+TORCHTRT_API std::map<std::string, DataType> plan_mixed_precision(
+    const torch::jit::Module& module,
+    std::string method_name,
+    CompileSpec info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches,
+    double tolerance = 1e-2);
+
+/**
+ * @brief Report which conv and FC layers of a TorchScript method meet the 2:4
+ * structured sparsity pattern TensorRT needs to use sparse kernels
+ *
+ * @param module: torch::jit::Module - Existing TorchScript module
+ * @param method_name: std::string - Name of method to analyze
+ * @param info: torch_tensorrt::CompileSpec - Compilation settings the method
+ * will be compiled with
+ * @param batches: std::vector<std::vector<torch::jit::IValue>> - Sample data,
+ * the inputs of one call of the method per batch
+ *
+ * The method is lowered the same way it is for compilation and run on CPU.
+ * For each layer the report lists the groups of weights which are not 2:4
+ * sparse and the share of the FLOPs of the layer, followed by the error of the
+ * outputs when the weights are pruned as with prune_sparse_weights relative to
+ * the dense outputs
+ *
+ * @return: std::string: Human readable report
+ */
+TORCHTRT_API std::string analyze_sparsity(
+    const torch::jit::Module& module,
+    std::string method_name,
+    CompileSpec info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches);
+
 /**
  * @brief Take a previously created TensorRT engine and embed it in
  * in a TorchScript module
@@ -936,5 +1192,27 @@ TORCHTRT_API torch::jit::Module embed_engine_in_new_module(
     Device device,
     const std::vector<std::string>& input_binding_names = std::vector<std::string>(),
     const std::vector<std::string>& output_binding_names = std::vector<std::string>());
+
+/**
+ * @brief Take a TensorRT engine previously written to a file and embed it in
+ * a TorchScript module
+ *
+ * @param path: std::string - File holding a pre-built serialized TensorRT engine
+ * @param device: CompileSepc::Device - Device information
+ * @param input_binding_names: std::vector<std::string> - Name of TensorRT bindings in order passed in by original
+ * PyTorch function (defaults to assuming convention below)
+ * @param output_binding_names: std::vector<std::string> - Name of TensorRT bindings in order returned by original
+ * PyTorch function (defaults to assuming convention below)
+ *
+ * Same as embed_engine_in_new_module, but the engine file is memory mapped
+ * while it is deserialized rather than read into host memory
+ *
+ * @return: A new module targeting a TensorRT engine
+ */
+TORCHTRT_API torch::jit::Module embed_engine_file_in_new_module(
+    const std::string& path,
+    Device device,
+    const std::vector<std::string>& input_binding_names = std::vector<std::string>(),
+    const std::vector<std::string>& output_binding_names = std::vector<std::string>());
 } // namespace torchscript
 } // namespace torch_tensorrt
@@ -0,0 +1,108 @@
+#include "core/runtime/runtime.h"
+#include "core/util/prelude.h"
+
+#include "torch_tensorrt/async.h"
+
+namespace torch_tensorrt {
+namespace torchscript {
+namespace {
+using Backend = torch_tensorrt::core::runtime::CUDAStreamBackend;
+using CorePipeline = torch_tensorrt::core::runtime::StreamPipeline<Backend>;
+
+std::vector<c10::cuda::CUDAStream> streams_from_pool(size_t num_streams) {
+  std::vector<c10::cuda::CUDAStream> streams;
+  for (size_t i = 0; i < num_streams; i++) {
+    streams.push_back(c10::cuda::getStreamFromPool());
+  }
+  return streams;
+}
+} // namespace
+
+struct AsyncResult::Impl {
+  torch_tensorrt::core::runtime::AsyncEngineResult result;
+};
+
+AsyncResult::AsyncResult(std::shared_ptr<Impl> impl) : impl_(std::move(impl)) {}
+
+bool AsyncResult::ready() const {
+  return impl_->result.ready();
+}
+
+void AsyncResult::wait() const {
+  impl_->result.wait();
+}
+
+void AsyncResult::wait_on(const c10::cuda::CUDAStream& stream) const {
+  impl_->result.wait_on(stream);
+}
+
+const std::vector<torch::jit::IValue>& AsyncResult::get() const {
+  return impl_->result.get();
+}
+
+const std::vector<torch::jit::IValue>& AsyncResult::values() const {
+  return impl_->result.values();
+}
+
+AsyncResult run_async(
+    torch::jit::Module& module,
+    std::vector<torch::jit::IValue> inputs,
+    const c10::cuda::CUDAStream& stream,
+    const std::string& method_name) {
+  auto method = module.get_method(method_name);
+  auto result = torch_tensorrt::core::runtime::RunAsync<Backend>(stream, inputs, [&]() {
+    return torch_tensorrt::core::runtime::AsyncValues{method(std::move(inputs))};
+  });
+  return AsyncResult(std::make_shared<AsyncResult::Impl>(AsyncResult::Impl{std::move(result)}));
+}
+
+struct StreamPipeline::Impl {
+  Impl(std::vector<CorePipeline::Stage> stages, std::vector<c10::cuda::CUDAStream> streams, size_t max_in_flight)
+      : pipeline(std::move(stages), std::move(streams), max_in_flight) {}
+  CorePipeline pipeline;
+};
+
+StreamPipeline::StreamPipeline(std::vector<Stage> stages, int64_t max_in_flight)
+    : StreamPipeline(stages, streams_from_pool(stages.size()), max_in_flight) {}
+
+StreamPipeline::StreamPipeline(
+    std::vector<Stage> stages,
+    std::vector<c10::cuda::CUDAStream> streams,
+    int64_t max_in_flight) {
+  TORCHTRT_CHECK(max_in_flight >= 1, "A stream pipeline has to allow at least one request in flight");
+  impl_ = std::make_unique<Impl>(std::move(stages), std::move(streams), static_cast<size_t>(max_in_flight));
+}
+
+StreamPipeline::~StreamPipeline() {
+  try {
+    impl_->pipeline.synchronize();
+  } catch (const std::exception& e) {
+    LOG_ERROR("Error while waiting for the requests of a stream pipeline: " << e.what());
+  }
+}
+
+AsyncResult StreamPipeline::submit(std::vector<torch::jit::IValue> inputs) {
+  auto result = impl_->pipeline.submit(std::move(inputs));
+  return AsyncResult(std::make_shared<AsyncResult::Impl>(AsyncResult::Impl{std::move(result)}));
+}
+
+void StreamPipeline::synchronize() {
+  impl_->pipeline.synchronize();
+}
+
+const std::vector<c10::cuda::CUDAStream>& StreamPipeline::streams() const {
+  return impl_->pipeline.streams();
+}
+
+StreamPipeline::Stage module_stage(torch::jit::Module module, std::string method_name) {
+  return [module, method_name](std::vector<torch::jit::IValue> inputs) mutable {
+    auto output = module.get_method(method_name)(std::move(inputs));
+    if (output.isTuple()) {
+      const auto& elements = output.toTupleRef().elements();
+      return std::vector<torch::jit::IValue>(elements.begin(), elements.end());
+    }
+    return std::vector<torch::jit::IValue>{std::move(output)};
+  };
+}
+} // namespace torchscript
+} // namespace torch_tensorrt
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <limits>
+
+#include "core/util/prelude.h"
+
+#include "torch_tensorrt/batching.h"
+
+namespace torch_tensorrt {
+namespace torchscript {
+namespace {
+void collect_input_specs(const torch::jit::IValue& input_signature, std::vector<Input>& inputs) {
+  if (input_signature.isTuple()) {
+    for (const auto& item : input_signature.toTupleRef().elements()) {
+      collect_input_specs(item, inputs);
+    }
+  } else if (input_signature.isList()) {
+    for (const auto& item : input_signature.toListRef()) {
+      collect_input_specs(item, inputs);
+    }
+  } else if (input_signature.isCustomClass()) {
+    inputs.push_back(*(input_signature.toCustomClass<Input>()));
+  }
+}
+
+void collect_batch_sizes(const torch::jit::IValue& value, std::vector<int64_t>& batch_sizes) {
+  if (value.isTensor()) {
+    auto& tensor = value.toTensor();
+    TORCHTRT_CHECK(tensor.dim() > 0, "Batched requests may not contain 0-dimensional tensors");
+    batch_sizes.push_back(tensor.size(0));
+  } else if (value.isTuple()) {
+    for (const auto& item : value.toTupleRef().elements()) {
+      collect_batch_sizes(item, batch_sizes);
+    }
+  } else if (value.isList()) {
+    for (const auto& item : value.toListRef()) {
+      collect_batch_sizes(item, batch_sizes);
+    }
+  }
+}
+
+// Two requests can share a batch if every tensor matches in everything but dimension 0 and all other values are
+// equal
+bool is_batch_compatible(const torch::jit::IValue& a, const torch::jit::IValue& b) {
+  if (a.isTensor() && b.isTensor()) {
+    auto& a_tensor = a.toTensor();
+    auto& b_tensor = b.toTensor();
+    return a_tensor.scalar_type() == b_tensor.scalar_type() && a_tensor.device() == b_tensor.device() &&
+        a_tensor.dim() == b_tensor.dim() && a_tensor.sizes().slice(1) == b_tensor.sizes().slice(1);
+  } else if (a.isTuple() && b.isTuple()) {
+    auto& a_elements = a.toTupleRef().elements();
+    auto& b_elements = b.toTupleRef().elements();
+    if (a_elements.size() != b_elements.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < a_elements.size(); ++i) {
+      if (!is_batch_compatible(a_elements[i], b_elements[i])) {
+        return false;
+      }
+    }
+    return true;
+  } else if (a.isList() && b.isList()) {
+    auto a_list = a.toListRef();
+    auto b_list = b.toListRef();
+    if (a_list.size() != b_list.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < a_list.size(); ++i) {
+      if (!is_batch_compatible(a_list[i], b_list[i])) {
+        return false;
+      }
+    }
+    return true;
+  } else if (a.isTensor() || b.isTensor() || a.isTuple() || b.isTuple() || a.isList() || b.isList()) {
+    return false;
+  }
+  return a == b;
+}
+
+bool is_batch_compatible(const std::vector<torch::jit::IValue>& a, const std::vector<torch::jit::IValue>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (!is_batch_compatible(a[i], b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Concatenates the corresponding values of each request along dimension 0, appending padding zero samples
+torch::jit::IValue concat_batch(const std::vector<torch::jit::IValue>& values, int64_t padding) {
+  const auto& first = values[0];
+  if (first.isTensor()) {
+    std::vector<at::Tensor> tensors;
+    for (const auto& v : values) {
+      tensors.push_back(v.toTensor());
+    }
+    if (padding > 0) {
+      auto pad_shape = first.toTensor().sizes().vec();
+      pad_shape[0] = padding;
+      tensors.push_back(at::zeros(pad_shape, first.toTensor().options()));
+    }
+    return at::cat(tensors, 0);
+  } else if (first.isTuple()) {
+    std::vector<torch::jit::IValue> elements;
+    for (size_t i = 0; i < first.toTupleRef().elements().size(); ++i) {
+      std::vector<torch::jit::IValue> items;
+      for (const auto& v : values) {
+        items.push_back(v.toTupleRef().elements()[i]);
+      }
+      elements.push_back(concat_batch(items, padding));
+    }
+    return c10::ivalue::Tuple::create(elements);
+  } else if (first.isList()) {
+    auto list = c10::impl::GenericList(first.toList().elementType());
+    for (size_t i = 0; i < first.toListRef().size(); ++i) {
+      std::vector<torch::jit::IValue> items;
+      for (const auto& v : values) {
+        items.push_back(v.toListRef()[i]);
+      }
+      list.push_back(concat_batch(items, padding));
+    }
+    return list;
+  }
+  return first;
+}
+
+// Extracts the samples [offset, offset + batch_size) from every tensor in a batched result
+torch::jit::IValue slice_batch(const torch::jit::IValue& value, int64_t offset, int64_t batch_size, int64_t total) {
+  if (value.isTensor()) {
+    auto& tensor = value.toTensor();
+    TORCHTRT_CHECK(
+        tensor.dim() > 0 && tensor.size(0) == total,
+        "Expected every tensor returned by a batched call to have " << total << " samples in dimension 0, found "
+                                                                    << tensor.sizes());
+    return tensor.narrow(0, offset, batch_size);
+  } else if (value.isTuple()) {
+    std::vector<torch::jit::IValue> elements;
+    for (const auto& item : value.toTupleRef().elements()) {
+      elements.push_back(slice_batch(item, offset, batch_size, total));
+    }
+    return c10::ivalue::Tuple::create(elements);
+  } else if (value.isList()) {
+    auto list = c10::impl::GenericList(value.toList().elementType());
+    for (const auto& item : value.toListRef()) {
+      list.push_back(slice_batch(item, offset, batch_size, total));
+    }
+    return list;
+  }
+  return value;
+}
+} // namespace
+
+BatchingExecutor::BatchingExecutor(torch::jit::Module module, BatchingSpec spec)
+    : module_(std::move(module)), spec_(std::move(spec)) {
+  std::vector<Input> inputs = spec_.graph_inputs.inputs;
+  if (inputs.empty()) {
+    collect_input_specs(spec_.graph_inputs.input_signature, inputs);
+  }
+
+  max_batch_size_ = std::numeric_limits<int64_t>::max();
+  min_batch_size_ = 1;
+  for (const auto& in : inputs) {
+    TORCHTRT_CHECK(
+        !in.min_shape.empty() && !in.max_shape.empty(), "Batching requires every input spec to have a batch dimension");
+    max_batch_size_ = std::min(max_batch_size_, in.max_shape[0]);
+    min_batch_size_ = std::max(min_batch_size_, in.min_shape[0]);
+  }
+
+  if (spec_.max_batch_size > 0) {
+    TORCHTRT_CHECK(
+        inputs.empty() || static_cast<int64_t>(spec_.max_batch_size) <= max_batch_size_,
+        "Requested max batch size " << spec_.max_batch_size << " exceeds the max batch size supported by the inputs ("
+                                    << max_batch_size_ << ")");
+    max_batch_size_ = spec_.max_batch_size;
+  }
+  TORCHTRT_CHECK(
+      !inputs.empty() || spec_.max_batch_size > 0,
+      "Either input specs or an explicit max batch size are required to batch requests");
+  TORCHTRT_CHECK(
+      min_batch_size_ <= max_batch_size_,
+      "Min batch size (" << min_batch_size_ << ") is larger than max batch size (" << max_batch_size_ << ")");
+
+  LOG_DEBUG(
+      "Batching requests to method " << spec_.method_name << " into batches of " << min_batch_size_ << " to "
+                                     << max_batch_size_ << " samples");
+  worker_ = std::thread([this]() { worker_loop(); });
+}
+
+BatchingExecutor::~BatchingExecutor() {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+std::future<torch::jit::IValue> BatchingExecutor::submit(std::vector<torch::jit::IValue> inputs) {
+  std::vector<int64_t> batch_sizes;
+  for (const auto& in : inputs) {
+    collect_batch_sizes(in, batch_sizes);
+  }
+  TORCHTRT_CHECK(!batch_sizes.empty(), "Batched requests must contain at least one tensor");
+  TORCHTRT_CHECK(
+      std::all_of(batch_sizes.begin(), batch_sizes.end(), [&](int64_t b) { return b == batch_sizes[0]; }),
+      "All tensors in a batched request must have the same size in dimension 0, found "
+          << c10::ArrayRef<int64_t>(batch_sizes));
+  TORCHTRT_CHECK(
+      batch_sizes[0] > 0 && batch_sizes[0] <= max_batch_size_,
+      "Request batch size " << batch_sizes[0] << " is outside of the supported range [1, " << max_batch_size_ << "]");
+
+  Request request;
+  request.inputs = std::move(inputs);
+  request.batch_size = batch_sizes[0];
+  request.enqueue_time = std::chrono::steady_clock::now();
+  auto result = request.result.get_future();
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    TORCHTRT_CHECK(!stopping_, "Cannot submit requests to a BatchingExecutor which is shutting down");
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+  return result;
+}
+
+uint64_t BatchingExecutor::num_batches_run() {
+  std::unique_lock<std::mutex> lock(mu_);
+  return num_batches_run_;
+}
+
+void BatchingExecutor::worker_loop() {
+  // Number of samples in the requests at the front of the queue which can run together
+  auto coalescable_samples = [this]() {
+    int64_t samples = 0;
+    for (const auto& r : queue_) {
+      if (samples + r.batch_size > max_batch_size_ || !is_batch_compatible(queue_.front().inputs, r.inputs)) {
+        break;
+      }
+      samples += r.batch_size;
+    }
+    return samples;
+  };
+
+  while (true) {
+    std::vector<Request> batch;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+
+      // Wait for the batch to fill up, but never let the oldest request wait past its deadline
+      auto deadline = queue_.front().enqueue_time + spec_.max_queue_delay;
+      while (!stopping_ && coalescable_samples() < max_batch_size_) {
+        if (cv_.wait_until(lock, deadline) == std::cv_status::timeout) {
+          break;
+        }
+      }
+
+      int64_t samples = coalescable_samples();
+      while (samples > 0) {
+        samples -= queue_.front().batch_size;
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+    }
+    run_batch(batch);
+  }
+}
+
+void BatchingExecutor::run_batch(std::vector<Request>& batch) {
+  int64_t samples = 0;
+  for (const auto& r : batch) {
+    samples += r.batch_size;
+  }
+  int64_t padding = std::max(min_batch_size_ - samples, (int64_t)0);
+
+  std::vector<torch::jit::IValue> results;
+  try {
+    std::vector<torch::jit::IValue> batched_inputs;
+    for (size_t i = 0; i < batch[0].inputs.size(); ++i) {
+      std::vector<torch::jit::IValue> args;
+      for (const auto& r : batch) {
+        args.push_back(r.inputs[i]);
+      }
+      batched_inputs.push_back(concat_batch(args, padding));
+    }
+
+    LOG_DEBUG("Running batch of " << batch.size() << " requests (" << samples << " samples, " << padding << " padding)");
+    auto batched_output = module_.get_method(spec_.method_name)(batched_inputs);
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      num_batches_run_++;
+    }
+
+    int64_t offset = 0;
+    for (const auto& r : batch) {
+      results.push_back(slice_batch(batched_output, offset, r.batch_size, samples + padding));
+      offset += r.batch_size;
+    }
+  } catch (...) {
+    for (auto& r : batch) {
+      r.result.set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    batch[i].result.set_value(std::move(results[i]));
+  }
+}
+
+} // namespace torchscript
+} // namespace torch_tensorrt
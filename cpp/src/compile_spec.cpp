@@ -87,12 +87,23 @@ torchtrt::core::CompileSpec to_internal_compile_spec(CompileSpec external, bool
     internal.convert_info.engine_settings.enabled_precisions.insert(toTRTDataType(p));
   }
 
-  internal.convert_info.engine_settings.sparse_weights = external.sparse_weights;
+  for (const auto& p : external.layer_precisions) {
+    internal.convert_info.engine_settings.layer_precisions[p.first] = toTRTDataType(p.second);
+  }
+
+  internal.lower_info.prune_sparse_weights = external.prune_sparse_weights;
+  internal.convert_info.engine_settings.sparse_weights = external.sparse_weights || external.prune_sparse_weights;
   internal.convert_info.engine_settings.disable_tf32 = external.disable_tf32;
   internal.convert_info.engine_settings.refit = external.refit;
   internal.convert_info.engine_settings.debug = external.debug;
   internal.convert_info.engine_settings.truncate_long_and_double = external.truncate_long_and_double;
   internal.convert_info.engine_settings.allow_shape_tensors = external.allow_shape_tensors;
+  TORCHTRT_CHECK(
+      external.engine_compression_level >= 0 &&
+          external.engine_compression_level <= torchtrt::core::util::ENGINE_COMPRESSION_LEVEL_MAX,
+      "Engine compression level must be between 0 and " << torchtrt::core::util::ENGINE_COMPRESSION_LEVEL_MAX
+                                                        << ", got " << external.engine_compression_level);
+  internal.convert_info.engine_settings.engine_compression_level = external.engine_compression_level;
   internal.convert_info.engine_settings.device.allow_gpu_fallback = external.device.allow_gpu_fallback;
   internal.lower_info.target_device.allow_gpu_fallback = external.device.allow_gpu_fallback;
   internal.partitioning_info.target_device.allow_gpu_fallback = external.device.allow_gpu_fallback;
@@ -111,6 +122,10 @@ torchtrt::core::CompileSpec to_internal_compile_spec(CompileSpec external, bool
   internal.partitioning_info.min_block_size = external.min_block_size;
   internal.partitioning_info.forced_fallback_operators = std::move(external.torch_executed_ops);
   internal.partitioning_info.truncate_long_and_double = external.truncate_long_and_double;
+  internal.partitioning_info.use_execution_plan = external.use_execution_plan;
+  internal.partitioning_info.refit_identical_segments = external.refit_identical_segments;
+  internal.partitioning_info.plan_segment_memory = external.plan_segment_memory;
+  internal.partitioning_info.symbolic_shape_analysis = external.symbolic_shape_analysis;
   internal.lower_info.forced_fallback_modules = std::move(external.torch_executed_modules);
 
   switch (external.device.device_type) {
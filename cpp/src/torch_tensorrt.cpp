@@ -1,6 +1,12 @@
 #include "torch/csrc/jit/api/module.h"
 
+#include <fstream>
+#include <sstream>
+
 #include "core/compiler.h"
+#include "core/ptq/calibration.h"
+#include "core/ptq/mixed_precision.h"
+#include "core/ptq/sparsity.h"
 #include "core/util/prelude.h"
 
 #include "torch_tensorrt/torch_tensorrt.h"
@@ -16,6 +22,10 @@ bool check_method_operator_support(const torch::jit::script::Module& module, std
   return torch_tensorrt::core::CheckMethodOperatorSupport(module, method_name);
 }
 
+void refit(torch::jit::Module& module, const std::unordered_map<std::string, at::Tensor>& new_state_dict) {
+  torch_tensorrt::core::RefitModule(module, new_state_dict);
+}
+
 std::string convert_method_to_trt_engine(
     const torch::jit::script::Module& module,
     std::string method_name,
@@ -27,6 +37,75 @@ std::string convert_method_to_trt_engine(
       module, method_name, to_internal_compile_spec(info, /*bool converting_to_trt_engine=*/true));
 }
 
+void convert_method_to_trt_engine_file(
+    const torch::jit::script::Module& module,
+    std::string method_name,
+    CompileSpec info,
+    const std::string& path) {
+  LOG_DEBUG(get_build_info());
+  torch_tensorrt::core::ConvertGraphToTRTEngineFile(
+      module, method_name, to_internal_compile_spec(info, /*bool converting_to_trt_engine=*/true), path);
+}
+
+void write_calibration_cache(
+    const torch::jit::script::Module& module,
+    std::string method_name,
+    CompileSpec info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches,
+    const std::string& cache_file_path,
+    CalibrationAlgorithm algorithm,
+    size_t num_threads) {
+  LOG_DEBUG(get_build_info());
+  auto cfg = to_internal_compile_spec(info, /*bool converting_to_trt_engine=*/true);
+  // The cache is read by a calibrator, in which case the module is frozen when it is lowered for compilation
+  cfg.lower_info.unfreeze_module = false;
+  cfg.lower_info.disable_cse = false;
+  auto cache = torch_tensorrt::core::ptq::CollectCalibrationCache(
+      module,
+      method_name,
+      cfg.lower_info,
+      batches,
+      algorithm == CalibrationAlgorithm::kMINMAX ? torch_tensorrt::core::ptq::CalibrationAlgorithm::kMINMAX
+                                                 : torch_tensorrt::core::ptq::CalibrationAlgorithm::kENTROPY,
+      num_threads);
+
+  std::ofstream out(cache_file_path, std::ios::binary);
+  TORCHTRT_CHECK(out, "Unable to open calibration cache file " << cache_file_path << " for writing");
+  out << cache;
+  TORCHTRT_CHECK(out.good(), "Failed to write calibration cache to " << cache_file_path);
+}
+
+std::map<std::string, DataType> plan_mixed_precision(
+    const torch::jit::script::Module& module,
+    std::string method_name,
+    CompileSpec info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches,
+    double tolerance) {
+  LOG_DEBUG(get_build_info());
+  auto cfg = to_internal_compile_spec(info);
+  auto constraints =
+      torch_tensorrt::core::ptq::PlanMixedPrecision(module, method_name, cfg.lower_info, batches, at::kHalf, tolerance);
+
+  // The planner only constrains nodes to FP32
+  std::map<std::string, DataType> layer_precisions;
+  for (const auto& c : constraints) {
+    layer_precisions[c.first] = DataType::kFloat;
+  }
+  return layer_precisions;
+}
+
+std::string analyze_sparsity(
+    const torch::jit::script::Module& module,
+    std::string method_name,
+    CompileSpec info,
+    const std::vector<std::vector<torch::jit::IValue>>& batches) {
+  LOG_DEBUG(get_build_info());
+  auto cfg = to_internal_compile_spec(info);
+  std::stringstream ss;
+  ss << torch_tensorrt::core::ptq::AnalyzeSparsity(module, method_name, cfg.lower_info, batches);
+  return ss.str();
+}
+
 torch::jit::script::Module compile(const torch::jit::script::Module& module, CompileSpec info) {
   LOG_DEBUG(get_build_info());
   // Want to export a much simpler (non TRT header dependent) API so doing the
@@ -34,6 +113,34 @@ torch::jit::script::Module compile(const torch::jit::script::Module& module, Com
   return torch_tensorrt::core::CompileGraph(module, to_internal_compile_spec(info));
 }
 
+namespace {
+std::vector<torch_tensorrt::core::MethodCompileSpec> to_internal_method_specs(
+    const std::map<std::string, CompileSpec>& method_specs) {
+  std::vector<torch_tensorrt::core::MethodCompileSpec> specs;
+  for (const auto& m : method_specs) {
+    specs.push_back({m.first, to_internal_compile_spec(m.second)});
+  }
+  return specs;
+}
+} // namespace
+
+torch::jit::script::Module compile(
+    const torch::jit::script::Module& module,
+    const std::map<std::string, CompileSpec>& method_specs) {
+  LOG_DEBUG(get_build_info());
+  return torch_tensorrt::core::CompileGraph(module, to_internal_method_specs(method_specs));
+}
+
+std::vector<torch::jit::script::Module> compile(
+    const std::vector<std::pair<torch::jit::script::Module, std::map<std::string, CompileSpec>>>& modules) {
+  LOG_DEBUG(get_build_info());
+  std::vector<std::pair<torch::jit::script::Module, std::vector<torch_tensorrt::core::MethodCompileSpec>>> specs;
+  for (const auto& m : modules) {
+    specs.push_back({m.first, to_internal_method_specs(m.second)});
+  }
+  return torch_tensorrt::core::CompileGraphs(specs);
+}
+
 torch::jit::Module embed_engine_in_new_module(
     const std::string& engine,
     Device device,
@@ -43,6 +150,15 @@ torch::jit::Module embed_engine_in_new_module(
       engine, to_internal_rt_device(device), input_binding_names, output_binding_names);
 }
 
+torch::jit::Module embed_engine_file_in_new_module(
+    const std::string& path,
+    Device device,
+    const std::vector<std::string>& input_binding_names,
+    const std::vector<std::string>& output_binding_names) {
+  return torch_tensorrt::core::EmbedEngineFileInNewModule(
+      path, to_internal_rt_device(device), input_binding_names, output_binding_names);
+}
+
 } // namespace torchscript
 
 std::string get_build_info() {
@@ -59,5 +175,22 @@ void set_device(const int gpu_id) {
   torch_tensorrt::core::set_device(gpu_id);
 }
 
+void set_engine_load_threads(size_t num_threads) {
+  torch_tensorrt::core::runtime::set_engine_load_threads(num_threads);
+}
+
+std::string warmup_engines(const torch::jit::Module& module, int64_t iterations) {
+  auto results = torch_tensorrt::core::runtime::WarmupEngines<torch_tensorrt::core::runtime::TRTEngine>(
+      module, torch_tensorrt::core::runtime::DEFAULT_WARMUP_SHAPES, iterations);
+  std::ostringstream ss;
+  bool ready = true;
+  for (const auto& r : results) {
+    ss << r << std::endl;
+    ready &= r.ready;
+  }
+  TORCHTRT_CHECK(ready, "Not all TensorRT engines of the module could be warmed up\n" << ss.str());
+  return ss.str();
+}
+
 static auto tensorrt_input_container = torch::class_<Input>("_torch_tensorrt", "Input").def(torch::init<>());
 } // namespace torch_tensorrt
@@ -24,42 +24,21 @@ constexpr const size_t kImageChannels = 3;
 constexpr const size_t kBatchSize = 10000;
 
 std::pair<torch::Tensor, torch::Tensor> read_batch(const std::string& path) {
-  std::ifstream batch;
-  batch.open(path, std::ios::in | std::ios::binary | std::ios::ate);
-
-  auto file_size = batch.tellg();
-  std::unique_ptr<char[]> buf(new char[file_size]);
-
-  batch.seekg(0, std::ios::beg);
-  batch.read(buf.get(), file_size);
-  batch.close();
-
-  std::vector<uint8_t> labels;
-  std::vector<torch::Tensor> images;
-  labels.reserve(kBatchSize);
-  images.reserve(kBatchSize);
-
-  for (size_t i = 0; i < kBatchSize; i++) {
-    uint8_t label = buf[i * (kImageSize + kLabelSize)];
-    std::vector<uint8_t> image;
-    image.reserve(kImageSize);
-    std::copy(
-        &buf[i * (kImageSize + kLabelSize) + 1],
-        &buf[i * (kImageSize + kLabelSize) + kImageSize],
-        std::back_inserter(image));
-    labels.push_back(label);
-    auto image_tensor =
-        torch::from_blob(image.data(), {kImageChannels, kImageDim, kImageDim}, torch::TensorOptions().dtype(torch::kU8))
-            .to(torch::kF32)
-            .div(255);
-    images.push_back(image_tensor);
-  }
-
-  auto labels_tensor =
-      torch::from_blob(labels.data(), {kBatchSize}, torch::TensorOptions().dtype(torch::kU8)).to(torch::kF32);
+  // Records are a label byte followed by the image stored as 3 planes of 32x32 pixels, the whole batch is read into
+  // one tensor and split into labels and images without copying each image on its own
+  std::ifstream batch(path, std::ios::in | std::ios::binary);
+  TORCH_CHECK(batch, "Unable to open ", path);
+  auto records = torch::empty({kBatchSize, kLabelSize + kImageSize}, torch::TensorOptions().dtype(torch::kU8));
+  batch.read(reinterpret_cast<char*>(records.data_ptr<uint8_t>()), records.numel());
+  TORCH_CHECK(batch.gcount() == records.numel(), path, " holds less than ", kBatchSize, " images");
+
+  auto labels_tensor = records.select(1, 0).to(torch::kF32);
   assert(labels_tensor.size(0) == kBatchSize);
 
-  auto images_tensor = torch::stack(images);
+  auto images_tensor = records.slice(1, kLabelSize)
+                           .reshape({kBatchSize, kImageChannels, kImageDim, kImageDim})
+                           .to(torch::kF32)
+                           .div(255);
   assert(images_tensor.size(0) == kBatchSize);
 
   return std::make_pair(images_tensor, labels_tensor);
@@ -407,6 +407,7 @@ else:
         "include/torch_tensorrt/core/partitioning/partitioningctx/*.h",
         "include/torch_tensorrt/core/plugins/*.h",
         "include/torch_tensorrt/core/plugins/impl/*.h",
+        "include/torch_tensorrt/core/ptq/*.h",
         "include/torch_tensorrt/core/runtime/*.h",
         "include/torch_tensorrt/core/util/*.h",
         "include/torch_tensorrt/core/util/logging/*.h",
@@ -41,14 +41,22 @@ c10::impl::GenericDict TensorRTBackend::compile(c10::IValue mod_val, c10::impl::
 c10::impl::GenericList TensorRTBackend::execute(c10::IValue handle, c10::impl::GenericList inputs) {
   TORCHTRT_ASSERT(inputs.size() > 0, "Trying to execute on empty list of arguments");
   auto engine = handle.toCustomClass<core::runtime::TRTEngine>();
-  std::vector<at::Tensor> in_vec;
+  // The inputs are run on the stack so that the outputs can be moved straight into the returned list
+  torch::jit::Stack stack;
+  stack.reserve(inputs.size() + engine->num_io.second);
   for (size_t i = 0, e = inputs.size(); i < e; ++i) {
-    c10::IValue val = inputs[i];
+    const c10::IValue& val = inputs[i];
     TORCHTRT_CHECK(val.isTensor(), "TensorRT currently only accepts Tensors as inputs");
-    in_vec.push_back(val.toTensor());
+    stack.push_back(val);
   }
-  auto outputs = core::runtime::execute_engine(in_vec, engine);
-  return c10::impl::toList(c10::List<at::Tensor>(outputs));
+  core::runtime::execute_engine(stack, stack.size(), *engine);
+
+  auto outputs = c10::impl::GenericList(c10::TensorType::get());
+  outputs.reserve(stack.size());
+  for (auto& out : stack) {
+    outputs.push_back(std::move(out));
+  }
+  return outputs;
 }
 
 namespace {
@@ -87,6 +87,7 @@ class TorchTensorRTModule(torch.nn.Module):
                     serialized_engine,
                     TorchTensorRTModule._pack_binding_names(self.input_binding_names),
                     TorchTensorRTModule._pack_binding_names(self.output_binding_names),
+                    "none",
                 ]
             )
         else:
@@ -107,15 +108,9 @@ class TorchTensorRTModule(torch.nn.Module):
             import base64
 
             serialized_engine = base64.b64decode(serialized_engine_info[3])
+            # Engines saved with the previous ABI do not have the engine codec field
             self.engine = torch.classes.tensorrt.Engine(
-                [
-                    serialized_engine_info[0],
-                    serialized_engine_info[1],
-                    serialized_engine_info[2],
-                    serialized_engine,
-                    serialized_engine_info[4],
-                    serialized_engine_info[5],
-                ]
+                serialized_engine_info[:3] + [serialized_engine] + serialized_engine_info[4:]
             )
         else:
             self.engine = None
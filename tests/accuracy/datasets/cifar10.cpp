@@ -1,4 +1,5 @@
 #include "tests/accuracy/datasets/cifar10.h"
+#include "tests/accuracy/datasets/record_file.h"
 
 #include "torch/data/example.h"
 #include "torch/torch.h"
@@ -25,42 +26,16 @@ constexpr const size_t kImageChannels = 3;
 constexpr const size_t kBatchSize = 10000;
 
 std::pair<torch::Tensor, torch::Tensor> read_batch(const std::string& path) {
-  std::ifstream batch;
-  batch.open(path, std::ios::in | std::ios::binary | std::ios::ate);
-
-  auto file_size = batch.tellg();
-  std::unique_ptr<char[]> buf(new char[file_size]);
-
-  batch.seekg(0, std::ios::beg);
-  batch.read(buf.get(), file_size);
-  batch.close();
-
-  std::vector<uint8_t> labels;
-  std::vector<torch::Tensor> images;
-  labels.reserve(kBatchSize);
-  images.reserve(kBatchSize);
-
-  for (size_t i = 0; i < kBatchSize; i++) {
-    uint8_t label = buf[i * (kImageSize + kLabelSize)];
-    std::vector<uint8_t> image;
-    image.reserve(kImageSize);
-    std::copy(
-        &buf[i * (kImageSize + kLabelSize) + 1],
-        &buf[i * (kImageSize + kLabelSize) + kImageSize],
-        std::back_inserter(image));
-    labels.push_back(label);
-    auto image_tensor =
-        torch::from_blob(image.data(), {kImageChannels, kImageDim, kImageDim}, torch::TensorOptions().dtype(torch::kU8))
-            .to(torch::kF32)
-            .div(255);
-    images.push_back(image_tensor);
-  }
+  // Records are a label byte followed by the image stored as 3 planes of 32x32 pixels
+  RecordFile batch(path, kLabelSize + kImageSize);
+  TORCH_CHECK(batch.size() == kBatchSize, path, " holds ", batch.size(), " images, expected ", kBatchSize);
+  auto records = batch.view();
 
-  auto labels_tensor =
-      torch::from_blob(labels.data(), {kBatchSize}, torch::TensorOptions().dtype(torch::kU8)).to(torch::kF32);
+  auto labels_tensor = records.select(1, 0).to(torch::kF32);
   assert(labels_tensor.size(0) == kBatchSize);
 
-  auto images_tensor = torch::stack(images);
+  auto images = records.slice(1, kLabelSize).view({kBatchSize, kImageChannels, kImageDim, kImageDim});
+  auto images_tensor = normalize_images(images, ImageLayout::kNCHW);
   assert(images_tensor.size(0) == kBatchSize);
 
   return std::make_pair(images_tensor, labels_tensor);
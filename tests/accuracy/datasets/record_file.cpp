@@ -0,0 +1,184 @@
+#include "tests/accuracy/datasets/record_file.h"
+
+#include "ATen/Parallel.h"
+#include "torch/torch.h"
+
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace datasets {
+struct RecordFile::Mapping {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+#ifndef _WIN32
+  ~Mapping() {
+    if (data) {
+      munmap(const_cast<uint8_t*>(data), size);
+    }
+  }
+#else
+  // Contents of the file, read instead of mapped on Windows
+  std::vector<uint8_t> contents;
+#endif
+};
+
+RecordFile::RecordFile(const std::string& path, size_t record_size)
+    : mapping_(std::make_shared<Mapping>()), record_size_(record_size) {
+  TORCH_CHECK(record_size > 0, "Record size must be positive");
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  TORCH_CHECK(fd >= 0, "Unable to open ", path);
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    TORCH_CHECK(false, "Unable to map ", path, ", the file is empty or its size cannot be read");
+  }
+  auto addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  TORCH_CHECK(addr != MAP_FAILED, "Unable to map ", path);
+  // Datasets are mostly read front to back
+  madvise(addr, st.st_size, MADV_SEQUENTIAL);
+  mapping_->data = static_cast<const uint8_t*>(addr);
+  mapping_->size = st.st_size;
+#else
+  std::ifstream f(path, std::ios::binary | std::ios::ate);
+  TORCH_CHECK(f, "Unable to open ", path);
+  mapping_->contents.resize(f.tellg());
+  f.seekg(0);
+  f.read(reinterpret_cast<char*>(mapping_->contents.data()), mapping_->contents.size());
+  mapping_->data = mapping_->contents.data();
+  mapping_->size = mapping_->contents.size();
+#endif
+  TORCH_CHECK(
+      mapping_->size % record_size == 0,
+      path,
+      " holds ",
+      mapping_->size,
+      " bytes, which is not a whole number of ",
+      record_size,
+      " byte records");
+  num_records_ = mapping_->size / record_size;
+}
+
+size_t RecordFile::size() const {
+  return num_records_;
+}
+
+size_t RecordFile::record_size() const {
+  return record_size_;
+}
+
+const uint8_t* RecordFile::record(size_t index) const {
+  TORCH_CHECK(index < num_records_, "Record ", index, " is out of range for a file of ", num_records_, " records");
+  return mapping_->data + index * record_size_;
+}
+
+torch::Tensor RecordFile::view(size_t start, size_t n) const {
+  TORCH_CHECK(start + n <= num_records_, "Records [", start, ", ", start + n, ") are out of range");
+  // The tensor holds a reference to the mapping so it stays valid after the RecordFile is gone
+  auto mapping = mapping_;
+  return torch::from_blob(
+      const_cast<uint8_t*>(mapping_->data + start * record_size_),
+      {static_cast<int64_t>(n), static_cast<int64_t>(record_size_)},
+      [mapping](void*) {},
+      torch::TensorOptions().dtype(torch::kU8));
+}
+
+torch::Tensor RecordFile::view() const {
+  return view(0, num_records_);
+}
+
+namespace {
+// dst[i] = src[i] * scale + bias for a plane of n pixels
+void normalize_plane(const uint8_t* src, float* dst, size_t n, float scale, float bias) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 vscale = _mm_set1_ps(scale);
+  const __m128 vbias = _mm_set1_ps(bias);
+  for (; i + 16 <= n; i += 16) {
+    __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i lo = _mm_unpacklo_epi8(px, zero);
+    __m128i hi = _mm_unpackhi_epi8(px, zero);
+    __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+    __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+    __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+    __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+    _mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(f0, vscale), vbias));
+    _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_mul_ps(f1, vscale), vbias));
+    _mm_storeu_ps(dst + i + 8, _mm_add_ps(_mm_mul_ps(f2, vscale), vbias));
+    _mm_storeu_ps(dst + i + 12, _mm_add_ps(_mm_mul_ps(f3, vscale), vbias));
+  }
+#endif
+  // Remaining pixels, and all of them on targets without SSE2 where the compiler vectorizes this loop itself
+  for (; i < n; i++) {
+    dst[i] = static_cast<float>(src[i]) * scale + bias;
+  }
+}
+} // namespace
+
+torch::Tensor normalize_images(const torch::Tensor& images, ImageLayout layout, const Normalization& normalization) {
+  TORCH_CHECK(images.dim() == 4, "Expected a batch of images with 4 dimensions, got ", images.sizes());
+  TORCH_CHECK(images.scalar_type() == torch::kU8, "Expected uint8 images, got ", images.scalar_type());
+  TORCH_CHECK(images.device().is_cpu(), "Expected images on the CPU");
+  TORCH_CHECK(images.size(0) == 0 || images[0].is_contiguous(), "Each image has to be contiguous");
+
+  int64_t n = images.size(0);
+  int64_t c = layout == ImageLayout::kNCHW ? images.size(1) : images.size(3);
+  int64_t hw = layout == ImageLayout::kNCHW ? images.size(2) * images.size(3) : images.size(1) * images.size(2);
+  int64_t h = layout == ImageLayout::kNCHW ? images.size(2) : images.size(1);
+  int64_t w = layout == ImageLayout::kNCHW ? images.size(3) : images.size(2);
+
+  TORCH_CHECK(
+      normalization.mean.empty() || static_cast<int64_t>(normalization.mean.size()) == c,
+      "Expected a mean for each of the ",
+      c,
+      " channels");
+  TORCH_CHECK(
+      normalization.std.empty() || static_cast<int64_t>(normalization.std.size()) == c,
+      "Expected a standard deviation for each of the ",
+      c,
+      " channels");
+  // (x / 255 - mean) / std folded into x * scale + bias
+  std::vector<float> scale(c, 1.0f / 255.0f), bias(c, 0.0f);
+  for (int64_t ch = 0; ch < c; ch++) {
+    float mean = normalization.mean.empty() ? 0.0f : normalization.mean[ch];
+    float stddev = normalization.std.empty() ? 1.0f : normalization.std[ch];
+    scale[ch] = 1.0f / (255.0f * stddev);
+    bias[ch] = -mean / stddev;
+  }
+
+  auto out = torch::empty({n, c, h, w}, torch::TensorOptions().dtype(torch::kF32));
+  auto src = images.data_ptr<uint8_t>();
+  auto dst = out.data_ptr<float>();
+  auto src_stride = images.stride(0);
+  at::parallel_for(0, n, /*grain_size=*/16, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      auto img = src + i * src_stride;
+      auto out_img = dst + i * c * hw;
+      if (layout == ImageLayout::kNCHW) {
+        for (int64_t ch = 0; ch < c; ch++) {
+          normalize_plane(img + ch * hw, out_img + ch * hw, hw, scale[ch], bias[ch]);
+        }
+      } else {
+        for (int64_t p = 0; p < hw; p++) {
+          for (int64_t ch = 0; ch < c; ch++) {
+            out_img[ch * hw + p] = static_cast<float>(img[p * c + ch]) * scale[ch] + bias[ch];
+          }
+        }
+      }
+    }
+  });
+  return out;
+}
+} // namespace datasets
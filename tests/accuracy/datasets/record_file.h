@@ -0,0 +1,64 @@
+#pragma once
+
+#include "torch/types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace datasets {
+// Read-only memory mapping of a file made of fixed size records (e.g. a CIFAR10 batch file, where each record is a
+// label byte followed by the image). Records are only paged in when they are read
+class RecordFile {
+ public:
+  // Maps the file at path, its size must be a multiple of record_size
+  RecordFile(const std::string& path, size_t record_size);
+
+  // The number of records in the file
+  size_t size() const;
+
+  // The size of a record in bytes
+  size_t record_size() const;
+
+  // Returns the bytes of the record at index
+  const uint8_t* record(size_t index) const;
+
+  // Returns records [start, start + n) as a uint8 tensor of shape [n, record_size] pointing into the mapping. The
+  // tensor keeps the mapping alive and must not be written to
+  torch::Tensor view(size_t start, size_t n) const;
+
+  // Returns all of the records as a uint8 tensor of shape [size, record_size], see view
+  torch::Tensor view() const;
+
+ private:
+  struct Mapping;
+  std::shared_ptr<Mapping> mapping_;
+  size_t record_size_;
+  size_t num_records_;
+};
+
+// The layout of uint8 images passed to normalize_images
+enum class ImageLayout {
+  // [N, C, H, W], channels stored as separate planes
+  kNCHW,
+  // [N, H, W, C], channels interleaved per pixel
+  kNHWC,
+};
+
+// Per channel mean and standard deviation applied after scaling pixels to [0, 1]. Empty vectors leave the scaled
+// pixels as they are
+struct Normalization {
+  std::vector<float> mean;
+  std::vector<float> std;
+};
+
+// Converts a batch of uint8 images into a contiguous float tensor of shape [N, C, H, W] computing
+// (pixel / 255 - mean[c]) / std[c]. The images only have to be contiguous within each image, so a view of a
+// RecordFile can be passed directly. Images are converted in parallel, each one with a vectorized kernel
+torch::Tensor normalize_images(
+    const torch::Tensor& images,
+    ImageLayout layout = ImageLayout::kNCHW,
+    const Normalization& normalization = Normalization());
+} // namespace datasets
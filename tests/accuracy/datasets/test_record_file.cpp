@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "tests/accuracy/datasets/record_file.h"
+#include "tests/util/helpers.h"
+#include "torch/torch.h"
+
+namespace {
+using torch_tensorrt::tests::util::TempPath;
+
+const int64_t kRecords = 1000;
+const int64_t kImageSize = 3 * 32 * 32;
+const int64_t kRecordSize = kImageSize + 1;
+
+// Writes a batch file in the CIFAR10 format, a label byte followed by a 3x32x32 image per record
+torch::Tensor WriteCIFARBatch(const std::string& path) {
+  auto records = torch::randint(0, 256, {kRecords, kRecordSize}, torch::TensorOptions().dtype(torch::kU8));
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  f.write(reinterpret_cast<const char*>(records.data_ptr<uint8_t>()), records.numel());
+  return records;
+}
+
+// How batches used to be read, each image copied and converted on its own then stacked
+torch::Tensor ReadImagesPerImage(const std::string& path) {
+  std::ifstream batch(path, std::ios::in | std::ios::binary | std::ios::ate);
+  auto file_size = batch.tellg();
+  std::unique_ptr<char[]> buf(new char[file_size]);
+  batch.seekg(0, std::ios::beg);
+  batch.read(buf.get(), file_size);
+
+  std::vector<torch::Tensor> images;
+  for (int64_t i = 0; i < kRecords; i++) {
+    std::vector<uint8_t> image(&buf[i * kRecordSize + 1], &buf[i * kRecordSize + kRecordSize]);
+    images.push_back(torch::from_blob(image.data(), {3, 32, 32}, torch::TensorOptions().dtype(torch::kU8))
+                         .to(torch::kF32)
+                         .div(255));
+  }
+  return torch::stack(images);
+}
+} // namespace
+
+TEST(Datasets, RecordFileViewsDoNotCopy) {
+  auto path = TempPath("torchtrt_test_records.bin");
+  auto records = WriteCIFARBatch(path);
+
+  torch::Tensor view;
+  {
+    datasets::RecordFile file(path, kRecordSize);
+    ASSERT_EQ(file.size(), static_cast<size_t>(kRecords));
+    ASSERT_EQ(file.record(7)[0], records[7][0].item<uint8_t>());
+    view = file.view(10, 100);
+    ASSERT_EQ(view.data_ptr<uint8_t>(), file.record(10));
+  }
+  // Views keep the mapping alive
+  ASSERT_TRUE(torch::equal(view, records.slice(0, 10, 110)));
+
+  ASSERT_THROW(datasets::RecordFile(path, kRecordSize + 1), c10::Error);
+  std::remove(path.c_str());
+}
+
+TEST(Datasets, NormalizeImagesMatchesTorch) {
+  auto images = torch::randint(0, 256, {37, 3, 17, 13}, torch::TensorOptions().dtype(torch::kU8));
+  auto expected = images.to(torch::kF32).div(255);
+  ASSERT_TRUE(torch::allclose(datasets::normalize_images(images), expected));
+
+  datasets::Normalization norm{{0.4914f, 0.4822f, 0.4465f}, {0.2470f, 0.2435f, 0.2616f}};
+  auto mean = torch::tensor(norm.mean).view({1, 3, 1, 1});
+  auto std = torch::tensor(norm.std).view({1, 3, 1, 1});
+  auto normalized = datasets::normalize_images(images, datasets::ImageLayout::kNCHW, norm);
+  ASSERT_TRUE(torch::allclose(normalized, (expected - mean) / std, 1e-5, 1e-5));
+
+  // Interleaved images come out planar
+  auto nhwc = images.permute({0, 2, 3, 1}).contiguous();
+  ASSERT_TRUE(torch::allclose(datasets::normalize_images(nhwc, datasets::ImageLayout::kNHWC, norm), normalized));
+
+  // Images only need to be contiguous individually, like the images of a record file view
+  auto records = torch::randint(0, 256, {37, 1 + 3 * 17 * 13}, torch::TensorOptions().dtype(torch::kU8));
+  auto strided = records.slice(1, 1).view({37, 3, 17, 13});
+  ASSERT_TRUE(torch::allclose(datasets::normalize_images(strided), strided.to(torch::kF32).div(255)));
+}
+
+TEST(Datasets, MappedBatchesMatchPerImageReads) {
+  auto path = TempPath("torchtrt_test_records_batches.bin");
+  WriteCIFARBatch(path);
+
+  auto per_image = ReadImagesPerImage(path);
+  datasets::RecordFile file(path, kRecordSize);
+  auto mapped = datasets::normalize_images(file.view().slice(1, 1).view({kRecords, 3, 32, 32}));
+  ASSERT_TRUE(torch::allclose(mapped, per_image));
+  std::remove(path.c_str());
+}
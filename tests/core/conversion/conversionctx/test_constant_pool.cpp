@@ -0,0 +1,77 @@
+#include <cstring>
+#include <vector>
+#include "core/conversion/conversionctx/ConstantPool.h"
+#include "gtest/gtest.h"
+
+using torch_tensorrt::core::conversion::ConstantPool;
+
+TEST(Conversion, ConstantPoolSharesIdenticalConstants) {
+  ConstantPool pool;
+  std::vector<float> ones(64, 1.f);
+  std::vector<float> other_ones(64, 1.f);
+
+  auto a = pool.intern(nvinfer1::DataType::kFLOAT, {8, 8}, ones.data(), ones.size() * sizeof(float));
+  auto b = pool.intern(nvinfer1::DataType::kFLOAT, {8, 8}, other_ones.data(), other_ones.size() * sizeof(float));
+  // The pool keeps its own copy of the data
+  ASSERT_NE(a, ones.data());
+  ASSERT_EQ(a, b);
+  ASSERT_EQ(pool.size(), 1UL);
+
+  auto& stats = pool.stats();
+  ASSERT_EQ(stats.num_requests, 2UL);
+  ASSERT_EQ(stats.num_hits, 1UL);
+  ASSERT_EQ(stats.bytes_requested, 2 * 64 * sizeof(float));
+  ASSERT_EQ(stats.bytes_stored, 64 * sizeof(float));
+}
+
+TEST(Conversion, ConstantPoolDistinguishesTypeShapeAndContents) {
+  ConstantPool pool;
+  std::vector<float> ones(64, 1.f);
+  std::vector<float> twos(64, 2.f);
+  std::vector<int32_t> int_ones(64, 0x3f800000); // Same bytes as 1.f
+
+  auto base = pool.intern(nvinfer1::DataType::kFLOAT, {8, 8}, ones.data(), ones.size() * sizeof(float));
+  ASSERT_NE(base, pool.intern(nvinfer1::DataType::kFLOAT, {64}, ones.data(), ones.size() * sizeof(float)));
+  ASSERT_NE(base, pool.intern(nvinfer1::DataType::kINT32, {8, 8}, int_ones.data(), int_ones.size() * sizeof(int32_t)));
+  ASSERT_NE(base, pool.intern(nvinfer1::DataType::kFLOAT, {8, 8}, twos.data(), twos.size() * sizeof(float)));
+
+  // A single differing byte at the end is not folded into the existing constant
+  ones.back() = 1.0001f;
+  auto changed = pool.intern(nvinfer1::DataType::kFLOAT, {8, 8}, ones.data(), ones.size() * sizeof(float));
+  ASSERT_NE(base, changed);
+  ASSERT_EQ(pool.size(), 5UL);
+  ASSERT_EQ(pool.stats().num_hits, 0UL);
+  ASSERT_EQ(memcmp(changed, ones.data(), ones.size() * sizeof(float)), 0);
+}
+
+TEST(Conversion, ConstantPoolSharesTensorsOfIdenticalConstants) {
+  ConstantPool pool;
+  float zero = 0.f;
+  int placeholder = 0;
+  auto tensor = reinterpret_cast<nvinfer1::ITensor*>(&placeholder);
+
+  auto buf = pool.intern(nvinfer1::DataType::kFLOAT, {}, &zero, sizeof(float));
+  ASSERT_EQ(pool.find_tensor(buf), nullptr);
+  pool.record_tensor(buf, tensor);
+
+  float other_zero = 0.f;
+  auto other_buf = pool.intern(nvinfer1::DataType::kFLOAT, {}, &other_zero, sizeof(float));
+  ASSERT_EQ(pool.find_tensor(other_buf), tensor);
+  ASSERT_EQ(pool.stats().num_shared_tensors, 1UL);
+
+  // Pointers which did not come from the pool never match
+  ASSERT_EQ(pool.find_tensor(&zero), nullptr);
+}
+
+TEST(Conversion, HashBytesDependsOnEveryByte) {
+  std::vector<uint8_t> data(37, 7);
+  auto h = torch_tensorrt::core::conversion::HashBytes(data.data(), data.size());
+  ASSERT_EQ(h, torch_tensorrt::core::conversion::HashBytes(data.data(), data.size()));
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i]++;
+    ASSERT_NE(h, torch_tensorrt::core::conversion::HashBytes(data.data(), data.size()));
+    data[i]--;
+  }
+  // The length is part of the hash
+  ASSERT_NE(h, torch_tensorrt::core::conversion::HashBytes(data.data(), data.size() - 1));
+}
@@ -0,0 +1,54 @@
+#include <string>
+#include "core/conversion/conversionctx/WeightNameMap.h"
+#include "gtest/gtest.h"
+
+using torch_tensorrt::core::conversion::WeightNameMap;
+
+namespace {
+WeightNameMap make_weight_name_map() {
+  WeightNameMap m;
+  m.record(
+      "conv1.weight",
+      {"%x.1 : Tensor = aten::_convolution(%input.1, %self.conv1.weight, ...)",
+       nvinfer1::WeightsRole::kKERNEL,
+       nvinfer1::DataType::kFLOAT,
+       864});
+  m.record(
+      "conv1.bias",
+      {"%x.1 : Tensor = aten::_convolution(%input.1, %self.conv1.weight, ...)",
+       nvinfer1::WeightsRole::kBIAS,
+       nvinfer1::DataType::kFLOAT,
+       32});
+  // Shared parameters become weights of several layers, names may contain delimiters and line breaks
+  m.record("embedding.weight", {"layer: 1\n[0]", nvinfer1::WeightsRole::kCONSTANT, nvinfer1::DataType::kHALF, 1024});
+  m.record("embedding.weight", {"", nvinfer1::WeightsRole::kKERNEL, nvinfer1::DataType::kHALF, 1024});
+  return m;
+}
+} // namespace
+
+TEST(Conversion, WeightNameMapRecordsEachUseOfAParameter) {
+  auto m = make_weight_name_map();
+  ASSERT_EQ(m.size(), 3UL);
+  ASSERT_EQ(m.lookup("embedding.weight").size(), 2UL);
+  ASSERT_EQ(m.lookup("conv1.bias")[0].role, nvinfer1::WeightsRole::kBIAS);
+  ASSERT_TRUE(m.lookup("bn1.running_mean").empty());
+
+  std::vector<std::string> expected_names = {"conv1.bias", "conv1.weight", "embedding.weight"};
+  ASSERT_EQ(m.param_names(), expected_names);
+}
+
+TEST(Conversion, WeightNameMapSerializationRoundTrips) {
+  auto m = make_weight_name_map();
+  auto serialized = m.serialize();
+  ASSERT_EQ(WeightNameMap::deserialize(serialized), m);
+  // The serialized form is deterministic so identical engines produce identical modules
+  ASSERT_EQ(WeightNameMap::deserialize(serialized).serialize(), serialized);
+  ASSERT_TRUE(WeightNameMap::deserialize(WeightNameMap().serialize()).empty());
+}
+
+TEST(Conversion, WeightNameMapRejectsMalformedInput) {
+  auto serialized = make_weight_name_map().serialize();
+  ASSERT_ANY_THROW(WeightNameMap::deserialize(serialized.substr(0, serialized.size() / 2)));
+  ASSERT_ANY_THROW(WeightNameMap::deserialize("0 1 12:conv1.weight 1"));
+  ASSERT_ANY_THROW(WeightNameMap::deserialize(""));
+}
@@ -0,0 +1,112 @@
+#include <string>
+#include "core/conversion/conversion.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/csrc/jit/ir/irparser.h"
+
+namespace {
+namespace conversion = torch_tensorrt::core::conversion;
+
+// Shape arithmetic on two integer inputs: num_chains independent chains of constant, mul, add and arange, gathered
+// into a tensor at the end
+std::shared_ptr<torch::jit::Graph> BuildShapeGraph(size_t num_chains) {
+  std::string ir = "graph(%a : int, %b : int):\n";
+  ir += "  %none : NoneType = prim::Constant()\n";
+  ir += "  %false : bool = prim::Constant[value=0]()\n";
+  std::string list;
+  for (size_t i = 0; i < num_chains; i++) {
+    auto id = std::to_string(i);
+    ir += "  %c" + id + " : int = prim::Constant[value=" + std::to_string(i % 7 + 1) + "]()\n";
+    ir += "  %x" + id + " : int = aten::mul(%a, %c" + id + ")\n";
+    ir += "  %y" + id + " : int = aten::add(%x" + id + ", %b)\n";
+    ir += "  %r" + id + " : Tensor = aten::arange(%y" + id + ", %none, %none, %none, %none)\n";
+    list += (i == 0 ? "%y" : ", %y") + id;
+  }
+  ir += "  %l : int[] = prim::ListConstruct(" + list + ")\n";
+  ir += "  %t : Tensor = aten::tensor(%l, %none, %none, %false)\n";
+  ir += "  return (%t)\n";
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(ir, g.get());
+  return g;
+}
+
+size_t CountNodes(const torch::jit::Block* b) {
+  return std::distance(b->nodes().begin(), b->nodes().end());
+}
+} // namespace
+
+TEST(Evaluators, StaticNodesEvaluateLikeSerialEvaluation) {
+  auto g = BuildShapeGraph(500);
+  std::vector<torch::jit::IValue> inputs = {3, 5};
+  auto serial_results = torch_tensorrt::tests::util::EvaluateGraph(g->block(), inputs);
+
+  conversion::ConversionCtx ctx({});
+  ctx.AssociateValueAndIValue(g->inputs()[0], inputs[0]);
+  ctx.AssociateValueAndIValue(g->inputs()[1], inputs[1]);
+  auto results = conversion::EvaluateStaticNodes(&ctx, g->block(), 4);
+
+  // Every node only depends on the inputs
+  ASSERT_EQ(results.size(), CountNodes(g->block()));
+  auto out_node = g->outputs()[0]->node();
+  ASSERT_TRUE(results.at(out_node).has_value());
+  ASSERT_TRUE(torch::equal(results.at(out_node).value().toTensor(), serial_results[0].toTensor()));
+
+  // Results are left for conversion to associate with the outputs of the nodes
+  ASSERT_EQ(ctx.evaluated_value_map.count(g->outputs()[0]), 0UL);
+}
+
+TEST(Evaluators, StaticNodesSkipNodesDependingOnNonStaticValues) {
+  const auto graph = R"IR(
+      graph(%x : Tensor, %a : int):
+        %zero : int = prim::Constant[value=0]()
+        %two : int = prim::Constant[value=2]()
+        %s : int = aten::size(%x, %zero)
+        %m : int = aten::mul(%s, %two)
+        %n : int = aten::mul(%a, %two)
+        return (%m, %n))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+
+  // Only the int input is known before conversion, the tensor input would be an ITensor
+  conversion::ConversionCtx ctx({});
+  ctx.AssociateValueAndIValue(g->inputs()[1], 4);
+  auto results = conversion::EvaluateStaticNodes(&ctx, g->block(), 1);
+
+  ASSERT_EQ(results.count(g->outputs()[0]->node()), 0UL);
+  ASSERT_EQ(results.at(g->outputs()[1]->node()).value().toInt(), 8);
+  // The two constants and %n
+  ASSERT_EQ(results.size(), 3UL);
+}
+
+TEST(Evaluators, StaticNodesAreNotEvaluatedInBlocksWithMutation) {
+  const auto graph = R"IR(
+      graph(%a : int):
+        %l : int[] = prim::ListConstruct(%a)
+        %l2 : int[] = aten::append(%l, %a)
+        %n : int = aten::len(%l)
+        return (%n))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+
+  conversion::ConversionCtx ctx({});
+  ctx.AssociateValueAndIValue(g->inputs()[0], 1);
+  ASSERT_TRUE(conversion::EvaluateStaticNodes(&ctx, g->block()).empty());
+}
+
+TEST(Evaluators, StaticNodesEvaluateWithAnyNumberOfThreads) {
+  auto g = BuildShapeGraph(500);
+  std::vector<torch::jit::IValue> inputs = {3, 5};
+  auto serial_results = torch_tensorrt::tests::util::EvaluateGraph(g->block(), inputs);
+
+  // 0 uses one thread per core
+  for (size_t num_threads : {1, 0}) {
+    conversion::ConversionCtx ctx({});
+    ctx.AssociateValueAndIValue(g->inputs()[0], inputs[0]);
+    ctx.AssociateValueAndIValue(g->inputs()[1], inputs[1]);
+    auto results = conversion::EvaluateStaticNodes(&ctx, g->block(), num_threads);
+    ASSERT_EQ(results.size(), CountNodes(g->block()));
+    ASSERT_TRUE(torch::equal(results.at(g->outputs()[0]->node()).value().toTensor(), serial_results[0].toTensor()));
+  }
+}
@@ -0,0 +1,142 @@
+#include <string>
+#include "core/conversion/conversion.h"
+#include "gtest/gtest.h"
+#include "torch/csrc/jit/ir/irparser.h"
+
+namespace {
+namespace conversion = torch_tensorrt::core::conversion;
+
+const std::string kGraph = R"IR(
+  graph(%x : Tensor, %y : Tensor):
+    %none : NoneType = prim::Constant()
+    %zero : int = prim::Constant[value=0]()
+    %one : int = prim::Constant[value=1]()
+    %cond : bool = prim::Constant[value=1]()
+    %a : Tensor = aten::relu(%x)
+    %b : Tensor = aten::add(%a, %y, %one)
+    %s : int = aten::size(%b, %zero)
+    %l : int[] = prim::ListConstruct(%s, %one)
+    %c : Tensor = aten::reshape(%b, %l)
+    %d : Tensor = prim::If(%cond)
+      block0():
+        %e : Tensor = aten::sigmoid(%c)
+        -> (%e)
+      block1():
+        %f : Tensor = aten::cumprod(%c, %zero, %none)
+        -> (%f)
+    return (%d))IR";
+
+void ExpectSameAsRegistries(conversion::NodeBindingTable& table, const torch::jit::Block* b) {
+  for (const auto n : b->nodes()) {
+    auto& binding = table.get(n);
+    EXPECT_EQ(binding.evaluated(), conversion::evaluators::shouldEvalAtConversionTime(n)) << *n;
+    EXPECT_EQ(binding.convertable(), conversion::converters::node_is_convertable(n)) << *n;
+    EXPECT_EQ(binding.supported(), conversion::OpSupported(n)) << *n;
+    for (const auto sub_b : n->blocks()) {
+      ExpectSameAsRegistries(table, sub_b);
+    }
+  }
+}
+
+size_t CountNodes(const torch::jit::Block* b) {
+  size_t count = 0;
+  for (const auto n : b->nodes()) {
+    count++;
+    for (const auto sub_b : n->blocks()) {
+      count += CountNodes(sub_b);
+    }
+  }
+  return count;
+}
+} // namespace
+
+TEST(Conversion, NodeBindingsMatchRegistries) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(kGraph, g.get());
+
+  conversion::NodeBindingTable table;
+  table.bind(g->block());
+  ASSERT_EQ(table.size(), CountNodes(g->block()));
+  ExpectSameAsRegistries(table, g->block());
+
+  for (const auto n : g->block()->nodes()) {
+    if (n->kind() == torch::jit::prim::Constant || n->kind() == torch::jit::prim::ListConstruct) {
+      ASSERT_TRUE(table.get(n).evaluated());
+    } else if (n->kind() == c10::Symbol::fromQualString("aten::relu")) {
+      ASSERT_FALSE(table.get(n).evaluated());
+      ASSERT_TRUE(table.get(n).convertable());
+    } else if (n->kind() == torch::jit::prim::If) {
+      // Conditionals are handled by the conversion phase itself
+      ASSERT_FALSE(table.get(n).supported());
+      auto unsupported = n->blocks()[1]->nodes().front();
+      ASSERT_FALSE(table.get(unsupported).supported());
+    }
+  }
+
+  // The result of verification does not depend on where the nodes are looked up
+  ASSERT_EQ(
+      conversion::VerifyConverterSupportForBlock(g->block(), true, &table),
+      conversion::VerifyConverterSupportForBlock(g->block(), true));
+}
+
+TEST(Conversion, NodeBindingsBindNewNodesOnFirstUse) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(kGraph, g.get());
+
+  conversion::NodeBindingTable table;
+  table.bind(g->block());
+  auto num_bound = table.size();
+
+  auto relu = g->create(c10::Symbol::fromQualString("aten::relu"), {g->inputs()[0]});
+  g->appendNode(relu);
+  ASSERT_TRUE(table.get(relu).convertable());
+  ASSERT_EQ(table.size(), num_bound + 1);
+
+  // Binding again does not replace the bindings which already exist
+  auto& binding = table.get(relu);
+  table.bind(g->block());
+  ASSERT_EQ(&binding, &table.get(relu));
+  ASSERT_EQ(table.size(), num_bound + 1);
+}
+
+TEST(Conversion, NodeBindingsAgreeWithRegistryLookups) {
+  // A chain of converted and evaluated nodes, checked the way verification, partitioning and conversion check nodes
+  // without the binding table
+  const size_t num_layers = 100;
+  std::string ir = "graph(%x : Tensor):\n";
+  ir += "  %zero : int = prim::Constant[value=0]()\n";
+  ir += "  %one : int = prim::Constant[value=1]()\n";
+  std::string last = "%x";
+  for (size_t i = 0; i < num_layers; i++) {
+    auto id = std::to_string(i);
+    ir += "  %r" + id + " : Tensor = aten::relu(" + last + ")\n";
+    ir += "  %s" + id + " : int = aten::size(%r" + id + ", %zero)\n";
+    ir += "  %l" + id + " : int[] = prim::ListConstruct(%s" + id + ", %one)\n";
+    ir += "  %v" + id + " : Tensor = aten::reshape(%r" + id + ", %l" + id + ")\n";
+    last = "%v" + id;
+  }
+  ir += "  return (" + last + ")\n";
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(ir, g.get());
+
+  size_t num_supported_direct = 0;
+  for (const auto n : g->block()->nodes()) {
+    if (conversion::OpSupported(n) && !conversion::evaluators::shouldEvalAtConversionTime(n) && n->maybeSchema() &&
+        conversion::converters::find_node_converter(n)) {
+      num_supported_direct++;
+    }
+  }
+
+  size_t num_supported_bound = 0;
+  conversion::NodeBindingTable table;
+  table.bind(g->block());
+  for (const auto n : g->block()->nodes()) {
+    auto& binding = table.get(n);
+    if (binding.supported() && !binding.evaluated() && binding.convertable()) {
+      num_supported_bound++;
+    }
+  }
+
+  ASSERT_EQ(num_supported_direct, num_supported_bound);
+  ASSERT_EQ(num_supported_bound, num_layers * 2);
+}
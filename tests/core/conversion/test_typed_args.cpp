@@ -0,0 +1,156 @@
+#include <string>
+#include "core/conversion/converters/typed_args.h"
+#include "gtest/gtest.h"
+
+namespace {
+namespace conversion = torch_tensorrt::core::conversion;
+namespace converters = torch_tensorrt::core::conversion::converters;
+using conversion::Var;
+using converters::ListArg;
+using converters::typed_pattern;
+
+const std::string kPoolSchema =
+    "aten::max_pool2d(Tensor self, int[2] kernel_size, int[2] stride=[], int[2] padding=0, int[2] dilation=1, "
+    "bool ceil_mode=False) -> (Tensor)";
+
+// Arguments are only IValues so the converters can run without a network
+struct PoolArgs {
+  std::vector<torch::jit::IValue> ivalues;
+  converters::args args;
+
+  PoolArgs() {
+    ivalues = {
+        at::ones({1, 3, 8, 8}),
+        c10::List<int64_t>({3, 3}),
+        c10::List<int64_t>({2, 2}),
+        c10::List<int64_t>({1, 1}),
+        c10::List<int64_t>({1, 1}),
+        true};
+    for (auto& i : ivalues) {
+      args.push_back(&i);
+    }
+  }
+};
+
+template <typename F>
+converters::ConversionPattern PoolPattern(F converter) {
+  return typed_pattern<at::Tensor, ListArg<int64_t>, ListArg<int64_t>, ListArg<int64_t>, ListArg<int64_t>, bool>(
+      kPoolSchema, converter);
+}
+} // namespace
+
+TEST(Converters, TypedPatternUnwrapsArguments) {
+  auto pattern = PoolPattern([](conversion::ConversionCtx*,
+                                 const torch::jit::Node*,
+                                 at::Tensor self,
+                                 ListArg<int64_t> kernel_size,
+                                 ListArg<int64_t> stride,
+                                 ListArg<int64_t> padding,
+                                 ListArg<int64_t> dilation,
+                                 bool ceil_mode) -> bool {
+    EXPECT_EQ(self.sizes(), c10::IntArrayRef({1, 3, 8, 8}));
+    EXPECT_EQ(kernel_size.vec(), std::vector<int64_t>({3, 3}));
+    EXPECT_EQ(stride[0], 2);
+    EXPECT_EQ(padding.size(), 2UL);
+    EXPECT_EQ(dilation[1], 1);
+    EXPECT_TRUE(ceil_mode);
+    return true;
+  });
+  ASSERT_EQ(pattern.signature, kPoolSchema);
+
+  PoolArgs a;
+  ASSERT_TRUE(pattern.converter(nullptr, nullptr, a.args));
+
+  // Lists are views of the evaluated values, not copies
+  auto view_pattern = typed_pattern<at::Tensor, ListArg<int64_t>, Var, Var, Var, Var>(
+      kPoolSchema,
+      [&a](conversion::ConversionCtx*,
+           const torch::jit::Node*,
+           at::Tensor,
+           ListArg<int64_t> kernel_size,
+           Var,
+           Var,
+           Var,
+           Var) -> bool {
+        return kernel_size.ivalues().data() == a.ivalues[1].toListRef().data();
+      });
+  ASSERT_TRUE(view_pattern.converter(nullptr, nullptr, a.args));
+}
+
+TEST(Converters, TypedPatternUnwrapsOptionalArguments) {
+  auto pattern = typed_pattern<c10::optional<int64_t>, c10::optional<double>, c10::Scalar, std::string>(
+      "aten::fake_op(int? a, float? b, Scalar c, str d) -> (Tensor)",
+      [](conversion::ConversionCtx*,
+         const torch::jit::Node*,
+         c10::optional<int64_t> a,
+         c10::optional<double> b,
+         c10::Scalar c,
+         std::string d) -> bool {
+        EXPECT_FALSE(a.has_value());
+        EXPECT_EQ(b.value(), 0.5);
+        EXPECT_EQ(c.toInt(), 4);
+        EXPECT_EQ(d, "mode");
+        return true;
+      });
+
+  std::vector<torch::jit::IValue> ivalues = {torch::jit::IValue(), 0.5, 4, std::string("mode")};
+  converters::args args = {&ivalues[0], &ivalues[1], &ivalues[2], &ivalues[3]};
+  ASSERT_TRUE(pattern.converter(nullptr, nullptr, args));
+
+  // None produced by an evaluator is passed as an empty Var
+  args[0] = conversion::Var();
+  ASSERT_TRUE(pattern.converter(nullptr, nullptr, args));
+}
+
+TEST(Converters, TypedPatternChecksSchema) {
+  auto converter = [](conversion::ConversionCtx*, const torch::jit::Node*, int64_t, int64_t) -> bool { return true; };
+  // Wrong number of arguments
+  ASSERT_THROW(
+      (typed_pattern<int64_t, int64_t>("aten::fake_op(int a) -> (Tensor)", converter)), torch_tensorrt::Error);
+  // Wrong argument type
+  ASSERT_THROW(
+      (typed_pattern<int64_t, int64_t>("aten::fake_op(int a, float b) -> (Tensor)", converter)), torch_tensorrt::Error);
+
+  auto pattern = typed_pattern<int64_t, int64_t>("aten::fake_op(int a, int b) -> (Tensor)", converter);
+  std::vector<torch::jit::IValue> ivalues = {1, 2.0};
+  converters::args args = {&ivalues[0], &ivalues[1]};
+  // Arguments of the wrong type at conversion time
+  ASSERT_THROW(pattern.converter(nullptr, nullptr, args), torch_tensorrt::Error);
+}
+
+TEST(Converters, TypedPatternMatchesUntypedConverter) {
+  PoolArgs a;
+  int64_t checksum = 0;
+
+  // The same converter written against args, unwrapping each argument through Var
+  converters::OpConverter untyped =
+      [&checksum](conversion::ConversionCtx*, const torch::jit::Node*, converters::args& args) -> bool {
+        auto self = args[0].unwrapToTensor();
+        auto kernel_size = args[1].unwrapToIntList();
+        auto stride = args[2].unwrapToIntList();
+        auto padding = args[3].unwrapToIntList();
+        auto dilation = args[4].unwrapToIntList();
+        auto ceil_mode = args[5].unwrapToBool();
+        checksum += self.dim() + kernel_size[0] + stride[0] + padding[0] + dilation[0] + ceil_mode;
+        return true;
+      };
+  auto typed = PoolPattern([&checksum](
+                               conversion::ConversionCtx*,
+                               const torch::jit::Node*,
+                               at::Tensor self,
+                               ListArg<int64_t> kernel_size,
+                               ListArg<int64_t> stride,
+                               ListArg<int64_t> padding,
+                               ListArg<int64_t> dilation,
+                               bool ceil_mode) -> bool {
+    checksum += self.dim() + kernel_size[0] + stride[0] + padding[0] + dilation[0] + ceil_mode;
+    return true;
+  });
+
+  untyped(nullptr, nullptr, a.args);
+  auto untyped_checksum = checksum;
+
+  checksum = 0;
+  ASSERT_TRUE(typed.converter(nullptr, nullptr, a.args));
+  ASSERT_EQ(checksum, untyped_checksum);
+}
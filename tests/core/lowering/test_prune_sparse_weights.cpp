@@ -0,0 +1,91 @@
+#include <string>
+#include "core/compiler.h"
+#include "core/lowering/passes/passes.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/torch.h"
+
+namespace {
+// Keeps the 2 elements of largest magnitude of every group of 4 along dim 1 of a 2D tensor with a multiple of 4 columns
+at::Tensor ReferencePrune(const at::Tensor& w) {
+  auto groups = w.reshape({w.size(0), -1, 4});
+  auto top = std::get<1>(groups.abs().topk(2, -1));
+  auto mask = at::zeros_like(groups).scatter_(-1, top, 1);
+  return (groups * mask).reshape(w.sizes());
+}
+} // namespace
+
+TEST(LoweringPasses, Count2by4DenseGroupsAlongDim) {
+  // Groups along dim 1: {1, 0, 2, 0} is sparse and {1, 2, 3, 0} is dense
+  auto w = torch::tensor({1, 0, 2, 0, 1, 2, 3, 0}, torch::kFloat).reshape({1, 8});
+  ASSERT_EQ(torch_tensorrt::core::lowering::passes::Count2by4DenseGroups(w, 1), 1);
+  // Along dim 0 every group is a single element padded with zeros
+  ASSERT_EQ(torch_tensorrt::core::lowering::passes::Count2by4DenseGroups(w, 0), 0);
+
+  auto dense = at::randn({37, 64}) + 10;
+  ASSERT_EQ(torch_tensorrt::core::lowering::passes::Count2by4DenseGroups(dense, 1), 37 * 16);
+  // The last group of 6 channels only has 2 channels and can not be dense
+  ASSERT_EQ(torch_tensorrt::core::lowering::passes::Count2by4DenseGroups(dense.narrow(1, 0, 6), 1), 37);
+}
+
+TEST(LoweringPasses, PruneTo2by4KeepsLargestMagnitudes) {
+  // Enough groups for several vectors and a partial one
+  auto w = at::randn({131, 48});
+  auto pruned = torch_tensorrt::core::lowering::passes::PruneTo2by4(w, 1);
+  ASSERT_TRUE(torch::equal(pruned, ReferencePrune(w)));
+  ASSERT_EQ(torch_tensorrt::core::lowering::passes::Count2by4DenseGroups(pruned, 1), 0);
+
+  // Groups along the first dimension of transposed weights
+  auto pruned_t = torch_tensorrt::core::lowering::passes::PruneTo2by4(w.t().contiguous(), 0);
+  ASSERT_TRUE(torch::equal(pruned_t, pruned.t()));
+
+  // Convolution weights are grouped along input channels, which are padded to a multiple of 4
+  auto conv_w = at::randn({8, 6, 3, 3}).to(at::kHalf);
+  auto pruned_conv = torch_tensorrt::core::lowering::passes::PruneTo2by4(conv_w, 1);
+  ASSERT_EQ(pruned_conv.scalar_type(), at::kHalf);
+  ASSERT_EQ(pruned_conv.sizes(), conv_w.sizes());
+  ASSERT_EQ(torch_tensorrt::core::lowering::passes::Count2by4DenseGroups(pruned_conv, 1), 0);
+  ASSERT_EQ((pruned_conv != 0).sum().item<int64_t>(), 8 * 3 * 3 * (2 + 2));
+}
+
+TEST(LoweringPasses, PruneWeightsTo2by4PrunesLayerWeights) {
+  std::string source_graph = R"IR(
+    graph(%x : Tensor, %w_conv : Tensor, %w_fc : Tensor, %w_deconv : Tensor):
+      %none : NoneType = prim::Constant()
+      %true : bool = prim::Constant[value=1]()
+      %false : bool = prim::Constant[value=0]()
+      %0 : int = prim::Constant[value=0]()
+      %1 : int = prim::Constant[value=1]()
+      %last : int = prim::Constant[value=-1]()
+      %ones : int[] = prim::ListConstruct(%1, %1)
+      %zeros : int[] = prim::ListConstruct(%0, %0)
+      %conv : Tensor = aten::_convolution(%x, %w_conv, %none, %ones, %zeros, %ones, %false, %zeros, %1, %false, %false, %true, %true)
+      %deconv : Tensor = aten::_convolution(%conv, %w_deconv, %none, %ones, %zeros, %ones, %true, %zeros, %1, %false, %false, %true, %true)
+      %flat : Tensor = aten::flatten(%deconv, %1, %last)
+      %w_fc_t : Tensor = aten::t(%w_fc)
+      %out : Tensor = aten::matmul(%flat, %w_fc_t)
+      return (%out))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(source_graph, g.get());
+  auto w_conv = at::randn({8, 4, 3, 3});
+  auto w_fc = at::randn({10, 16});
+  auto w_deconv = at::randn({8, 4, 1, 1});
+  std::vector<torch::jit::IValue> params = {w_conv, w_fc, w_deconv};
+
+  auto uses = torch_tensorrt::core::lowering::passes::FindSparseWeightUses(g, params);
+  ASSERT_EQ(uses.size(), 2);
+  ASSERT_EQ(uses[0].reduction_dim, 1);
+  ASSERT_EQ(uses[0].output_dim, 0);
+  // The transpose is looked through, the weights are reduced over their second dimension
+  ASSERT_EQ(uses[1].weight, g->inputs()[2]);
+  ASSERT_EQ(uses[1].reduction_dim, 1);
+  ASSERT_EQ(uses[1].output_dim, 0);
+
+  torch_tensorrt::core::lowering::passes::PruneWeightsTo2by4(g, params);
+  ASSERT_EQ(torch_tensorrt::core::lowering::passes::Count2by4DenseGroups(params[0].toTensor(), 1), 0);
+  ASSERT_TRUE(torch::equal(params[1].toTensor(), ReferencePrune(w_fc)));
+  // Transposed convolutions are left dense
+  ASSERT_TRUE(torch::equal(params[2].toTensor(), w_deconv));
+}
@@ -12,7 +12,7 @@ size_t count_trt_engines_in_conditionals(std::shared_ptr<torch::jit::Graph> g) {
       std::vector<torch::jit::Block*> blocks{n->blocks()[0], n->blocks()[1]};
       for (auto cur_block : blocks) {
         for (auto n : cur_block->nodes()) {
-          if (n->kind().toQualString() == std::string("tensorrt::execute_engine")) {
+          if (n->kind().toQualString() == std::string("tensorrt::execute_engine_unpacked")) {
             ++count;
           }
         }
@@ -0,0 +1,201 @@
+#include <string>
+#include "core/partitioning/partitioning.h"
+#include "gtest/gtest.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/script.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace partitioning {
+namespace tests {
+
+namespace {
+// Tensors with overlapping lifetimes must not share memory
+bool isValidPlan(const MemoryPlan& plan) {
+  for (size_t i = 0; i < plan.tensors.size(); i++) {
+    for (size_t j = i + 1; j < plan.tensors.size(); j++) {
+      const auto& a = plan.tensors[i];
+      const auto& b = plan.tensors[j];
+      if (a.first_use > b.last_use || b.first_use > a.last_use) {
+        continue;
+      }
+      auto a_offset = plan.offsets.at(a.value);
+      auto b_offset = plan.offsets.at(b.value);
+      if (a_offset < b_offset + b.size && b_offset < a_offset + a.size) {
+        return false;
+      }
+    }
+    if (plan.offsets.at(plan.tensors[i].value) + plan.tensors[i].size > plan.arena_size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Splits the graph into one Torch segment per node, registers the max shapes of the segment inputs and stitches the
+// segments back together
+GraphAndMapping segmentAndStitch(
+    std::shared_ptr<torch::jit::Graph>& g,
+    PartitioningCtx& ctx,
+    const std::vector<int64_t>& max_shape) {
+  PartitionedGraph segmented_blocks;
+  for (auto n : g->nodes()) {
+    if (n->kind() != torch::jit::prim::Constant) {
+      segmented_blocks.emplace_back(SegmentedBlock::kTorch, std::vector<torch::jit::Node*>{n});
+    }
+  }
+  for (auto& seg_block : segmented_blocks) {
+    for (auto out : seg_block.raw_nodes()[0]->outputs()) {
+      seg_block.registerOutput(out);
+    }
+    std::vector<std::vector<int64_t>> in_shapes(seg_block.raw_inputs().size(), max_shape);
+    std::vector<at::ScalarType> in_types(seg_block.raw_inputs().size(), at::kFloat);
+    seg_block.register_inshapes(in_shapes, ir::ShapeMode::kMAX);
+    seg_block.register_intypes(in_types);
+  }
+  ctx.partitioned_blocks[g->block()] = segmented_blocks;
+  return stitch(&ctx, g->block());
+}
+} // namespace
+
+TEST(Partitioning, ArenaOffsetsReuseMemoryOfDeadTensors) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  std::vector<torch::jit::Value*> values;
+  for (int i = 0; i < 4; i++) {
+    values.push_back(g->addInput());
+  }
+  std::vector<TensorLifetime> tensors = {
+      {values[0], 0, 2, 1000},
+      {values[1], 1, 3, 1024},
+      {values[2], 3, 5, 1024},
+      {values[3], 4, 6, 2048},
+  };
+
+  auto plan = assignArenaOffsets(tensors);
+  ASSERT_TRUE(isValidPlan(plan));
+  // Tensors are placed largest first, the second tensor reuses the memory of the last since they are never alive at
+  // the same time. Sizes are rounded up to the alignment
+  ASSERT_EQ(plan.offsets[values[3]], 0UL);
+  ASSERT_EQ(plan.offsets[values[1]], 0UL);
+  ASSERT_EQ(plan.offsets[values[2]], 2048UL);
+  ASSERT_EQ(plan.offsets[values[0]], 1024UL);
+  ASSERT_EQ(plan.arena_size, 3072UL);
+  ASSERT_EQ(plan.naive_size, 5120UL);
+  ASSERT_EQ(plan.live_peak, 3072UL);
+}
+
+TEST(Partitioning, PlanSegmentMemoryFromStitchedGraph) {
+  const auto graph = R"IR(
+    graph(%x : Tensor):
+      %alpha : int = prim::Constant[value=1]()
+      %1 : Tensor = aten::relu(%x)
+      %2 : Tensor = aten::sigmoid(%1)
+      %3 : Tensor = aten::tanh(%2)
+      %4 : Tensor = aten::exp(%3)
+      %5 : Tensor = aten::add(%4, %1, %alpha)
+      return (%5))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+  PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  PartitioningCtx ctx(g->block(), partitioning_info);
+  auto graph_and_mapping = segmentAndStitch(g, ctx, {16, 16});
+
+  auto plan = planSegmentMemory(&ctx, g->block(), graph_and_mapping);
+  LOG_DEBUG(plan);
+  ASSERT_TRUE(isValidPlan(plan));
+  // %x is owned by the caller and %5 is returned, %1 to %4 are passed between segments
+  ASSERT_EQ(plan.tensors.size(), 4UL);
+  ASSERT_EQ(plan.num_unplanned, 0UL);
+  ASSERT_EQ(plan.naive_size, 4UL * 1024);
+  // %2 is dead by the time %4 is created so they can share memory
+  ASSERT_EQ(plan.arena_size, 3UL * 1024);
+  ASSERT_EQ(plan.arena_size, plan.live_peak);
+}
+
+TEST(Partitioning, PlanSegmentMemoryExtendsLifetimesThroughViews) {
+  const auto graph = R"IR(
+    graph(%x : Tensor):
+      %alpha : int = prim::Constant[value=1]()
+      %1 : Tensor = aten::relu(%x)
+      %2 : Tensor = aten::t(%1)
+      %3 : Tensor = aten::sigmoid(%2)
+      %4 : Tensor = aten::tanh(%3)
+      %5 : Tensor = aten::add(%4, %2, %alpha)
+      return (%5))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+  PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  PartitioningCtx ctx(g->block(), partitioning_info);
+  auto graph_and_mapping = segmentAndStitch(g, ctx, {16, 16});
+  auto& old_to_new_g = graph_and_mapping.second;
+
+  auto plan = planSegmentMemory(&ctx, g->block(), graph_and_mapping);
+  ASSERT_TRUE(isValidPlan(plan));
+
+  // %2 is a view of %1 so it is not planned on its own, but keeps %1 alive until the add
+  torch::jit::Value* relu_out = nullptr;
+  torch::jit::Value* t_out = nullptr;
+  for (auto n : g->nodes()) {
+    if (n->kind() == torch::jit::aten::relu) {
+      relu_out = old_to_new_g.at(n->output());
+    } else if (n->kind() == torch::jit::aten::t) {
+      t_out = old_to_new_g.at(n->output());
+    }
+  }
+  ASSERT_EQ(plan.num_unplanned, 1UL);
+  ASSERT_EQ(plan.offsets.count(t_out), 0UL);
+  ASSERT_EQ(plan.offsets.count(relu_out), 1UL);
+
+  size_t last_use = 0;
+  size_t relu_last_use = 0;
+  for (const auto& t : plan.tensors) {
+    last_use = std::max(last_use, t.last_use);
+    if (t.value == relu_out) {
+      relu_last_use = t.last_use;
+    }
+  }
+  ASSERT_EQ(relu_last_use, last_use);
+}
+
+TEST(Partitioning, PlanSegmentMemoryAfterPartitioningStaticInputs) {
+  const auto graph = R"IR(
+    graph(%x : Tensor):
+      %1 : Tensor = aten::relu(%x)
+      %2 : Tensor = aten::log_sigmoid(%1)
+      %3 : Tensor = aten::relu(%2)
+      %4 : Tensor = aten::log_sigmoid(%3)
+      %5 : Tensor = aten::relu(%4)
+      return (%5))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+  PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  partitioning_info.forced_fallback_operators.push_back("aten::log_sigmoid");
+  partitioning_info.collection_input_spec_map = {{g->inputs()[0], {ir::Input({4, 16})}}};
+  PartitioningCtx ctx(g->block(), partitioning_info);
+  ctx.input_types_map = {{g->inputs()[0], {{at::kFloat}}}};
+
+  // Static inputs only get opt shapes from shape analysis
+  populateInputIValues(&ctx);
+  partition(&ctx);
+  auto graph_and_mapping = stitch(&ctx, g->block());
+
+  auto plan = planSegmentMemory(&ctx, g->block(), graph_and_mapping);
+  ASSERT_TRUE(isValidPlan(plan));
+  // %1 to %4 are passed between segments, each of them 4 * 16 floats
+  ASSERT_EQ(plan.tensors.size(), 4UL);
+  for (const auto& t : plan.tensors) {
+    ASSERT_EQ(t.size, 4UL * 16 * sizeof(float));
+  }
+  ASSERT_GT(plan.arena_size, 0UL);
+}
+
+} // namespace tests
+} // namespace partitioning
+} // namespace core
+} // namespace torch_tensorrt
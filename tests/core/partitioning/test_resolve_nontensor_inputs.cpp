@@ -20,7 +20,7 @@ bool checkSegmentedBlockInputType(
 int count_trt_engines(std::shared_ptr<torch::jit::Graph> g) {
   int count = 0;
   for (const auto n : g->nodes()) {
-    if (n->kind().toQualString() == std::string("tensorrt::execute_engine")) {
+    if (n->kind().toQualString() == std::string("tensorrt::execute_engine_unpacked")) {
       ++count;
     }
   }
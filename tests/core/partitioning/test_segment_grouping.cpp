@@ -0,0 +1,145 @@
+#include <string>
+#include "core/partitioning/partitioning.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/script.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace partitioning {
+namespace tests {
+
+namespace {
+// Three conv + relu blocks separated by ops forced to run in Torch, the first two only differ in weights
+const auto repeated_block_graph = R"IR(
+      graph(%0 : Tensor,
+            %w1 : Float(16, 16, 3, 3, strides=[144, 9, 3, 1]),
+            %b1 : Float(16),
+            %w2 : Float(16, 16, 3, 3, strides=[144, 9, 3, 1]),
+            %b2 : Float(16),
+            %w3 : Float(8, 16, 3, 3, strides=[144, 9, 3, 1]),
+            %b3 : Float(8)):
+        %2 : int[] = prim::Constant[value=[1, 1]]()
+        %3 : int = prim::Constant[value=1]()
+        %10 : bool = prim::Constant[value=0]()
+        %11 : int[] = prim::Constant[value=[0, 0]]()
+        %12 : Tensor = aten::_convolution(%0, %w1, %b1, %2, %2, %2, %10, %11, %3, %10, %10, %10, %10)
+        %13 : Tensor = aten::relu(%12)
+        %14 : Tensor = aten::log_sigmoid(%13)
+        %15 : Tensor = aten::_convolution(%14, %w2, %b2, %2, %2, %2, %10, %11, %3, %10, %10, %10, %10)
+        %16 : Tensor = aten::relu(%15)
+        %17 : Tensor = aten::log_sigmoid(%16)
+        %18 : Tensor = aten::_convolution(%17, %w3, %b3, %2, %2, %2, %10, %11, %3, %10, %10, %10, %10)
+        %19 : Tensor = aten::relu(%18)
+        return (%19))IR";
+
+// Replaces the weight inputs of the graph with tensor constants, like they are after the module is frozen
+void freezeWeights(std::shared_ptr<torch::jit::Graph>& g) {
+  torch::jit::WithInsertPoint guard(*g->nodes().begin());
+  for (size_t i = g->inputs().size() - 1; i > 0; i--) {
+    auto in = g->inputs()[i];
+    auto sizes = in->type()->expect<c10::TensorType>()->sizes().concrete_sizes().value();
+    in->replaceAllUsesWith(g->insertConstant(at::randn(sizes)));
+    g->eraseInput(i);
+  }
+}
+
+bool isTensorConstant(const torch::jit::Node* n) {
+  return n->kind() == torch::jit::prim::Constant && n->hasAttribute(c10::attr::value) &&
+      n->kindOf(c10::attr::value) == torch::jit::AttributeKind::t;
+}
+
+PartitionedGraph segmentRepeatedBlockGraph(std::shared_ptr<torch::jit::Graph>& g) {
+  torch::jit::parseIR(repeated_block_graph, g.get());
+  freezeWeights(g);
+  LOG_GRAPH(*g);
+
+  PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  partitioning_info.forced_fallback_operators = {"aten::log_sigmoid"};
+  PartitioningCtx ctx(g->block(), partitioning_info);
+  segmentGraph(&ctx, g->block());
+  return ctx.partitioned_blocks.begin()->second;
+}
+} // namespace
+
+TEST(Partitioning, GroupStructurallyIdenticalSegmentsCorrectly) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  auto segmented_blocks = segmentRepeatedBlockGraph(g);
+  ASSERT_EQ(segmented_blocks.size(), 5UL);
+
+  auto first = canonicalizeSegmentedBlock(segmented_blocks[0]);
+  ASSERT_FALSE(first.empty());
+  ASSERT_EQ(first, canonicalizeSegmentedBlock(segmented_blocks[2]));
+  ASSERT_NE(first, canonicalizeSegmentedBlock(segmented_blocks[4]));
+
+  auto groups = groupIdenticalSegments(segmented_blocks);
+  std::vector<std::vector<size_t>> expected_groups = {{0, 2}, {4}};
+  ASSERT_EQ(groups, expected_groups);
+}
+
+TEST(Partitioning, SegmentsWithDifferentInputShapesAreNotGrouped) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  auto segmented_blocks = segmentRepeatedBlockGraph(g);
+  ASSERT_EQ(segmented_blocks.size(), 5UL);
+
+  std::vector<std::vector<int64_t>> small_shapes = {{1, 16, 8, 8}};
+  std::vector<std::vector<int64_t>> large_shapes = {{1, 16, 16, 16}};
+  segmented_blocks[0].register_inshapes(small_shapes, ir::ShapeMode::kOPT);
+  segmented_blocks[2].register_inshapes(large_shapes, ir::ShapeMode::kOPT);
+
+  auto groups = groupIdenticalSegments(segmented_blocks);
+  std::vector<std::vector<size_t>> expected_groups = {{0}, {2}, {4}};
+  ASSERT_EQ(groups, expected_groups);
+}
+
+TEST(Partitioning, CanonicalFormWithWeightsDistinguishesWeights) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  auto segmented_blocks = segmentRepeatedBlockGraph(g);
+  ASSERT_EQ(segmented_blocks.size(), 5UL);
+
+  // Segments only differing in weights no longer compare equal
+  std::vector<at::Tensor> first_weights, second_weights;
+  auto first = canonicalizeSegmentedBlock(segmented_blocks[0], &first_weights);
+  ASSERT_FALSE(first.empty());
+  ASSERT_NE(first, canonicalizeSegmentedBlock(segmented_blocks[2], &second_weights));
+  ASSERT_EQ(first_weights.size(), 2UL);
+  ASSERT_EQ(second_weights.size(), 2UL);
+}
+
+TEST(Partitioning, CanonicalFormWithWeightsMatchesCopiesOfWeights) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(repeated_block_graph, g.get());
+  freezeWeights(g);
+
+  // The same graph lowered again (ex. for another method of the module) holds copies of the weights
+  auto copy = g->copy();
+  for (auto n : copy->nodes()) {
+    if (isTensorConstant(n)) {
+      n->t_(c10::attr::value, n->t(c10::attr::value).clone());
+    }
+  }
+
+  std::vector<at::Tensor> weights, copy_weights;
+  auto canonical = canonicalizeBlockWithWeights(g->block(), &weights);
+  ASSERT_FALSE(canonical.empty());
+  ASSERT_EQ(canonical, canonicalizeBlockWithWeights(copy->block(), &copy_weights));
+  ASSERT_EQ(weights.size(), 6UL);
+  ASSERT_FALSE(weights[0].is_same(copy_weights[0]));
+
+  // Changing a single weight changes the canonical form
+  for (auto n : copy->nodes()) {
+    if (isTensorConstant(n)) {
+      n->t_(c10::attr::value, n->t(c10::attr::value) + 1);
+      break;
+    }
+  }
+  copy_weights.clear();
+  ASSERT_NE(canonical, canonicalizeBlockWithWeights(copy->block(), &copy_weights));
+}
+
+} // namespace tests
+} // namespace partitioning
+} // namespace core
+} // namespace torch_tensorrt
@@ -1,3 +1,4 @@
+#include <sstream>
 #include <string>
 #include "core/partitioning/partitioning.h"
 #include "gtest/gtest.h"
@@ -331,6 +332,53 @@ TEST(Partitioning, SegmentModelWithDependencyAwareness) {
       checkSegmentedBlockNodesMapping(ctx.partitioned_blocks.begin()->second, g, {{0, 2, 4}, {1, 3, 5}, {6, 7}}));
 }
 
+// Builds a chain of islands, alternating 4 and 2 TensorRT nodes, separated by nodes forced to fallback
+std::shared_ptr<torch::jit::Graph> buildSyntheticIslandGraph(size_t num_island_pairs) {
+  std::stringstream ir;
+  ir << "graph(%x : Tensor):\n";
+  std::string prev = "%x";
+  size_t id = 0;
+  auto emit = [&](const std::string& op) {
+    auto out = "%v" + std::to_string(id++);
+    ir << "  " << out << " : Tensor = " << op << "(" << prev << ")\n";
+    prev = out;
+  };
+  for (size_t i = 0; i < num_island_pairs; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      emit("aten::relu");
+    }
+    emit("aten::log_sigmoid");
+    for (size_t j = 0; j < 2; ++j) {
+      emit("aten::relu");
+    }
+    emit("aten::log_sigmoid");
+  }
+  ir << "  return (" << prev << ")";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(ir.str(), g.get());
+  return g;
+}
+
+TEST(Partitioning, SegmentLargeSyntheticGraphWithMinBlockSize) {
+  for (size_t num_island_pairs : {100, 1000}) {
+    auto g = buildSyntheticIslandGraph(num_island_pairs);
+
+    PartitioningInfo partitioning_info;
+    partitioning_info.enabled = true;
+    partitioning_info.min_block_size = 3;
+    partitioning_info.forced_fallback_operators.push_back("aten::log_sigmoid");
+    PartitioningCtx ctx(g->block(), partitioning_info);
+
+    segmentGraph(&ctx, g->block());
+
+    auto& segmented_blocks = ctx.partitioned_blocks.begin()->second;
+    int expected = static_cast<int>(num_island_pairs);
+    ASSERT_TRUE(checkSegmentedBlockNumber(segmented_blocks, SegmentedBlock::kTensorRT, expected));
+    ASSERT_TRUE(checkSegmentedBlockNumber(segmented_blocks, SegmentedBlock::kTorch, expected));
+  }
+}
+
 } // namespace tests
 } // namespace partitioning
 } // namespace core
@@ -171,3 +171,53 @@ TEST(Partitioning, PopulateInputIValuesDynamic) {
   ASSERT_EQ(ctx.min_input_ivalues_map.size(), 2UL);
   ASSERT_EQ(ctx.max_input_ivalues_map.size(), 2UL);
 }
+
+TEST(Partitioning, InferDynamicTorchSegmentedBlockShapesConcurrently) {
+  const auto graph = R"IR(
+          graph(%0 : Tensor, %1 : Tensor):
+            %2 : int = prim::Constant[value=1]()
+            %3 : Tensor = aten::log_sigmoid(%0)
+            %4 : Tensor = aten::add(%3, %1, %2)
+            %5 : Tensor = aten::relu(%4)
+            return (%5))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get(), true);
+
+  torch_tensorrt::core::partitioning::PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  partitioning_info.truncate_long_and_double = true;
+  partitioning_info.forced_fallback_operators = {"aten::log_sigmoid", "aten::add", "aten::relu"};
+
+  std::unordered_map<const torch::jit::Value*, std::vector<torch_tensorrt::core::ir::Input>> inputs_map;
+  inputs_map.insert({g->inputs()[0], {torch_tensorrt::core::ir::Input({1, 4}, {2, 4}, {3, 4})}});
+  inputs_map.insert({g->inputs()[1], {torch_tensorrt::core::ir::Input({1, 4}, {2, 4}, {3, 4})}});
+  partitioning_info.collection_input_spec_map = inputs_map;
+  torch_tensorrt::core::partitioning::PartitioningCtx ctx(g->block(), partitioning_info);
+
+  // Torch only segments can be analyzed with CPU example inputs
+  std::vector<torch_tensorrt::core::partitioning::ExampleIValues*> ivalues_maps = {
+      &ctx.min_input_ivalues_map, &ctx.opt_input_ivalues_map, &ctx.max_input_ivalues_map};
+  for (int64_t i = 0; i < 3; ++i) {
+    (*ivalues_maps[i])[g->inputs()[0]] = at::randn({i + 1, 4});
+    (*ivalues_maps[i])[g->inputs()[1]] = at::randint(0, 5, {i + 1, 4}, {at::kLong});
+  }
+
+  torch_tensorrt::core::partitioning::partition(&ctx);
+  auto segmented_blocks = ctx.partitioned_blocks.begin()->second;
+
+  ASSERT_EQ(segmented_blocks.size(), 1UL);
+  auto& seg_block = segmented_blocks[0];
+  ASSERT_EQ(seg_block.in_min_shapes(), std::vector<std::vector<int64_t>>({{1, 4}, {1, 4}}));
+  ASSERT_EQ(seg_block.in_opt_shapes(), std::vector<std::vector<int64_t>>({{2, 4}, {2, 4}}));
+  ASSERT_EQ(seg_block.in_max_shapes(), std::vector<std::vector<int64_t>>({{3, 4}, {3, 4}}));
+
+  // The Long input cast must be inserted once, not once per shape mode
+  size_t num_casts = 0;
+  for (auto n : seg_block.nodes()) {
+    if (n->kind() == torch::jit::aten::to) {
+      num_casts++;
+    }
+  }
+  ASSERT_EQ(num_casts, 1UL);
+}
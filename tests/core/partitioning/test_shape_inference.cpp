@@ -0,0 +1,299 @@
+#include <string>
+#include "core/partitioning/partitioning.h"
+#include "gtest/gtest.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/script.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace partitioning {
+namespace tests {
+
+namespace {
+// Partitions the graph without generating example inputs, so shape analysis can only succeed symbolically
+PartitionedGraph partitionWithoutExampleInputs(
+    std::shared_ptr<torch::jit::Graph>& g,
+    std::vector<ir::Input> inputs,
+    std::vector<std::string> forced_fallback_operators = {}) {
+  PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  partitioning_info.symbolic_shape_analysis = true;
+  partitioning_info.forced_fallback_operators = forced_fallback_operators;
+  for (size_t i = 0; i < g->inputs().size(); ++i) {
+    partitioning_info.collection_input_spec_map.insert({g->inputs()[i], {inputs[i]}});
+  }
+  PartitioningCtx ctx(g->block(), partitioning_info);
+  for (size_t i = 0; i < g->inputs().size(); ++i) {
+    ctx.input_types_map.insert({g->inputs()[i], {{at::kFloat}}});
+  }
+  partition(&ctx);
+  return ctx.partitioned_blocks.begin()->second;
+}
+
+std::vector<std::vector<std::vector<int64_t>>> optShapes(PartitionedGraph& segmented_blocks) {
+  std::vector<std::vector<std::vector<int64_t>>> shapes;
+  for (auto& seg_block : segmented_blocks) {
+    shapes.push_back(seg_block.in_opt_shapes());
+  }
+  return shapes;
+}
+
+torch::jit::Value* findOutput(std::shared_ptr<torch::jit::Graph>& g, const char* kind) {
+  for (auto n : g->nodes()) {
+    if (n->kind() == c10::Symbol::fromQualString(kind)) {
+      return n->output();
+    }
+  }
+  return nullptr;
+}
+} // namespace
+
+// Same model and expectations as InferSequentialModelSegmentedBlockShapeCorrectly in test_shape_analysis.cpp
+TEST(Partitioning, InferSequentialModelSegmentedBlockShapeSymbolically) {
+  const auto graph = R"IR(
+          graph(%0 : Tensor,
+                %w1 : Float(32, 3, 3, 3, strides=[27, 9, 3, 1]),
+                %b1 : Float(32),
+                %w2 : Float(16, 32, 3, 3, strides=[288, 9, 3, 1]),
+                %b2 : Float(16),
+                %w3 : Float(8, 16, 3, 3, strides=[144, 9, 3, 1]),
+                %b3 : Float(8)):
+            %2 : int[] = prim::Constant[value=[1, 1]]()
+            %3 : int = prim::Constant[value=1]()
+            %10 : bool = prim::Constant[value=0]()
+            %11 : int[] = prim::Constant[value=[0, 0]]()
+            %12: Tensor = aten::_convolution(%0, %w1, %b1, %2, %2, %2, %10, %11, %3, %10, %10, %10, %10)
+            %13 : Tensor = aten::relu(%12)
+            %14 : Tensor = aten::_convolution(%13, %w2, %b2, %2, %2, %2, %10, %11, %3, %10, %10, %10, %10)
+            %15 : Tensor = aten::log_sigmoid(%14)
+            %16 : Tensor = aten::_convolution(%15, %w3, %b3, %2, %2, %2, %10, %11, %3, %10, %10, %10, %10)
+            return (%16))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+  auto segmented_blocks = partitionWithoutExampleInputs(
+      g,
+      {ir::Input({3, 3, 16, 16}),
+       ir::Input({32, 3, 3, 3}),
+       ir::Input({32}),
+       ir::Input({16, 32, 3, 3}),
+       ir::Input({16}),
+       ir::Input({8, 16, 3, 3}),
+       ir::Input({8})});
+
+  std::vector<std::vector<std::vector<int64_t>>> expected = {
+      {{3, 3, 16, 16}, {32, 3, 3, 3}, {32}, {16, 32, 3, 3}, {16}},
+      {{3, 16, 16, 16}},
+      {{3, 16, 16, 16}, {8, 16, 3, 3}, {8}}};
+  ASSERT_EQ(optShapes(segmented_blocks), expected);
+}
+
+// Same model and expectations as InferBranchModelSegmentedBlockShapeCorrectly in test_shape_analysis.cpp
+TEST(Partitioning, InferBranchModelSegmentedBlockShapeSymbolically) {
+  const auto graph = R"IR(
+                  graph(%0 : Tensor,
+                        %1 : Float(32, 3, 3, 3, strides=[27, 9, 3, 1]),
+                        %2 : Float(32),
+                        %3 : Float(16, 32, 3, 3, strides=[288, 9, 3, 1]),
+                        %4 : Float(16)):
+                    %5 : int[] = prim::Constant[value=[0, 0]]()
+                    %6 : int[] = prim::Constant[value=[2, 2]]()
+                    %7 : bool = prim::Constant[value=0]()
+                    %8 : int[] = prim::Constant[value=[1, 1]]()
+                    %9 : int = prim::Constant[value=1]()
+                    %10: Tensor = aten::_convolution(%0, %1, %2, %8, %8, %8, %7, %5, %9, %7, %7, %7, %7)
+                    %11 : Tensor = aten::_convolution(%10, %3, %4, %8, %8, %8, %7, %5, %9, %7, %7, %7, %7)
+                    %12: Tensor = aten::log_sigmoid(%10)
+                    %13 : Tensor = aten::_convolution(%12, %3, %4,  %8, %8, %8, %7, %5, %9, %7, %7, %7, %7)
+                    %14 : Tensor = aten::relu(%11)
+                    %15 : Tensor = aten::add(%13, %14, %9)
+                    %16 : Tensor = aten::max_pool2d(%15, %6, %6, %5, %8, %7)
+                    return (%16))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+  auto segmented_blocks = partitionWithoutExampleInputs(
+      g,
+      {ir::Input({3, 3, 16, 16}),
+       ir::Input({32, 3, 3, 3}),
+       ir::Input({32}),
+       ir::Input({16, 32, 3, 3}),
+       ir::Input({16})});
+
+  std::vector<std::vector<std::vector<int64_t>>> expected = {
+      {{3, 3, 16, 16}, {32, 3, 3, 3}, {32}, {16, 32, 3, 3}, {16}},
+      {{3, 32, 16, 16}},
+      {{3, 32, 16, 16}, {16, 32, 3, 3}, {16}, {3, 16, 16, 16}}};
+  ASSERT_EQ(optShapes(segmented_blocks), expected);
+}
+
+TEST(Partitioning, InferDynamicSegmentedBlockShapesSymbolically) {
+  const auto graph = R"IR(
+          graph(%x : Tensor,
+                %w : Float(8, 3, 3, 3, strides=[27, 9, 3, 1]),
+                %b : Float(8)):
+            %1 : int = prim::Constant[value=1]()
+            %2 : int = prim::Constant[value=-1]()
+            %stride : int[] = prim::Constant[value=[2, 2]]()
+            %padding : int[] = prim::Constant[value=[1, 1]]()
+            %dilation : int[] = prim::Constant[value=[1, 1]]()
+            %output_padding : int[] = prim::Constant[value=[0, 0]]()
+            %false : bool = prim::Constant[value=0]()
+            %c : Tensor = aten::_convolution(%x, %w, %b, %stride, %padding, %dilation, %false, %output_padding, %1, %false, %false, %false, %false)
+            %r : Tensor = aten::relu(%c)
+            %f : Tensor = aten::flatten(%r, %1, %2)
+            %s : Tensor = aten::sigmoid(%f)
+            return (%s))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+  auto segmented_blocks = partitionWithoutExampleInputs(
+      g,
+      {ir::Input({1, 3, 16, 16}, {4, 3, 32, 32}, {8, 3, 64, 64}), ir::Input({8, 3, 3, 3}), ir::Input({8})},
+      {"aten::relu"});
+
+  // conv -> relu (Torch) -> flatten, sigmoid
+  ASSERT_EQ(segmented_blocks.size(), 3UL);
+  ASSERT_EQ(segmented_blocks[1].target(), SegmentedBlock::kTorch);
+  ASSERT_EQ(segmented_blocks[1].in_min_shapes(), std::vector<std::vector<int64_t>>({{1, 8, 8, 8}}));
+  ASSERT_EQ(segmented_blocks[1].in_opt_shapes(), std::vector<std::vector<int64_t>>({{4, 8, 16, 16}}));
+  ASSERT_EQ(segmented_blocks[1].in_max_shapes(), std::vector<std::vector<int64_t>>({{8, 8, 32, 32}}));
+  ASSERT_EQ(segmented_blocks[2].in_min_shapes(), std::vector<std::vector<int64_t>>({{1, 8, 8, 8}}));
+  ASSERT_EQ(segmented_blocks[2].in_max_shapes(), std::vector<std::vector<int64_t>>({{8, 8, 32, 32}}));
+}
+
+TEST(Partitioning, SymbolicShapesTrackInputDimensions) {
+  const auto graph = R"IR(
+          graph(%x : Tensor, %y : Tensor):
+            %0 : int = prim::Constant[value=0]()
+            %1 : int = prim::Constant[value=1]()
+            %2 : int = prim::Constant[value=2]()
+            %minus_one : int = prim::Constant[value=-1]()
+            %n : int = aten::size(%x, %0)
+            %n2 : int = aten::mul(%n, %2)
+            %shape : int[] = prim::ListConstruct(%n2, %minus_one)
+            %v : Tensor = aten::view(%x, %shape)
+            %a : Tensor = aten::add(%x, %y, %1)
+            %t : Tensor = aten::transpose(%a, %0, %1)
+            return (%v, %t))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+
+  PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  partitioning_info.collection_input_spec_map.insert({g->inputs()[0], {ir::Input({2, 8}, {4, 8}, {6, 8})}});
+  // %y broadcasts along the first dimension of %x
+  partitioning_info.collection_input_spec_map.insert({g->inputs()[1], {ir::Input({1, 8})}});
+  PartitioningCtx ctx(g->block(), partitioning_info);
+  auto shapes = inferSymbolicShapes(&ctx, g->block());
+
+  const auto& v = shapes.at(findOutput(g, "aten::view"));
+  ASSERT_EQ(v.kind, SymValue::Kind::kTensor);
+  ASSERT_EQ(v.shape(ir::ShapeMode::kMIN), std::vector<int64_t>({4, 4}));
+  ASSERT_EQ(v.shape(ir::ShapeMode::kOPT), std::vector<int64_t>({8, 4}));
+  ASSERT_EQ(v.shape(ir::ShapeMode::kMAX), std::vector<int64_t>({12, 4}));
+  ASSERT_EQ(v.dims[0].str(), "(s0*2)");
+  ASSERT_TRUE(v.dims[1].is_static());
+
+  const auto& t = shapes.at(findOutput(g, "aten::transpose"));
+  ASSERT_EQ(t.shape(ir::ShapeMode::kMAX), std::vector<int64_t>({8, 6}));
+  ASSERT_EQ(t.dims[1].str(), "s0");
+  ASSERT_EQ(t.dtype, at::kFloat);
+}
+
+TEST(Partitioning, SymbolicShapesRunOpsWithoutShapeFunctions) {
+  const auto graph = R"IR(
+          graph(%x : Tensor):
+            %2 : int = prim::Constant[value=2]()
+            %1 : Tensor = aten::pixel_shuffle(%x, %2)
+            %3 : Tensor = aten::relu(%1)
+            return (%3))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+
+  PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  partitioning_info.collection_input_spec_map.insert(
+      {g->inputs()[0], {ir::Input({1, 8, 4, 4}, {2, 8, 4, 4}, {4, 8, 4, 4})}});
+  PartitioningCtx ctx(g->block(), partitioning_info);
+  auto shapes = inferSymbolicShapes(&ctx, g->block());
+
+  // aten::pixel_shuffle has no shape function so it is run on CPU for each input shape
+  const auto& out = shapes.at(g->outputs()[0]);
+  ASSERT_EQ(out.kind, SymValue::Kind::kTensor);
+  ASSERT_EQ(out.shape(ir::ShapeMode::kMIN), std::vector<int64_t>({1, 2, 8, 8}));
+  ASSERT_EQ(out.shape(ir::ShapeMode::kOPT), std::vector<int64_t>({2, 2, 8, 8}));
+  ASSERT_EQ(out.shape(ir::ShapeMode::kMAX), std::vector<int64_t>({4, 2, 8, 8}));
+}
+
+TEST(Partitioning, SymbolicShapeAnalysisDefersToExecutionForControlFlow) {
+  const auto graph = R"IR(
+          graph(%x : Tensor):
+            %c : bool = prim::Constant[value=1]()
+            %y : Tensor = prim::If(%c)
+              block0():
+                %a : Tensor = aten::relu(%x)
+                -> (%a)
+              block1():
+                -> (%x)
+            %z : Tensor = aten::sigmoid(%y)
+            return (%z))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+
+  PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  partitioning_info.collection_input_spec_map.insert({g->inputs()[0], {ir::Input({1, 4}, {2, 4}, {3, 4})}});
+  PartitioningCtx ctx(g->block(), partitioning_info);
+
+  auto z = findOutput(g, "aten::sigmoid");
+  PartitionedGraph segmented_blocks;
+  segmented_blocks.emplace_back(SegmentedBlock::kTorch, std::vector<torch::jit::Node*>{z->node()});
+  segmented_blocks[0].registerOutput(z);
+  ctx.partitioned_blocks[g->block()] = segmented_blocks;
+
+  auto shapes = inferSymbolicShapes(&ctx, g->block());
+  ASSERT_EQ(shapes.at(z).kind, SymValue::Kind::kUnknown);
+  // The input of the segment depends on the prim::If so the segment has to be run instead
+  ASSERT_FALSE(runSymbolicShapeAnalysis(&ctx, g->block()));
+  ASSERT_TRUE(ctx.partitioned_blocks[g->block()][0].in_opt_shapes().empty());
+}
+
+TEST(Partitioning, SymbolicShapeAnalysisDefersToExecutionForMutation) {
+  const auto graph = R"IR(
+          graph(%x : Tensor):
+            %0 : int = prim::Constant[value=0]()
+            %l : Tensor[] = prim::ListConstruct(%x)
+            %a : Tensor[] = aten::append(%l, %x)
+            %y : Tensor = aten::cat(%l, %0)
+            %z : Tensor = aten::sigmoid(%y)
+            return (%z))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+
+  PartitioningInfo partitioning_info;
+  partitioning_info.enabled = true;
+  partitioning_info.symbolic_shape_analysis = true;
+  partitioning_info.collection_input_spec_map.insert({g->inputs()[0], {ir::Input({1, 4}, {2, 4}, {3, 4})}});
+  PartitioningCtx ctx(g->block(), partitioning_info);
+
+  auto z = findOutput(g, "aten::sigmoid");
+  PartitionedGraph segmented_blocks;
+  segmented_blocks.emplace_back(SegmentedBlock::kTorch, std::vector<torch::jit::Node*>{z->node()});
+  segmented_blocks[0].registerOutput(z);
+  ctx.partitioned_blocks[g->block()] = segmented_blocks;
+
+  // The list holds two tensors by the time aten::cat reads it, the shape of %y cannot be taken from its construction
+  auto shapes = inferSymbolicShapes(&ctx, g->block());
+  ASSERT_EQ(shapes.count(findOutput(g, "aten::cat")), 0u);
+  ASSERT_FALSE(runSymbolicShapeAnalysis(&ctx, g->block()));
+}
+
+} // namespace tests
+} // namespace partitioning
+} // namespace core
+} // namespace torch_tensorrt
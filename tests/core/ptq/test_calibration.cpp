@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <string>
+#include "core/ptq/calibration.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/script.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace ptq {
+namespace tests {
+
+namespace {
+// Linear layer followed by a ReLU. The graph is lowered for cuda:0 and the transpose of the weights only depends on
+// parameters, so it is not observed
+const auto kGraph = R"IR(
+    graph(%x : Tensor, %w : Tensor, %b : Tensor):
+      %none : NoneType = prim::Constant()
+      %false : bool = prim::Constant[value=0]()
+      %float : int = prim::Constant[value=6]()
+      %dev : Device = prim::Constant[value="cuda:0"]()
+      %wt : Tensor = aten::t(%w)
+      %y : Tensor = aten::linear(%x, %w, %b)
+      %z : Tensor = aten::relu(%y)
+      %out : Tensor = aten::to(%z, %dev, %float, %false, %false, %none)
+      return (%out, %y))IR";
+
+std::shared_ptr<torch::jit::Graph> ParseGraph() {
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(kGraph, g.get());
+  return g;
+}
+
+std::vector<std::vector<torch::jit::IValue>> MakeBatches(size_t num_batches) {
+  std::vector<std::vector<torch::jit::IValue>> batches;
+  for (size_t i = 0; i < num_batches; i++) {
+    batches.push_back({at::randn({4, 16}) * static_cast<double>(i + 1)});
+  }
+  return batches;
+}
+} // namespace
+
+TEST(CoreTest, HistogramMergeMatchesSinglePass) {
+  std::vector<at::Tensor> batches = {
+      at::zeros({64}), at::randn({1000}) * 0.01, at::randn({1000}) * 3, at::rand({1000}) * 40, at::randn({1000})};
+
+  Histogram single_pass;
+  for (auto& b : batches) {
+    single_pass.Add(b);
+  }
+  Histogram first, second;
+  for (size_t i = 0; i < batches.size(); i++) {
+    (i % 2 ? second : first).Add(batches[i]);
+  }
+  first.Merge(second);
+
+  ASSERT_EQ(first.Range(), single_pass.Range());
+  ASSERT_EQ(first.Amax(), single_pass.Amax());
+  ASSERT_EQ(first.Counts(), single_pass.Counts());
+  int64_t total = 0;
+  for (auto c : single_pass.Counts()) {
+    total += c;
+  }
+  ASSERT_EQ(total, 64 + 4 * 1000);
+  // The range is the smallest power of two above every value
+  ASSERT_GT(single_pass.Range(), single_pass.Amax());
+  ASSERT_LE(single_pass.Range() / 2, single_pass.Amax());
+}
+
+TEST(CoreTest, HistogramEntropyRangeClipsOutliers) {
+  auto x = at::randn({100000});
+  x.index_put_({at::indexing::Slice(0, 4)}, 20);
+
+  Histogram h;
+  h.Add(x);
+  ASSERT_EQ(h.Amax(), 20);
+  // The range settles a few standard deviations out instead of covering the outliers
+  auto amax = h.EntropyAmax();
+  ASSERT_GT(amax, 2);
+  ASSERT_LT(amax, 10);
+
+  // Without a histogram the largest value is the only range there is
+  Histogram min_max(0);
+  min_max.Add(x);
+  ASSERT_EQ(min_max.NumBins(), 0u);
+  ASSERT_EQ(min_max.EntropyAmax(), 20);
+}
+
+TEST(CoreTest, CalibrationCacheRoundTrips) {
+  TensorRanges scales = {{"input_0", 0.5f / 127}, {"x.1", 1.f}, {"output_0", 3.25e-3f}};
+  auto cache = WriteCalibrationCache(scales, CalibrationAlgorithm::kMINMAX, 8601);
+  ASSERT_EQ(cache.rfind("TRT-8601-MinMaxCalibration\n", 0), 0u);
+  ASSERT_NE(cache.find("x.1: 3f800000\n"), std::string::npos);
+
+  CalibrationAlgorithm algorithm = CalibrationAlgorithm::kENTROPY;
+  auto read = ReadCalibrationCache(cache, &algorithm);
+  ASSERT_EQ(algorithm, CalibrationAlgorithm::kMINMAX);
+  ASSERT_EQ(read, scales);
+
+  auto entropy_cache = WriteCalibrationCache(scales, CalibrationAlgorithm::kENTROPY, 8601);
+  ASSERT_EQ(entropy_cache.rfind("TRT-8601-EntropyCalibration2\n", 0), 0u);
+  ASSERT_ANY_THROW(ReadCalibrationCache("input_0: 3f800000\n"));
+  ASSERT_ANY_THROW(ReadCalibrationCache("TRT-8601-EntropyCalibration2\ninput_0 3f800000\n"));
+}
+
+TEST(CoreTest, ActivationRangeCollectorObservesNetworkTensorsOnCPU) {
+  auto w = at::randn({8, 16});
+  auto b = at::randn({8});
+  auto batches = MakeBatches(6);
+
+  ActivationRangeCollector collector(ParseGraph(), {w, b}, CalibrationAlgorithm::kMINMAX);
+  collector.Collect(batches, 1);
+  ASSERT_EQ(collector.TensorNames(), std::vector<std::string>({"input_0", "output_1", "z", "output_0"}));
+
+  float input_amax = 0, output_amax = 0;
+  for (auto& batch : batches) {
+    auto x = batch[0].toTensor();
+    input_amax = std::max(input_amax, x.abs().max().item<float>());
+    output_amax = std::max(output_amax, at::linear(x, w, b).abs().max().item<float>());
+  }
+  auto ranges = collector.Ranges();
+  ASSERT_EQ(ranges.size(), 4u);
+  ASSERT_EQ(ranges[0].second, input_amax);
+  ASSERT_FLOAT_EQ(ranges[1].second, output_amax);
+
+  auto cache = ReadCalibrationCache(collector.CalibrationCache());
+  ASSERT_EQ(cache.size(), ranges.size());
+  for (size_t i = 0; i < cache.size(); i++) {
+    ASSERT_EQ(cache[i].first, ranges[i].first);
+    ASSERT_FLOAT_EQ(cache[i].second * 127, ranges[i].second);
+  }
+}
+
+TEST(CoreTest, ActivationRangeCollectorThreadsMatchSingleThread) {
+  auto w = at::randn({8, 16});
+  auto b = at::randn({8});
+  auto batches = MakeBatches(32);
+
+  ActivationRangeCollector single(ParseGraph(), {w, b});
+  single.Collect(batches, 1);
+  ActivationRangeCollector threaded(ParseGraph(), {w, b});
+  threaded.Collect(batches, 4);
+
+  ASSERT_EQ(threaded.TensorNames(), single.TensorNames());
+  for (auto& name : single.TensorNames()) {
+    ASSERT_EQ(threaded.GetHistogram(name).Counts(), single.GetHistogram(name).Counts()) << name;
+  }
+  ASSERT_EQ(threaded.Ranges(), single.Ranges());
+  ASSERT_EQ(threaded.CalibrationCache(), single.CalibrationCache());
+
+  // Batches are checked against the inputs of the graph
+  ASSERT_ANY_THROW(threaded.Collect({{at::randn({4, 16}), at::randn({4, 16})}}, 2));
+}
+
+} // namespace tests
+} // namespace ptq
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,97 @@
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include "core/ptq/mixed_precision.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/script.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace ptq {
+namespace tests {
+
+namespace {
+// Linear layer followed by a ReLU and a scaling which overflows FP16 in between. The transpose of the weights only
+// depends on parameters, so it is folded into weights and not measured
+const auto kGraph = R"IR(
+    graph(%x : Tensor, %w : Tensor, %b : Tensor):
+      %scale : float = prim::Constant[value=100000.]()
+      %wt : Tensor = aten::t(%w)
+      %y : Tensor = aten::linear(%x, %w, %b)
+      %z : Tensor = aten::relu(%y)
+      %big : Tensor = aten::mul(%z, %scale)
+      %out : Tensor = aten::div(%big, %scale)
+      return (%out))IR";
+
+std::shared_ptr<torch::jit::Graph> ParseGraph() {
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(kGraph, g.get());
+  return g;
+}
+
+std::vector<torch::jit::IValue> MakeParams() {
+  return {at::randn({8, 16}), at::randn({8})};
+}
+
+std::vector<std::vector<torch::jit::IValue>> MakeBatches(size_t num_batches) {
+  std::vector<std::vector<torch::jit::IValue>> batches;
+  for (size_t i = 0; i < num_batches; i++) {
+    batches.push_back({at::randn({4, 16})});
+  }
+  return batches;
+}
+} // namespace
+
+TEST(CoreTest, MixedPrecisionPlannerMeasuresNodesComputingActivations) {
+  MixedPrecisionPlanner planner(ParseGraph(), MakeParams());
+  planner.Analyze(MakeBatches(3));
+
+  std::vector<std::string> names;
+  for (const auto& s : planner.Sensitivities()) {
+    names.push_back(s.name);
+  }
+  ASSERT_EQ(names, std::vector<std::string>({"y", "z", "big", "out"}));
+  ASSERT_EQ(planner.Sensitivities()[0].kind, "aten::linear");
+}
+
+TEST(CoreTest, MixedPrecisionPlannerKeepsOverflowingNodesInFP32) {
+  MixedPrecisionPlanner planner(ParseGraph(), MakeParams(), at::kHalf);
+  planner.Analyze(MakeBatches(3));
+
+  // Scaling overflows FP16 and the division gets the overflowed input, while the linear layer and the ReLU are within
+  // the rounding error of FP16
+  LayerPrecisions expected = {{"big", nvinfer1::DataType::kFLOAT}, {"out", nvinfer1::DataType::kFLOAT}};
+  ASSERT_EQ(planner.Constraints(), expected);
+  for (const auto& s : planner.Sensitivities()) {
+    if (s.name == "y" || s.name == "z") {
+      ASSERT_LT(s.error, 1e-2);
+    } else {
+      ASSERT_EQ(s.error, std::numeric_limits<double>::infinity());
+    }
+  }
+}
+
+TEST(CoreTest, MixedPrecisionPlannerComparesErrorToTolerance) {
+  // BF16 does not overflow but rounds to 8 bits of mantissa, which exceeds a tight tolerance for every node
+  MixedPrecisionPlanner planner(ParseGraph(), MakeParams(), at::kBFloat16, 1e-4);
+  planner.Analyze(MakeBatches(2));
+
+  auto constraints = planner.Constraints();
+  ASSERT_EQ(constraints.size(), 4u);
+  ASSERT_EQ(constraints.count("y"), 1u);
+  for (const auto& s : planner.Sensitivities()) {
+    ASSERT_TRUE(std::isfinite(s.error));
+  }
+}
+
+TEST(CoreTest, MixedPrecisionPlannerRejectsNonFloatingPointPrecisions) {
+  ASSERT_THROW(MixedPrecisionPlanner(ParseGraph(), MakeParams(), at::kChar), torch_tensorrt::Error);
+}
+
+} // namespace tests
+} // namespace ptq
+} // namespace core
+} // namespace torch_tensorrt
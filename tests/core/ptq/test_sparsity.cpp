@@ -0,0 +1,78 @@
+#include <string>
+#include "core/lowering/passes/passes.h"
+#include "core/ptq/sparsity.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/script.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace ptq {
+namespace tests {
+
+namespace {
+// Two fully connected layers the way linear layers are lowered
+const auto kGraph = R"IR(
+    graph(%x : Tensor, %w1 : Tensor, %w2 : Tensor):
+      %w1_t : Tensor = aten::t(%w1)
+      %h : Tensor = aten::matmul(%x, %w1_t)
+      %r : Tensor = aten::relu(%h)
+      %w2_t : Tensor = aten::t(%w2)
+      %out : Tensor = aten::matmul(%r, %w2_t)
+      return (%out))IR";
+
+std::shared_ptr<torch::jit::Graph> ParseGraph() {
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(kGraph, g.get());
+  return g;
+}
+
+std::vector<std::vector<torch::jit::IValue>> MakeBatches(size_t num_batches) {
+  std::vector<std::vector<torch::jit::IValue>> batches;
+  for (size_t i = 0; i < num_batches; i++) {
+    batches.push_back({at::randn({4, 16})});
+  }
+  return batches;
+}
+} // namespace
+
+TEST(CoreTest, AnalyzeSparsityReportsLayersAndFLOPShares) {
+  auto w1 = lowering::passes::PruneTo2by4(at::randn({32, 16}), 1);
+  auto w2 = at::randn({8, 32});
+  auto report = AnalyzeSparsity(ParseGraph(), {w1, w2}, MakeBatches(2));
+
+  ASSERT_EQ(report.layers.size(), 2);
+  auto& first = report.layers[0];
+  auto& second = report.layers[1];
+  ASSERT_EQ(first.name, "h");
+  ASSERT_EQ(first.kind, "aten::matmul");
+  ASSERT_EQ(first.weight_shape, std::vector<int64_t>({32, 16}));
+  ASSERT_TRUE(first.IsSparse());
+  ASSERT_EQ(first.num_groups, 32 * 4);
+  ASSERT_EQ(second.name, "out");
+  ASSERT_FALSE(second.IsSparse());
+  ASSERT_EQ(second.dense_groups, 8 * 8);
+
+  // 4 rows of 32 dot products of 16 elements and 4 rows of 8 dot products of 32 elements
+  ASSERT_EQ(first.flops, 2 * 4 * 32 * 16);
+  ASSERT_EQ(second.flops, 2 * 4 * 8 * 32);
+  ASSERT_DOUBLE_EQ(first.flop_share, 2. / 3);
+  ASSERT_DOUBLE_EQ(report.sparse_flop_share, 2. / 3);
+  // Pruning the second layer drops half of its weights
+  ASSERT_GT(report.pruned_error, 0);
+}
+
+TEST(CoreTest, AnalyzeSparsityOfSparseGraphHasNoPruningError) {
+  auto w1 = lowering::passes::PruneTo2by4(at::randn({32, 16}), 1);
+  auto w2 = lowering::passes::PruneTo2by4(at::randn({8, 32}), 1);
+  auto report = AnalyzeSparsity(ParseGraph(), {w1, w2}, MakeBatches(3));
+
+  ASSERT_DOUBLE_EQ(report.sparse_flop_share, 1);
+  ASSERT_EQ(report.pruned_error, 0);
+}
+
+} // namespace tests
+} // namespace ptq
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,240 @@
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "core/runtime/BindingTable.h"
+#include "core/util/Exception.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+namespace tests {
+
+namespace {
+nvinfer1::Dims MakeDims(std::vector<int64_t> sizes) {
+  return util::toDims(c10::IntArrayRef(sizes));
+}
+
+// Stands in for nvinfer1::ICudaEngine, which looks bindings up by name as well
+struct FakeEngine {
+  struct Binding {
+    std::string name;
+    nvinfer1::DataType type;
+    nvinfer1::Dims shape;
+  };
+  std::vector<Binding> bindings;
+  std::unordered_map<std::string, size_t> index;
+
+  void add(const std::string& name, nvinfer1::DataType type, std::vector<int64_t> shape) {
+    index[name] = bindings.size();
+    bindings.push_back({name, type, MakeDims(shape)});
+  }
+  int32_t getNbIOTensors() const {
+    return static_cast<int32_t>(bindings.size());
+  }
+  const char* getIOTensorName(int32_t i) const {
+    return bindings[i].name.c_str();
+  }
+  nvinfer1::DataType getTensorDataType(const char* name) const {
+    return bindings[index.at(name)].type;
+  }
+  nvinfer1::Dims getTensorShape(const char* name) const {
+    return bindings[index.at(name)].shape;
+  }
+};
+
+// Stands in for nvinfer1::IExecutionContext, records what is bound. Outputs take the shape of the first input
+struct FakeContext {
+  std::vector<std::pair<const char*, nvinfer1::Dims>> shapes;
+  std::vector<std::pair<const char*, void*>> addresses;
+
+  bool setInputShape(const char* name, const nvinfer1::Dims& dims) {
+    shapes.emplace_back(name, dims);
+    return true;
+  }
+  bool setTensorAddress(const char* name, void* data) {
+    addresses.emplace_back(name, data);
+    return true;
+  }
+  nvinfer1::Dims getTensorShape(const char*) const {
+    return shapes.front().second;
+  }
+  void clear() {
+    shapes.clear();
+    addresses.clear();
+  }
+};
+
+struct Inputs {
+  std::vector<at::Tensor> tensors;
+  std::vector<at::Tensor> staged;
+
+  const at::Tensor& input(size_t i) const {
+    return staged.empty() || !staged[i].defined() ? tensors[i] : staged[i];
+  }
+  void stage(size_t i, at::Tensor t) {
+    staged.resize(tensors.size());
+    staged[i] = std::move(t);
+  }
+  void bind(FakeContext& ctx, const BindingTable& table) {
+    BindInputs(
+        ctx,
+        table,
+        at::Device(at::kCPU),
+        tensors.size(),
+        [this](size_t i) -> const at::Tensor& { return input(i); },
+        [this](size_t i, at::Tensor t) { stage(i, std::move(t)); });
+  }
+};
+
+FakeEngine MakeEngine(size_t num_inputs, std::vector<std::string>* in_names, std::vector<std::string>* out_names) {
+  FakeEngine engine;
+  for (size_t i = 0; i < num_inputs; i++) {
+    in_names->push_back("input_" + std::to_string(i));
+    engine.add(in_names->back(), i % 2 ? nvinfer1::DataType::kHALF : nvinfer1::DataType::kFLOAT, {2, 3, 4});
+  }
+  out_names->push_back("output_0");
+  engine.add(out_names->back(), nvinfer1::DataType::kFLOAT, {2, 3, 4});
+  return engine;
+}
+
+Inputs MakeInputs(size_t num_inputs) {
+  Inputs inputs;
+  for (size_t i = 0; i < num_inputs; i++) {
+    inputs.tensors.push_back(at::randn({2, 3, 4}).to(i % 2 ? at::kHalf : at::kFloat));
+  }
+  return inputs;
+}
+
+// What execute_engine did for each input on every call before the binding table
+void BindInputsByName(
+    FakeContext& ctx,
+    const FakeEngine& engine,
+    const std::vector<std::string>& names,
+    const std::vector<at::Tensor>& inputs,
+    const std::string& target_device) {
+  for (size_t i = 0; i < inputs.size(); i++) {
+    const std::string& name = names[i];
+    TORCHTRT_CHECK(inputs[i].device().str() == target_device, "Input " << i << " is on the wrong device");
+    auto expected_type = util::TRTDataTypeToScalarType(engine.getTensorDataType(name.c_str()));
+    TORCHTRT_CHECK(inputs[i].dtype() == expected_type, "Input " << i << " has the wrong type");
+    auto dims = util::toDimsPad(inputs[i].sizes(), 1);
+    ctx.setInputShape(name.c_str(), dims);
+    ctx.setTensorAddress(name.c_str(), inputs[i].data_ptr());
+  }
+}
+} // namespace
+
+TEST(Runtime, BindingTableIsBuiltFromTheEngine) {
+  std::vector<std::string> in_names, out_names;
+  auto engine = MakeEngine(3, &in_names, &out_names);
+  auto table = MakeBindingTable(engine, in_names, out_names);
+  ASSERT_EQ(table.inputs.size(), 3UL);
+  ASSERT_EQ(table.outputs.size(), 1UL);
+  for (size_t i = 0; i < in_names.size(); i++) {
+    ASSERT_EQ(table.inputs[i].trt_idx, static_cast<int64_t>(i));
+    // Names are interned in the binding names of the engine
+    ASSERT_EQ(table.inputs[i].name, in_names[i].c_str());
+    ASSERT_EQ(table.inputs[i].dtype, i % 2 ? at::kHalf : at::kFloat);
+    ASSERT_EQ(table.inputs[i].rank, 3);
+  }
+  ASSERT_EQ(table.outputs[0].trt_idx, 3);
+
+  in_names.push_back("missing");
+  ASSERT_THROW(MakeBindingTable(engine, in_names, out_names), torch_tensorrt::Error);
+}
+
+TEST(Runtime, BindingTableBindsInputsInPlace) {
+  std::vector<std::string> in_names, out_names;
+  auto engine = MakeEngine(2, &in_names, &out_names);
+  auto table = MakeBindingTable(engine, in_names, out_names);
+  FakeContext ctx;
+
+  auto inputs = MakeInputs(2);
+  inputs.bind(ctx, table);
+  ASSERT_TRUE(inputs.staged.empty());
+  ASSERT_EQ(ctx.addresses.size(), 2UL);
+  for (size_t i = 0; i < 2; i++) {
+    ASSERT_EQ(ctx.shapes[i].first, in_names[i].c_str());
+    ASSERT_EQ(util::toVec(ctx.shapes[i].second), (std::vector<int64_t>{2, 3, 4}));
+    ASSERT_EQ(ctx.addresses[i].second, inputs.tensors[i].data_ptr());
+  }
+
+  // Inputs which are not contiguous are copied, the copy is bound
+  ctx.clear();
+  inputs.tensors[1] = at::randn({4, 3, 2}).to(at::kHalf).permute({2, 1, 0});
+  inputs.bind(ctx, table);
+  ASSERT_FALSE(inputs.staged[0].defined());
+  ASSERT_TRUE(inputs.staged[1].is_contiguous());
+  ASSERT_EQ(ctx.addresses[1].second, inputs.staged[1].data_ptr());
+  ASSERT_TRUE(at::equal(inputs.staged[1], inputs.tensors[1]));
+
+  // 0-dim inputs are given a dimension as before
+  ctx.clear();
+  std::vector<std::string> scalar_names = {"scalar"};
+  FakeEngine scalar_engine;
+  scalar_engine.add("scalar", nvinfer1::DataType::kFLOAT, {1});
+  auto scalar_table = MakeBindingTable(scalar_engine, scalar_names, {});
+  Inputs scalar;
+  scalar.tensors.push_back(at::ones({}));
+  scalar.bind(ctx, scalar_table);
+  ASSERT_EQ(util::toVec(ctx.shapes[0].second), std::vector<int64_t>{1});
+}
+
+TEST(Runtime, BindingTableRejectsBadInputs) {
+  std::vector<std::string> in_names, out_names;
+  auto engine = MakeEngine(2, &in_names, &out_names);
+  auto table = MakeBindingTable(engine, in_names, out_names);
+  FakeContext ctx;
+
+  auto inputs = MakeInputs(2);
+  inputs.tensors[0] = inputs.tensors[0].to(at::kInt);
+  ASSERT_THROW(inputs.bind(ctx, table), torch_tensorrt::Error);
+
+  auto too_few = MakeInputs(1);
+  ASSERT_THROW(too_few.bind(ctx, table), torch_tensorrt::Error);
+}
+
+TEST(Runtime, BindingTableAllocatesOutputs) {
+  std::vector<std::string> in_names, out_names;
+  auto engine = MakeEngine(1, &in_names, &out_names);
+  auto table = MakeBindingTable(engine, in_names, out_names);
+  FakeContext ctx;
+  ctx.setInputShape(in_names[0].c_str(), MakeDims({5, 6}));
+
+  std::vector<at::Tensor> outputs(1);
+  BindOutputs(ctx, table, at::Device(at::kCPU), [&](size_t i, at::Tensor t) { outputs[i] = std::move(t); });
+  ASSERT_EQ(outputs[0].sizes().vec(), (std::vector<int64_t>{5, 6}));
+  ASSERT_EQ(outputs[0].scalar_type(), at::kFloat);
+  ASSERT_EQ(ctx.addresses.back().first, out_names[0].c_str());
+  ASSERT_EQ(ctx.addresses.back().second, outputs[0].data_ptr());
+}
+
+TEST(Runtime, BindingTableMatchesBindingByName) {
+  const size_t num_inputs = 8;
+  std::vector<std::string> in_names, out_names;
+  auto engine = MakeEngine(num_inputs, &in_names, &out_names);
+  auto table = MakeBindingTable(engine, in_names, out_names);
+  auto inputs = MakeInputs(num_inputs);
+
+  FakeContext by_name, by_table;
+  BindInputsByName(by_name, engine, in_names, inputs.tensors, "cpu");
+  inputs.bind(by_table, table);
+  ASSERT_TRUE(inputs.staged.empty());
+
+  ASSERT_EQ(by_table.shapes.size(), num_inputs);
+  ASSERT_EQ(by_table.addresses.size(), num_inputs);
+  for (size_t i = 0; i < num_inputs; i++) {
+    ASSERT_STREQ(by_table.shapes[i].first, by_name.shapes[i].first);
+    ASSERT_EQ(util::toVec(by_table.shapes[i].second), util::toVec(by_name.shapes[i].second));
+    ASSERT_STREQ(by_table.addresses[i].first, by_name.addresses[i].first);
+    ASSERT_EQ(by_table.addresses[i].second, by_name.addresses[i].second);
+  }
+}
+
+} // namespace tests
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,120 @@
+#include <random>
+#include <string>
+#include "core/util/Exception.h"
+#include "core/util/engine_codec.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace util {
+namespace tests {
+
+namespace {
+// Stands in for a serialized engine: runs of zeros, random bytes, repeating patterns and sparse weights like the
+// padding, weights and kernel tables of a real engine
+std::string SyntheticEngine(size_t size, uint32_t seed = 0) {
+  std::mt19937 rng(seed);
+  std::string engine;
+  engine.reserve(size);
+  while (engine.size() < size) {
+    auto kind = rng() % 4;
+    size_t length = 1 + rng() % 8192;
+    for (size_t i = 0; i < length && engine.size() < size; i++) {
+      if (kind == 0) {
+        engine.push_back(0);
+      } else if (kind == 1) {
+        engine.push_back(static_cast<char>(rng()));
+      } else if (kind == 2) {
+        engine.push_back(static_cast<char>((i % 16) * 3));
+      } else {
+        engine.push_back(static_cast<char>(rng() % 4 ? 0 : rng()));
+      }
+    }
+  }
+  return engine;
+}
+
+std::string RandomBytes(size_t size) {
+  std::mt19937 rng(1);
+  std::string bytes(size, '\0');
+  for (auto& b : bytes) {
+    b = static_cast<char>(rng());
+  }
+  return bytes;
+}
+} // namespace
+
+TEST(Runtime, EngineCodecRoundTrips) {
+  const size_t sizes[] = {0, 1, 4, 17, 1000, 3 * 65536 + 7, 3 * 1024 * 1024 + 5};
+  // A small block size as well so that there are many blocks with a partial one at the end
+  const size_t block_sizes[] = {4096, ENGINE_CODEC_BLOCK_SIZE};
+  for (auto size : sizes) {
+    auto engine = SyntheticEngine(size, size);
+    for (int64_t level = 1; level <= ENGINE_COMPRESSION_LEVEL_MAX; level++) {
+      for (auto block_size : block_sizes) {
+        auto payload = CompressEngine(engine.data(), engine.size(), level, block_size);
+        ASSERT_EQ(CompressedEngineLevel(payload), level);
+        ASSERT_EQ(DecompressEngine(payload), engine) << "size " << size << ", level " << level;
+      }
+    }
+  }
+}
+
+TEST(Runtime, EngineCodecCompresses) {
+  auto engine = SyntheticEngine(8 * 1024 * 1024);
+  auto fast = CompressEngine(engine.data(), engine.size(), 1);
+  auto small = CompressEngine(engine.data(), engine.size(), ENGINE_COMPRESSION_LEVEL_MAX);
+  ASSERT_LT(fast.size(), engine.size() / 2);
+  ASSERT_LE(small.size(), fast.size());
+}
+
+TEST(Runtime, EngineCodecStoresIncompressibleBlocks) {
+  auto bytes = RandomBytes(4 * 1024 * 1024 + 3);
+  auto payload = CompressEngine(bytes.data(), bytes.size(), 5);
+  // Only the header and the size of each block are added
+  ASSERT_LE(payload.size(), bytes.size() + 64);
+  ASSERT_EQ(DecompressEngine(payload), bytes);
+}
+
+TEST(Runtime, EngineCodecRejectsBadPayloads) {
+  auto engine = SyntheticEngine(1024 * 1024);
+  auto payload = CompressEngine(engine.data(), engine.size(), 3, 64 * 1024);
+  ASSERT_THROW(DecompressEngine(payload.substr(0, payload.size() - 1)), torch_tensorrt::Error);
+  ASSERT_THROW(DecompressEngine(payload.substr(0, 10)), torch_tensorrt::Error);
+  ASSERT_THROW(DecompressEngine(""), torch_tensorrt::Error);
+  auto bad_version = payload;
+  bad_version[0] = 42;
+  ASSERT_THROW(DecompressEngine(bad_version), torch_tensorrt::Error);
+
+  // A header claiming a 1 TiB engine, in blocks which each have a stored size, is rejected before the engine is
+  // allocated
+  auto le = [](uint64_t v, int num_bytes) {
+    std::string bytes;
+    for (int i = 0; i < num_bytes; i++) {
+      bytes.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+    return bytes;
+  };
+  const uint64_t num_blocks = 512;
+  auto huge = payload.substr(0, 2) + le(1u << 31, 4) + le(num_blocks << 31, 8) + le(num_blocks, 4);
+  for (uint64_t b = 0; b < num_blocks; b++) {
+    huge += le(1, 4);
+  }
+  huge += std::string(num_blocks, '\0');
+  ASSERT_THROW(DecompressEngine(huge), torch_tensorrt::Error);
+  ASSERT_THROW(CompressEngine(engine.data(), engine.size(), 0), torch_tensorrt::Error);
+  ASSERT_THROW(CompressEngine(engine.data(), engine.size(), ENGINE_COMPRESSION_LEVEL_MAX + 1), torch_tensorrt::Error);
+}
+
+TEST(Runtime, EngineCodecNames) {
+  for (auto codec : {EngineCodec::kNONE, EngineCodec::kBLOCK_LZ}) {
+    ASSERT_EQ(ParseEngineCodec(EngineCodecName(codec)), codec);
+  }
+  ASSERT_THROW(ParseEngineCodec("zstd"), torch_tensorrt::Error);
+}
+
+} // namespace tests
+} // namespace util
+} // namespace core
+} // namespace torch_tensorrt
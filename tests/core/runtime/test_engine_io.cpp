@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+#include "core/util/Exception.h"
+#include "core/util/engine_io.h"
+#include "gtest/gtest.h"
+#include "tests/util/helpers.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace util {
+namespace tests {
+
+namespace {
+using torch_tensorrt::tests::util::TempPath;
+
+// Stands in for a serialized engine, the bytes only need to be distinguishable
+std::string SyntheticEngine(size_t size) {
+  std::string engine(size, '\0');
+  for (size_t i = 0; i < size; i++) {
+    engine[i] = static_cast<char>((i * 131 + (i >> 12)) & 0xFF);
+  }
+  return engine;
+}
+
+// Reads a field of /proc/self/status in kB, -1 if it is not available
+int64_t ReadProcStatusKB(const std::string& field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind(field + ":", 0) == 0) {
+      return std::stoll(line.substr(field.size() + 1));
+    }
+  }
+  return -1;
+}
+
+// Resets the peak resident set size of the process so that the peak of the next step can be measured
+bool ResetPeakRSS() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+  clear_refs.close();
+  return clear_refs.good() && ReadProcStatusKB("VmHWM") >= 0;
+}
+
+// Growth of the peak resident set size over the current resident set size while f runs, in bytes
+template <typename F>
+int64_t PeakRSSGrowth(F f) {
+  auto base = ReadProcStatusKB("VmRSS");
+  EXPECT_TRUE(ResetPeakRSS());
+  f();
+  return (ReadProcStatusKB("VmHWM") - base) * 1024;
+}
+} // namespace
+
+TEST(Runtime, EngineFileRoundTrips) {
+  auto path = TempPath("torchtrt_test_engine_io.engine");
+  auto engine = SyntheticEngine(10 * 1024 * 1024 + 7);
+  // A small chunk size so that the engine is written in several chunks with a partial one at the end
+  WriteEngineFile(path, engine.data(), engine.size(), 1024 * 1024);
+
+  auto blob = EngineBlob::MapFile(path);
+  ASSERT_EQ(blob->size(), engine.size());
+  ASSERT_EQ(std::string(blob->data(), blob->size()), engine);
+#ifndef _WIN32
+  ASSERT_TRUE(blob->is_mapped());
+#endif
+  std::ifstream partial(path + ".partial");
+  ASSERT_FALSE(partial.good());
+
+  // Rewriting the file replaces it completely, the blob keeps the contents it was mapped with
+  auto smaller = SyntheticEngine(1024);
+  WriteEngineFile(path, smaller.data(), smaller.size());
+  ASSERT_EQ(std::string(blob->data(), blob->size()), engine);
+  ASSERT_EQ(std::string(EngineBlob::MapFile(path)->data(), smaller.size()), smaller);
+  std::remove(path.c_str());
+}
+
+TEST(Runtime, EngineFileErrors) {
+  auto path = TempPath("torchtrt_test_engine_io_empty.engine");
+  ASSERT_THROW(EngineBlob::MapFile(path + ".missing"), torch_tensorrt::Error);
+
+  std::ofstream(path).close();
+  ASSERT_THROW(EngineBlob::MapFile(path), torch_tensorrt::Error);
+  std::remove(path.c_str());
+
+  auto engine = SyntheticEngine(1024);
+  ASSERT_THROW(WriteEngineFile(TempPath("missing_dir/engine"), engine.data(), engine.size()), torch_tensorrt::Error);
+  ASSERT_THROW(WriteEngineFile(path, engine.data(), engine.size(), 0), torch_tensorrt::Error);
+
+#ifndef _WIN32
+  // The engine cannot replace a directory which is not empty, what was written of it is removed
+  auto dir = TempPath("torchtrt_test_engine_io_dir");
+  ASSERT_EQ(mkdir(dir.c_str(), 0755), 0);
+  std::ofstream(dir + "/file").close();
+  ASSERT_THROW(WriteEngineFile(dir, engine.data(), engine.size()), torch_tensorrt::Error);
+  ASSERT_FALSE(std::ifstream(dir + ".partial").good());
+  std::remove((dir + "/file").c_str());
+  std::remove(dir.c_str());
+#endif
+}
+
+TEST(Runtime, WritingEngineFileDoesNotCopyEngine) {
+  if (!ResetPeakRSS()) {
+    GTEST_SKIP() << "Peak resident set size cannot be reset on this system";
+  }
+  const int64_t size = 64 * 1024 * 1024;
+  auto path = TempPath("torchtrt_test_engine_io_large.engine");
+  auto engine = SyntheticEngine(size);
+
+  // A copy of the serialized engine in a string, which is what saving an engine used to take, shows up in the peak
+  auto copy_growth = PeakRSSGrowth([&]() {
+    auto engine_str = std::string(engine.data(), engine.size());
+    ASSERT_EQ(engine_str, engine);
+  });
+  ASSERT_GE(copy_growth, size * 3 / 4);
+
+  auto write_growth = PeakRSSGrowth([&]() { WriteEngineFile(path, engine.data(), engine.size()); });
+  ASSERT_LT(write_growth, size / 4);
+
+  // Mapping the engine back does not allocate a copy of it either, pages are only loaded when they are read
+  auto map_growth = PeakRSSGrowth([&]() {
+    auto blob = EngineBlob::MapFile(path);
+    ASSERT_EQ(blob->size(), static_cast<size_t>(size));
+  });
+  ASSERT_LT(map_growth, size / 4);
+  std::remove(path.c_str());
+}
+
+} // namespace tests
+} // namespace util
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,169 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "core/runtime/EngineLoader.h"
+#include "gtest/gtest.h"
+#include "tests/util/helpers.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+namespace tests {
+
+namespace {
+// Stands in for nvinfer1::IRuntime so that sharing can be checked without a GPU
+struct FakeRuntime {
+  int64_t device_id;
+  size_t id;
+};
+
+RuntimeRegistry<FakeRuntime>::Factory FakeRuntimeFactory(std::atomic<size_t>* num_created) {
+  return [num_created](int64_t device_id) {
+    return std::make_shared<FakeRuntime>(FakeRuntime{device_id, (*num_created)++});
+  };
+}
+
+// Blocks the tasks waiting on it until it is opened
+struct Gate {
+  std::promise<void> open_promise;
+  std::shared_future<void> opened = open_promise.get_future().share();
+  void open() {
+    open_promise.set_value();
+  }
+  void wait() const {
+    opened.wait();
+  }
+};
+} // namespace
+
+TEST(Runtime, EnginesOfADeviceShareARuntime) {
+  std::atomic<size_t> num_created{0};
+  RuntimeRegistry<FakeRuntime> registry(FakeRuntimeFactory(&num_created));
+
+  // Deserializing engines one after the other, as torch::jit::load does, needs a single runtime per device
+  std::vector<std::shared_ptr<FakeRuntime>> engine_runtimes;
+  for (int i = 0; i < 30; i++) {
+    auto lease = registry.acquire(0);
+    engine_runtimes.push_back(lease.get());
+  }
+  ASSERT_EQ(registry.num_runtimes(0), 1UL);
+  for (const auto& rt : engine_runtimes) {
+    ASSERT_EQ(rt, engine_runtimes[0]);
+  }
+
+  // Concurrent deserializations lease separate runtimes, which are reused afterwards
+  {
+    auto first = registry.acquire(0);
+    auto second = registry.acquire(0);
+    ASSERT_NE(first.get(), second.get());
+  }
+  ASSERT_EQ(registry.num_runtimes(0), 2UL);
+  {
+    auto first = registry.acquire(0);
+    auto second = registry.acquire(0);
+  }
+  ASSERT_EQ(registry.num_runtimes(0), 2UL);
+
+  // Devices never share runtimes
+  auto other = registry.acquire(1);
+  ASSERT_EQ(other.get()->device_id, 1);
+  ASSERT_EQ(registry.num_runtimes(1), 1UL);
+  ASSERT_EQ(num_created.load(), 3UL);
+}
+
+TEST(Runtime, EngineLoadPoolIsBounded) {
+  const size_t num_threads = 4;
+  EngineLoadPool pool(num_threads);
+  ASSERT_EQ(pool.num_threads(), num_threads);
+
+  torch_tensorrt::tests::util::ConcurrencyProbe probe;
+  std::atomic<size_t> num_ran{0};
+  std::vector<std::shared_ptr<LoadTask>> tasks;
+  for (int i = 0; i < 30; i++) {
+    tasks.push_back(pool.submit([&]() {
+      probe.run([]() { std::this_thread::sleep_for(std::chrono::milliseconds(5)); });
+      num_ran++;
+    }));
+  }
+  for (auto& t : tasks) {
+    t->wait();
+    ASSERT_TRUE(t->done());
+  }
+  ASSERT_EQ(num_ran.load(), 30UL);
+  // Waiting may run a queued task on the waiting thread as well
+  ASSERT_LE(probe.max_running(), num_threads + 1);
+  ASSERT_GT(probe.max_running(), 1UL);
+}
+
+TEST(Runtime, WaitingForAnEngineOnlyWaitsForThatEngine) {
+  EngineLoadPool pool(1);
+  Gate gate;
+  std::atomic<bool> slow_done{false};
+  // Occupies the only thread of the pool
+  auto slow = pool.submit([&]() {
+    gate.wait();
+    slow_done = true;
+  });
+  std::atomic<std::thread::id> needed_thread;
+  auto needed = pool.submit([&]() { needed_thread = std::this_thread::get_id(); });
+
+  // The engine the caller needs is queued behind the slow one, it is deserialized on the caller's thread instead
+  needed->wait();
+  ASSERT_TRUE(needed->done());
+  ASSERT_EQ(needed_thread.load(), std::this_thread::get_id());
+  ASSERT_FALSE(slow_done.load());
+  ASSERT_FALSE(slow->done());
+
+  gate.open();
+  slow->wait();
+  ASSERT_TRUE(slow_done.load());
+}
+
+TEST(Runtime, EngineLoadErrorsSurfaceWhenTheEngineIsUsed) {
+  EngineLoadPool pool(2);
+  auto failing = pool.submit([]() { throw std::runtime_error("corrupt engine"); });
+  ASSERT_THROW(failing->wait(), std::runtime_error);
+  // Every user of the engine sees the error
+  ASSERT_THROW(failing->wait(), std::runtime_error);
+
+  // Engines released before they are used are not deserialized
+  Gate gate;
+  auto blocker = pool.submit([&]() { gate.wait(); });
+  auto blocker2 = pool.submit([&]() { gate.wait(); });
+  std::atomic<bool> ran{false};
+  auto unused = pool.submit([&]() { ran = true; });
+  unused->cancel();
+  ASSERT_TRUE(unused->done());
+  gate.open();
+  blocker->wait();
+  blocker2->wait();
+  ASSERT_FALSE(ran.load());
+}
+
+TEST(Runtime, EngineLoadThreadsSetting) {
+  ASSERT_EQ(get_engine_load_threads(), 0UL);
+  ASSERT_EQ(get_engine_load_pool(), nullptr);
+
+  set_engine_load_threads(3);
+  auto pool = get_engine_load_pool();
+  ASSERT_NE(pool, nullptr);
+  ASSERT_EQ(pool->num_threads(), 3UL);
+  ASSERT_EQ(get_engine_load_pool(), pool);
+
+  // Tasks already scheduled on a pool which is replaced still run
+  std::atomic<bool> ran{false};
+  auto task = pool->submit([&]() { ran = true; });
+  set_engine_load_threads(0);
+  ASSERT_EQ(get_engine_load_pool(), nullptr);
+  pool.reset();
+  ASSERT_TRUE(ran.load());
+  ASSERT_TRUE(task->done());
+}
+
+} // namespace tests
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,73 @@
+#include <string>
+#include <vector>
+#include "core/conversion/conversion.h"
+#include "core/runtime/runtime.h"
+#include "core/util/Exception.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/csrc/jit/ir/irparser.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+namespace tests {
+
+namespace {
+// Serialized info of an engine the way programs saved with ABI 4 store it, without the engine codec
+std::vector<std::string> ABI4SerializedInfo(const std::string& engine) {
+  std::vector<std::string> info(ENGINE_CODEC_IDX);
+  info[ABI_TARGET_IDX] = ABI_VERSION_WITHOUT_ENGINE_CODEC;
+  info[NAME_IDX] = "abi4_engine";
+  info[DEVICE_IDX] = RTDevice(0, nvinfer1::DeviceType::kGPU).serialize();
+  info[ENGINE_IDX] = engine;
+  return info;
+}
+} // namespace
+
+TEST(Runtime, SerializationFormatAcceptsPreviousABI) {
+  TRTEngine::verify_serialization_fmt(ABI4SerializedInfo("engine"));
+
+  auto current = ABI4SerializedInfo("engine");
+  current[ABI_TARGET_IDX] = ABI_VERSION;
+  current.push_back("none");
+  TRTEngine::verify_serialization_fmt(current);
+
+  // The engine codec is only optional for ABI 4
+  current.pop_back();
+  ASSERT_THROW(TRTEngine::verify_serialization_fmt(current), torch_tensorrt::Error);
+  auto abi4_with_codec = ABI4SerializedInfo("engine");
+  abi4_with_codec.push_back("none");
+  ASSERT_THROW(TRTEngine::verify_serialization_fmt(abi4_with_codec), torch_tensorrt::Error);
+  auto abi3 = ABI4SerializedInfo("engine");
+  abi3[ABI_TARGET_IDX] = "3";
+  ASSERT_THROW(TRTEngine::verify_serialization_fmt(abi3), torch_tensorrt::Error);
+}
+
+TEST(Runtime, LoadsEngineSerializedWithPreviousABI) {
+  const auto graph = R"IR(
+      graph(%0 : Tensor):
+        %1 : Tensor = aten::relu(%0)
+        return (%1))IR";
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+
+  auto in = at::randint(-5, 5, {5}, {at::kCUDA}).to(at::kFloat);
+  auto params = ir::get_static_params(g->inputs(), {});
+  auto info = conversion::ConversionInfo();
+  info.inputs = ir::pair_input_vals_with_specs({g->inputs()[0]}, {ir::Input({5})});
+  auto engine = conversion::ConvertBlockToEngine(g->block(), info, params);
+
+  // The same steps as unpickling an engine
+  auto serialized_info = ABI4SerializedInfo(engine);
+  TRTEngine::verify_serialization_fmt(serialized_info);
+  auto engine_ptr = c10::make_intrusive<TRTEngine>(serialized_info);
+  ASSERT_EQ(engine_ptr->compression_level, 0);
+
+  auto outputs = execute_engine({in}, engine_ptr);
+  ASSERT_TRUE(torch_tensorrt::tests::util::exactlyEqual(outputs[0], at::relu(in)));
+}
+
+} // namespace tests
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,214 @@
+#include <sstream>
+#include <string>
+#include "core/runtime/runtime.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/csrc/jit/runtime/custom_operator.h"
+#include "torch/script.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+namespace tests {
+
+namespace {
+// Stands in for tensorrt::execute_engine so that plans can be run without a GPU, the engine is just an id
+std::vector<at::Tensor> stub_execute_engine(std::vector<at::Tensor> inputs, int64_t engine) {
+  return {at::sigmoid(inputs[0]) + engine, inputs[0] * inputs[1]};
+}
+
+TORCH_LIBRARY(tests_runtime, m) {
+  m.def("stub_execute_engine", stub_execute_engine);
+}
+
+const auto kStubEngineCall = c10::Symbol::fromQualString("tests_runtime::stub_execute_engine");
+
+std::vector<at::Tensor> runStubEngine(const c10::IValue& engine, std::vector<at::Tensor> inputs) {
+  return stub_execute_engine(std::move(inputs), engine.toInt());
+}
+
+// Addresses of the inputs the unpacked stub engine was last called with
+std::vector<const void*> stub_input_addresses;
+
+// Stands in for the TRTEngine runner of tensorrt::execute_engine_unpacked
+void runStubEngineOnStack(torch::jit::Stack& stack, size_t num_inputs, const c10::IValue& engine) {
+  auto base = stack.size() - num_inputs;
+  stub_input_addresses.clear();
+  std::vector<at::Tensor> inputs;
+  for (size_t i = base; i < stack.size(); i++) {
+    stub_input_addresses.push_back(stack[i].toTensor().unsafeGetTensorImpl());
+    inputs.push_back(stack[i].toTensor());
+  }
+  auto outputs = stub_execute_engine(std::move(inputs), engine.toInt());
+  stack.resize(base);
+  for (auto& out : outputs) {
+    stack.emplace_back(std::move(out));
+  }
+}
+
+static auto stub_unpacked_reg = torch::jit::RegisterOperators({torch::jit::Operator(
+    "tests_runtime::stub_execute_engine_unpacked(...) -> Tensor[]",
+    [](const torch::jit::Node* n) -> torch::jit::Operation {
+      return make_unpacked_engine_op(n->inputs().size() - 1, runStubEngineOnStack);
+    },
+    c10::AliasAnalysisKind::CONSERVATIVE)});
+
+const auto kStubUnpackedEngineCall = c10::Symbol::fromQualString("tests_runtime::stub_execute_engine_unpacked");
+
+// Alternates between Torch segments and engine calls, stitched the same way as hybrid graphs
+std::string hybridGraphIR(size_t num_engines, bool unpacked = false) {
+  std::stringstream ss;
+  ss << "graph(%x0 : Tensor, %y0 : Tensor):\n";
+  ss << "  %alpha : int = prim::Constant[value=1]()\n";
+  for (size_t i = 0; i < num_engines; i++) {
+    ss << "  %e" << i << " : int = prim::Constant[value=" << i << "]()\n";
+    ss << "  %a" << i << " : Tensor = aten::relu(%x" << i << ")\n";
+    ss << "  %b" << i << " : Tensor = aten::add(%a" << i << ", %y" << i << ", %alpha)\n";
+    if (unpacked) {
+      ss << "  %o" << i << " : Tensor[] = tests_runtime::stub_execute_engine_unpacked(%a" << i << ", %b" << i << ", %e"
+         << i << ")\n";
+    } else {
+      ss << "  %l" << i << " : Tensor[] = prim::ListConstruct(%a" << i << ", %b" << i << ")\n";
+      ss << "  %o" << i << " : Tensor[] = tests_runtime::stub_execute_engine(%l" << i << ", %e" << i << ")\n";
+    }
+    ss << "  %x" << i + 1 << " : Tensor, %y" << i + 1 << " : Tensor = prim::ListUnpack(%o" << i << ")\n";
+  }
+  ss << "  return (%x" << num_engines << ", %y" << num_engines << ")\n";
+  return ss.str();
+}
+
+std::vector<c10::IValue> runInterpreter(std::shared_ptr<torch::jit::Graph> g, std::vector<c10::IValue> inputs) {
+  torch::jit::GraphFunction fn("reference", g->copy(), nullptr);
+  torch::jit::Stack stack(inputs.begin(), inputs.end());
+  fn.run(stack);
+  return stack;
+}
+
+void checkOutputsMatch(const std::vector<c10::IValue>& plan_outputs, const std::vector<c10::IValue>& ref_outputs) {
+  ASSERT_EQ(plan_outputs.size(), ref_outputs.size());
+  for (size_t i = 0; i < ref_outputs.size(); i++) {
+    ASSERT_TRUE(torch_tensorrt::tests::util::almostEqual(plan_outputs[i].toTensor(), ref_outputs[i].toTensor()));
+  }
+}
+} // namespace
+
+TEST(Runtime, ExecutionPlanCallsEnginesDirectly) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(hybridGraphIR(4), g.get());
+
+  ExecutionPlan plan(g, runStubEngine, kStubEngineCall);
+  ASSERT_EQ(plan.num_engine_calls(), 4UL);
+  ASSERT_EQ(plan.num_torch_segments(), 4UL);
+  for (const auto& instr : plan.instructions()) {
+    if (instr.kind == ExecutionPlan::InstructionKind::kTorch) {
+      // Constants are cloned into the segment, only the two tensors are passed in
+      ASSERT_EQ(instr.inputs.size(), 2UL);
+      ASSERT_EQ(instr.outputs.size(), 2UL);
+    }
+  }
+
+  std::vector<c10::IValue> inputs = {at::randn({2, 8}), at::randn({2, 8})};
+  checkOutputsMatch(plan.run(inputs), runInterpreter(g, inputs));
+}
+
+TEST(Runtime, UnpackedEngineCallsBorrowTheirInputs) {
+  const auto graph = R"IR(
+    graph(%x : Tensor, %y : Tensor):
+      %e : int = prim::Constant[value=3]()
+      %o : Tensor[] = tests_runtime::stub_execute_engine_unpacked(%x, %y, %e)
+      %a : Tensor, %b : Tensor = prim::ListUnpack(%o)
+      return (%a, %b))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+
+  auto x = at::randn({4});
+  auto y = at::randn({4});
+  auto outputs = runInterpreter(g, {x, y});
+  auto expected = stub_execute_engine({x, y}, 3);
+  ASSERT_EQ(outputs.size(), 2UL);
+  ASSERT_TRUE(torch_tensorrt::tests::util::almostEqual(outputs[0].toTensor(), expected[0]));
+  ASSERT_TRUE(torch_tensorrt::tests::util::almostEqual(outputs[1].toTensor(), expected[1]));
+
+  // The engine sees the tensors passed in, not copies of them
+  ASSERT_EQ(stub_input_addresses.size(), 2UL);
+  ASSERT_EQ(stub_input_addresses[0], x.unsafeGetTensorImpl());
+  ASSERT_EQ(stub_input_addresses[1], y.unsafeGetTensorImpl());
+}
+
+TEST(Runtime, ExecutionPlanCallsUnpackedEnginesDirectly) {
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(hybridGraphIR(4, /*unpacked=*/true), g.get());
+
+  ExecutionPlan plan(g, runStubEngine, kStubEngineCall, kStubUnpackedEngineCall);
+  ASSERT_EQ(plan.num_engine_calls(), 4UL);
+  ASSERT_EQ(plan.num_torch_segments(), 4UL);
+  for (const auto& instr : plan.instructions()) {
+    ASSERT_EQ(instr.inputs.size(), 2UL);
+    ASSERT_EQ(instr.outputs.size(), 2UL);
+  }
+
+  std::vector<c10::IValue> inputs = {at::randn({2, 8}), at::randn({2, 8})};
+  checkOutputsMatch(plan.run(inputs), runInterpreter(g, inputs));
+}
+
+TEST(Runtime, ExecutionPlanRunsUnfusableEngineCallsInTorch) {
+  const auto graph = R"IR(
+    graph(%x : Tensor, %y : Tensor):
+      %e : int = prim::Constant[value=2]()
+      %l : Tensor[] = prim::ListConstruct(%x, %y)
+      %o : Tensor[] = tests_runtime::stub_execute_engine(%l, %e)
+      %n : int = aten::len(%o)
+      %a : Tensor, %b : Tensor = prim::ListUnpack(%o)
+      %c : Tensor = aten::mul(%a, %n)
+      return (%c, %b))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, g.get());
+
+  // The output list of the engine call is used by aten::len so it has to be materialized
+  ExecutionPlan plan(g, runStubEngine, kStubEngineCall);
+  ASSERT_EQ(plan.num_engine_calls(), 0UL);
+  ASSERT_EQ(plan.num_torch_segments(), 1UL);
+
+  std::vector<c10::IValue> inputs = {at::randn({4}), at::randn({4})};
+  checkOutputsMatch(plan.run(inputs), runInterpreter(g, inputs));
+}
+
+TEST(Runtime, ExecutionPlanHolderRunsModuleMethod) {
+  torch::jit::Module mod("ExecutionPlanModule");
+  mod.register_buffer("scale", at::full({1}, 2.0));
+  mod.define(R"JIT(
+    def _forward_stitched(self, x, y):
+      return x.relu() * self.scale + y
+  )JIT");
+
+  auto holder = c10::make_intrusive<ExecutionPlanHolder>(EXECUTION_PLAN_METHOD_NAME);
+  auto x = at::randn({3, 3});
+  auto y = at::randn({3, 3});
+  auto out = holder->run(mod._ivalue(), c10::List<c10::IValue>({x, y}));
+  ASSERT_TRUE(torch_tensorrt::tests::util::almostEqual(out.toTensor(), x.relu() * 2.0 + y));
+  // The plan is only built on the first run
+  auto plan = holder->plan.get();
+  holder->run(mod._ivalue(), c10::List<c10::IValue>({x, y}));
+  ASSERT_EQ(holder->plan.get(), plan);
+}
+
+TEST(Runtime, ExecutionPlanMatchesInterpreterAcrossManyEngines) {
+  const size_t num_engines = 32;
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(hybridGraphIR(num_engines), g.get());
+
+  ExecutionPlan plan(g, runStubEngine, kStubEngineCall);
+  std::vector<c10::IValue> inputs = {at::randn({1, 8}), at::randn({1, 8})};
+  // Plans are reused across runs
+  for (int i = 0; i < 3; i++) {
+    checkOutputsMatch(plan.run(inputs), runInterpreter(g, inputs));
+  }
+}
+
+} // namespace tests
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
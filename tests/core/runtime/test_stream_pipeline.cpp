@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "core/runtime/StreamPipeline.h"
+#include "core/util/Exception.h"
+#include "gtest/gtest.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+namespace tests {
+
+namespace {
+struct FakeEventState {
+  bool done = false;
+};
+
+// Simulates a device running the streams of FakeBackend. The device only makes progress when the host blocks on it,
+// in rounds in which every stream whose next work is not waiting on an event runs that work. Recording and waiting on
+// events takes no time
+struct FakeDevice {
+  struct Op {
+    // Work if label is set, otherwise an event record (record) or an event wait (wait_for)
+    std::string label;
+    std::shared_ptr<FakeEventState> record;
+    std::shared_ptr<FakeEventState> wait_for;
+  };
+
+  std::vector<std::deque<Op>> streams;
+  // Labels of the work run in each round
+  std::vector<std::vector<std::string>> rounds;
+  int current_stream = 0;
+  size_t num_waits = 0;
+  size_t num_record_use = 0;
+
+  explicit FakeDevice(size_t num_streams) : streams(num_streams) {}
+
+  // Completes the event records and waits at the front of the streams, as long as any of them can
+  void drain() {
+    bool progress = true;
+    while (progress) {
+      progress = false;
+      for (auto& s : streams) {
+        while (!s.empty() && s.front().label.empty()) {
+          auto& op = s.front();
+          if (op.record) {
+            op.record->done = true;
+          } else if (op.wait_for && !op.wait_for->done) {
+            break;
+          }
+          s.pop_front();
+          progress = true;
+        }
+      }
+    }
+  }
+
+  // Runs one round, returns false if no work could run
+  bool step() {
+    drain();
+    std::vector<std::string> round;
+    for (auto& s : streams) {
+      if (!s.empty() && !s.front().label.empty()) {
+        round.push_back(s.front().label);
+        s.pop_front();
+      }
+    }
+    drain();
+    if (round.empty()) {
+      return false;
+    }
+    std::sort(round.begin(), round.end());
+    rounds.push_back(round);
+    return true;
+  }
+
+  void run_until(const FakeEventState& event) {
+    while (!event.done) {
+      TORCHTRT_CHECK(step(), "The fake device deadlocked");
+    }
+  }
+
+  // Enqueues work on the current stream, which is what a stage does
+  void enqueue(const std::string& label) {
+    streams[current_stream].push_back(Op{label, nullptr, nullptr});
+  }
+
+  // Round in which the work with the given label ran
+  int64_t round_of(const std::string& label) const {
+    for (size_t r = 0; r < rounds.size(); r++) {
+      if (std::find(rounds[r].begin(), rounds[r].end(), label) != rounds[r].end()) {
+        return static_cast<int64_t>(r);
+      }
+    }
+    return -1;
+  }
+};
+
+FakeDevice* device = nullptr;
+
+struct FakeBackend {
+  using Stream = int;
+  struct Event {
+    // Events which were never recorded are complete, like CUDA events
+    std::shared_ptr<FakeEventState> state = std::make_shared<FakeEventState>(FakeEventState{true});
+  };
+
+  static Stream current_stream() {
+    return device->current_stream;
+  }
+  static void record(Event& event, const Stream& stream) {
+    event.state = std::make_shared<FakeEventState>();
+    device->streams[stream].push_back(FakeDevice::Op{"", event.state, nullptr});
+  }
+  static void wait(Event& event, const Stream& stream) {
+    device->num_waits++;
+    device->streams[stream].push_back(FakeDevice::Op{"", nullptr, event.state});
+  }
+  static bool query(const Event& event) {
+    return event.state->done;
+  }
+  static void synchronize(const Event& event) {
+    device->run_until(*event.state);
+  }
+  static AsyncValues run_on(const Stream& stream, const AsyncWork& work) {
+    auto prev = device->current_stream;
+    device->current_stream = stream;
+    try {
+      auto out = work();
+      device->current_stream = prev;
+      return out;
+    } catch (...) {
+      device->current_stream = prev;
+      throw;
+    }
+  }
+  static void record_use(const c10::IValue&, const Stream&) {
+    device->num_record_use++;
+  }
+};
+
+std::string Label(size_t stage, int64_t request) {
+  return "s" + std::to_string(stage) + "r" + std::to_string(request);
+}
+
+// Stage which enqueues one piece of work labeled with the stage and the request, whose id it passes on
+StreamPipeline<FakeBackend>::Stage MakeStage(size_t stage) {
+  return [stage](AsyncValues in) {
+    device->enqueue(Label(stage, in[0].toInt()));
+    return in;
+  };
+}
+
+StreamPipeline<FakeBackend> MakePipeline(size_t num_stages, size_t max_in_flight) {
+  std::vector<StreamPipeline<FakeBackend>::Stage> stages;
+  std::vector<int> streams;
+  for (size_t s = 0; s < num_stages; s++) {
+    stages.push_back(MakeStage(s));
+    // Stream 0 is the stream of the caller
+    streams.push_back(static_cast<int>(s) + 1);
+  }
+  return StreamPipeline<FakeBackend>(std::move(stages), std::move(streams), max_in_flight);
+}
+} // namespace
+
+TEST(Runtime, StreamPipelineOverlapsStagesOfConsecutiveRequests) {
+  const size_t num_stages = 3;
+  const int64_t num_requests = 4;
+  FakeDevice fake(num_stages + 1);
+  device = &fake;
+  auto pipeline = MakePipeline(num_stages, num_requests);
+
+  std::vector<AsyncResult<FakeBackend>> results;
+  for (int64_t r = 0; r < num_requests; r++) {
+    results.push_back(pipeline.submit({c10::IValue(r)}));
+  }
+  // Nothing ran yet, submit only enqueues
+  ASSERT_TRUE(fake.rounds.empty());
+  ASSERT_FALSE(results[0].ready());
+
+  ASSERT_EQ(results.back().get()[0].toInt(), num_requests - 1);
+  for (const auto& r : results) {
+    ASSERT_TRUE(r.ready());
+  }
+  // Fully pipelined, the device is busy for as many rounds as the first request has stages and then one more round per
+  // request instead of one round per stage of each request
+  ASSERT_EQ(fake.rounds.size(), num_stages + static_cast<size_t>(num_requests) - 1);
+  for (size_t s = 0; s < num_stages; s++) {
+    for (int64_t r = 0; r < num_requests; r++) {
+      ASSERT_EQ(fake.round_of(Label(s, r)), static_cast<int64_t>(s) + r);
+    }
+  }
+  // Stage s + 1 of request i - 1 runs alongside stage s of request i
+  ASSERT_EQ(fake.rounds[1], (std::vector<std::string>{"s0r1", "s1r0"}));
+  device = nullptr;
+}
+
+TEST(Runtime, StreamPipelineKeepsStagesOfARequestInOrder) {
+  const size_t num_stages = 2;
+  FakeDevice fake(num_stages + 1);
+  device = &fake;
+  auto pipeline = MakePipeline(num_stages, 8);
+
+  // Stage 0 of the second request is held up by more work on its stream, which stage 1 has to wait for while stage 1
+  // of the first request can still run
+  auto first = pipeline.submit({c10::IValue(int64_t(0))});
+  fake.streams[1].push_back(FakeDevice::Op{"slow", nullptr, nullptr});
+  auto second = pipeline.submit({c10::IValue(int64_t(1))});
+  pipeline.synchronize();
+
+  ASSERT_TRUE(first.ready() && second.ready());
+  ASSERT_EQ(fake.round_of("s0r0"), 0);
+  ASSERT_EQ(fake.round_of("s1r0"), 1);
+  ASSERT_EQ(fake.round_of("slow"), 1);
+  ASSERT_EQ(fake.round_of("s0r1"), 2);
+  ASSERT_EQ(fake.round_of("s1r1"), 3);
+  // Inputs of each stage are marked as used on the stream of the stage
+  ASSERT_EQ(fake.num_record_use, 2 * num_stages);
+  device = nullptr;
+}
+
+TEST(Runtime, StreamPipelineBoundsTheRequestsInFlight) {
+  const size_t num_stages = 3;
+  const int64_t num_requests = 4;
+  FakeDevice fake(num_stages + 1);
+  device = &fake;
+  auto pipeline = MakePipeline(num_stages, 1);
+
+  for (int64_t r = 0; r < num_requests; r++) {
+    pipeline.submit({c10::IValue(r)});
+    // Submitting waited for the previous request, which completed before this one was enqueued
+    ASSERT_EQ(fake.rounds.size(), num_stages * static_cast<size_t>(r));
+  }
+  pipeline.synchronize();
+  ASSERT_EQ(fake.rounds.size(), num_stages * static_cast<size_t>(num_requests));
+
+  ASSERT_THROW(MakePipeline(num_stages, 0), torch_tensorrt::Error);
+  ASSERT_THROW(StreamPipeline<FakeBackend>({MakeStage(0)}, std::vector<int>{1, 2}, 1), torch_tensorrt::Error);
+  device = nullptr;
+}
+
+TEST(Runtime, StreamPipelineOrdersInputsAfterTheCurrentStream) {
+  FakeDevice fake(3);
+  device = &fake;
+  auto pipeline = MakePipeline(2, 2);
+
+  // The inputs are produced by work on the stream of the caller
+  fake.enqueue("produce_inputs");
+  auto result = pipeline.submit({c10::IValue(int64_t(0))});
+  // The caller consumes the outputs on its own stream without blocking
+  result.wait_on(0);
+  fake.enqueue("consume_outputs");
+  ASSERT_TRUE(fake.rounds.empty());
+
+  fake.run_until(*result.event()->state);
+  while (fake.step()) {
+  }
+  ASSERT_EQ(fake.round_of("produce_inputs"), 0);
+  ASSERT_EQ(fake.round_of("s0r0"), 1);
+  ASSERT_EQ(fake.round_of("s1r0"), 2);
+  ASSERT_EQ(fake.round_of("consume_outputs"), 3);
+  device = nullptr;
+}
+
+TEST(Runtime, StreamPipelineThrowsErrorsOfStages) {
+  FakeDevice fake(3);
+  device = &fake;
+  std::vector<StreamPipeline<FakeBackend>::Stage> stages = {
+      MakeStage(0), [](AsyncValues) -> AsyncValues { throw std::runtime_error("Bad request"); }};
+  StreamPipeline<FakeBackend> pipeline(std::move(stages), {1, 2}, 2);
+
+  ASSERT_THROW(pipeline.submit({c10::IValue(int64_t(0))}), std::runtime_error);
+  // The stream of the caller is current again and the work enqueued before the error still runs
+  ASSERT_EQ(fake.current_stream, 0);
+  while (fake.step()) {
+  }
+  ASSERT_EQ(fake.round_of("s0r0"), 0);
+  device = nullptr;
+}
+
+TEST(Runtime, RunAsyncRecordsAnEventAfterTheWork) {
+  FakeDevice fake(2);
+  device = &fake;
+
+  fake.enqueue("produce_inputs");
+  auto result = RunAsync<FakeBackend>(1, {c10::IValue(int64_t(7))}, [&]() {
+    EXPECT_EQ(fake.current_stream, 1);
+    fake.enqueue("work");
+    return AsyncValues{c10::IValue(int64_t(8))};
+  });
+  ASSERT_EQ(fake.current_stream, 0);
+  ASSERT_FALSE(result.ready());
+  ASSERT_EQ(result.values()[0].toInt(), 8);
+  ASSERT_EQ(result.get()[0].toInt(), 8);
+  ASSERT_EQ(fake.round_of("produce_inputs"), 0);
+  ASSERT_EQ(fake.round_of("work"), 1);
+  device = nullptr;
+}
+
+TEST(Runtime, EnqueueOrderRunsAnEngineOnOneStreamAtATime) {
+  FakeDevice fake(3);
+  device = &fake;
+  // Stands in for an engine, its execution context runs for two rounds on the stream it is enqueued on
+  EnqueueOrder<FakeBackend> order;
+  size_t num_order_waits = 0;
+  auto run_engine = [&](const std::string& request) {
+    auto stream = FakeBackend::current_stream();
+    auto num_waits = fake.num_waits;
+    order.before_enqueue(stream);
+    num_order_waits += fake.num_waits - num_waits;
+    fake.enqueue(request + "_a");
+    fake.enqueue(request + "_b");
+    order.after_enqueue(stream);
+  };
+
+  // Requests submitted to the engine from two streams, the second one is preprocessed on its stream first
+  auto first = RunAsync<FakeBackend>(1, {}, [&]() {
+    run_engine("r0");
+    return AsyncValues{};
+  });
+  auto second = RunAsync<FakeBackend>(2, {}, [&]() {
+    fake.enqueue("pre_r1");
+    run_engine("r1");
+    return AsyncValues{};
+  });
+  auto third = RunAsync<FakeBackend>(2, {}, [&]() {
+    run_engine("r2");
+    return AsyncValues{};
+  });
+  third.wait();
+
+  ASSERT_TRUE(first.ready() && second.ready());
+  // Work before the engine still overlaps it
+  ASSERT_EQ(fake.rounds[0], (std::vector<std::string>{"pre_r1", "r0_a"}));
+  ASSERT_EQ(fake.round_of("r0_b"), 1);
+  // The context only starts on the second stream once it completed on the first
+  ASSERT_EQ(fake.round_of("r1_a"), 2);
+  ASSERT_EQ(fake.round_of("r1_b"), 3);
+  ASSERT_EQ(fake.round_of("r2_a"), 4);
+  // Consecutive enqueues on the same stream are already in order
+  ASSERT_EQ(num_order_waits, 1u);
+  device = nullptr;
+}
+
+} // namespace tests
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
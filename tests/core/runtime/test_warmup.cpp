@@ -0,0 +1,159 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "core/runtime/Warmup.h"
+#include "core/util/Exception.h"
+#include "core/util/macros.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/custom_class.h"
+
+namespace torch_tensorrt {
+namespace core {
+namespace runtime {
+namespace tests {
+
+namespace {
+using Shapes = std::vector<std::vector<int64_t>>;
+
+// Stands in for TRTEngine so that warmups can be orchestrated without a GPU, runs are recorded instead of enqueued
+struct FakeEngine : torch::CustomClassHolder {
+  std::string name;
+  std::vector<InputProfile> profiles;
+  // Runs with a first input larger than this fail, like an engine running out of memory
+  int64_t max_batch = 1 << 30;
+  std::vector<Shapes> runs;
+  bool warmed_up = false;
+
+  WarmupResult warmup(const std::vector<WarmupShape>& shapes, int64_t iterations) {
+    auto result = RunWarmup(
+        name,
+        profiles,
+        shapes,
+        iterations,
+        [](const std::vector<int64_t>& shape, at::ScalarType dtype) {
+          return at::zeros(shape, at::TensorOptions().dtype(dtype));
+        },
+        [this](const std::vector<at::Tensor>& inputs) {
+          Shapes shapes;
+          for (const auto& in : inputs) {
+            shapes.push_back(in.sizes().vec());
+          }
+          runs.push_back(shapes);
+          TORCHTRT_CHECK(inputs[0].size(0) <= max_batch, "Out of memory");
+        });
+    warmed_up = result.ready;
+    return result;
+  }
+};
+
+auto TORCHTRT_UNUSED fake_engine_registration =
+    torch::class_<FakeEngine>("tensorrt_tests", "FakeWarmupEngine").def(torch::init<>());
+
+InputProfile DynamicBatchInput(const std::string& name, at::ScalarType dtype = at::kFloat) {
+  return InputProfile{name, dtype, {1, 3, 8, 8}, {4, 3, 8, 8}, {16, 3, 8, 8}};
+}
+
+c10::intrusive_ptr<FakeEngine> MakeEngine(const std::string& name, std::vector<InputProfile> profiles) {
+  auto engine = c10::make_intrusive<FakeEngine>();
+  engine->name = name;
+  engine->profiles = std::move(profiles);
+  return engine;
+}
+
+void AddEngine(torch::jit::Module& mod, const std::string& attr, const c10::intrusive_ptr<FakeEngine>& engine) {
+  mod.register_attribute(attr, c10::getCustomClassType<c10::intrusive_ptr<FakeEngine>>(), c10::IValue(engine), false);
+}
+} // namespace
+
+TEST(Runtime, WarmupShapesEnumerateTheProfile) {
+  auto inputs = std::vector<InputProfile>{DynamicBatchInput("x"), InputProfile{"y", at::kInt, {2}, {2}, {2}}};
+  auto cases = EnumerateWarmupCases(inputs, DEFAULT_WARMUP_SHAPES);
+  ASSERT_EQ(cases.size(), 3UL);
+  ASSERT_EQ(cases[0].shape, WarmupShape::kMIN);
+  ASSERT_EQ(cases[0].input_shapes, (Shapes{{1, 3, 8, 8}, {2}}));
+  ASSERT_EQ(cases[1].input_shapes, (Shapes{{4, 3, 8, 8}, {2}}));
+  ASSERT_EQ(cases[2].shape, WarmupShape::kMAX);
+  ASSERT_EQ(cases[2].input_shapes, (Shapes{{16, 3, 8, 8}, {2}}));
+
+  // Requested points are run in the order given
+  cases = EnumerateWarmupCases(inputs, {WarmupShape::kMAX, WarmupShape::kMIN});
+  ASSERT_EQ(cases.size(), 2UL);
+  ASSERT_EQ(cases[0].shape, WarmupShape::kMAX);
+  ASSERT_EQ(cases[1].shape, WarmupShape::kMIN);
+
+  // Engines with static shapes only need a single case
+  auto static_inputs = std::vector<InputProfile>{InputProfile{"x", at::kFloat, {1, 4}, {1, 4}, {1, 4}}};
+  cases = EnumerateWarmupCases(static_inputs, DEFAULT_WARMUP_SHAPES);
+  ASSERT_EQ(cases.size(), 1UL);
+  ASSERT_EQ(cases[0].shape, WarmupShape::kMIN);
+}
+
+TEST(Runtime, WarmupShapeNames) {
+  for (auto shape : DEFAULT_WARMUP_SHAPES) {
+    ASSERT_EQ(ParseWarmupShape(WarmupShapeName(shape)), shape);
+  }
+  ASSERT_THROW(ParseWarmupShape("median"), torch_tensorrt::Error);
+}
+
+TEST(Runtime, WarmupRunsEachShape) {
+  auto engine = MakeEngine("engine", {DynamicBatchInput("x"), DynamicBatchInput("y", at::kHalf)});
+  auto result = engine->warmup(DEFAULT_WARMUP_SHAPES, 3);
+  ASSERT_TRUE(result.ready);
+  ASSERT_TRUE(engine->warmed_up);
+  ASSERT_EQ(result.timings.size(), 3UL);
+  ASSERT_EQ(engine->runs.size(), 9UL);
+  for (size_t i = 0; i < engine->runs.size(); i++) {
+    ASSERT_EQ(engine->runs[i], result.timings[i / 3].warmup_case.input_shapes);
+  }
+  ASSERT_EQ(engine->runs.back(), (Shapes{{16, 3, 8, 8}, {16, 3, 8, 8}}));
+  for (const auto& t : result.timings) {
+    ASSERT_GE(t.first_ms, 0);
+    ASSERT_GE(t.steady_ms, 0);
+  }
+  ASSERT_THROW(engine->warmup(DEFAULT_WARMUP_SHAPES, 0), torch_tensorrt::Error);
+}
+
+TEST(Runtime, WarmupReportsFailures) {
+  auto engine = MakeEngine("engine", {DynamicBatchInput("x")});
+  engine->max_batch = 8;
+  auto result = engine->warmup(DEFAULT_WARMUP_SHAPES, 2);
+  ASSERT_FALSE(result.ready);
+  ASSERT_FALSE(engine->warmed_up);
+  ASSERT_NE(result.error.find("Out of memory"), std::string::npos);
+  // The min and opt shapes ran, the max shape stopped the warmup on its first run
+  ASSERT_EQ(result.timings.size(), 2UL);
+  ASSERT_EQ(engine->runs.size(), 5UL);
+}
+
+TEST(Runtime, WarmupFindsTheEnginesOfAModule) {
+  torch::jit::Module mod("tensorrt_tests.WarmupModule");
+  torch::jit::Module sub("tensorrt_tests.WarmupSubmodule");
+  auto first = MakeEngine("first", {DynamicBatchInput("x")});
+  auto second = MakeEngine("second", {DynamicBatchInput("x")});
+  AddEngine(mod, "first_engine", first);
+  AddEngine(sub, "second_engine", second);
+  // Engines shared by identical segments are held by several attributes
+  AddEngine(sub, "shared_engine", first);
+  mod.register_module("sub", sub);
+
+  auto engines = FindEngines<FakeEngine>(mod);
+  ASSERT_EQ(engines.size(), 2UL);
+  ASSERT_EQ(engines[0].first, "first_engine");
+  ASSERT_EQ(engines[0].second.get(), first.get());
+  ASSERT_EQ(engines[1].first, "sub.second_engine");
+  ASSERT_EQ(engines[1].second.get(), second.get());
+
+  auto results = WarmupEngines<FakeEngine>(mod, DEFAULT_WARMUP_SHAPES, 1);
+  ASSERT_EQ(results.size(), 2UL);
+  ASSERT_EQ(results[0].engine, "first");
+  ASSERT_EQ(results[1].engine, "second");
+  ASSERT_TRUE(first->warmed_up && second->warmed_up);
+  ASSERT_EQ(first->runs.size(), 3UL);
+  ASSERT_EQ(second->runs.size(), 3UL);
+}
+
+} // namespace tests
+} // namespace runtime
+} // namespace core
+} // namespace torch_tensorrt
@@ -0,0 +1,92 @@
+#include <string>
+#include "core/compiler.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/script.h"
+
+namespace {
+namespace core = torch_tensorrt::core;
+
+// A model exporting several methods, two of which run the same backbone
+torch::jit::Module BuildModule(at::Tensor weight) {
+  torch::jit::Module m("m");
+  m.register_attribute("training", c10::BoolType::get(), false);
+  m.register_parameter("weight", weight, false);
+  m.define(R"(
+    def encode(self, x):
+        return torch.relu(torch.matmul(x, self.weight))
+
+    def embed(self, x):
+        return torch.relu(torch.matmul(x, self.weight))
+
+    def score(self, x):
+        return torch.sigmoid(torch.matmul(x, self.weight))
+  )");
+  return m;
+}
+
+std::string EngineKey(
+    const torch::jit::Module& m,
+    const std::string& method_name,
+    std::vector<at::Tensor>* weights,
+    core::conversion::ConversionInfo convert_info = core::conversion::ConversionInfo()) {
+  auto graph_and_parameters = core::lowering::Lower(m, method_name, core::lowering::LowerInfo());
+  auto g = graph_and_parameters.first;
+  auto static_params = core::ir::get_static_params(g->inputs(), graph_and_parameters.second);
+  return core::CanonicalizeGraphForEngine(g, static_params, convert_info, weights);
+}
+} // namespace
+
+TEST(CoreTest, IdenticalMethodsHaveTheSameEngineKey) {
+  auto m = BuildModule(at::randn({16, 16}));
+
+  std::vector<at::Tensor> encode_weights, embed_weights, score_weights;
+  auto encode = EngineKey(m, "encode", &encode_weights);
+  ASSERT_FALSE(encode.empty());
+  ASSERT_EQ(encode, EngineKey(m, "embed", &embed_weights));
+  ASSERT_NE(encode, EngineKey(m, "score", &score_weights));
+  ASSERT_EQ(encode_weights.size(), 1UL);
+  ASSERT_TRUE(encode_weights[0].equal(embed_weights[0]));
+}
+
+TEST(CoreTest, ModulesWithTheSameWeightsHaveTheSameEngineKey) {
+  auto weight = at::randn({16, 16});
+  auto m = BuildModule(weight);
+  auto same = BuildModule(weight.clone());
+  auto other = BuildModule(weight + 1);
+
+  std::vector<at::Tensor> weights, same_weights, other_weights;
+  auto key = EngineKey(m, "encode", &weights);
+  ASSERT_EQ(key, EngineKey(same, "encode", &same_weights));
+  ASSERT_NE(key, EngineKey(other, "encode", &other_weights));
+
+  // Engines built with different settings are not shared
+  core::conversion::ConversionInfo fp16_info;
+  fp16_info.engine_settings.enabled_precisions = {nvinfer1::DataType::kHALF};
+  std::vector<at::Tensor> fp16_weights;
+  ASSERT_NE(key, EngineKey(m, "encode", &fp16_weights, fp16_info));
+}
+
+TEST(CoreTest, EngineCacheMatchesWeightsExactly) {
+  auto weight = at::randn({16, 16});
+  // Matching does not depend on the engine, which would need a GPU to deserialize
+  auto entry = [](at::Tensor w) -> core::EngineCache::Entry { return {{}, {w}}; };
+  core::EngineCache cache;
+  cache.insert("key", entry(weight));
+  ASSERT_EQ(cache.size(), 1UL);
+
+  ASSERT_NE(cache.find("key", {weight}), nullptr);
+  ASSERT_NE(cache.find("key", {weight.clone()}), nullptr);
+  ASSERT_EQ(cache.num_hits(), 2UL);
+
+  // Keys only hold hashes of the weights, different weights under the same key are not a match
+  ASSERT_EQ(cache.find("key", {weight + 1}), nullptr);
+  ASSERT_EQ(cache.find("key", {weight.to(at::kDouble)}), nullptr);
+  ASSERT_EQ(cache.find("key", {}), nullptr);
+  ASSERT_EQ(cache.find("other", {weight}), nullptr);
+  ASSERT_EQ(cache.num_hits(), 2UL);
+
+  cache.insert("key", entry(weight + 1));
+  ASSERT_EQ(cache.size(), 2UL);
+  ASSERT_NE(cache.find("key", {weight + 1}), nullptr);
+}
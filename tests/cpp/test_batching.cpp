@@ -0,0 +1,92 @@
+#include <string>
+#include <thread>
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/script.h"
+#include "torch_tensorrt/batching.h"
+
+namespace {
+// Adds the size of the batch each sample was run in, so tests can observe how requests were coalesced
+torch::jit::Module make_batch_size_module() {
+  torch::jit::Module mod("batch_size_module");
+  mod.define(R"(
+    def forward(self, x, pair: Tuple[Tensor, Tensor]):
+        return x + x.size(0), (pair[0] * 2, pair[1] - pair[0])
+  )");
+  return mod;
+}
+
+torch_tensorrt::Input batch_input(int64_t min_batch, int64_t opt_batch, int64_t max_batch, int64_t features) {
+  return torch_tensorrt::Input(
+      std::vector<int64_t>{min_batch, features},
+      std::vector<int64_t>{opt_batch, features},
+      std::vector<int64_t>{max_batch, features});
+}
+
+std::vector<torch::jit::IValue> make_request(int64_t batch_size) {
+  auto x = at::randn({batch_size, 4});
+  auto a = at::randn({batch_size, 2});
+  auto b = at::randn({batch_size, 2});
+  return {x, c10::ivalue::Tuple::create({a, b})};
+}
+
+void check_result(const std::vector<torch::jit::IValue>& request, torch::jit::IValue result, int64_t run_batch_size) {
+  auto x = request[0].toTensor();
+  auto pair = request[1].toTupleRef().elements();
+  auto outputs = result.toTupleRef().elements();
+  auto out_pair = outputs[1].toTupleRef().elements();
+  ASSERT_TRUE(torch_tensorrt::tests::util::almostEqual(outputs[0].toTensor(), x + run_batch_size));
+  ASSERT_TRUE(torch_tensorrt::tests::util::almostEqual(out_pair[0].toTensor(), pair[0].toTensor() * 2));
+  ASSERT_TRUE(
+      torch_tensorrt::tests::util::almostEqual(out_pair[1].toTensor(), pair[1].toTensor() - pair[0].toTensor()));
+}
+} // namespace
+
+TEST(CppAPITests, BatchingExecutorCoalescesConcurrentRequests) {
+  torch_tensorrt::ts::BatchingSpec spec;
+  spec.graph_inputs.inputs = {batch_input(1, 2, 4, 4), batch_input(1, 2, 4, 2), batch_input(1, 2, 4, 2)};
+  // Long enough that only a full batch triggers execution
+  spec.max_queue_delay = std::chrono::seconds(10);
+  torch_tensorrt::ts::BatchingExecutor executor(make_batch_size_module(), spec);
+  ASSERT_EQ(executor.max_batch_size(), 4);
+
+  std::vector<std::vector<torch::jit::IValue>> requests;
+  std::vector<std::future<torch::jit::IValue>> results(8);
+  for (size_t i = 0; i < results.size(); ++i) {
+    requests.push_back(make_request(1));
+  }
+
+  std::vector<std::thread> clients;
+  for (size_t i = 0; i < results.size(); ++i) {
+    clients.emplace_back([&, i]() { results[i] = executor.submit(requests[i]); });
+  }
+  for (auto& c : clients) {
+    c.join();
+  }
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    check_result(requests[i], results[i].get(), 4);
+  }
+  ASSERT_EQ(executor.num_batches_run(), 2UL);
+}
+
+TEST(CppAPITests, BatchingExecutorPadsToMinBatchAfterDeadline) {
+  torch_tensorrt::ts::BatchingSpec spec;
+  spec.graph_inputs.inputs = {batch_input(3, 4, 8, 4), batch_input(3, 4, 8, 2), batch_input(3, 4, 8, 2)};
+  spec.max_queue_delay = std::chrono::milliseconds(1);
+  torch_tensorrt::ts::BatchingExecutor executor(make_batch_size_module(), spec);
+  ASSERT_EQ(executor.min_batch_size(), 3);
+
+  auto request = make_request(2);
+  auto result = executor.submit(request).get();
+  // Only the request's samples are returned even though the batch was padded to 3
+  ASSERT_EQ(result.toTupleRef().elements()[0].toTensor().size(0), 2);
+  check_result(request, result, 3);
+}
+
+TEST(CppAPITests, BatchingExecutorRejectsOversizedRequests) {
+  torch_tensorrt::ts::BatchingSpec spec;
+  spec.graph_inputs.inputs = {batch_input(1, 2, 4, 4), batch_input(1, 2, 4, 2), batch_input(1, 2, 4, 2)};
+  torch_tensorrt::ts::BatchingExecutor executor(make_batch_size_module(), spec);
+  ASSERT_ANY_THROW(executor.submit(make_request(5)));
+}
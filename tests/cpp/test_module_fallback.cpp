@@ -62,7 +62,7 @@ TEST(CppAPITest, MobileNetModuleFallbacksCorrectlyWithOneEngine) {
   auto nodes = g->block()->nodes();
   std::size_t trt_count = 0;
   for (const auto n : nodes) {
-    if (n->kind().toQualString() == std::string("tensorrt::execute_engine")) {
+    if (n->kind().toQualString() == std::string("tensorrt::execute_engine_unpacked")) {
       trt_count++;
     }
   }
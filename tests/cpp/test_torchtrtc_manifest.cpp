@@ -0,0 +1,159 @@
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "cpp/bin/torchtrtc/manifest.h"
+#include "gtest/gtest.h"
+#include "tests/util/helpers.h"
+#include "torch/script.h"
+
+namespace {
+using torch_tensorrt::tests::util::TempPath;
+
+torchtrtc::manifest::Manifest MakeManifest(size_t num_models) {
+  torchtrtc::manifest::Manifest manifest;
+  for (size_t i = 0; i < num_models; i++) {
+    torchtrtc::manifest::ModelJob job;
+    job.name = "model_" + std::to_string(i);
+    manifest.models.push_back(job);
+  }
+  return manifest;
+}
+} // namespace
+
+TEST(CppAPITests, ManifestAppliesDefaultsAndResolvesPaths) {
+  const std::string text = R"({
+    "jobs": 3,
+    "defaults": { "enabled_precisions": ["fp16"], "min_block_size": 5, "inputs": ["(1,3,224,224)"] },
+    "models": [
+      { "name": "resnet", "input": "resnet.jit.pt", "output": "/out/resnet_trt.ts" },
+      {
+        "input": "bert.jit.pt",
+        "output": "bert.engine",
+        "inputs": ["(1,128)@i32", "(1,128)@i32"],
+        "enabled_precisions": ["fp32", "fp16"],
+        "save_engine": true,
+        "torch_executed_ops": ["aten::gelu"]
+      }
+    ]
+  })";
+  auto manifest = torchtrtc::manifest::parse_manifest(text, "/models");
+
+  ASSERT_EQ(manifest.jobs, 3u);
+  ASSERT_EQ(manifest.models.size(), 2u);
+
+  auto& resnet = manifest.models[0];
+  ASSERT_EQ(resnet.name, "resnet");
+  ASSERT_EQ(resnet.input_path, "/models/resnet.jit.pt");
+  ASSERT_EQ(resnet.output_path, "/out/resnet_trt.ts");
+  ASSERT_EQ(resnet.enabled_precisions, std::vector<std::string>({"fp16"}));
+  ASSERT_EQ(resnet.min_block_size, 5u);
+  ASSERT_EQ(resnet.input_specs, std::vector<std::string>({"(1,3,224,224)"}));
+
+  auto& bert = manifest.models[1];
+  ASSERT_EQ(bert.name, "bert.jit.pt");
+  ASSERT_EQ(bert.input_path, "/models/bert.jit.pt");
+  ASSERT_EQ(bert.input_specs.size(), 2u);
+  ASSERT_EQ(bert.enabled_precisions.size(), 2u);
+  ASSERT_EQ(bert.min_block_size, 5u);
+  ASSERT_TRUE(bert.save_engine);
+
+  auto spec = torchtrtc::manifest::to_compile_spec(bert);
+  ASSERT_EQ(spec.graph_inputs.inputs.size(), 2u);
+  ASSERT_EQ(spec.min_block_size, 5u);
+  ASSERT_EQ(spec.enabled_precisions.size(), 2u);
+  ASSERT_EQ(spec.torch_executed_ops, std::vector<std::string>({"aten::gelu"}));
+}
+
+TEST(CppAPITests, ManifestRejectsInvalidManifests) {
+  auto parse = [](const std::string& text) { return torchtrtc::manifest::parse_manifest(text); };
+  // Not JSON
+  ASSERT_THROW(parse("{\"models\": [}"), std::runtime_error);
+  ASSERT_THROW(parse("{\"models\": []} trailing"), std::runtime_error);
+  // No models
+  ASSERT_THROW(parse("{}"), std::runtime_error);
+  // Missing paths
+  ASSERT_THROW(parse(R"({"models": [{"input": "a.jit.pt"}]})"), std::runtime_error);
+  ASSERT_THROW(parse(R"({"models": [{"output": "a.ts"}]})"), std::runtime_error);
+  // Wrong types
+  ASSERT_THROW(parse(R"({"models": [{"input": "a", "output": "b", "min_block_size": "3"}]})"), std::runtime_error);
+  ASSERT_THROW(parse(R"({"models": [{"input": "a", "output": "b", "inputs": "(1,3)"}]})"), std::runtime_error);
+  // Invalid settings
+  ASSERT_THROW(parse(R"({"models": [{"input": "a", "output": "b", "device_type": "tpu"}]})"), std::runtime_error);
+  ASSERT_THROW(
+      parse(R"({"models": [{"input": "a", "output": "b", "enabled_precisions": ["fp64"]}]})"), std::runtime_error);
+  ASSERT_THROW(
+      parse(R"({"models": [{"input": "a", "output": "b", "require_full_compilation": true,
+                            "torch_executed_ops": ["aten::relu"]}]})"),
+      std::runtime_error);
+
+  ASSERT_EQ(parse(R"({"models": []})").models.size(), 0u);
+}
+
+TEST(CppAPITests, ManifestSchedulerBoundsConcurrencyAndIsolatesFailures) {
+  auto manifest = MakeManifest(12);
+  torch_tensorrt::tests::util::ConcurrencyProbe probe;
+  auto results = torchtrtc::manifest::run_manifest(manifest, 3, [&](const torchtrtc::manifest::ModelJob& job) {
+    probe.run([]() { std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+    if (job.name == "model_4") {
+      throw std::runtime_error("conversion failed");
+    }
+    return static_cast<uint64_t>(job.name.size());
+  });
+
+  ASSERT_LE(probe.max_running(), 3u);
+  ASSERT_GT(probe.max_running(), 1u);
+  ASSERT_EQ(results.size(), manifest.models.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    // Results come back in the order of the manifest
+    ASSERT_EQ(results[i].name, manifest.models[i].name);
+    if (i == 4) {
+      ASSERT_FALSE(results[i].success);
+      ASSERT_EQ(results[i].error, "conversion failed");
+    } else {
+      ASSERT_TRUE(results[i].success);
+      ASSERT_EQ(results[i].num_engines, results[i].name.size());
+    }
+    ASSERT_GT(results[i].seconds, 0);
+  }
+
+  auto summary = torchtrtc::manifest::summarize(results, 1.0);
+  ASSERT_NE(summary.find("FAILED"), std::string::npos);
+  ASSERT_NE(summary.find("conversion failed"), std::string::npos);
+  ASSERT_NE(summary.find("11 of 12 models compiled, 1 failed"), std::string::npos);
+}
+
+TEST(CppAPITests, ManifestDryRunChecksModelsWithoutCompiling) {
+  auto model_path = TempPath("torchtrtc_manifest_relu.jit.pt");
+  torch::jit::Module mod("Relu");
+  mod.define(R"(
+    def forward(self, x):
+        return torch.relu(x)
+  )");
+  mod.save(model_path);
+
+  auto manifest = torchtrtc::manifest::parse_manifest(
+      R"({"models": [
+        { "name": "relu", "input": ")" + model_path + R"(", "output": "relu_trt.ts", "inputs": ["(1,3,8,8)"] },
+        { "name": "missing", "input": "does_not_exist.jit.pt", "output": "missing_trt.ts", "inputs": ["(1,3,8,8)"] },
+        { "name": "no_method", "input": ")" +
+          model_path + R"(", "output": "x.ts", "method": "predict", "inputs": ["(1,3,8,8)"] },
+        { "name": "bad_input", "input": ")" + model_path + R"(", "output": "y.ts", "inputs": ["(1,3,8,8"] },
+        { "name": "bad_dtype", "input": ")" + model_path + R"(", "output": "z.ts", "inputs": ["(1,3,8,8)@f64"] }
+      ]})",
+      TempPath(""));
+  auto results = torchtrtc::manifest::run_manifest(manifest, 2, torchtrtc::manifest::check_job);
+
+  ASSERT_EQ(results.size(), 5u);
+  ASSERT_TRUE(results[0].success) << results[0].error;
+  ASSERT_EQ(results[0].num_engines, 0u);
+  ASSERT_FALSE(results[1].success);
+  ASSERT_FALSE(results[2].success);
+  // Invalid input specs fail their own model instead of exiting
+  ASSERT_FALSE(results[3].success);
+  ASSERT_NE(results[3].error.find("Shapes need dimensions"), std::string::npos);
+  ASSERT_FALSE(results[4].success);
+  ASSERT_NE(results[4].error.find("Invalid datatype"), std::string::npos);
+  std::remove(model_path.c_str());
+}
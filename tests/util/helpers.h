@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+
+// Helpers of tests which do not need libtorch or TensorRT
+namespace torch_tensorrt {
+namespace tests {
+namespace util {
+
+// Path of a file in the temporary directory of the test
+inline std::string TempPath(const std::string& name) {
+  auto dir = std::getenv("TEST_TMPDIR");
+  return std::string(dir ? dir : "/tmp") + "/" + name;
+}
+
+// Records how many of the tasks given to run are running at the same time, to check the bound of a pool or scheduler
+class ConcurrencyProbe {
+ public:
+  template <typename F>
+  void run(F f) {
+    auto now = ++running_;
+    auto prev = max_running_.load();
+    while (now > prev && !max_running_.compare_exchange_weak(prev, now)) {
+    }
+    f();
+    running_--;
+  }
+
+  size_t max_running() const {
+    return max_running_.load();
+  }
+
+ private:
+  std::atomic<size_t> running_{0};
+  std::atomic<size_t> max_running_{0};
+};
+
+} // namespace util
+} // namespace tests
+} // namespace torch_tensorrt